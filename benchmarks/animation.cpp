@@ -0,0 +1,189 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include <y/test/bench.h>
+
+#include <yave/animations/AnimationClip.h>
+#include <yave/animations/pose.h>
+
+#include <y/utils/format.h>
+
+namespace {
+using namespace yave;
+
+static constexpr usize character_count = 1000;
+static constexpr usize bone_count = 100;
+static constexpr usize key_count = 120;
+static constexpr float key_interval = 1.0f / 30.0f;
+static constexpr float frame_time = 1.0f / 60.0f;
+
+static core::Vector<Bone> create_bones() {
+    core::Vector<Bone> bones;
+    for(usize i = 0; i != bone_count; ++i) {
+        Bone bone;
+        bone.name = fmt("bone_{}", i);
+        // Chains of 10 bones
+        bone.parent = i % 10 ? u32(i - 1) : u32(-1);
+        bone.local_transform.position = math::Vec3(0.0f, 0.0f, 1.0f);
+        bones << std::move(bone);
+    }
+    return bones;
+}
+
+static Animation create_animation() {
+    core::Vector<AnimationChannel> channels;
+    // Channels in reverse order and one bone in 10 without channel, to not make name lookups trivial
+    for(usize i = bone_count; i != 0; --i) {
+        if(i % 10 == 5) {
+            continue;
+        }
+
+        core::Vector<AnimationChannel::BoneKey> keys;
+        for(usize k = 0; k != key_count; ++k) {
+            const float angle = float(k + i) * 0.1f;
+            BoneTransform tr;
+            tr.position = math::Vec3(0.0f, 0.0f, 1.0f + std::sin(angle) * 0.1f);
+            tr.rotation = math::Quaternion<>::from_euler(angle, angle * 0.5f, 0.0f);
+            keys << AnimationChannel::BoneKey{float(k) * key_interval, tr};
+        }
+        channels << AnimationChannel(fmt("bone_{}", i - 1), std::move(keys));
+    }
+    return Animation(float(key_count - 1) * key_interval, std::move(channels));
+}
+
+struct Character {
+    float time = 0.0f;
+    core::Vector<u32> cursors = core::Vector<u32>(bone_count, 0);
+    core::Vector<BoneTransform> pose = core::Vector<BoneTransform>(bone_count, BoneTransform());
+};
+
+static core::Vector<Character> create_characters(float duration) {
+    core::Vector<Character> characters(character_count, Character());
+    for(usize i = 0; i != character_count; ++i) {
+        characters[i].time = std::fmod(float(i) * 0.37f, duration);
+    }
+    return characters;
+}
+
+y_bench_func("Animation sample by name") {
+    const core::Vector<Bone> bones = create_bones();
+    const Animation animation = create_animation();
+    core::Vector<Character> characters = create_characters(animation.duration());
+
+    bench.set_items_per_iteration(character_count * bone_count);
+    bench.run([&] {
+        for(Character& character : characters) {
+            character.time = std::fmod(character.time + frame_time, animation.duration());
+            for(usize i = 0; i != bone_count; ++i) {
+                math::Transform<> tr = animation.bone_transform(bones[i].name, character.time).value_or(bones[i].transform());
+                test::do_not_optimize(tr);
+            }
+        }
+    });
+}
+
+y_bench_func("AnimationClip sample") {
+    const Skeleton skeleton(create_bones());
+    const Animation animation = create_animation();
+    const AnimationClip clip(&animation, &skeleton);
+    core::Vector<Character> characters = create_characters(animation.duration());
+
+    bench.set_items_per_iteration(character_count * bone_count);
+    bench.run([&] {
+        for(Character& character : characters) {
+            character.time = std::fmod(character.time + frame_time, animation.duration());
+            clip.sample(character.time, character.cursors, character.pose);
+            test::do_not_optimize(character.pose);
+        }
+    });
+}
+
+y_bench_func("AnimationClip sample random seek") {
+    const Skeleton skeleton(create_bones());
+    const Animation animation = create_animation();
+    const AnimationClip clip(&animation, &skeleton);
+    core::Vector<Character> characters = create_characters(animation.duration());
+
+    bench.set_items_per_iteration(character_count * bone_count);
+    bench.run([&] {
+        for(Character& character : characters) {
+            character.time = std::fmod(character.time + 1.7f, animation.duration());
+            clip.sample(character.time, character.cursors, character.pose);
+            test::do_not_optimize(character.pose);
+        }
+    });
+}
+
+struct PoseBatch {
+    core::Vector<Character> characters;
+    core::Vector<math::Transform<>> palettes;
+    core::Vector<PoseJob> jobs;
+
+    PoseBatch(const AnimationClip& clip) : characters(create_characters(clip.duration())), palettes(character_count * bone_count, math::Transform<>()) {
+        for(usize i = 0; i != character_count; ++i) {
+            jobs << PoseJob {
+                &clip,
+                characters[i].time,
+                characters[i].cursors,
+                core::MutableSpan<math::Transform<>>(palettes.data() + i * bone_count, bone_count),
+            };
+        }
+    }
+
+    void advance(float dt, float duration) {
+        for(PoseJob& job : jobs) {
+            job.time = std::fmod(job.time + dt, duration);
+        }
+    }
+};
+
+y_bench_func("Pose evaluation") {
+    const Skeleton skeleton(create_bones());
+    const Animation animation = create_animation();
+    const AnimationClip clip(&animation, &skeleton);
+    PoseBatch batch(clip);
+
+    bench.set_items_per_iteration(character_count * bone_count);
+    bench.run([&] {
+        batch.advance(frame_time, animation.duration());
+        evaluate_poses(batch.jobs);
+        test::do_not_optimize(batch.palettes);
+    });
+}
+
+y_bench_func("Pose evaluation parallel") {
+    const Skeleton skeleton(create_bones());
+    const Animation animation = create_animation();
+    const AnimationClip clip(&animation, &skeleton);
+    PoseBatch batch(clip);
+
+    concurrent::StaticThreadPool thread_pool;
+
+    bench.set_items_per_iteration(character_count * bone_count);
+    bench.run([&] {
+        batch.advance(frame_time, animation.duration());
+        evaluate_poses(batch.jobs, &thread_pool);
+        test::do_not_optimize(batch.palettes);
+    });
+}
+
+}
@@ -0,0 +1,161 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include <y/test/bench.h>
+
+#include <yave/assets/AssetPathTree.h>
+
+#include <y/utils/format.h>
+
+#include <map>
+
+namespace {
+using namespace yave;
+
+// 50 folders of 10 sub folders of 100 assets
+static constexpr usize top_folder_count = 50;
+static constexpr usize sub_folder_count = 10;
+static constexpr usize assets_per_folder = 100;
+static constexpr usize asset_count = top_folder_count * sub_folder_count * assets_per_folder;
+
+template<typename F>
+static void for_each_asset_path(F&& func) {
+    u64 id = 0;
+    for(usize i = 0; i != top_folder_count; ++i) {
+        for(usize j = 0; j != sub_folder_count; ++j) {
+            for(usize k = 0; k != assets_per_folder; ++k) {
+                func(core::String(fmt("folder_{}/sub_folder_{}/asset_{}", i, j, k)), AssetId::from_id(id++));
+            }
+        }
+    }
+}
+
+// add_asset doesn't create missing parent folders
+static void add_asset(AssetPathTree& tree, std::string_view path, AssetId id) {
+    const usize separator = path.rfind('/');
+    if(separator != std::string_view::npos) {
+        y_always_assert(tree.create_folder(path.substr(0, separator)), "Unable to create folder");
+    }
+    y_always_assert(tree.add_asset(path, AssetPathTree::AssetData{id, AssetType::Mesh, 0}), "Unable to add asset");
+}
+
+static void fill(AssetPathTree& tree) {
+    for_each_asset_path([&](const core::String& path, AssetId id) {
+        add_asset(tree, path, id);
+    });
+    y_always_assert(tree.asset_count() == asset_count, "Tree is incomplete");
+}
+
+static const AssetPathTree::Node* find(const AssetPathTree& tree, std::string_view path) {
+    const AssetPathTree::Node* node = tree.find(path);
+    y_always_assert(node, "Path not found");
+    return node;
+}
+
+y_bench_func("AssetPathTree build") {
+    core::Vector<std::pair<core::String, AssetId>> paths;
+    for_each_asset_path([&](const core::String& path, AssetId id) {
+        paths.emplace_back(path, id);
+    });
+
+    bench.set_items_per_iteration(asset_count);
+    bench.run([&] {
+        AssetPathTree tree;
+        for(const auto& [path, id] : paths) {
+            add_asset(tree, path, id);
+        }
+        test::do_not_optimize(tree);
+    });
+}
+
+y_bench_func("AssetPathTree list folder") {
+    AssetPathTree tree;
+    fill(tree);
+
+    bench.set_items_per_iteration(assets_per_folder);
+    bench.run([&] {
+        usize total_size = 0;
+        find(tree, "folder_25/sub_folder_5")->for_each_child([&](const AssetPathTree::Node& node) {
+            total_size += node.name().size();
+        });
+        test::do_not_optimize(total_size);
+    });
+}
+
+// What folder listing used to cost: a prefix scan over an ordered map of full paths
+y_bench_func("Sorted path map list folder") {
+    std::map<core::String, AssetId> assets;
+    for_each_asset_path([&](const core::String& path, AssetId id) {
+        assets.emplace(path, id);
+    });
+
+    const std::string_view folder = "folder_25/sub_folder_5";
+
+    bench.set_items_per_iteration(assets_per_folder);
+    bench.run([&] {
+        usize total_size = 0;
+        for(auto it = assets.lower_bound(folder); it != assets.end() && it->first.starts_with(folder); ++it) {
+            total_size += it->first.size() - folder.size();
+        }
+        test::do_not_optimize(total_size);
+    });
+}
+
+y_bench_func("AssetPathTree find by path") {
+    AssetPathTree tree;
+    fill(tree);
+
+    find(tree, "folder_42/sub_folder_7/asset_63");
+
+    bench.run([&] {
+        test::do_not_optimize(tree.find("folder_42/sub_folder_7/asset_63"));
+    });
+}
+
+y_bench_func("AssetPathTree path from id") {
+    AssetPathTree tree;
+    fill(tree);
+
+    u64 id = 0;
+    bench.run([&] {
+        id = (id + 7919) % asset_count;
+        core::String path = tree.path(tree.find(AssetId::from_id(id)));
+        test::do_not_optimize(path);
+    });
+}
+
+y_bench_func("AssetPathTree rename folder") {
+    AssetPathTree tree;
+    fill(tree);
+
+    const AssetPathTree::Node* folder = find(tree, "folder_10");
+    bool renamed = false;
+
+    bench.set_items_per_iteration(sub_folder_count * assets_per_folder);
+    bench.run([&] {
+        y_always_assert(tree.move(folder, renamed ? "folder_10" : "renamed/folder_10"), "Unable to move folder");
+        renamed = !renamed;
+        test::do_not_optimize(folder);
+    });
+}
+
+}
@@ -0,0 +1,179 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include <y/test/bench.h>
+
+#include <yave/graphics/images/block_compression.h>
+
+#include <y/core/Vector.h>
+#include <y/math/random.h>
+
+namespace {
+using namespace yave;
+
+static constexpr usize image_size = 128;
+static constexpr usize texel_count = image_size * image_size;
+
+// Smooth gradients, hard edges with anti-correlated channels, some noise and an alpha ramp
+static core::Vector<u8> create_image() {
+    math::FastRandom rng;
+
+    core::Vector<u8> image;
+    image.set_min_capacity(texel_count * 4);
+    for(usize y = 0; y != image_size; ++y) {
+        for(usize x = 0; x != image_size; ++x) {
+            const float fx = float(x) / float(image_size);
+            const float fy = float(y) / float(image_size);
+
+            float rgb[] = {
+                0.5f + 0.4f * std::sin(fx * 9.0f + fy * 3.0f),
+                0.5f + 0.4f * std::cos(fy * 7.0f - fx * 2.0f),
+                fx * fy,
+            };
+            if(((x / 37) + (y / 23)) % 3 == 0) {
+                rgb[0] = 1.0f - rgb[0];
+                rgb[2] = 0.9f;
+            }
+
+            for(const float c : rgb) {
+                const float noise = float(rng() % 9) - 4.0f;
+                image << u8(std::clamp(c * 255.0f + noise, 0.0f, 255.0f));
+            }
+            image << u8(std::clamp(fx * 300.0f, 0.0f, 255.0f));
+        }
+    }
+    return image;
+}
+
+static void load_block(const core::Vector<u8>& image, usize block_x, usize block_y, u8* block) {
+    for(usize y = 0; y != 4; ++y) {
+        std::memcpy(block + y * 16, image.data() + ((block_y + y) * image_size + block_x) * 4, 16);
+    }
+}
+
+template<typename E>
+static void compress_image(const core::Vector<u8>& image, E&& encode) {
+    u8 block[64];
+    for(usize y = 0; y != image_size; y += 4) {
+        for(usize x = 0; x != image_size; x += 4) {
+            load_block(image, x, y, block);
+            const auto compressed = encode(block);
+            test::do_not_optimize(compressed);
+        }
+    }
+}
+
+// PSNR over the first channel_count channels
+template<typename E, typename D>
+static double compute_psnr(const core::Vector<u8>& image, usize channel_count, E&& encode, D&& decode) {
+    double squared_error = 0.0;
+
+    u8 block[64];
+    u8 decoded[64];
+    for(usize y = 0; y != image_size; y += 4) {
+        for(usize x = 0; x != image_size; x += 4) {
+            load_block(image, x, y, block);
+            std::copy_n(block, 64, decoded);
+            decode(encode(block), decoded);
+
+            for(usize i = 0; i != 16; ++i) {
+                for(usize c = 0; c != channel_count; ++c) {
+                    const double diff = double(block[i * 4 + c]) - double(decoded[i * 4 + c]);
+                    squared_error += diff * diff;
+                }
+            }
+        }
+    }
+
+    const double mse = squared_error / double(texel_count * channel_count);
+    return 10.0 * std::log10(255.0 * 255.0 / std::max(mse, 1e-9));
+}
+
+// Checks the quality before measuring the throughput, so regressions in either show up here
+template<typename E, typename D>
+static void bench_compression(test::Bench& bench, usize channel_count, double min_psnr, E&& encode, D&& decode) {
+    const core::Vector<u8> image = create_image();
+
+    const double psnr = compute_psnr(image, channel_count, encode, decode);
+    y_always_assert(psnr >= min_psnr, "Compression quality regressed");
+
+    bench.set_items_per_iteration(texel_count);
+    bench.set_bytes_per_iteration(texel_count * 4);
+    bench.run([&] {
+        compress_image(image, encode);
+    });
+}
+
+static const auto decode_bc1 = [](Block64 block, u8* texels) { decode_bc1_block(block, texels); };
+static const auto decode_bc4 = [](Block64 block, u8* texels) { decode_bc4_block(block, texels); };
+static const auto decode_bc5 = [](const Block128& block, u8* texels) { decode_bc5_block(block, texels); };
+static const auto decode_bc7 = [](const Block128& block, u8* texels) { decode_bc7_block(block, texels); };
+
+y_bench_func("BC1 compression (fast)") {
+    bench_compression(bench, 3, 33.5, [](const u8* block) { return encode_bc1_block(block, BlockCompressionQuality::Fast); }, decode_bc1);
+}
+
+y_bench_func("BC1 compression (normal)") {
+    bench_compression(bench, 3, 35.5, [](const u8* block) { return encode_bc1_block(block, BlockCompressionQuality::Normal); }, decode_bc1);
+}
+
+y_bench_func("BC1 compression (high)") {
+    bench_compression(bench, 3, 35.5, [](const u8* block) { return encode_bc1_block(block, BlockCompressionQuality::High); }, decode_bc1);
+}
+
+y_bench_func("BC4 compression (fast)") {
+    bench_compression(bench, 1, 40.5, [](const u8* block) { return encode_bc4_block(block, 0, BlockCompressionQuality::Fast); }, decode_bc4);
+}
+
+y_bench_func("BC4 compression (normal)") {
+    bench_compression(bench, 1, 41.0, [](const u8* block) { return encode_bc4_block(block, 0, BlockCompressionQuality::Normal); }, decode_bc4);
+}
+
+y_bench_func("BC4 compression (high)") {
+    bench_compression(bench, 1, 42.5, [](const u8* block) { return encode_bc4_block(block, 0, BlockCompressionQuality::High); }, decode_bc4);
+}
+
+y_bench_func("BC5 compression (fast)") {
+    bench_compression(bench, 2, 43.0, [](const u8* block) { return encode_bc5_block(block, BlockCompressionQuality::Fast); }, decode_bc5);
+}
+
+y_bench_func("BC5 compression (normal)") {
+    bench_compression(bench, 2, 43.5, [](const u8* block) { return encode_bc5_block(block, BlockCompressionQuality::Normal); }, decode_bc5);
+}
+
+y_bench_func("BC5 compression (high)") {
+    bench_compression(bench, 2, 45.0, [](const u8* block) { return encode_bc5_block(block, BlockCompressionQuality::High); }, decode_bc5);
+}
+
+y_bench_func("BC7 compression (fast)") {
+    bench_compression(bench, 4, 37.5, [](const u8* block) { return encode_bc7_block(block, BlockCompressionQuality::Fast); }, decode_bc7);
+}
+
+y_bench_func("BC7 compression (normal)") {
+    bench_compression(bench, 4, 38.0, [](const u8* block) { return encode_bc7_block(block, BlockCompressionQuality::Normal); }, decode_bc7);
+}
+
+y_bench_func("BC7 compression (high)") {
+    bench_compression(bench, 4, 38.5, [](const u8* block) { return encode_bc7_block(block, BlockCompressionQuality::High); }, decode_bc7);
+}
+
+}
@@ -0,0 +1,130 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include <y/test/bench.h>
+
+#include <yave/ecs/SparseComponentSet.h>
+
+#include <y/math/random.h>
+
+namespace {
+using namespace yave;
+using namespace yave::ecs;
+
+static constexpr u32 entity_count = 64 * 1024;
+
+struct Position {
+    math::Vec3 pos;
+};
+
+struct Velocity {
+    math::Vec3 vel;
+};
+
+static void fill(SparseComponentSet<Position>& positions, SparseComponentSet<Velocity>& velocities) {
+    for(u32 i = 0; i != entity_count; ++i) {
+        positions.insert(EntityId(i), Position{math::Vec3(float(i))});
+        // Only one entity in 2 has a velocity
+        if(i % 2) {
+            velocities.insert(EntityId(i), Velocity{math::Vec3(1.0f)});
+        }
+    }
+}
+
+y_bench_func("SparseComponentSet insert") {
+    bench.set_items_per_iteration(entity_count);
+    bench.run([] {
+        SparseComponentSet<Position> positions;
+        for(u32 i = 0; i != entity_count; ++i) {
+            positions.insert(EntityId(i), Position{});
+        }
+        test::do_not_optimize(positions);
+    });
+}
+
+y_bench_func("SparseComponentSet iterate") {
+    SparseComponentSet<Position> positions;
+    SparseComponentSet<Velocity> velocities;
+    fill(positions, velocities);
+
+    bench.set_items_per_iteration(entity_count);
+    bench.run([&] {
+        math::Vec3 sum;
+        for(const Position& p : positions.values()) {
+            sum += p.pos;
+        }
+        test::do_not_optimize(sum);
+    });
+}
+
+y_bench_func("SparseComponentSet iterate pairs") {
+    SparseComponentSet<Position> positions;
+    SparseComponentSet<Velocity> velocities;
+    fill(positions, velocities);
+
+    bench.set_items_per_iteration(entity_count);
+    bench.run([&] {
+        u32 sum = 0;
+        for(auto&& [id, p] : positions) {
+            sum += id.index();
+        }
+        test::do_not_optimize(sum);
+    });
+}
+
+y_bench_func("SparseComponentSet join") {
+    SparseComponentSet<Position> positions;
+    SparseComponentSet<Velocity> velocities;
+    fill(positions, velocities);
+
+    bench.set_items_per_iteration(velocities.size());
+    bench.run([&] {
+        for(auto&& [id, v] : velocities) {
+            if(Position* p = positions.try_get(id)) {
+                p->pos += v.vel;
+            }
+        }
+    });
+}
+
+y_bench_func("SparseComponentSet random lookup") {
+    SparseComponentSet<Position> positions;
+    SparseComponentSet<Velocity> velocities;
+    fill(positions, velocities);
+
+    math::FastRandom rng;
+    core::Vector<EntityId> ids;
+    for(u32 i = 0; i != entity_count; ++i) {
+        ids << EntityId(rng() % entity_count);
+    }
+
+    bench.set_items_per_iteration(ids.size());
+    bench.run([&] {
+        usize found = 0;
+        for(const EntityId id : ids) {
+            found += velocities.contains(id);
+        }
+        test::do_not_optimize(found);
+    });
+}
+
+}
@@ -0,0 +1,85 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include <y/test/bench.h>
+
+#include <yave/camera/Frustum.h>
+
+#include <y/core/Vector.h>
+#include <y/math/random.h>
+#include <y/math/math.h>
+
+namespace {
+using namespace yave;
+
+static constexpr usize aabb_count = 16 * 1024;
+
+static core::Vector<AABB> random_aabbs() {
+    math::FastRandom rng;
+    const auto rand_float = [&](float range) {
+        return (float(rng()) / float(math::FastRandom::max()) * 2.0f - 1.0f) * range;
+    };
+
+    core::Vector<AABB> aabbs;
+    for(usize i = 0; i != aabb_count; ++i) {
+        const math::Vec3 center(rand_float(100.0f), rand_float(100.0f), rand_float(100.0f));
+        const math::Vec3 extent(1.0f + std::abs(rand_float(5.0f)));
+        aabbs << AABB::from_center_extent(center, extent);
+    }
+    return aabbs;
+}
+
+static Frustum create_frustum() {
+    const math::Matrix4<> view = math::look_at(math::Vec3(0.0f), math::Vec3(1.0f, 0.0f, 0.0f), math::Vec3(0.0f, 0.0f, 1.0f));
+    const math::Matrix4<> proj = math::perspective(math::to_rad(60.0f), 16.0f / 9.0f, 0.1f);
+    return Frustum::from_view_proj(view, proj);
+}
+
+y_bench_func("Frustum intersection") {
+    const Frustum frustum = create_frustum();
+    const core::Vector<AABB> aabbs = random_aabbs();
+
+    bench.set_items_per_iteration(aabbs.size());
+    bench.run([&] {
+        usize visible = 0;
+        for(const AABB& aabb : aabbs) {
+            visible += frustum.intersection(aabb) != Intersection::Outside;
+        }
+        test::do_not_optimize(visible);
+    });
+}
+
+y_bench_func("Frustum intersection (far distance)") {
+    const Frustum frustum = create_frustum();
+    const core::Vector<AABB> aabbs = random_aabbs();
+
+    bench.set_items_per_iteration(aabbs.size());
+    bench.run([&] {
+        usize visible = 0;
+        for(const AABB& aabb : aabbs) {
+            visible += frustum.intersection(aabb, 50.0f) != Intersection::Outside;
+        }
+        test::do_not_optimize(visible);
+    });
+}
+
+}
@@ -0,0 +1,204 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include <y/test/bench.h>
+
+#include <yave/meshes/mesh_optimization.h>
+
+#include <y/core/Vector.h>
+#include <y/math/random.h>
+#include <y/utils/log.h>
+#include <y/utils/format.h>
+
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+namespace {
+using namespace yave;
+
+static constexpr usize sphere_rings = 128;
+static constexpr usize sphere_segments = 256;
+
+// UV sphere with triangles and vertices shuffled, to simulate a badly ordered mesh
+static std::pair<MeshVertexStreams, core::Vector<IndexedTriangle>> create_mesh() {
+    const usize row_size = sphere_segments + 1;
+
+    core::Vector<PackedVertex> vertices;
+    for(usize r = 0; r <= sphere_rings; ++r) {
+        const float theta = math::pi<float> * float(r) / float(sphere_rings);
+        for(usize s = 0; s != row_size; ++s) {
+            const float phi = 2.0f * math::pi<float> * float(s) / float(sphere_segments);
+            const math::Vec3 normal(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+            vertices << pack_vertex(FullVertex{normal, normal, math::Vec4(1.0f, 0.0f, 0.0f, 1.0f), math::Vec2(float(s), float(r))});
+        }
+    }
+
+    core::Vector<IndexedTriangle> triangles;
+    for(usize r = 0; r != sphere_rings; ++r) {
+        for(usize s = 0; s != sphere_segments; ++s) {
+            const u32 a = u32(r * row_size + s);
+            const u32 b = a + 1;
+            const u32 c = u32(a + row_size);
+            const u32 d = c + 1;
+            triangles << IndexedTriangle{a, c, b} << IndexedTriangle{b, c, d};
+        }
+    }
+
+    math::FastRandom rng;
+    std::shuffle(triangles.begin(), triangles.end(), rng);
+
+    core::Vector<u32> shuffled_vertices(vertices.size(), 0);
+    std::iota(shuffled_vertices.begin(), shuffled_vertices.end(), 0);
+    std::shuffle(shuffled_vertices.begin(), shuffled_vertices.end(), rng);
+
+    core::Vector<u32> remap(vertices.size(), 0);
+    for(usize i = 0; i != shuffled_vertices.size(); ++i) {
+        remap[shuffled_vertices[i]] = u32(i);
+    }
+    for(IndexedTriangle& tri : triangles) {
+        for(u32& index : tri) {
+            index = remap[index];
+        }
+    }
+
+    return {MeshVertexStreams(vertices).reordered(shuffled_vertices), std::move(triangles)};
+}
+
+static void log_stats(const char* name, const MeshVertexStreams& streams, core::Span<IndexedTriangle> triangles) {
+    const VertexCacheStats cache = analyze_vertex_cache(triangles, streams.vertex_count());
+    const VertexFetchStats fetch = analyze_vertex_fetch(triangles, streams.vertex_count(), sizeof(math::Vec3));
+    log_msg(fmt("{}: ACMR = {:.3f}, ATVR = {:.3f}, position overfetch = {:.3f}", name, cache.acmr, cache.atvr, fetch.overfetch), Log::Perf);
+}
+
+y_bench_func("Mesh vertex cache optimization") {
+    auto [streams, triangles] = create_mesh();
+
+    const VertexCacheStats before = analyze_vertex_cache(triangles, streams.vertex_count());
+    log_stats("Shuffled", streams, triangles);
+
+    core::Vector<IndexedTriangle> optimized(triangles);
+    optimize_vertex_cache(optimized, streams.vertex_count());
+    log_stats("Vertex cache optimized", streams, optimized);
+
+    const VertexCacheStats after = analyze_vertex_cache(optimized, streams.vertex_count());
+    y_always_assert(after.acmr < 0.75f && after.acmr < before.acmr * 0.5f, "Vertex cache optimization regressed");
+
+    bench.set_items_per_iteration(triangles.size());
+    bench.run([&] {
+        core::Vector<IndexedTriangle> tris(triangles);
+        optimize_vertex_cache(tris, streams.vertex_count());
+        test::do_not_optimize(tris);
+    });
+}
+
+y_bench_func("Mesh overdraw optimization") {
+    auto [streams, triangles] = create_mesh();
+    optimize_vertex_cache(triangles, streams.vertex_count());
+
+    const VertexCacheStats before = analyze_vertex_cache(triangles, streams.vertex_count());
+
+    core::Vector<IndexedTriangle> optimized(triangles);
+    optimize_overdraw(optimized, streams.stream<VertexStreamType::Position>(), 1.05f);
+    log_stats("Overdraw optimized", streams, optimized);
+
+    // Cluster boundaries flush the cache, the threshold bounds the loss
+    const VertexCacheStats after = analyze_vertex_cache(optimized, streams.vertex_count());
+    y_always_assert(after.acmr <= before.acmr * 1.1f, "Overdraw optimization degraded vertex cache efficiency");
+
+    bench.set_items_per_iteration(triangles.size());
+    bench.run([&] {
+        core::Vector<IndexedTriangle> tris(triangles);
+        optimize_overdraw(tris, streams.stream<VertexStreamType::Position>(), 1.05f);
+        test::do_not_optimize(tris);
+    });
+}
+
+y_bench_func("Mesh vertex fetch optimization") {
+    auto [streams, triangles] = create_mesh();
+    optimize_vertex_cache(triangles, streams.vertex_count());
+
+    const VertexFetchStats before = analyze_vertex_fetch(triangles, streams.vertex_count(), sizeof(math::Vec3));
+    log_stats("Vertex cache optimized", streams, triangles);
+
+    core::Vector<IndexedTriangle> optimized(triangles);
+    const core::Vector<u32> vertices = optimize_vertex_fetch(optimized, streams.vertex_count());
+    const MeshVertexStreams reordered = streams.reordered(vertices);
+    log_stats("Vertex fetch optimized", reordered, optimized);
+
+    const VertexFetchStats after = analyze_vertex_fetch(optimized, reordered.vertex_count(), sizeof(math::Vec3));
+    y_always_assert(after.overfetch < 2.5f && after.overfetch < before.overfetch * 0.5f, "Vertex fetch optimization regressed");
+
+    for(usize i = 0; i != triangles.size(); ++i) {
+        for(usize k = 0; k != 3; ++k) {
+            y_always_assert(vertices[optimized[i][k]] == triangles[i][k], "Vertex fetch optimization broke indices");
+        }
+    }
+
+    bench.set_items_per_iteration(triangles.size());
+    bench.run([&] {
+        core::Vector<IndexedTriangle> tris(triangles);
+        const auto remap = optimize_vertex_fetch(tris, streams.vertex_count());
+        test::do_not_optimize(remap);
+    });
+}
+
+y_bench_func("Meshlet generation") {
+    auto [streams, triangles] = create_mesh();
+    optimize_mesh(streams, triangles);
+
+    const core::Span<math::Vec3> positions = streams.stream<VertexStreamType::Position>();
+
+    MeshletData meshlets;
+    build_meshlets(meshlets, triangles, positions);
+
+    usize triangle_count = 0;
+    for(const Meshlet& meshlet : meshlets.meshlets) {
+        y_always_assert(meshlet.vertex_count <= max_meshlet_vertices && meshlet.triangle_count <= max_meshlet_triangles, "Meshlet is too big");
+        for(u32 t = 0; t != meshlet.triangle_count; ++t) {
+            for(u32 k = 0; k != 3; ++k) {
+                const u8 local = meshlets.triangles[(meshlet.first_triangle + t) * 3 + k];
+                y_always_assert(local < meshlet.vertex_count, "Invalid meshlet index");
+                const u32 index = meshlets.vertices[meshlet.first_vertex + local];
+                y_always_assert(index == triangles[triangle_count + t][k], "Meshlet doesn't match triangles");
+                y_always_assert((positions[index] - meshlet.center).length() <= meshlet.radius * 1.001f, "Vertex outside of meshlet bounds");
+            }
+        }
+        triangle_count += meshlet.triangle_count;
+    }
+    y_always_assert(triangle_count == triangles.size(), "Meshlets don't cover the mesh");
+
+    const usize meshlet_count = meshlets.meshlets.size();
+    const float triangles_per_meshlet = float(triangles.size()) / float(meshlet_count);
+    const float vertices_per_meshlet = float(meshlets.vertices.size()) / float(meshlet_count);
+    log_msg(fmt("{} meshlets, {:.1f} triangles and {:.1f} vertices per meshlet", meshlet_count, triangles_per_meshlet, vertices_per_meshlet), Log::Perf);
+    y_always_assert(triangles_per_meshlet > 64.0f, "Meshlets are badly filled");
+
+    bench.set_items_per_iteration(triangles.size());
+    bench.run([&] {
+        MeshletData data;
+        build_meshlets(data, triangles, positions);
+        test::do_not_optimize(data);
+    });
+}
+
+}
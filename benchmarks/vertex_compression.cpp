@@ -0,0 +1,113 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include <y/test/bench.h>
+
+#include <yave/meshes/MeshVertexStreams.h>
+
+#include <y/core/Vector.h>
+#include <y/math/random.h>
+#include <y/utils/log.h>
+#include <y/utils/format.h>
+
+#include <cmath>
+
+namespace {
+using namespace yave;
+
+static constexpr usize sphere_rings = 128;
+static constexpr usize sphere_segments = 256;
+
+static MeshVertexStreams create_streams() {
+    const math::Vec3 center(12.0f, -4.0f, 150.0f);
+    const float radius = 25.0f;
+
+    core::Vector<PackedVertex> vertices;
+    for(usize r = 0; r <= sphere_rings; ++r) {
+        const float theta = math::pi<float> * float(r) / float(sphere_rings);
+        for(usize s = 0; s <= sphere_segments; ++s) {
+            const float phi = 2.0f * math::pi<float> * float(s) / float(sphere_segments);
+            const math::Vec3 normal(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+            const math::Vec4 tangent(-std::sin(phi), std::cos(phi), 0.0f, s % 2 ? 1.0f : -1.0f);
+            const math::Vec2 uv(float(s) / float(sphere_segments), float(r) / float(sphere_rings));
+            vertices << pack_vertex(FullVertex{center + normal * radius, normal, tangent, uv * 4.0f});
+        }
+    }
+
+    return MeshVertexStreams(vertices);
+}
+
+static float angle_between(const math::Vec3& a, const math::Vec3& b) {
+    return math::to_deg(std::atan2(a.cross(b).length(), a.dot(b)));
+}
+
+y_bench_func("Compact vertex encoding") {
+    const MeshVertexStreams streams = create_streams();
+    const CompactVertexStreams compact(streams);
+    const MeshVertexStreams decoded = compact.decoded();
+
+    const math::Vec3 position_step = compact.position_range().extent / 65535.0f;
+
+    float max_position_error = 0.0f;
+    float max_normal_error = 0.0f;
+    float max_tangent_error = 0.0f;
+    float max_uv_error = 0.0f;
+    for(usize i = 0; i != streams.vertex_count(); ++i) {
+        const math::Vec3 position_error = (streams.stream<VertexStreamType::Position>()[i] - decoded.stream<VertexStreamType::Position>()[i]).abs();
+        for(usize k = 0; k != 3; ++k) {
+            y_always_assert(position_error[k] <= position_step[k] * 0.5f + 1e-4f, "Position quantization error too large");
+            max_position_error = std::max(max_position_error, position_error[k]);
+        }
+
+        const math::Vec2ui original = streams.stream<VertexStreamType::NormalTangent>()[i];
+        const math::Vec2ui compressed = decoded.stream<VertexStreamType::NormalTangent>()[i];
+        const math::Vec4 normal = unpack_2_10_10_10(original.x());
+        const math::Vec4 decoded_normal = unpack_2_10_10_10(compressed.x());
+        const math::Vec4 tangent = unpack_2_10_10_10(original.y());
+        const math::Vec4 decoded_tangent = unpack_2_10_10_10(compressed.y());
+        y_always_assert(tangent.w() == decoded_tangent.w(), "Bitangent sign lost");
+
+        max_normal_error = std::max(max_normal_error, angle_between(normal.to<3>(), decoded_normal.to<3>()));
+        max_tangent_error = std::max(max_tangent_error, angle_between(tangent.to<3>(), decoded_tangent.to<3>()));
+
+        const math::Vec2 uv = streams.stream<VertexStreamType::Uv>()[i];
+        const math::Vec2 uv_error = (uv - decoded.stream<VertexStreamType::Uv>()[i]).abs();
+        max_uv_error = std::max(max_uv_error, std::max(uv_error.x(), uv_error.y()));
+    }
+
+    log_msg(fmt("Compact vertices: {} -> {} bytes, max errors: position = {:.5f}, normal = {:.3f} deg, tangent = {:.3f} deg, uv = {:.5f}",
+        MeshVertexStreams::total_vertex_size, CompactVertexStreams::total_vertex_size,
+        max_position_error, max_normal_error, max_tangent_error, max_uv_error), Log::Perf);
+
+    // Includes the error of 2_10_10_10 packing of the decoded streams
+    y_always_assert(max_normal_error < 1.5f, "Normal quantization error too large");
+    y_always_assert(max_tangent_error < 2.5f, "Tangent quantization error too large");
+    y_always_assert(max_uv_error < 4.0f / 2048.0f, "Uv quantization error too large");
+
+    bench.set_items_per_iteration(streams.vertex_count());
+    bench.run([&] {
+        const CompactVertexStreams encoded(streams);
+        test::do_not_optimize(encoded);
+    });
+}
+
+}
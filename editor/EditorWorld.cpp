@@ -39,6 +39,7 @@ SOFTWARE.
 #include <yave/components/AtmosphereComponent.h>
 
 #include <yave/systems/AssetLoaderSystem.h>
+#include <yave/systems/AnimationSystem.h>
 
 #include <editor/systems/DebugAnimateSystem.h>
 
@@ -54,6 +55,7 @@ editor_action("Remove all entities", [] { current_world().remove_all_entities();
 
 EditorWorld::EditorWorld(AssetLoader& loader) {
     add_system<AssetLoaderSystem>(loader);
+    add_system<AnimationSystem>();
     add_system<DebugAnimateSystem>();
 }
 
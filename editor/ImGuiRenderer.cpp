@@ -25,6 +25,7 @@ SOFTWARE.
 #include <editor/EditorResources.h>
 
 #include <yave/graphics/commands/CmdBufferRecorder.h>
+#include <yave/graphics/descriptors/TransientDescriptorSet.h>
 #include <yave/graphics/images/ImageData.h>
 #include <yave/graphics/buffers/Buffer.h>
 #include <yave/material/Material.h>
@@ -112,7 +113,7 @@ void ImGuiRenderer::render(ImDrawData* draw_data, RenderPassRecorder& recorder)
     uniform[1] = viewport_offset;
 
     const auto create_descriptor_set = [&](const TextureView* tex) {
-        return DescriptorSet(Descriptor(*tex, SamplerType::LinearClamp), uniform_buffer);
+        return TransientDescriptorSet(recorder, Descriptor(*tex, SamplerType::LinearClamp), uniform_buffer);
     };
 
     const DescriptorSetBase default_set = create_descriptor_set(&_font_view);
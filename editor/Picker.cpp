@@ -32,6 +32,7 @@ SOFTWARE.
 #include <yave/framegraph/FrameGraphFrameResources.h>
 #include <yave/framegraph/FrameGraphResourcePool.h>
 #include <yave/graphics/commands/CmdQueue.h>
+#include <yave/graphics/descriptors/TransientDescriptorSet.h>
 
 #include <yave/graphics/shaders/ComputeProgram.h>
 
@@ -75,7 +76,7 @@ PickingResult Picker::pick_sync(const SceneView& scene_view, const math::Vec2& u
         builder.set_render_func([=](CmdBufferRecorder& recorder, const FrameGraphPass* self) {
             const auto& program = resources()[EditorResources::PickingProgram];
 
-            const auto uv_set = DescriptorSet(InlineDescriptor(uv));
+            const auto uv_set = TransientDescriptorSet(recorder, InlineDescriptor(uv));
             const std::array<DescriptorSetBase, 2> descriptor_sets = {self->descriptor_sets()[0], uv_set};
             recorder.dispatch(program, math::Vec3ui(1), descriptor_sets);
         });
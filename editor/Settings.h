@@ -63,6 +63,10 @@ struct UiSettings {
 };
 
 struct PerfSettings {
+    // Cull static meshes in a compute shader instead of on the CPU, if supported
+    bool gpu_culling = false;
+
+    y_reflect(PerfSettings, gpu_culling)
 };
 
 struct DebugSettings {
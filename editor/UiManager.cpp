@@ -28,6 +28,7 @@ SOFTWARE.
 
 #include <yave/assets/AssetLoader.h>
 #include <y/core/HashMap.h>
+#include <y/utils/memory.h>
 
 #include <regex>
 #include <tuple>
@@ -68,6 +69,7 @@ UiManager::~UiManager() {
 
 void UiManager::on_gui() {
     y_profile();
+    y_memory_tag("ui");
 
     if(!_frame_number) {
         open_default_widgets();
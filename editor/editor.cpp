@@ -34,6 +34,8 @@ SOFTWARE.
 #include <yave/utils/DirectDraw.h>
 #include <yave/scene/SceneView.h>
 #include <yave/scene/EcsScene.h>
+#include <yave/renderer/DefaultRenderer.h>
+#include <yave/renderer/IdBufferPass.h>
 
 #include <y/io2/File.h>
 #include <y/serde3/archives.h>
@@ -93,6 +95,8 @@ enum DeferredActions : u32 {
 };
 
 u32 deferred_actions = None;
+
+usize prewarmed_mesh_count = 0;
 }
 
 
@@ -100,10 +104,23 @@ u32 deferred_actions = None;
 
 static void create_scene() {
     application::scene = std::make_unique<EcsScene>(application::world.get());
+    application::scene->set_async_pipelines(true);
     application::default_scene_view = SceneView(application::scene.get());
+    application::prewarmed_mesh_count = 0;
     set_scene_view(nullptr);
 }
 
+static void prewarm_pipelines() {
+    const usize mesh_count = application::scene->meshes().size();
+    if(mesh_count == application::prewarmed_mesh_count) {
+        return;
+    }
+
+    DefaultRenderer::prewarm_pipelines(*application::scene);
+    application::scene->prewarm_pipelines(PassType::Id, IdBufferPass::render_pass_layout());
+    application::prewarmed_mesh_count = mesh_count;
+}
+
 static void save_world_deferred() {
     y_profile();
 
@@ -216,7 +233,9 @@ void destroy_editor() {
 void run_editor() {
     application::imgui_platform->exec([] {
         application::world->tick(*application::thread_pool);
+        application::scene->set_gpu_culling(app_settings().perf.gpu_culling);
         application::scene->update_from_world();
+        prewarm_pipelines();
         application::world->process_deferred_changes();
         application::ui->on_gui();
         post_tick();
@@ -0,0 +1,131 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#include "animation_utils.h"
+
+#include <y/math/keyframes.h>
+
+namespace editor {
+namespace import {
+
+using BoneKey = AnimationChannel::BoneKey;
+
+// Angle of the rotation between a and b. Using the vector part of conj(a) * b keeps it precise for tiny angles, unlike acos(dot)
+static float rotation_error(const math::Quaternion<>& a, const math::Quaternion<>& b) {
+    const math::Quaternion<> delta = a.inverse() * b;
+    return 2.0f * std::asin(std::min(1.0f, delta.as_vec().to<3>().length()));
+}
+
+static float position_error(const math::Vec3& a, const math::Vec3& b) {
+    return (a - b).length();
+}
+
+static float scale_error(const math::Vec3& a, const math::Vec3& b) {
+    const math::Vec3 d = a - b;
+    return std::max({std::abs(d.x()), std::abs(d.y()), std::abs(d.z())});
+}
+
+// Same interpolation as AnimationChannel::sample
+static BoneTransform interpolate(const BoneKey& a, const BoneKey& b, float time) {
+    const float delta = b.time - a.time;
+    const float factor = delta > 0.0f ? std::clamp((time - a.time) / delta, 0.0f, 1.0f) : 0.0f;
+    const float q = 1.0f - factor;
+
+    BoneTransform tr;
+    tr.position = a.local_transform.position * q + b.local_transform.position * factor;
+    tr.scale = a.local_transform.scale * q + b.local_transform.scale * factor;
+    tr.rotation = a.local_transform.rotation.slerp(b.local_transform.rotation, factor);
+    return tr;
+}
+
+static bool is_within_tolerance(const BoneTransform& a, const BoneTransform& b, const AnimationCompressionSettings& settings) {
+    return position_error(a.position, b.position) <= settings.position_tolerance &&
+           rotation_error(a.rotation, b.rotation) <= settings.rotation_tolerance &&
+           scale_error(a.scale, b.scale) <= settings.scale_tolerance;
+}
+
+// Can every key strictly between begin and end be rebuilt from begin and end?
+static bool can_interpolate(core::Span<BoneKey> keys, usize begin, usize end, const AnimationCompressionSettings& settings) {
+    for(usize i = begin + 1; i < end; ++i) {
+        if(!is_within_tolerance(interpolate(keys[begin], keys[end], keys[i].time), keys[i].local_transform, settings)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename T, typename E>
+static void snap_constant_track(core::MutableSpan<BoneKey> keys, T BoneTransform::* member, E&& error, float tolerance) {
+    const T& first = keys[0].local_transform.*member;
+    if(std::all_of(keys.begin(), keys.end(), [&](const BoneKey& k) { return error(k.local_transform.*member, first) <= tolerance; })) {
+        for(BoneKey& key : keys) {
+            key.local_transform.*member = first;
+        }
+    }
+}
+
+core::Vector<BoneKey> reduce_keys(core::Span<BoneKey> keys, const AnimationCompressionSettings& settings) {
+    y_profile();
+
+    core::Vector<BoneKey> source(keys);
+    if(source.size() <= 2) {
+        return source;
+    }
+
+    // Quantization only merges identical keys, so tracks that merely wobble have to be flattened here
+    snap_constant_track(source, &BoneTransform::position, position_error, settings.position_tolerance);
+    snap_constant_track(source, &BoneTransform::rotation, rotation_error, settings.rotation_tolerance);
+    snap_constant_track(source, &BoneTransform::scale, scale_error, settings.scale_tolerance);
+
+    core::Vector<BoneKey> reduced;
+    for(const usize index : math::reduce_keys(source.size(), [&](usize begin, usize end) { return can_interpolate(source, begin, end, settings); })) {
+        reduced << source[index];
+    }
+
+    return reduced;
+}
+
+AnimationChannel compress_channel(const core::String& name, core::Span<BoneKey> keys, const AnimationCompressionSettings& settings, AnimationCompressionStats* stats) {
+    y_profile();
+
+    AnimationChannel channel(name, reduce_keys(keys, settings));
+
+    if(stats) {
+        stats->source_key_count += keys.size();
+        stats->key_count += channel.key_count();
+
+        stats->source_byte_size += sizeof(AnimationChannel) + name.size() + keys.size() * (sizeof(float) + sizeof(BoneTransform));
+        stats->byte_size += channel.byte_size();
+
+        u32 cursor = 0;
+        for(const BoneKey& key : keys) {
+            const BoneTransform tr = channel.sample(key.time, cursor);
+            stats->max_position_error = std::max(stats->max_position_error, position_error(tr.position, key.local_transform.position));
+            stats->max_rotation_error = std::max(stats->max_rotation_error, rotation_error(tr.rotation, key.local_transform.rotation));
+            stats->max_scale_error = std::max(stats->max_scale_error, scale_error(tr.scale, key.local_transform.scale));
+        }
+    }
+
+    return channel;
+}
+
+}
+}
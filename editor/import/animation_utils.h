@@ -0,0 +1,58 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#ifndef EDITOR_IMPORT_ANIMATIONUTILS_H
+#define EDITOR_IMPORT_ANIMATIONUTILS_H
+
+#include "import.h"
+
+namespace editor {
+namespace import {
+
+struct AnimationCompressionSettings {
+    // Error allowed when removing keys, quantization adds up to AnimationChannel::max_*_error on top of it
+    float position_tolerance = 0.0001f;
+    float rotation_tolerance = math::to_rad(0.01f);
+    float scale_tolerance = 0.0001f;
+};
+
+// Accumulated over every compressed channel. Errors are measured by sampling the compressed channel at the source key times.
+struct AnimationCompressionStats {
+    usize source_key_count = 0;
+    usize key_count = 0;
+
+    usize source_byte_size = 0;
+    usize byte_size = 0;
+
+    float max_position_error = 0.0f;
+    float max_rotation_error = 0.0f;
+    float max_scale_error = 0.0f;
+};
+
+// Removes the keys that interpolating their neighbours reconstructs within tolerance, and snaps near constant tracks to their first value
+[[nodiscard]] core::Vector<AnimationChannel::BoneKey> reduce_keys(core::Span<AnimationChannel::BoneKey> keys, const AnimationCompressionSettings& settings = {});
+
+[[nodiscard]] AnimationChannel compress_channel(const core::String& name, core::Span<AnimationChannel::BoneKey> keys, const AnimationCompressionSettings& settings = {}, AnimationCompressionStats* stats = nullptr);
+
+}
+}
+
+#endif // EDITOR_IMPORT_ANIMATIONUTILS_H
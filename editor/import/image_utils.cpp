@@ -25,6 +25,7 @@ SOFTWARE.
 #include <yave/graphics/images/ImageData.h>
 
 #include <y/core/ScratchPad.h>
+#include <y/concurrent/StaticThreadPool.h>
 #include <y/utils/log.h>
 
 #if defined(Y_MSVC) || defined(__SSE4_2__)
@@ -42,151 +43,302 @@ static ImageData copy(const ImageData& image) {
     return ImageData(image.size().to<2>(), image.data(), image.format(), image.mipmaps());
 }
 
-static void unpack_with_gamma(const u8* in, usize size, float* out) {
-    y_profile();
-    float gamma_lut[256];
-    for(usize i = 0; i != 256; ++i) {
-        gamma_lut[i] = std::pow(i / 255.0f, 2.2f);
+// Used by all the image processing functions, including when called from another pool's tasks
+static concurrent::StaticThreadPool& image_thread_pool() {
+    static concurrent::StaticThreadPool thread_pool;
+    return thread_pool;
+}
+
+// Calls func(begin, end) over chunks of [0, count), in parallel. The calling thread processes the first chunk.
+template<typename F>
+static void parallel_for(usize count, usize min_chunk_size, F&& func) {
+    concurrent::StaticThreadPool& thread_pool = image_thread_pool();
+
+    const usize chunk_count = std::clamp(count / std::max(min_chunk_size, usize(1)), usize(1), thread_pool.concurency() * 4);
+    if(chunk_count == 1) {
+        func(usize(0), count);
+        return;
     }
 
-    for(usize i = 0; i != size; ++i) {
-        out[i] = gamma_lut[in[i]];
-        y_debug_assert(out[i] >= 0.0f);
-        y_debug_assert(out[i] <= 1.0f);
+    const usize chunk_size = (count + chunk_count - 1) / chunk_count;
+
+    core::Vector<concurrent::DependencyGroup> chunks_done(chunk_count - 1, concurrent::DependencyGroup());
+    for(usize i = 1; i != chunk_count; ++i) {
+        const usize begin = i * chunk_size;
+        const usize end = std::min(begin + chunk_size, count);
+        if(begin < end) {
+            thread_pool.schedule([&func, begin, end] { func(begin, end); }, &chunks_done[i - 1]);
+        }
     }
+
+    func(usize(0), std::min(chunk_size, count));
+
+    thread_pool.process_until_complete(chunks_done);
+}
+
+
+
+// https://en.wikipedia.org/wiki/SRGB#Transfer_function_(%22gamma%22)
+static float srgb_to_linear(float x) {
+    return x <= 0.04045f ? x / 12.92f : std::pow((x + 0.055f) / 1.055f, 2.4f);
+}
+
+static float linear_to_srgb(float x) {
+    return x <= 0.0031308f ? x * 12.92f : 1.055f * std::pow(x, 1.0f / 2.4f) - 0.055f;
+}
+
+// Alpha is always linear, even in sRGB formats
+static bool is_alpha(usize component, usize components) {
+    return components == 4 && component == 3;
 }
 
-static void unpack(const u8* in, usize size, float* out) {
+static void unpack(const u8* in, usize size, float* out, usize components, bool is_sRGB) {
     y_profile();
-    for(usize i = 0; i != size; ++i) {
-        out[i] = in[i] / 255.0f;
-        y_debug_assert(out[i] >= 0.0f);
-        y_debug_assert(out[i] <= 1.0f);
+
+    static const auto luts = [] {
+        std::array<std::array<float, 256>, 2> tables = {};
+        for(usize i = 0; i != 256; ++i) {
+            tables[0][i] = float(i) / 255.0f;
+            tables[1][i] = srgb_to_linear(float(i) / 255.0f);
+        }
+        return tables;
+    }();
+
+    std::array<const float*, 4> component_luts = {};
+    for(usize c = 0; c != components; ++c) {
+        component_luts[c] = luts[is_sRGB && !is_alpha(c, components)].data();
     }
+
+    parallel_for(size / components, 64 * 1024, [&](usize begin, usize end) {
+        for(usize i = begin * components; i != end * components; i += components) {
+            for(usize c = 0; c != components; ++c) {
+                out[i + c] = component_luts[c][in[i + c]];
+            }
+        }
+    });
 }
 
-static void pack_with_gamma(const float* in, usize size, u8* out) {
+static void pack(const float* in, usize size, u8* out, usize components, bool is_sRGB) {
     y_profile();
-    const usize lut_size = 1 << 12;
-    const float lut_factor = float(lut_size - 1);
-    const float inv_lut_factor = 1.0f / lut_factor;
-    const float inv_gamma = 1.0f / 2.2f;
-
-    u8 gamma_lut[lut_size];
-    for(usize i = 0; i != lut_size; ++i) {
-        const float with_gamma = std::pow(i * inv_lut_factor, inv_gamma);
-        y_debug_assert(with_gamma <= 1.0f);
-        gamma_lut[i] = u8(with_gamma * 255.0f);
-    }
 
+    // The encoding curve is steep close to 0, so the table needs to be quite precise to not lose dark values
+    static constexpr usize lut_size = 1 << 14;
+    static const auto srgb_lut = [] {
+        auto lut = std::make_unique<u8[]>(lut_size);
+        for(usize i = 0; i != lut_size; ++i) {
+            lut[i] = u8(linear_to_srgb(float(i) / float(lut_size - 1)) * 255.0f + 0.5f);
+        }
+        return lut;
+    }();
+
+    parallel_for(size / components, 64 * 1024, [&](usize begin, usize end) {
+        const usize first = begin * components;
+        const usize last = end * components;
+
+        if(!is_sRGB) {
+            usize i = first;
+#ifdef USE_SIMD
+            const char n = 15;
+            const __m128 norm = _mm_set1_ps(255.0f);
+            const __m128i mask = _mm_set_epi8(n, n, n, n, n, n, n, n, n, n, n, n, 12, 8, 4, 0);
+            for(; i + 4 <= last; i += 4) {
+                const __m128 a = _mm_loadu_ps(in + i);
+                const __m128 b = _mm_mul_ps(a, norm);
+                const __m128 c = _mm_round_ps(b, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);    // round
+                const __m128i d = _mm_cvtps_epi32(c);           // to int
+                const __m128i e = _mm_shuffle_epi8(d, mask);    // extract bytes
+                _mm_storeu_si32(out + i, e);                    // store
+            }
+#endif
+            for(; i != last; ++i) {
+                y_debug_assert(in[i] >= 0.0f && in[i] <= 1.0f);
+                out[i] = u8(in[i] * 255.0f + 0.5f);
+            }
+        } else {
+            const float lut_factor = float(lut_size - 1);
+            usize i = first;
 #ifdef USE_SIMD
-    const __m128 norm = _mm_set1_ps(lut_factor);
-
-    y_always_assert(size % 4 == 0, "Size should be a multiple of 4");
-    for(usize i = 0; i != size; i += 4) {
-        const __m128 a = _mm_loadu_ps(in + i);
-        const __m128 b = _mm_mul_ps(a, norm);
-        const __m128 c = _mm_round_ps(b, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);    // round
-        const __m128i d = _mm_cvtps_epi32(c);           // to int
-        const u32* indices = reinterpret_cast<const u32*>(&d);
-        for(usize comp = 0; comp != 4; ++comp) {
-            out[i + comp] = gamma_lut[indices[comp]];
+            if(components == 4) {
+                // Alpha goes straight to 0-255, colors become indices in the sRGB table
+                const __m128 factors = _mm_set_ps(255.0f, lut_factor, lut_factor, lut_factor);
+                const __m128 half = _mm_set1_ps(0.5f);
+                for(; i != last; i += 4) {
+                    alignas(16) u32 indices[4];
+                    _mm_store_si128(reinterpret_cast<__m128i*>(indices), _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(in + i), factors), half)));
+                    out[i + 0] = srgb_lut[indices[0]];
+                    out[i + 1] = srgb_lut[indices[1]];
+                    out[i + 2] = srgb_lut[indices[2]];
+                    out[i + 3] = u8(indices[3]);
+                }
+            }
+#endif
+            for(; i != last; i += components) {
+                for(usize c = 0; c != components; ++c) {
+                    const float value = in[i + c];
+                    y_debug_assert(value >= 0.0f && value <= 1.0f);
+                    out[i + c] = is_alpha(c, components)
+                        ? u8(value * 255.0f + 0.5f)
+                        : srgb_lut[u32(value * lut_factor + 0.5f)];
+                }
+            }
         }
+    });
+}
+
+
+
+// Enough for a Kaiser kernel when downsampling 3 texels to 1
+static constexpr usize max_filter_taps = 24;
+
+struct FilterTaps {
+    u32 count = 0;
+    std::array<u32, max_filter_taps> indices = {};
+    std::array<float, max_filter_taps> weights = {};
+};
+
+static float bessel_i0(float x) {
+    float sum = 1.0f;
+    float term = 1.0f;
+    for(usize k = 1; k != 16; ++k) {
+        term *= (x * x * 0.25f) / float(k * k);
+        sum += term;
     }
-#else
-    for(usize i = 0; i != size; ++i) {
-        const usize lut_index = usize(std::round(in[i] * lut_factor));
-        y_debug_assert(lut_index < lut_size);
-        out[i] = gamma_lut[lut_index];
-    }
-#endif
+    return sum;
 }
 
-static void pack(const float* in, usize size, u8* out) {
-    y_profile();
+// Windowed sinc, see http://www.realitypixels.com/turk/computergraphics/ResamplingFilters.pdf
+static float kaiser_kernel(float t) {
+    static constexpr float width = 3.0f;
+    static constexpr float alpha = 4.0f;
 
-#ifdef USE_SIMD
-    const char n = 15;
-    const __m128 norm = _mm_set1_ps(255.0f);
-    const __m128i mask = _mm_set_epi8(n, n, n, n, n, n, n, n, n, n, n, n, 12, 8, 4, 0);
-
-    y_always_assert(size % 4 == 0, "Size should be a multiple of 4");
-    for(usize i = 0; i != size; i += 4) {
-        const __m128 a = _mm_loadu_ps(in + i);
-        const __m128 b = _mm_mul_ps(a, norm);
-        const __m128 c = _mm_round_ps(b, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);    // round
-        const __m128i d = _mm_cvtps_epi32(c);           // to int
-        const __m128i e = _mm_shuffle_epi8(d, mask);    // extract bytes
-        _mm_storeu_si32(out + i, e);                    // store
+    if(std::abs(t) >= width) {
+        return 0.0f;
     }
-#else
-    for(usize i = 0; i < size; ++i) {
-        y_debug_assert(in[i] >= 0.0f);
-        y_debug_assert(in[i] <= 1.0f);
-        out[i] = u8(std::round(in[i] * 255.0f));
+
+    const float x = t / width;
+    const float window = bessel_i0(alpha * std::sqrt(1.0f - x * x)) / bessel_i0(alpha);
+    const float sinc = t == 0.0f ? 1.0f : std::sin(math::pi<float> * t) / (math::pi<float> * t);
+    return sinc * window;
+}
+
+// Weights of the source texels for every destination texel along one axis.
+// The box filter uses the exact coverage of each source texel, which handles odd sizes without shifting the image
+static core::Vector<FilterTaps> compute_filter_taps(u32 src_size, u32 dst_size, MipFilter filter) {
+    const float scale = float(src_size) / float(dst_size);
+
+    core::Vector<FilterTaps> taps(dst_size, FilterTaps());
+    for(u32 x = 0; x != dst_size; ++x) {
+        FilterTaps& t = taps[x];
+
+        const float begin = float(x) * scale;
+        const float end = begin + scale;
+
+        if(filter == MipFilter::Box) {
+            for(u32 i = u32(begin); float(i) < end && i < src_size; ++i) {
+                const float coverage = std::min(end, float(i + 1)) - std::max(begin, float(i));
+                if(coverage > 0.0f) {
+                    y_debug_assert(t.count < max_filter_taps);
+                    t.indices[t.count] = i;
+                    t.weights[t.count] = coverage;
+                    ++t.count;
+                }
+            }
+        } else {
+            const float center = (begin + end) * 0.5f;
+            const i32 first = i32(std::floor(center - 3.0f * scale));
+            const i32 last = i32(std::ceil(center + 3.0f * scale));
+            for(i32 i = first; i <= last; ++i) {
+                const float w = kaiser_kernel((float(i) + 0.5f - center) / scale);
+                if(w != 0.0f) {
+                    y_debug_assert(t.count < max_filter_taps);
+                    t.indices[t.count] = u32(std::clamp(i, 0, i32(src_size) - 1));
+                    t.weights[t.count] = w;
+                    ++t.count;
+                }
+            }
+        }
+
+        float total = 0.0f;
+        for(u32 k = 0; k != t.count; ++k) {
+            total += t.weights[k];
+        }
+        for(u32 k = 0; k != t.count; ++k) {
+            t.weights[k] /= total;
+        }
     }
-#endif
+
+    return taps;
 }
 
-core::FixedArray<float> compute_mipmaps_internal(core::FixedArray<float> input, const math::Vec2ui& size, usize components, usize mip_count) {
+static void compute_mip(const float* src, const math::Vec2ui& src_size, float* dst, const math::Vec2ui& dst_size, usize components, MipFilter filter) {
     y_profile();
 
-    y_debug_assert(size.x() * size.y() * components == input.size());
+    const core::Vector<FilterTaps> row_taps = compute_filter_taps(src_size.y(), dst_size.y(), filter);
+    const core::Vector<FilterTaps> column_taps = compute_filter_taps(src_size.x(), dst_size.x(), filter);
 
-    const ImageFormat normalized_format = VK_FORMAT_R32G32B32A32_SFLOAT;
-    const usize output_size = ImageData::byte_size(math::Vec3ui(size, 1), normalized_format, mip_count) / sizeof(float);
+    const usize src_row_size = src_size.x() * components;
+    const usize dst_row_size = dst_size.x() * components;
 
-    core::FixedArray<float> output(output_size);
-    {
-        const auto compute_mip = [&](const float* image_data, float* out, const math::Vec2ui& orig_size) -> usize {
-            y_profile_zone("compute mip");
-
-            usize cursor = 0;
-            const math::Vec2ui mip_size = {
-                std::max(1u, orig_size.x() / 2),
-                std::max(1u, orig_size.y() / 2),
-            };
-
-            const math::Vec2 factors = math::Vec2(orig_size) / math::Vec2(mip_size);
-            const float texel_width = factors.x() * 0.5f;
-            const usize row_size = mip_size.y() > 1
-                ? std::min(orig_size.x(), u32(orig_size.x() * texel_width))
-                : 0u;
-
-            for(usize y = 0; y != mip_size.y(); ++y) {
-                for(usize x = 0; x != mip_size.x(); ++x) {
-                    const usize orig = (u32(x * factors.x()) + u32(y * factors.y()) * row_size);
-                    y_debug_assert(usize(orig + row_size + texel_width) <= orig_size.x() * orig_size.y());
-
-                    for(usize cc = 0; cc != components; ++cc) {
-                        const float a = image_data[components * usize(orig) + cc];
-                        const float b = image_data[components * usize(orig + texel_width) + cc];
-                        const float c = image_data[components * usize(orig + row_size) + cc];
-                        const float d = image_data[components * usize(orig + row_size + texel_width) + cc];
-                        y_debug_assert((a + b + c + d) >= 0.0f);
-                        out[cursor++] = std::min((a + b + c + d) * 0.25f, 1.0f);
+    parallel_for(dst_size.y(), std::max(usize(1), usize(16 * 1024) / dst_row_size), [&](usize begin, usize end) {
+        core::Vector<float> filtered_row(src_row_size, 0.0f);
+
+        for(usize y = begin; y != end; ++y) {
+            // Vertical pass: blend the source rows into filtered_row
+            {
+                const FilterTaps& taps = row_taps[y];
+                float* row = filtered_row.data();
+                std::fill_n(row, src_row_size, 0.0f);
+
+                for(u32 k = 0; k != taps.count; ++k) {
+                    const float* src_row = src + taps.indices[k] * src_row_size;
+                    const float w = taps.weights[k];
+
+                    usize i = 0;
+#ifdef USE_SIMD
+                    const __m128 weight = _mm_set1_ps(w);
+                    for(; i + 4 <= src_row_size; i += 4) {
+                        _mm_storeu_ps(row + i, _mm_add_ps(_mm_loadu_ps(row + i), _mm_mul_ps(_mm_loadu_ps(src_row + i), weight)));
+                    }
+#endif
+                    for(; i != src_row_size; ++i) {
+                        row[i] += src_row[i] * w;
                     }
                 }
             }
-            return cursor;
-        };
 
-
-        float* out_data = output.data();
-        usize mip_values = size.x() * size.y() * components;
-        std::copy_n(input.data(), mip_values, out_data);
-
-        for(usize mip = 0; mip < mip_count - 1; ++mip) {
-            const usize s = compute_mip(out_data, out_data + mip_values, ImageData::mip_size(math::Vec3ui(size, 1), mip).to<2>());
-            out_data += mip_values;
-            mip_values = s;
+            // Horizontal pass: blend the texels of filtered_row into the destination row
+            float* dst_row = dst + y * dst_row_size;
+#ifdef USE_SIMD
+            if(components == 4) {
+                const __m128 zero = _mm_setzero_ps();
+                const __m128 one = _mm_set1_ps(1.0f);
+                for(usize x = 0; x != dst_size.x(); ++x) {
+                    const FilterTaps& taps = column_taps[x];
+                    __m128 acc = zero;
+                    for(u32 k = 0; k != taps.count; ++k) {
+                        acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(filtered_row.data() + taps.indices[k] * 4), _mm_set1_ps(taps.weights[k])));
+                    }
+                    // Negative lobes can overshoot
+                    _mm_storeu_ps(dst_row + x * 4, _mm_min_ps(_mm_max_ps(acc, zero), one));
+                }
+                continue;
+            }
+#endif
+            for(usize x = 0; x != dst_size.x(); ++x) {
+                const FilterTaps& taps = column_taps[x];
+                for(usize c = 0; c != components; ++c) {
+                    float acc = 0.0f;
+                    for(u32 k = 0; k != taps.count; ++k) {
+                        acc += filtered_row[taps.indices[k] * components + c] * taps.weights[k];
+                    }
+                    dst_row[x * components + c] = std::clamp(acc, 0.0f, 1.0f);
+                }
+            }
         }
-    }
-
-    return output;
+    });
 }
 
-ImageData compute_mipmaps(const ImageData& image) {
+ImageData compute_mipmaps(const ImageData& image, MipFilter filter) {
     y_profile();
 
     if(image.size().z() != 1) {
@@ -196,188 +348,155 @@ ImageData compute_mipmaps(const ImageData& image) {
 
     const bool is_sRGB = image.format().is_sRGB();
     const usize components = image.format().components();
-    const usize texels = image.size().x() * image.size().y();
-    const usize mip_count = ImageData::mip_count(image.size());
+    const math::Vec3ui size = image.size();
+    const usize mip_count = ImageData::mip_count(size);
 
     if(image.format().is_block_format() || image.format().is_depth_format() || image.format().bit_per_pixel() != 8 * components) {
         log_msg("Unable to generate mipmaps: format is not supported.", Log::Error);
         return copy(image);
     }
 
-    core::FixedArray<float> input(texels * components);
-    {
-        y_profile_zone("unpack");
-        if(is_sRGB) {
-            Y_TODO(Alpha should not be gammaed)
-            unpack_with_gamma(image.data(), input.size(), input.data());
-        } else {
-            unpack(image.data(), input.size(), input.data());
-        }
+    usize total_size = 0;
+    for(usize mip = 0; mip != mip_count; ++mip) {
+        const math::Vec3ui mip_size = ImageData::mip_size(size, mip);
+        total_size += mip_size.x() * mip_size.y() * components;
     }
 
-    core::FixedArray<float> output = compute_mipmaps_internal(std::move(input), image.size().to<2>(), components, mip_count);
-    core::FixedArray<u8> data(output.size());
+    // Filtering is done in linear space on the whole chain, which is then packed back at once
+    // Not zero initialized: every value is written by unpack or compute_mip
+    auto mips = std::make_unique_for_overwrite<float[]>(total_size);
+    unpack(image.data(), size.x() * size.y() * components, mips.get(), components, is_sRGB);
+
     {
-        y_profile_zone("pack");
-        if(is_sRGB) {
-            pack_with_gamma(output.data(), output.size(), data.data());
-        } else {
-            pack(output.data(), output.size(), data.data());
+        y_profile_zone("compute mips");
+
+        float* src = mips.get();
+        for(usize mip = 1; mip != mip_count; ++mip) {
+            const math::Vec2ui src_size = ImageData::mip_size(size, mip - 1).to<2>();
+            const math::Vec2ui dst_size = ImageData::mip_size(size, mip).to<2>();
+
+            float* dst = src + src_size.x() * src_size.y() * components;
+            compute_mip(src, src_size, dst, dst_size, components, filter);
+            src = dst;
         }
     }
-    output.clear();
+
+    auto data = std::make_unique_for_overwrite<u8[]>(total_size);
+    pack(mips.get(), total_size, data.get(), components, is_sRGB);
+    mips = nullptr;
 
     y_profile_zone("building image");
-    return ImageData(image.size().to<2>(), data.data(), image.format(), mip_count);
+    return ImageData(size.to<2>(), data.get(), image.format(), mip_count);
 }
 
 
-template<typename F>
-ImageData block_compress(const ImageData& image, ImageFormat compressed_format, F&& process_block) {
-    if(image.format().bit_per_pixel() == 32 && image.size().z() == 1) {
-        y_profile_zone("compress");
-
-        const usize mip_count = image.mipmaps();
-        const usize compressed_size = ImageData::byte_size(image.size(), compressed_format, mip_count);
-        core::FixedArray<u8> compressed_data(compressed_size);
-
-        const math::Vec3ui block_size = compressed_format.block_size();
-        y_debug_assert(block_size.z() == 1);
-
-        core::ScratchPad<u8> block(block_size.x() * block_size.y() * 4);
+// Copies a 4x4 block of RGBA8 texels, texels outside the mip are clamped to the edge
+static void gather_block(const ImageData::Mip& mip, usize x, usize y, u8* block) {
+    const usize width = mip.size.x();
+    const usize height = mip.size.y();
+    const u8* data = mip.data.data();
 
-        usize offset = 0;
-        for(usize i = 0; i != mip_count; ++i) {
-            y_profile_zone("compress mip");
-            const ImageData::Mip mip = image.mip_data(i);
-            const usize mip_texel_count = mip.size.x() * mip.size.y();
-            unused(mip_texel_count);
-
-            for(usize y = 0; y < mip.size.y(); y += block_size.y()) {
-                for(usize x = 0; x < mip.size.x(); x += block_size.x()) {
-
-                    usize block_index = 0;
-                    for(usize by = 0; by != block_size.y(); ++by) {
-                        for(usize bx = 0; bx != block_size.x(); ++bx) {
-                            const math::Vec2ui coord = math::Vec2ui(x + bx, y + by).min(mip.size.to<2>() - math::Vec2ui(1, 1));
-                            const usize image_index = coord.y() * mip.size.x() + coord.x();
-                            y_debug_assert(image_index < mip_texel_count);
-                            for(usize c = 0; c != 4; ++c) {
-                                block[block_index++] = u8(mip.data[image_index * 4 + c]);
-                            }
-                        }
-                    }
+    if(x + 4 <= width && y + 4 <= height) {
+        for(usize by = 0; by != 4; ++by) {
+            std::memcpy(block + by * 16, data + ((y + by) * width + x) * 4, 16);
+        }
+        return;
+    }
 
-                    const auto compressed_block = process_block(block.data());
-                    y_debug_assert(offset + sizeof(compressed_block) <= compressed_data.size());
-                    std::memcpy(compressed_data.data() + offset, &compressed_block, sizeof(compressed_block));
-                    offset += sizeof(compressed_block);
-                }
-            }
+    for(usize by = 0; by != 4; ++by) {
+        const usize src_y = std::min(y + by, height - 1);
+        for(usize bx = 0; bx != 4; ++bx) {
+            const usize src_x = std::min(x + bx, width - 1);
+            std::memcpy(block + (by * 4 + bx) * 4, data + (src_y * width + src_x) * 4, 4);
         }
+    }
+}
 
-        y_debug_assert(offset == compressed_size);
+template<typename F>
+static ImageData block_compress(const ImageData& image, ImageFormat compressed_format, F&& process_block) {
+    y_profile();
 
-        return ImageData(image.size().to<2>(), compressed_data.data(), compressed_format, mip_count);
+    if(image.format().bit_per_pixel() != 32 || image.format().is_block_format() || image.size().z() != 1) {
+        log_msg("Compression isn't supported for given image format", Log::Warning);
+        return copy(image);
     }
 
-    log_msg("Compression isn't supported for given image format", Log::Warning);
-    return copy(image);
-}
+    using block_type = decltype(process_block(std::declval<const u8*>()));
+    y_debug_assert(compressed_format.block_size() == math::Vec3ui(4, 4, 1));
+    y_debug_assert(compressed_format.bit_per_pixel() * 16 == sizeof(block_type) * 8);
 
-static inline u16 to_565(u8 r, u8 g, u8 b) {
-    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
-}
+    const usize mip_count = image.mipmaps();
+    const usize compressed_size = ImageData::byte_size(image.size(), compressed_format, mip_count);
+
+    // Not zero initialized: every block is written
+    auto compressed_data = std::make_unique_for_overwrite<u8[]>(compressed_size);
 
-// Inspired by https://github.com/wolfpld/tracy/blame/master/client/TracyDxt1.cpp
-static inline u64 compress_block_bc1(const u8* src) {
-    u8 min[3] = {src[0], src[1], src[2]};
-    u8 max[3] = {src[0], src[1], src[2]};
+    // Rows of blocks are independent, whatever mip they belong to
+    struct BlockRow {
+        usize mip;
+        usize y;
+        usize offset;
+    };
 
+    core::Vector<ImageData::Mip> mips;
+    core::Vector<BlockRow> rows;
     {
-        const u8* next_px = src + 4;
-        for(usize i = 1; i != 16; ++i) {
-            for(usize c = 0; c != 3; ++c) {
-                min[c] = std::min(min[c], next_px[c]);
-                max[c] = std::max(max[c], next_px[c]);
+        usize offset = 0;
+        for(usize i = 0; i != mip_count; ++i) {
+            mips << image.mip_data(i);
+            const math::Vec3ui mip_size = mips.last().size;
+            const usize row_size = ((mip_size.x() + 3) / 4) * sizeof(block_type);
+            for(usize y = 0; y < mip_size.y(); y += 4) {
+                rows << BlockRow{i, y, offset};
+                offset += row_size;
             }
-            next_px += 4;
         }
+        y_debug_assert(offset == compressed_size);
     }
 
-#if 0
-    for(usize c = 0; c != 3; ++c) {
-        const u8 inset = (max[c] - min[c]) >> 4;
-        min[c] += inset;
-        max[c] -= inset;
-        y_debug_assert(min[c] <= max[c]);
-    }
-#endif
+    parallel_for(rows.size(), 4, [&](usize begin, usize end) {
+        y_profile_zone("compress rows");
 
-    const u64 endpoint_0 = u64(to_565(min[0], min[1], min[2]));
-    const u64 endpoint_1 = u64(to_565(max[0], max[1], max[2]));
-    y_debug_assert(endpoint_0 <= endpoint_1);
-    if(endpoint_0 == endpoint_1) {
-        return endpoint_0;
-    }
+        u8 block[64];
+        for(usize r = begin; r != end; ++r) {
+            const BlockRow& row = rows[r];
+            const ImageData::Mip& mip = mips[row.mip];
 
-    math::Vec3i c0(min[0] & 0xF8, min[1] & 0xFC, min[2] & 0xF8);
-    math::Vec3i c1(max[0] & 0xF8, max[1] & 0xFC, max[2] & 0xF8);
-    const math::Vec3i colors[] = { c1, c0, (c1 * 2 + c0) / 3, (c1 + c0 * 2) / 3  };
-
-    u32 idx_data = 0;
-    for(usize i = 0; i != 16; ++i) {
-        const math::Vec3i color(src[0] & 0xF8, src[1] & 0xFC, src[2] & 0xF8);
-        u32 idx = 0;
-        i32 best = (colors[0] - color).length2();
-        for(u32 c = 1; c != 4; ++c) {
-            i32 score = (colors[c] - color).length2();
-            if(score < best) {
-                best = score;
-                idx = c;
+            u8* out = compressed_data.get() + row.offset;
+            for(usize x = 0; x < mip.size.x(); x += 4) {
+                gather_block(mip, x, row.y, block);
+                const block_type compressed = process_block(block);
+                std::memcpy(out, &compressed, sizeof(compressed));
+                out += sizeof(compressed);
             }
         }
-        idx_data |= idx << (i * 2);
-        src += 4;
-    }
+    });
 
-    return (u64(idx_data) << 32) | (endpoint_0 << 16) | (endpoint_1);
+    return ImageData(image.size().to<2>(), compressed_data.get(), compressed_format, mip_count);
 }
 
-static inline u64 compress_block_bc4(const u8* src) {
-    const usize stride = 4;
-    u8 min = src[0];
-    u8 max = src[0];
-
-    for(usize i = 1; i != 16; ++i) {
-        min = std::min(min, src[stride * i]);
-        max = std::max(max, src[stride * i]);
-    }
+ImageData compress_bc1(const ImageData& image, BlockCompressionQuality quality) {
+    const ImageFormat compressed_format = image.format().is_sRGB()
+        ? VK_FORMAT_BC1_RGB_SRGB_BLOCK
+        : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
 
-    const u8 diff = max - min;
+    return block_compress(image, compressed_format, [=](const u8* block) { return encode_bc1_block(block, quality); });
+}
 
-    u64 idx_data = 0;
-    for(usize i = 0; i != 16; ++i) {
-        const u32 value = src[stride * i];
-        const u64 idx = (value - min) * 8 / (diff + 1);
-        y_debug_assert(idx < 8);
-        idx_data |= idx << (i * 3);
-        src += 4;
-    }
+ImageData compress_bc4(const ImageData& image, BlockCompressionQuality quality) {
+    return block_compress(image, VK_FORMAT_BC4_UNORM_BLOCK, [=](const u8* block) { return encode_bc4_block(block, 0, quality); });
+}
 
-    return (u64(idx_data) << 48) | (u64(min) << 8) | (u64(max));
+ImageData compress_bc5(const ImageData& image, BlockCompressionQuality quality) {
+    return block_compress(image, VK_FORMAT_BC5_UNORM_BLOCK, [=](const u8* block) { return encode_bc5_block(block, quality); });
 }
 
-ImageData compress_bc1(const ImageData& image) {
+ImageData compress_bc7(const ImageData& image, BlockCompressionQuality quality) {
     const ImageFormat compressed_format = image.format().is_sRGB()
-        ? VK_FORMAT_BC1_RGB_SRGB_BLOCK
-        : VK_FORMAT_BC1_RGB_UNORM_BLOCK;
-
-    return block_compress(image, compressed_format, compress_block_bc1);
-}
+        ? VK_FORMAT_BC7_SRGB_BLOCK
+        : VK_FORMAT_BC7_UNORM_BLOCK;
 
-ImageData compress_bc4(const ImageData& image) {
-    return block_compress(image, VK_FORMAT_BC4_UNORM_BLOCK, compress_block_bc4);
+    return block_compress(image, compressed_format, [=](const u8* block) { return encode_bc7_block(block, quality); });
 }
 
 }
@@ -24,12 +24,23 @@ SOFTWARE.
 
 #include "import.h"
 
+#include <yave/graphics/images/block_compression.h>
+
 namespace editor {
 namespace import {
 
-[[nodiscard]] ImageData compute_mipmaps(const ImageData& image);
-[[nodiscard]] ImageData compress_bc1(const ImageData& image);
-[[nodiscard]] ImageData compress_bc4(const ImageData& image);
+enum class MipFilter {
+    Box,
+    Kaiser,     // Sharper but slower
+};
+
+[[nodiscard]] ImageData compute_mipmaps(const ImageData& image, MipFilter filter = MipFilter::Box);
+
+// Blocks are compressed in parallel, across all mips
+[[nodiscard]] ImageData compress_bc1(const ImageData& image, BlockCompressionQuality quality = BlockCompressionQuality::Normal);
+[[nodiscard]] ImageData compress_bc4(const ImageData& image, BlockCompressionQuality quality = BlockCompressionQuality::Normal);
+[[nodiscard]] ImageData compress_bc5(const ImageData& image, BlockCompressionQuality quality = BlockCompressionQuality::Normal);
+[[nodiscard]] ImageData compress_bc7(const ImageData& image, BlockCompressionQuality quality = BlockCompressionQuality::Normal);
 
 }
 }
@@ -22,8 +22,10 @@ SOFTWARE.
 
 #include "import.h"
 #include "image_utils.h"
+#include "animation_utils.h"
 
 #include <yave/meshes/Vertex.h>
+#include <yave/meshes/mesh_optimization.h>
 #include <yave/graphics/images/ImageData.h>
 #include <yave/material/MaterialData.h>
 #include <yave/utils/FileSystemModel.h>
@@ -131,6 +133,8 @@ core::Result<ImageData> import_image(const core::String& filename, ImageImportFl
 core::Result<ImageData> import_image(core::Span<u8> image_data, ImageImportFlags flags) {
     y_profile();
 
+    const core::Chrono timer;
+
     const usize req_components = 4;
 
     int width, height, bpp;
@@ -160,20 +164,30 @@ core::Result<ImageData> import_image(core::Span<u8> image_data, ImageImportFlags
     }
 
     if((flags & ImageImportFlags::Compress) == ImageImportFlags::Compress) {
-        switch(bpp) {
-            case 3:
-                img = compress_bc1(img);
-            break;
-
-            /* case 1:
-                img = compress_bc4(img);
-            break; */
-
-            default:
-                log_msg("Compression is not supported for the given image format", Log::Warning);
+        if((flags & ImageImportFlags::NormalMap) == ImageImportFlags::NormalMap) {
+            // Z is reconstructed in the shader
+            img = compress_bc5(img);
+        } else {
+            switch(bpp) {
+                // BC4 only stores red, grey images still need all 3 channels
+                case 1:
+                case 3:
+                    img = compress_bc1(img);
+                break;
+
+                case 2:
+                case 4:
+                    img = compress_bc7(img);
+                break;
+
+                default:
+                    log_msg("Compression is not supported for the given image format", Log::Warning);
+            }
         }
     }
 
+    log_msg(fmt("{}x{} image imported in {}ms", width, height, timer.elapsed().to_millis()), Log::Perf);
+
     return core::Ok(std::move(img));
 }
 
@@ -292,6 +306,21 @@ static void import_stream(const tinygltf::Model& model, const tinygltf::Accessor
     }
 }
 
+static core::Result<core::Vector<math::Vec4>> import_animation_values(const tinygltf::Model& model, int accessor_index) {
+    if(accessor_index < 0) {
+        return core::Err();
+    }
+
+    const tinygltf::Accessor& accessor = model.accessors[accessor_index];
+    if(accessor.sparse.isSparse || accessor.bufferView < 0 || accessor.componentType != TINYGLTF_COMPONENT_TYPE_FLOAT || component_count(accessor.type).is_error()) {
+        return core::Err();
+    }
+
+    core::Vector<math::Vec4> values(accessor.count, math::Vec4());
+    import_stream(model, accessor, core::MutableSpan<math::Vec4>(values), read_attrib<math::Vec4>);
+    return core::Ok(std::move(values));
+}
+
 static core::Result<MeshVertexStreams> import_vertices(const tinygltf::Model& model, const tinygltf::Primitive& primitive) {
     usize size = 0;
     for(auto [name, id] : primitive.attributes) {
@@ -485,6 +514,30 @@ core::Result<ParsedScene> parse_scene(const core::String& filename) {
         if(const int image_index = compute_image_index(gltf_material.normalTexture.index); image_index >= 0) {
             scene.images[image_index].as_normal = true;
         }
+
+        // Every image create_material can reference, so the material can be imported as soon as they are
+        core::SmallVector<int, 8> texture_indices = {
+            gltf_material.pbrMetallicRoughness.baseColorTexture.index,
+            gltf_material.pbrMetallicRoughness.metallicRoughnessTexture.index,
+            gltf_material.normalTexture.index,
+            gltf_material.emissiveTexture.index,
+        };
+
+        if(const auto it = gltf_material.extensions.find("KHR_materials_specular"); it != gltf_material.extensions.end() && it->second.IsObject()) {
+            for(const char* texture_name : {"specularTexture", "specularColorTexture"}) {
+                if(const auto tex_info = it->second.Get(texture_name); tex_info.IsObject()) {
+                    if(const auto value = tex_info.Get("index"); value.IsInt()) {
+                        texture_indices << value.GetNumberAsInt();
+                    }
+                }
+            }
+        }
+
+        for(const int texture_index : texture_indices) {
+            if(const int image_index = compute_image_index(texture_index); image_index >= 0) {
+                material.images << image_index;
+            }
+        }
     }
 
 
@@ -503,6 +556,17 @@ core::Result<ParsedScene> parse_scene(const core::String& filename) {
     }
 
 
+    for(const tinygltf::Animation& gltf_animation : scene.gltf->animations) {
+        auto& animation = scene.animations.emplace_back();
+
+        animation.name = gltf_animation.name;
+
+        if(animation.name.is_empty()) {
+            animation.name = fmt_to_owned("animation_{}", scene.animations.size());
+        }
+    }
+
+
     for(const tinygltf::Light& gltf_light : scene.gltf->lights) {
         auto& light = scene.lights.emplace_back();
 
@@ -571,31 +635,53 @@ core::Result<ParsedScene> parse_scene(const core::String& filename) {
     return core::Ok(std::move(scene));
 }
 
-core::Result<MeshData> ParsedScene::create_mesh(int index) const {
-    if(index < 0) {
+core::Result<ParsedScene::Primitive> ParsedScene::create_primitive(int mesh_index, usize primitive_index) const {
+    if(mesh_index < 0) {
         return core::Err();
     }
 
-    const tinygltf::Mesh& mesh = gltf->meshes[index];
+    const tinygltf::Primitive& primitive = gltf->meshes[mesh_index].primitives[primitive_index];
 
-    MeshData mesh_data;
-    for(usize i = 0; i != mesh.primitives.size(); ++i) {
-        const tinygltf::Primitive& primitive = mesh.primitives[i];
+    if(primitive.mode != TINYGLTF_MODE_TRIANGLES) {
+        return core::Err();
+    }
+
+    auto vertex_streams = import_vertices(*gltf, primitive);
+    auto triangles = import_triangles(*gltf, primitive);
+
+    if(vertex_streams.is_error() || triangles.is_error()) {
+        return core::Err();
+    }
 
-        if(primitive.mode != TINYGLTF_MODE_TRIANGLES) {
+    const usize vertex_count = vertex_streams.unwrap().vertex_count();
+    for(const IndexedTriangle& tri : triangles.unwrap()) {
+        if(tri[0] >= vertex_count || tri[1] >= vertex_count || tri[2] >= vertex_count) {
             return core::Err();
         }
+    }
 
-        auto vertex_streams = import_vertices(*gltf, primitive);
-        auto triangles = import_triangles(*gltf, primitive);
+    optimize_mesh(vertex_streams.unwrap(), triangles.unwrap());
 
-        if(vertex_streams.is_error() || triangles.is_error()) {
+    return core::Ok(Primitive{std::move(vertex_streams.unwrap()), std::move(triangles.unwrap())});
+}
+
+core::Result<MeshData> ParsedScene::create_mesh(int index) const {
+    if(index < 0) {
+        return core::Err();
+    }
+
+    MeshData mesh_data;
+    for(usize i = 0; i != gltf->meshes[index].primitives.size(); ++i) {
+        const auto primitive = create_primitive(index, i);
+        if(primitive.is_error()) {
             return core::Err();
         }
 
-        mesh_data.add_sub_mesh(std::move(vertex_streams.unwrap()), std::move(triangles.unwrap()));
+        mesh_data.add_sub_mesh(primitive.unwrap().vertices, primitive.unwrap().triangles);
     }
 
+    mesh_data.build_meshlets();
+
     return core::Ok(std::move(mesh_data));
 }
 
@@ -699,9 +785,12 @@ core::Result<ImageData> ParsedScene::create_image(int index, bool compress) cons
     }
 
     ImageImportFlags flags = ImageImportFlags::None;
-    if(compress && !images[index].as_normal) {
+    if(compress) {
         flags = flags | ImageImportFlags::Compress;
     }
+    if(images[index].as_normal) {
+        flags = flags | ImageImportFlags::NormalMap;
+    }
     if(images[index].as_sRGB) {
         flags = flags | ImageImportFlags::ImportAsSRGB;
     }
@@ -723,6 +812,130 @@ core::Result<ImageData> ParsedScene::create_image(int index, bool compress) cons
     return import_image(core::Span<u8>(buffer.data.data() + view.byteOffset, view.byteLength), flags);
 }
 
+// glTF samplers animate a single property while our keys hold full transforms,
+// so every property of a node is resampled at the union of the key times of all of them.
+core::Result<yave::Animation> ParsedScene::create_animation(int index, const AnimationCompressionSettings& settings, AnimationCompressionStats* stats) const {
+    if(index < 0) {
+        return core::Err();
+    }
+
+    struct Track {
+        core::Vector<float> times;
+        core::Vector<math::Vec4> values;
+        bool step = false;
+
+        bool is_empty() const {
+            return times.is_empty();
+        }
+
+        math::Vec4 sample(float time, bool is_rotation) const {
+            const usize next = usize(std::upper_bound(times.begin(), times.end(), time) - times.begin());
+            if(next == 0) {
+                return values.first();
+            }
+            if(next == times.size()) {
+                return values.last();
+            }
+
+            const usize prev = next - 1;
+            const float delta = times[next] - times[prev];
+            const float factor = (step || delta <= 0.0f) ? 0.0f : (time - times[prev]) / delta;
+
+            if(is_rotation) {
+                return math::Quaternion<>(values[prev]).slerp(math::Quaternion<>(values[next]), factor).as_vec();
+            }
+            return values[prev] * (1.0f - factor) + values[next] * factor;
+        }
+    };
+
+    struct NodeTracks {
+        Track position;
+        Track rotation;
+        Track scale;
+    };
+
+    const tinygltf::Animation& animation = gltf->animations[index];
+
+    core::Vector<NodeTracks> node_tracks(gltf->nodes.size(), NodeTracks());
+    for(const tinygltf::AnimationChannel& gltf_channel : animation.channels) {
+        if(gltf_channel.target_node < 0 || gltf_channel.sampler < 0) {
+            continue;
+        }
+
+        NodeTracks& tracks = node_tracks[gltf_channel.target_node];
+        Track* track = nullptr;
+        if(gltf_channel.target_path == "translation") {
+            track = &tracks.position;
+        } else if(gltf_channel.target_path == "rotation") {
+            track = &tracks.rotation;
+        } else if(gltf_channel.target_path == "scale") {
+            track = &tracks.scale;
+        } else {
+            // Morph target weights
+            continue;
+        }
+
+        const tinygltf::AnimationSampler& sampler = animation.samplers[gltf_channel.sampler];
+        auto times = import_animation_values(*gltf, sampler.input);
+        auto values = import_animation_values(*gltf, sampler.output);
+        if(times.is_error() || values.is_error()) {
+            log_msg(fmt("Unsupported accessor in animation \"{}\"", animations[index].name), Log::Error);
+            return core::Err();
+        }
+
+        // Cubic splines store an in tangent, the value and an out tangent per key, only the value is kept
+        const bool cubic = sampler.interpolation == "CUBICSPLINE";
+        const usize stride = cubic ? 3 : 1;
+        if(values.unwrap().size() != times.unwrap().size() * stride) {
+            return core::Err();
+        }
+
+        track->step = sampler.interpolation == "STEP";
+        for(usize i = 0; i != times.unwrap().size(); ++i) {
+            track->times << times.unwrap()[i].x();
+            track->values << values.unwrap()[i * stride + (cubic ? 1 : 0)];
+        }
+    }
+
+    float duration = 0.0f;
+    core::Vector<AnimationChannel> channels;
+    for(usize i = 0; i != node_tracks.size(); ++i) {
+        const NodeTracks& tracks = node_tracks[i];
+
+        core::Vector<float> times;
+        for(const Track* track : {&tracks.position, &tracks.rotation, &tracks.scale}) {
+            std::copy(track->times.begin(), track->times.end(), std::back_inserter(times));
+        }
+
+        if(times.is_empty()) {
+            continue;
+        }
+
+        std::sort(times.begin(), times.end());
+        times.shrink_to(usize(std::unique(times.begin(), times.end()) - times.begin()));
+
+        const auto [rest_position, rest_rotation, rest_scale] = parse_node_transform(gltf->nodes[i]).decompose();
+
+        core::Vector<AnimationChannel::BoneKey> keys;
+        for(const float time : times) {
+            BoneTransform tr;
+            tr.position = tracks.position.is_empty() ? rest_position : tracks.position.sample(time, false).to<3>();
+            tr.rotation = tracks.rotation.is_empty() ? rest_rotation : math::Quaternion<>(tracks.rotation.sample(time, true));
+            tr.scale = tracks.scale.is_empty() ? rest_scale : tracks.scale.sample(time, false).to<3>();
+            keys.emplace_back(time, tr);
+        }
+
+        duration = std::max(duration, times.last());
+        channels << compress_channel(nodes[i].name, keys, settings, stats);
+    }
+
+    if(channels.is_empty()) {
+        return core::Err();
+    }
+
+    return core::Ok(yave::Animation(duration, std::move(channels)));
+}
+
 core::String supported_scene_extensions() {
     return "*.gltf;*.glb";
 }
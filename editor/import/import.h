@@ -42,6 +42,9 @@ namespace import {
 // ----------------------------- UTILS -----------------------------
 core::String clean_asset_name(const core::String& name);
 
+struct AnimationCompressionSettings;
+struct AnimationCompressionStats;
+
 
 
 
@@ -66,7 +69,7 @@ struct ParsedScene : NonCopyable {
     };
 
     struct Material : Asset {
-
+        core::Vector<int> images;
     };
 
     struct Mesh : Asset {
@@ -82,6 +85,14 @@ struct ParsedScene : NonCopyable {
         int parent_index = -1;
     };
 
+    struct Animation : Asset {
+    };
+
+    struct Primitive {
+        MeshVertexStreams vertices;
+        core::Vector<IndexedTriangle> triangles;
+    };
+
     struct Light {
         core::String name = "Unamed light";
 
@@ -97,15 +108,20 @@ struct ParsedScene : NonCopyable {
     core::Vector<Material> materials;
     core::Vector<Image> images;
     core::Vector<Light> lights;
+    core::Vector<Animation> animations;
 
     core::Vector<Node> nodes;
     int root_node = -1;
 
     std::unique_ptr<tinygltf::Model, std::function<void(tinygltf::Model*)>> gltf;
 
+    core::Result<Primitive> create_primitive(int mesh_index, usize primitive_index) const;
     core::Result<MeshData> create_mesh(int index) const;
     core::Result<MaterialData> create_material(int index) const;
     core::Result<ImageData> create_image(int index, bool compress = false) const;
+
+    // Channels are named after their target node and keyed in the node's local space
+    core::Result<yave::Animation> create_animation(int index, const AnimationCompressionSettings& settings, AnimationCompressionStats* stats = nullptr) const;
 };
 
 
@@ -123,6 +139,7 @@ enum class ImageImportFlags {
     GenerateMipmaps = 0x01,
     ImportAsSRGB    = 0x02,
     Compress        = 0x04,
+    NormalMap       = 0x08,     // Compressed as two channels (BC5)
 };
 
 core::Result<ImageData> import_image(const core::String& filename, ImageImportFlags flags = ImageImportFlags::None);
@@ -55,10 +55,20 @@ static SceneVisibilitySubPass filter_selected(const SceneVisibilitySubPass& visi
 
     SceneVisibilitySubPass filtered = visibility;
     filtered.visible = std::make_shared<SceneVisibility>();
-    filtered.visible->meshes = filter(visibility.visible->meshes);
     filtered.visible->point_lights = filter(visibility.visible->point_lights);
     filtered.visible->spot_lights = filter(visibility.visible->spot_lights);
 
+    if(visibility.visible->has_meshes) {
+        filtered.visible->meshes = filter(visibility.visible->meshes);
+    } else if(selected) {
+        // Meshes are culled on the GPU: only look at the selection, the id pass takes care of what is offscreen
+        for(const ecs::EntityId id : selected->ids()) {
+            if(const StaticMeshObject* mesh = scene->mesh(id)) {
+                filtered.visible->meshes << mesh;
+            }
+        }
+    }
+
     return filtered;
 }
 
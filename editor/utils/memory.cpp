@@ -22,10 +22,26 @@ SOFTWARE.
 
 #include "memory.h"
 
+#include <y/concurrent/SpinLock.h>
+
 #include <y/utils/memory.h>
+#include <y/utils/hash.h>
+#include <y/utils/log.h>
+#include <y/utils/format.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cstdlib>
+#include <mutex>
+#include <new>
+
+#if defined(Y_OS_WIN)
+#include <windows.h>
+#define EDITOR_CALL_SITE_SAMPLING
+#elif defined(Y_OS_LINUX)
+#include <execinfo.h>
+#define EDITOR_CALL_SITE_SAMPLING
+#endif
 
 namespace editor {
 namespace memory {
@@ -33,6 +49,49 @@ namespace memory {
 constinit std::atomic<usize> live_allocs = 0;
 constinit std::atomic<u64> total_allocs = 0;
 
+// Every allocation is prefixed by a header, so frees can be attributed to the right tag
+struct AllocHeader {
+    u64 size;
+    u32 tag;
+    u32 offset;
+};
+
+static_assert(sizeof(AllocHeader) <= max_alignment);
+
+struct alignas(64) TagCounters {
+    std::atomic<u64> live_bytes;
+    std::atomic<u64> live_allocs;
+    std::atomic<u64> total_bytes;
+    std::atomic<u64> total_allocs;
+    std::atomic<u64> size_histogram[histogram_buckets];
+};
+
+constinit TagCounters tag_counters[y::memory::max_tags] = {};
+
+
+static constexpr usize max_call_sites = 4096;
+
+struct CallSiteTable {
+    concurrent::SpinLock lock;
+    CallSite sites[max_call_sites] = {};
+    u64 hashes[max_call_sites] = {};
+    u64 dropped = 0;
+};
+
+constinit std::atomic<u32> sampling = 0;
+constinit thread_local u32 allocs_until_sample = 0;
+constinit thread_local bool in_sampling = false;
+
+static CallSiteTable& call_site_table() {
+    // Never destroyed: allocations can happen after static destruction
+    static CallSiteTable* table = [] {
+        void* storage = std::malloc(sizeof(CallSiteTable));
+        return new(storage) CallSiteTable();
+    }();
+    return *table;
+}
+
+
 usize live_allocations() {
     return live_allocs;
 }
@@ -41,6 +100,165 @@ u64 total_allocations() {
     return total_allocs;
 }
 
+static usize histogram_bucket(usize size) {
+    const usize l = log2ui(std::max(size, usize(1)));
+    return std::min(std::max(l, usize(4)) - 4, histogram_buckets - 1);
+}
+
+usize histogram_bucket_min_size(usize bucket) {
+    return bucket ? usize(1) << (bucket + 4) : 0;
+}
+
+core::Vector<TagStats> tag_stats() {
+    core::Vector<TagStats> stats;
+    for(usize i = 0; i != y::memory::tag_count(); ++i) {
+        const TagCounters& counters = tag_counters[i];
+
+        TagStats& tag = stats.emplace_back();
+        tag.name = y::memory::tag_name(u32(i));
+        tag.live_bytes = counters.live_bytes.load(std::memory_order_relaxed);
+        tag.live_allocs = counters.live_allocs.load(std::memory_order_relaxed);
+        tag.total_bytes = counters.total_bytes.load(std::memory_order_relaxed);
+        tag.total_allocs = counters.total_allocs.load(std::memory_order_relaxed);
+        for(usize b = 0; b != histogram_buckets; ++b) {
+            tag.size_histogram[b] = counters.size_histogram[b].load(std::memory_order_relaxed);
+        }
+    }
+    return stats;
+}
+
+void set_sampling_rate(u32 rate) {
+    sampling = rate;
+}
+
+u32 sampling_rate() {
+    return sampling;
+}
+
+void clear_call_sites() {
+    CallSiteTable& table = call_site_table();
+    const std::unique_lock lock(table.lock);
+    std::fill(std::begin(table.sites), std::end(table.sites), CallSite{});
+    std::fill(std::begin(table.hashes), std::end(table.hashes), 0);
+    table.dropped = 0;
+}
+
+core::Vector<CallSite> top_call_sites(usize count) {
+    core::Vector<CallSite> sites;
+    {
+        CallSiteTable& table = call_site_table();
+        const std::unique_lock lock(table.lock);
+        for(const CallSite& site : table.sites) {
+            if(site.sampled_allocs) {
+                sites << site;
+            }
+        }
+    }
+
+    std::sort(sites.begin(), sites.end(), [](const CallSite& a, const CallSite& b) { return a.sampled_bytes > b.sampled_bytes; });
+    sites.shrink_to(count);
+    return sites;
+}
+
+void dump_top_call_sites(usize count) {
+    const core::Vector<CallSite> sites = top_call_sites(count);
+    log_msg(fmt("Top {} allocation call sites (1 in {} allocations sampled):", sites.size(), sampling_rate()), Log::Perf);
+
+    for(const CallSite& site : sites) {
+        log_msg(fmt("  [{}] {} bytes in {} allocations", y::memory::tag_name(site.tag), site.sampled_bytes, site.sampled_allocs), Log::Perf);
+
+#if defined(Y_OS_LINUX)
+        if(char** symbols = ::backtrace_symbols(site.frames.data(), int(site.frame_count))) {
+            for(usize i = 0; i != site.frame_count; ++i) {
+                log_msg(fmt("      {}", symbols[i]), Log::Perf);
+            }
+            std::free(symbols);
+            continue;
+        }
+#endif
+        for(usize i = 0; i != site.frame_count; ++i) {
+            log_msg(fmt("      {}", site.frames[i]), Log::Perf);
+        }
+    }
+}
+
+
+#ifdef EDITOR_CALL_SITE_SAMPLING
+static void sample_call_site(u32 tag, usize size) {
+    // Capturing the stack might allocate
+    in_sampling = true;
+    y_defer(in_sampling = false);
+
+    // Skip this function and the allocation function
+    static constexpr usize skipped_frames = 2;
+
+    void* frames[max_call_site_frames + skipped_frames] = {};
+#if defined(Y_OS_WIN)
+    const usize frame_count = ::RtlCaptureStackBackTrace(0, DWORD(std::size(frames)), frames, nullptr);
+#else
+    const usize frame_count = usize(std::max(0, ::backtrace(frames, int(std::size(frames)))));
+#endif
+
+    if(frame_count <= skipped_frames) {
+        return;
+    }
+
+    CallSite site;
+    site.frame_count = frame_count - skipped_frames;
+    std::copy_n(frames + skipped_frames, site.frame_count, site.frames.begin());
+
+    u64 hash = tag + 1;
+    for(usize i = 0; i != site.frame_count; ++i) {
+        hash_combine(hash, u64(site.frames[i]));
+    }
+    hash |= 1; // 0 is used for empty slots
+
+    CallSiteTable& table = call_site_table();
+    const std::unique_lock lock(table.lock);
+
+    for(usize i = 0; i != max_call_sites; ++i) {
+        const usize index = (hash + i) % max_call_sites;
+        if(!table.hashes[index]) {
+            table.hashes[index] = hash;
+            site.tag = tag;
+            table.sites[index] = site;
+        }
+
+        if(table.hashes[index] == hash) {
+            table.sites[index].sampled_bytes += size;
+            ++table.sites[index].sampled_allocs;
+            return;
+        }
+    }
+
+    ++table.dropped;
+}
+#endif
+
+static void track_alloc(u32 tag, usize size) {
+    TagCounters& counters = tag_counters[tag];
+    counters.live_bytes.fetch_add(size, std::memory_order_relaxed);
+    counters.live_allocs.fetch_add(1, std::memory_order_relaxed);
+    counters.total_bytes.fetch_add(size, std::memory_order_relaxed);
+    counters.total_allocs.fetch_add(1, std::memory_order_relaxed);
+    counters.size_histogram[histogram_bucket(size)].fetch_add(1, std::memory_order_relaxed);
+
+#ifdef EDITOR_CALL_SITE_SAMPLING
+    if(const u32 rate = sampling.load(std::memory_order_relaxed); rate && !in_sampling) {
+        if(allocs_until_sample == 0) {
+            allocs_until_sample = rate;
+            sample_call_site(tag, size);
+        }
+        --allocs_until_sample;
+    }
+#endif
+}
+
+static void track_free(u32 tag, usize size) {
+    TagCounters& counters = tag_counters[tag];
+    counters.live_bytes.fetch_sub(size, std::memory_order_relaxed);
+    counters.live_allocs.fetch_sub(1, std::memory_order_relaxed);
+}
 
 
 
@@ -50,16 +268,19 @@ static void* alloc_internal(usize size, usize alignment = max_alignment) {
         return nullptr;
     }
 
+    alignment = std::max(alignment, max_alignment);
+    const usize header_size = alignment;
+
     auto try_alloc = [=] {
         #ifdef Y_MSVC
-            return _aligned_malloc(size, alignment);
+            return _aligned_malloc(size + header_size, alignment);
         #else
-            return std::aligned_alloc(alignment, size);
+            return std::aligned_alloc(alignment, size + header_size);
         #endif
     };
 
-    void* ptr = nullptr;
-    while((ptr = try_alloc()) == nullptr) {
+    void* block = nullptr;
+    while((block = try_alloc()) == nullptr) {
         std::new_handler nh = std::get_new_handler();
         if(!nh) {
             throw std::bad_alloc{};
@@ -70,6 +291,16 @@ static void* alloc_internal(usize size, usize alignment = max_alignment) {
     ++total_allocs;
     ++live_allocs;
 
+    void* ptr = static_cast<u8*>(block) + header_size;
+
+    const u32 tag = y::memory::current_tag();
+    AllocHeader* header = static_cast<AllocHeader*>(ptr) - 1;
+    header->size = size;
+    header->tag = tag;
+    header->offset = u32(header_size);
+
+    track_alloc(tag, size);
+
     y_profile_alloc(ptr, size);
 
     return ptr;
@@ -77,16 +308,23 @@ static void* alloc_internal(usize size, usize alignment = max_alignment) {
 }
 
 static void free_internal(void* ptr) {
-    if(ptr) {
-        --live_allocs;
+    if(!ptr) {
+        return;
     }
 
+    --live_allocs;
+
     y_profile_free(ptr);
 
+    const AllocHeader* header = static_cast<const AllocHeader*>(ptr) - 1;
+    track_free(header->tag, usize(header->size));
+
+    void* block = static_cast<u8*>(ptr) - header->offset;
+
 #ifdef Y_MSVC
-    _aligned_free(ptr);
+    _aligned_free(block);
 #else
-    std::free(ptr);
+    std::free(block);
 #endif
 }
 }
@@ -24,10 +24,54 @@ SOFTWARE.
 
 #include <editor/editor.h>
 
+#include <y/core/Vector.h>
+
+#include <array>
+
 namespace editor {
 namespace memory {
+
+static constexpr usize histogram_buckets = 16;
+static constexpr usize max_call_site_frames = 12;
+
+struct TagStats {
+    const char* name = nullptr;
+
+    u64 live_bytes = 0;
+    u64 live_allocs = 0;
+
+    u64 total_bytes = 0;
+    u64 total_allocs = 0;
+
+    // Number of allocations per size class, see histogram_bucket_min_size
+    std::array<u64, histogram_buckets> size_histogram = {};
+};
+
+struct CallSite {
+    std::array<void*, max_call_site_frames> frames = {};
+    usize frame_count = 0;
+
+    u32 tag = 0;
+    u64 sampled_bytes = 0;
+    u64 sampled_allocs = 0;
+};
+
 usize live_allocations();
 u64 total_allocations();
+
+usize histogram_bucket_min_size(usize bucket);
+
+// One entry per registered tag, indexed by tag
+core::Vector<TagStats> tag_stats();
+
+// Captures the call stack of one allocation every "rate" allocations per thread, 0 disables sampling
+void set_sampling_rate(u32 rate);
+u32 sampling_rate();
+void clear_call_sites();
+
+core::Vector<CallSite> top_call_sites(usize count);
+void dump_top_call_sites(usize count = 16);
+
 }
 }
 
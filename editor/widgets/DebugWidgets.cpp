@@ -239,22 +239,36 @@ class MeshAllocatorDebug : public Widget {
 
     protected:
         void on_gui() override {
-            auto [vert, tris] = mesh_allocator().allocated();
+            pool_gui("Full", MeshVertexFormat::Full);
+            pool_gui("Compact", MeshVertexFormat::Compact);
+        }
+
+    private:
+        void pool_gui(const char* name, MeshVertexFormat format) {
+            const auto [vert, tris] = mesh_allocator().allocated(format);
+            const auto [vert_capacity, tris_capacity] = mesh_allocator().capacity(format);
 
+            ImGui::TextUnformatted(name);
             {
                 ImGui::TextUnformatted("Vertex buffer:");
                 ImGui::SameLine();
-                ImGui::ProgressBar(float(vert) / MeshAllocator::default_vertex_count, ImVec2(-1.0f, 0.0f),
-                    fmt_c_str("{}k / {}k", vert / 1000, MeshAllocator::default_vertex_count / 1000)
+                ImGui::ProgressBar(float(vert) / vert_capacity, ImVec2(-1.0f, 0.0f),
+                    fmt_c_str("{}k / {}k", vert / 1000, vert_capacity / 1000)
                 );
             }
             {
                 ImGui::TextUnformatted("Triangle buffer:");
                 ImGui::SameLine();
-                ImGui::ProgressBar(float(tris) / MeshAllocator::default_triangle_count, ImVec2(-1.0f, 0.0f),
-                    fmt_c_str("{}k / {}k", tris / 1000, MeshAllocator::default_triangle_count / 1000)
+                ImGui::ProgressBar(float(tris) / tris_capacity, ImVec2(-1.0f, 0.0f),
+                    fmt_c_str("{}k / {}k", tris / 1000, tris_capacity / 1000)
                 );
             }
+
+            const auto [vertex_stats, triangle_stats] = mesh_allocator().stats(format);
+            ImGui::Text("Fragmentation: vertices %.1f%% (%u blocks), triangles %.1f%% (%u blocks)",
+                vertex_stats.fragmentation() * 100.0f, unsigned(vertex_stats.free_blocks),
+                triangle_stats.fragmentation() * 100.0f, unsigned(triangle_stats.free_blocks)
+            );
         }
 };
 
@@ -38,6 +38,7 @@ SOFTWARE.
 #include <yave/graphics/commands/CmdBufferRecorder.h>
 #include <yave/graphics/commands/CmdTimingRecorder.h>
 #include <yave/graphics/device/DeviceResources.h>
+#include <yave/graphics/device/DeviceProperties.h>
 
 #include <yave/utils/color.h>
 
@@ -585,6 +586,15 @@ void EngineView::draw_settings_menu() {
 
         ImGui::EndMenu();
     }
+
+    if(ImGui::BeginMenu("Culling")) {
+        ImGui::Checkbox("GPU culling", &app_settings().perf.gpu_culling);
+        if(!device_properties().draw_indirect_count) {
+            ImGui::TextDisabled("Not supported by this device");
+        }
+
+        ImGui::EndMenu();
+    }
 }
 
 }
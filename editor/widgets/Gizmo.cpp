@@ -149,7 +149,7 @@ static bool is_inside(core::Span<math::Vec2> pts, const math::Vec2& p) {
 static void move_recursive(EditorWorld& world, ecs::EntityId id, math::Transform<> old_parent_transform, math::Transform<> new_parent_transform) {
     if(TransformableComponent* component = world.component_mut<TransformableComponent>(id)) {
         const math::Transform<> tr = component->transform();
-        component->set_transform(new_parent_transform * old_parent_transform.inverse() * tr);
+        component->set_transform(new_parent_transform * old_parent_transform.affine_inverse() * tr);
         old_parent_transform = tr;
         new_parent_transform = component->transform();
     }
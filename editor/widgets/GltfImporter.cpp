@@ -33,10 +33,14 @@ SOFTWARE.
 #include <yave/meshes/StaticMesh.h>
 #include <yave/material/Material.h>
 
+#include <editor/import/animation_utils.h>
 #include <editor/utils/ui.h>
 #include <editor/components/EditorComponent.h>
 
 #include <y/io2/Buffer.h>
+#include <y/core/Chrono.h>
+
+#include <optional>
 
 
 
@@ -149,11 +153,22 @@ static AssetId import_node(import::ParsedScene& scene, int index, bool import_ch
     return node.asset_id;
 }
 
+// Every asset is imported by its own task, which only waits for the assets it references:
+// images before the materials using them, primitives before their mesh, and meshes, materials and child prefabs before a prefab.
+// Tasks are scheduled in dependency order, so that every group waited on already has its signal.
 template<typename T>
 static void import_all(concurrent::StaticThreadPool& thread_pool, import::ParsedScene& scene, T settings) {
-    concurrent::DependencyGroup image_group;
-    concurrent::DependencyGroup material_group;
-    concurrent::DependencyGroup mesh_group;
+    y_profile();
+
+    using DependencyGroups = core::SmallVector<concurrent::DependencyGroup, 8>;
+
+    const core::Chrono timer;
+
+    core::Vector<concurrent::DependencyGroup> image_groups(scene.images.size(), concurrent::DependencyGroup());
+    core::Vector<concurrent::DependencyGroup> material_groups(scene.materials.size(), concurrent::DependencyGroup());
+    core::Vector<concurrent::DependencyGroup> mesh_groups(scene.meshes.size(), concurrent::DependencyGroup());
+    core::Vector<concurrent::DependencyGroup> node_groups(scene.nodes.size(), concurrent::DependencyGroup());
+    core::Vector<concurrent::DependencyGroup> animation_groups(settings.import_animations ? scene.animations.size() : 0, concurrent::DependencyGroup());
 
     for(usize i = 0; i != scene.images.size(); ++i) {
         thread_pool.schedule([i, settings, &scene] {
@@ -161,31 +176,125 @@ static void import_all(concurrent::StaticThreadPool& thread_pool, import::Parsed
             if(const auto image_data = scene.create_image(int(i), true)) {
                 image.set_id(import_asset(image.name, image_data.unwrap(), AssetType::Image, settings.import_path));
             }
-        }, &image_group);
+        }, &image_groups[i]);
     }
 
     for(usize i = 0; i != scene.materials.size(); ++i) {
+        DependencyGroups wait_for;
+        for(const int image_index : scene.materials[i].images) {
+            wait_for << image_groups[image_index];
+        }
+
         thread_pool.schedule([i, settings, &scene] {
             auto& material = scene.materials[i];
             if(const auto material_data = scene.create_material(int(i))) {
                 material.set_id(import_asset(material.name, material_data.unwrap(), AssetType::Material, settings.import_path));
             }
-        }, &material_group, image_group);
+        }, &material_groups[i], wait_for);
     }
 
     for(usize i = 0; i != scene.meshes.size(); ++i) {
-        thread_pool.schedule([i, settings, &scene] {
+        using Primitives = core::Vector<std::optional<import::ParsedScene::Primitive>>;
+
+        const usize primitive_count = scene.meshes[i].materials.size();
+        auto primitives = std::make_shared<Primitives>();
+        primitives->set_min_size(primitive_count);
+
+        DependencyGroups primitive_groups(primitive_count, concurrent::DependencyGroup());
+        for(usize p = 0; p != primitive_count; ++p) {
+            thread_pool.schedule([i, p, primitives, &scene] {
+                if(auto primitive = scene.create_primitive(int(i), p)) {
+                    (*primitives)[p] = std::move(primitive.unwrap());
+                }
+            }, &primitive_groups[p]);
+        }
+
+        thread_pool.schedule([i, settings, primitives, &scene] {
             auto& mesh = scene.meshes[i];
-            if(const auto mesh_data = scene.create_mesh(int(i))) {
-                mesh.set_id(import_asset(mesh.name, mesh_data.unwrap(), AssetType::Mesh, settings.import_path));
+
+            MeshData mesh_data;
+            for(const auto& primitive : *primitives) {
+                if(!primitive) {
+                    log_msg(fmt("Unable to import mesh \"{}\"", mesh.name), Log::Error);
+                    return;
+                }
+                mesh_data.add_sub_mesh(primitive->vertices, primitive->triangles);
             }
-        }, &mesh_group, material_group);
+            primitives->make_empty();
+
+            mesh_data.build_meshlets();
+
+            if(settings.compact_vertices && mesh_data.vertex_streams().vertex_count() <= max_compact_vertex_count) {
+                mesh_data.set_vertex_format(MeshVertexFormat::Compact);
+            }
+
+            mesh.set_id(import_asset(mesh.name, mesh_data, AssetType::Mesh, settings.import_path));
+        }, &mesh_groups[i], primitive_groups);
+    }
+
+    for(usize i = 0; i != animation_groups.size(); ++i) {
+        thread_pool.schedule([i, settings, &scene] {
+            auto& animation = scene.animations[i];
+
+            import::AnimationCompressionStats stats;
+            if(const auto animation_data = scene.create_animation(int(i), import::AnimationCompressionSettings(), &stats)) {
+                log_msg(fmt("\"{}\": {} keys compressed to {} ({}KB to {}KB), max error: {} position, {} deg rotation, {} scale",
+                    animation.name, stats.source_key_count, stats.key_count, stats.source_byte_size / 1024, stats.byte_size / 1024,
+                    stats.max_position_error, math::to_deg(stats.max_rotation_error), stats.max_scale_error), Log::Perf);
+                animation.set_id(import_asset(animation.name, animation_data.unwrap(), AssetType::Animation, settings.import_path));
+            } else {
+                log_msg(fmt("Unable to import animation \"{}\"", animation.name), Log::Error);
+            }
+        }, &animation_groups[i]);
+    }
+
+    const auto schedule_prefab = [&](auto&& schedule_prefab, int index) -> void {
+        DependencyGroups wait_for;
+
+        // Children imported as assets are their own task, otherwise they are part of this prefab
+        const auto gather_dependencies = [&](auto&& gather_dependencies, int node_index) -> void {
+            const auto& node = scene.nodes[node_index];
+            if(node.mesh_index >= 0) {
+                wait_for << mesh_groups[node.mesh_index];
+                for(const int material_index : scene.meshes[node.mesh_index].materials) {
+                    if(material_index >= 0) {
+                        wait_for << material_groups[material_index];
+                    }
+                }
+            }
+
+            for(const int child_index : node.children) {
+                if(settings.import_child_prefabs_as_assets) {
+                    schedule_prefab(schedule_prefab, child_index);
+                    wait_for << node_groups[child_index];
+                } else {
+                    gather_dependencies(gather_dependencies, child_index);
+                }
+            }
+        };
+        gather_dependencies(gather_dependencies, index);
+
+        thread_pool.schedule([index, settings, &scene] {
+            import_node(scene, index, settings.import_child_prefabs_as_assets, settings.import_path);
+        }, &node_groups[index], wait_for);
+    };
+
+    if(scene.root_node < 0) {
+        return;
+    }
+
+    schedule_prefab(schedule_prefab, scene.root_node);
+
+    core::Vector<concurrent::DependencyGroup> all_groups;
+    for(const auto* groups : {&image_groups, &material_groups, &mesh_groups, &node_groups, &animation_groups}) {
+        for(const concurrent::DependencyGroup& group : *groups) {
+            all_groups << group;
+        }
     }
 
-    Y_TODO(slow, be import_node is not thread safe)
-    thread_pool.schedule([settings, &scene] {
-        import_node(scene, scene.root_node, settings.import_child_prefabs_as_assets, settings.import_path);
-    }, nullptr, mesh_group);
+    thread_pool.schedule([timer, name = scene.name] {
+        log_msg(fmt("\"{}\" imported in {}ms", name, timer.elapsed().to_millis()), Log::Perf);
+    }, nullptr, all_groups);
 }
 
 
@@ -195,8 +304,7 @@ GltfImporter::GltfImporter() : GltfImporter(asset_store().filesystem()->current_
 
 GltfImporter::GltfImporter(std::string_view import_dst_path) :
         Widget("glTF importer"),
-        _import_path(import_dst_path),
-        _thread_pool(4_uu) {
+        _import_path(import_dst_path) {
 
     _browser.set_selection_filter(import::supported_scene_extensions());
     _browser.set_canceled_callback([this] { close(); return true; });
@@ -253,6 +361,8 @@ void GltfImporter::on_gui() {
             }
 
             ImGui::Checkbox("Import children prefabs as assets", &_settings.import_child_prefabs_as_assets);
+            ImGui::Checkbox("Compact vertices", &_settings.compact_vertices);
+            ImGui::Checkbox("Import animations", &_settings.import_animations);
 
             if(ImGui::Button(ICON_FA_CHECK " Import")) {
                 import_all(_thread_pool, _scene.unwrap(), _settings);
@@ -61,6 +61,8 @@ class GltfImporter final : public Widget {
         struct {
             core::String import_path = "import/";
             bool import_child_prefabs_as_assets = false;
+            bool compact_vertices = true;
+            bool import_animations = true;
         } _settings;
 
 
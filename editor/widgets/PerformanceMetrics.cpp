@@ -29,6 +29,10 @@ SOFTWARE.
 
 #include <editor/utils/ui.h>
 
+#include <y/io2/File.h>
+
+#include <y/utils/log.h>
+
 #include <y/utils/format.h>
 
 namespace editor {
@@ -113,16 +117,30 @@ bool PerformanceMetrics::before_gui() {
 }
 
 void PerformanceMetrics::on_gui() {
+    // Always sampled, so deltas stay per frame even when the allocation header is collapsed
+    _last_tag_stats = std::exchange(_tag_stats, memory::tag_stats());
+    _last_descriptor_cache_stats = std::exchange(_descriptor_cache_stats, DescriptorSetCache::total_stats());
+
     if(ImGui::CollapsingHeader("Timings", ImGuiTreeNodeFlags_DefaultOpen)) {
         ImGui::Indent();
         draw_timings();
         ImGui::Unindent();
     }
+    if(ImGui::CollapsingHeader("CPU zones")) {
+        ImGui::Indent();
+        draw_cpu_zones();
+        ImGui::Unindent();
+    }
     if(ImGui::CollapsingHeader("Memory", ImGuiTreeNodeFlags_DefaultOpen)) {
         ImGui::Indent();
         draw_memory();
         ImGui::Unindent();
     }
+    if(ImGui::CollapsingHeader("Allocations")) {
+        ImGui::Indent();
+        draw_allocations();
+        ImGui::Unindent();
+    }
 }
 
 void PerformanceMetrics::draw_timings() {
@@ -143,15 +161,176 @@ void PerformanceMetrics::draw_timings() {
     ImGui::Text("%.3u active command buffers", unsigned(lifetime_manager().pending_cmd_buffers()));
 }
 
+void PerformanceMetrics::draw_cpu_zones() {
+    if(!profiler::is_enabled()) {
+        ImGui::TextColored(imgui::error_text_color, "Built-in profiling is disabled");
+        return;
+    }
+
+    const profiler::FrameStats frame = profiler::frame_stats();
+    ImGui::Text("Over %u frames: min %.2fms, avg %.2fms, max %.2fms", unsigned(frame.frame_count), frame.min_ms, frame.avg_ms, frame.max_ms);
+    if(frame.dropped_events) {
+        ImGui::TextColored(imgui::error_text_color, "%u events dropped", unsigned(frame.dropped_events));
+    }
+
+    if(profiler::is_capturing()) {
+        ImGui::TextUnformatted("Capturing...");
+    } else {
+        if(ImGui::Button("Capture trace")) {
+            profiler::capture_frames(_capture_frames);
+        }
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(100.0f);
+        ImGui::InputScalar("frames", ImGuiDataType_U32, &_capture_frames);
+        _capture_frames = std::max(_capture_frames, 1u);
+
+        if(profiler::has_capture()) {
+            ImGui::SameLine();
+            if(ImGui::Button("Export")) {
+                const char* filename = "cpu_trace.json";
+                if(auto file = io2::File::create(filename); file && profiler::export_chrome_trace(file.unwrap())) {
+                    log_msg(fmt("CPU trace exported as {}", filename));
+                } else {
+                    log_msg(fmt("Unable to export CPU trace to {}", filename), Log::Error);
+                }
+            }
+        }
+    }
+
+    core::Vector<profiler::ZoneStats> zones = profiler::zone_stats();
+    std::sort(zones.begin(), zones.end(), [](const auto& a, const auto& b) { return a.avg_ms > b.avg_ms; });
+
+    const ImGuiTableFlags table_flags =
+            ImGuiTableFlags_NoSavedSettings |
+            ImGuiTableFlags_SizingFixedFit |
+            ImGuiTableFlags_BordersInnerV |
+            ImGuiTableFlags_Resizable |
+            ImGuiTableFlags_ScrollY |
+            ImGuiTableFlags_RowBg;
+
+    if(ImGui::BeginTable("##zones", 5, table_flags, ImVec2(0.0f, 300.0f))) {
+        ImGui::TableSetupColumn("Zone", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Calls", ImGuiTableColumnFlags_NoResize, 60.0f);
+        ImGui::TableSetupColumn("Min", ImGuiTableColumnFlags_NoResize, 70.0f);
+        ImGui::TableSetupColumn("Avg", ImGuiTableColumnFlags_NoResize, 70.0f);
+        ImGui::TableSetupColumn("Max", ImGuiTableColumnFlags_NoResize, 70.0f);
+        ImGui::TableHeadersRow();
+
+        for(const profiler::ZoneStats& zone : zones) {
+            imgui::table_begin_next_row();
+            ImGui::TextUnformatted(zone.name);
+
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%.1f", zone.avg_calls);
+
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%.2fms", zone.min_ms);
+
+            ImGui::TableSetColumnIndex(3);
+            ImGui::Text("%.2fms", zone.avg_ms);
+
+            ImGui::TableSetColumnIndex(4);
+            ImGui::Text("%.2fms", zone.max_ms);
+        }
+
+        ImGui::EndTable();
+    }
+}
+
+void PerformanceMetrics::draw_allocations() {
+    const core::Vector<memory::TagStats>& tags = _tag_stats;
+
+    ImGui::Text("%u live allocations", unsigned(memory::live_allocations()));
+
+    {
+        bool sampling = memory::sampling_rate() != 0;
+        if(ImGui::Checkbox("Sample call sites", &sampling)) {
+            memory::set_sampling_rate(sampling ? _sampling_rate : 0);
+        }
+
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(100.0f);
+        if(ImGui::InputScalar("rate", ImGuiDataType_U32, &_sampling_rate)) {
+            _sampling_rate = std::max(_sampling_rate, 1u);
+            if(sampling) {
+                memory::set_sampling_rate(_sampling_rate);
+            }
+        }
+
+        if(sampling) {
+            if(ImGui::Button("Dump top call sites")) {
+                memory::dump_top_call_sites();
+            }
+            ImGui::SameLine();
+            if(ImGui::Button("Clear")) {
+                memory::clear_call_sites();
+            }
+        }
+    }
+
+    const ImGuiTableFlags table_flags =
+            ImGuiTableFlags_NoSavedSettings |
+            ImGuiTableFlags_SizingFixedFit |
+            ImGuiTableFlags_BordersInnerV |
+            ImGuiTableFlags_Resizable |
+            ImGuiTableFlags_RowBg;
+
+    if(ImGui::BeginTable("##allocations", 5, table_flags)) {
+        ImGui::TableSetupColumn("Tag", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Live", ImGuiTableColumnFlags_NoResize, 80.0f);
+        ImGui::TableSetupColumn("Live allocs", ImGuiTableColumnFlags_NoResize, 80.0f);
+        ImGui::TableSetupColumn("Allocs/frame", ImGuiTableColumnFlags_NoResize, 80.0f);
+        ImGui::TableSetupColumn("Bytes/frame", ImGuiTableColumnFlags_NoResize, 80.0f);
+        ImGui::TableHeadersRow();
+
+        for(usize i = 0; i != tags.size(); ++i) {
+            const memory::TagStats& tag = tags[i];
+            const memory::TagStats last = i < _last_tag_stats.size() ? _last_tag_stats[i] : memory::TagStats{};
+
+            imgui::table_begin_next_row();
+            ImGui::TextUnformatted(tag.name);
+
+            if(ImGui::IsItemHovered()) {
+                ImGui::BeginTooltip();
+                for(usize b = 0; b != memory::histogram_buckets; ++b) {
+                    if(tag.size_histogram[b]) {
+                        ImGui::Text(">= %u bytes: %u", unsigned(memory::histogram_bucket_min_size(b)), unsigned(tag.size_histogram[b]));
+                    }
+                }
+                ImGui::EndTooltip();
+            }
+
+            ImGui::TableSetColumnIndex(1);
+            ImGui::Text("%.2fMB", to_mb(tag.live_bytes));
+
+            ImGui::TableSetColumnIndex(2);
+            ImGui::Text("%u", unsigned(tag.live_allocs));
+
+            ImGui::TableSetColumnIndex(3);
+            ImGui::Text("%u", unsigned(tag.total_allocs - last.total_allocs));
+
+            ImGui::TableSetColumnIndex(4);
+            ImGui::Text("%.1fKB", double(tag.total_bytes - last.total_bytes) / 1024.0);
+        }
+
+        ImGui::EndTable();
+    }
+}
+
 void PerformanceMetrics::draw_memory() {
     double used_per_type_mb[4] = {};
     double allocated_per_type_mb[4] = {};
+    float fragmentation_per_type[4] = {};
     for(const auto& heaps : device_allocator().heaps()) {
         for(const auto& heap : heaps) {
             u64 free = heap->available();
             const u64 used = heap->size() - free;
             used_per_type_mb[uenum(heap->memory_type())] += to_mb(used);
             allocated_per_type_mb[uenum(heap->memory_type())] += to_mb(heap->size());
+            if(_show_heaps) {
+                float& fragmentation = fragmentation_per_type[uenum(heap->memory_type())];
+                fragmentation = std::max(fragmentation, heap->stats().fragmentation());
+            }
         }
     }
 
@@ -192,6 +371,18 @@ void PerformanceMetrics::draw_memory() {
 
         ImGui::SetNextItemWidth(-1);
         ImGui::PlotLines("##memory", _memory.values().data(), int(_memory.values().size()), int(_memory.next_index()), "", 0.0f, _memory.max() * 1.33f, ImVec2(0, 80));
+
+        const TransientHeap::Stats heap_stats = TransientHeap::last_frame_stats();
+        ImGui::Text("Frame graph transients: %.1lfMB (%.1lfMB without aliasing)", to_mb(heap_stats.heap_size), to_mb(heap_stats.resource_size));
+
+        const FrameGraphResourcePool::Stats pool_stats = FrameGraphResourcePool::total_stats();
+        const u64 pool_hits = pool_stats.hits - _last_resource_pool_stats.hits;
+        const u64 pool_misses = pool_stats.misses - _last_resource_pool_stats.misses;
+        _last_resource_pool_stats = pool_stats;
+
+        ImGui::Text("Frame graph pools: %.1lfMB unused", to_mb(pool_stats.pooled_bytes));
+        ImGui::Text("Frame graph pools: %u hits, %u misses", u32(pool_hits), u32(pool_misses));
+        ImGui::Text("Frame graph pools: %u aged out, %u evicted", u32(pool_stats.aged_out), u32(pool_stats.evicted));
     }
 
     {
@@ -208,6 +399,19 @@ void PerformanceMetrics::draw_memory() {
         ImGui::Text("Descriptor set pools: %u", u32(pools));
 
         ImGui::ProgressBar(used_sets / float(total_sets), ImVec2(0, 0), fmt_c_str("{} / {} sets", used_sets, total_sets));
+
+        const DescriptorSetCache::Stats& cache_stats = _descriptor_cache_stats;
+        const u64 hits = cache_stats.hits - _last_descriptor_cache_stats.hits;
+        const u64 misses = cache_stats.misses - _last_descriptor_cache_stats.misses;
+        const u64 invalidations = cache_stats.invalidations - _last_descriptor_cache_stats.invalidations;
+        const u64 update_ns = cache_stats.update_time_ns - _last_descriptor_cache_stats.update_time_ns;
+
+        ImGui::Text("Descriptor set cache: %u hits, %u misses", u32(hits), u32(misses));
+        ImGui::Text("Descriptor set updates: %.3fms", update_ns / 1'000'000.0);
+        ImGui::Text("Invalidated sets: %u", u32(invalidations));
+
+        const TransientDescriptorSetAllocator& transient = transient_descriptor_set_allocator();
+        ImGui::Text("Transient descriptor sets: %u in %u pools", u32(transient.used_sets()), u32(transient.pool_count()));
     }
 
     ImGui::Spacing();
@@ -223,6 +427,7 @@ void PerformanceMetrics::draw_memory() {
             ImGui::Bullet();
             ImGui::TextUnformatted(memory_type_name(MemoryType(i)));
             progress_bar(used_per_type_mb[i], allocated_per_type_mb[i]);
+            ImGui::Text("Worst heap fragmentation: %.1f%%", fragmentation_per_type[i] * 100.0f);
 
         }
         ImGui::Unindent();
@@ -23,6 +23,10 @@ SOFTWARE.
 #define EDITOR_WIDGETS_PERFORMANCEMETRICS_H
 
 #include <editor/Widget.h>
+#include <editor/utils/memory.h>
+
+#include <yave/graphics/descriptors/DescriptorSetCache.h>
+#include <yave/framegraph/FrameGraphResourcePool.h>
 
 #include <y/core/FixedArray.h>
 #include <y/core/Chrono.h>
@@ -73,7 +77,9 @@ class PerformanceMetrics : public Widget {
 
     private:
         void draw_timings();
+        void draw_cpu_zones();
         void draw_memory();
+        void draw_allocations();
 
         core::Chrono _timer;
 
@@ -82,6 +88,14 @@ class PerformanceMetrics : public Widget {
         PlotData _memory;
 
         bool _show_heaps = false;
+        u32 _capture_frames = 8;
+
+        core::Vector<memory::TagStats> _tag_stats;
+        core::Vector<memory::TagStats> _last_tag_stats;
+        DescriptorSetCache::Stats _descriptor_cache_stats;
+        DescriptorSetCache::Stats _last_descriptor_cache_stats;
+        FrameGraphResourcePool::Stats _last_resource_pool_stats;
+        u32 _sampling_rate = 64;
 };
 
 }
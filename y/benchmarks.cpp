@@ -0,0 +1,72 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include <y/test/bench.h>
+#include <y/io2/File.h>
+#include <y/utils/log.h>
+#include <y/utils/format.h>
+
+#include <string_view>
+
+using namespace y;
+
+// Usage: benchmarks [--filter <substring>] [--json <output file>] [--quick]
+int main(int argc, char** argv) {
+    test::BenchSettings settings;
+    std::string_view json_file;
+
+    for(int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if(arg == "--filter" && i + 1 < argc) {
+            settings.filter = argv[++i];
+        } else if(arg == "--json" && i + 1 < argc) {
+            json_file = argv[++i];
+        } else if(arg == "--quick") {
+            settings.warmup = core::Duration::milliseconds(5.0);
+            settings.max_total_time = core::Duration::milliseconds(50.0);
+            settings.min_samples = 4;
+        } else {
+            log_msg(fmt("Unknown argument: {}", arg), Log::Error);
+            return 1;
+        }
+    }
+
+    const core::Vector<test::BenchResult> results = test::run_benchmarks(settings);
+
+    if(!json_file.empty()) {
+        auto file = io2::File::create(json_file);
+        if(!file) {
+            log_msg(fmt("Unable to create file {}", json_file), Log::Error);
+            return 1;
+        }
+
+        const core::String json = test::results_to_json(results);
+        if(!file.unwrap().write(json.data(), json.size())) {
+            log_msg("Unable to write results", Log::Error);
+            return 1;
+        }
+
+        log_msg(fmt("Results written to {}", json_file));
+    }
+
+    return 0;
+}
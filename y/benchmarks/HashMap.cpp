@@ -0,0 +1,121 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include <y/test/bench.h>
+
+#include <y/core/Vector.h>
+#include <y/core/HashMap.h>
+
+#include <y/math/random.h>
+
+#include <unordered_map>
+
+namespace {
+using namespace y;
+using namespace y::core;
+
+static constexpr usize key_count = 64 * 1024;
+
+static Vector<u64> random_keys(usize count) {
+    math::FastRandom rng;
+    Vector<u64> keys;
+    for(usize i = 0; i != count; ++i) {
+        keys << (u64(rng()) << 32 | rng());
+    }
+    return keys;
+}
+
+template<typename M>
+static void bench_insert(test::Bench& bench) {
+    const auto keys = random_keys(key_count);
+
+    bench.set_items_per_iteration(key_count);
+    bench.run([&] {
+        M map;
+        for(const u64 k : keys) {
+            map.insert({k, k});
+        }
+        test::do_not_optimize(map);
+    });
+}
+
+template<typename M>
+static void bench_find(test::Bench& bench) {
+    const auto keys = random_keys(key_count);
+    const auto missing = random_keys(key_count * 2);
+
+    M map;
+    for(const u64 k : keys) {
+        map.insert({k, k});
+    }
+
+    bench.set_items_per_iteration(key_count * 2);
+    bench.run([&] {
+        usize found = 0;
+        for(usize i = 0; i != key_count; ++i) {
+            found += map.find(keys[i]) != map.end();
+            found += map.find(missing[key_count + i]) != map.end();
+        }
+        test::do_not_optimize(found);
+    });
+}
+
+template<typename M>
+static void bench_iterate(test::Bench& bench) {
+    const auto keys = random_keys(key_count);
+
+    M map;
+    for(const u64 k : keys) {
+        map.insert({k, k});
+    }
+
+    bench.set_items_per_iteration(key_count);
+    bench.run([&] {
+        u64 sum = 0;
+        for(const auto& [k, v] : map) {
+            sum += v;
+        }
+        test::do_not_optimize(sum);
+    });
+}
+
+y_bench_func("FlatHashMap insert") {
+    bench_insert<FlatHashMap<u64, u64>>(bench);
+}
+
+y_bench_func("std::unordered_map insert") {
+    bench_insert<std::unordered_map<u64, u64>>(bench);
+}
+
+y_bench_func("FlatHashMap find (50% hit)") {
+    bench_find<FlatHashMap<u64, u64>>(bench);
+}
+
+y_bench_func("std::unordered_map find (50% hit)") {
+    bench_find<std::unordered_map<u64, u64>>(bench);
+}
+
+y_bench_func("FlatHashMap iterate") {
+    bench_iterate<FlatHashMap<u64, u64>>(bench);
+}
+
+}
@@ -0,0 +1,131 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#include <y/test/bench.h>
+
+#include <y/concurrent/Signal.h>
+
+#include <thread>
+
+namespace {
+using namespace y;
+using namespace y::concurrent;
+
+static constexpr usize receiver_count = 8;
+static constexpr usize sends_per_iteration = 1024;
+
+static core::Vector<Subscription> subscribe_all(Signal<u64>& signal, u64& sum) {
+    core::Vector<Subscription> subs;
+    for(usize i = 0; i != receiver_count; ++i) {
+        subs.emplace_back(signal.subscribe([&sum](u64 x) { sum += x; }));
+    }
+    return subs;
+}
+
+y_bench_func("Signal send") {
+    Signal<u64> signal;
+    u64 sum = 0;
+    const auto subs = subscribe_all(signal, sum);
+
+    bench.set_items_per_iteration(sends_per_iteration);
+    bench.run([&] {
+        for(usize i = 0; i != sends_per_iteration; ++i) {
+            signal.send(i);
+        }
+        test::do_not_optimize(sum);
+    });
+}
+
+y_bench_func("Signal send with subscription churn") {
+    Signal<u64> signal;
+    u64 sum = 0;
+    const auto subs = subscribe_all(signal, sum);
+
+    std::atomic<bool> done = false;
+    std::thread churn([&] {
+        while(!done) {
+            Subscription sub = signal.subscribe([](u64 x) { test::do_not_optimize(x); });
+        }
+    });
+    y_defer({
+        done = true;
+        churn.join();
+    });
+
+    bench.set_items_per_iteration(sends_per_iteration);
+    bench.run([&] {
+        for(usize i = 0; i != sends_per_iteration; ++i) {
+            signal.send(i);
+        }
+        test::do_not_optimize(sum);
+    });
+}
+
+y_bench_func("Signal concurrent send") {
+    Signal<u64> signal;
+    std::atomic<u64> sum = 0;
+    Subscription sub = signal.subscribe([&](u64 x) { sum.fetch_add(x, std::memory_order_relaxed); });
+
+    static constexpr usize thread_count = 4;
+
+    bench.set_items_per_iteration(sends_per_iteration * thread_count);
+    bench.run([&] {
+        std::array<std::thread, thread_count> threads;
+        for(std::thread& thread : threads) {
+            thread = std::thread([&] {
+                for(usize i = 0; i != sends_per_iteration; ++i) {
+                    signal.send(i);
+                }
+            });
+        }
+        for(std::thread& thread : threads) {
+            thread.join();
+        }
+    });
+}
+
+y_bench_func("Signal post and send_deferred") {
+    Signal<u64> signal;
+    u64 sum = 0;
+    const auto subs = subscribe_all(signal, sum);
+
+    bench.set_items_per_iteration(sends_per_iteration);
+    bench.run([&] {
+        for(usize i = 0; i != sends_per_iteration; ++i) {
+            signal.post(i);
+        }
+        signal.send_deferred();
+        test::do_not_optimize(sum);
+    });
+}
+
+y_bench_func("Signal subscribe and disconnect") {
+    Signal<u64> signal;
+    u64 sum = 0;
+    const auto subs = subscribe_all(signal, sum);
+
+    bench.run([&] {
+        Subscription sub = signal.subscribe([](u64) {});
+        test::do_not_optimize(sub);
+    });
+}
+
+}
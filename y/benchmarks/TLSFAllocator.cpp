@@ -0,0 +1,215 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include <y/test/bench.h>
+
+#include <y/core/TLSFAllocator.h>
+#include <y/math/random.h>
+#include <y/utils/log.h>
+#include <y/utils/format.h>
+
+#include <algorithm>
+
+namespace {
+using namespace y;
+using namespace y::core;
+
+static constexpr u64 heap_size = 1024 * 1024 * 1024;
+static constexpr u64 granularity = 256;
+static constexpr usize live_allocations = 4096;
+static constexpr usize trace_length = 16 * 1024;
+
+// Sorted free list with first fit, as previously used by DeviceMemoryHeap and MeshAllocator
+class FreeListAllocator {
+    struct FreeBlock {
+        u64 offset;
+        u64 size;
+    };
+
+    public:
+        FreeListAllocator(u64 size) {
+            _free_blocks << FreeBlock{0, size};
+        }
+
+        Result<u64> alloc(u64 size) {
+            sort_and_compact_blocks();
+            size = (size + granularity - 1) & ~(granularity - 1);
+            for(usize i = 0; i != _free_blocks.size(); ++i) {
+                FreeBlock& block = _free_blocks[i];
+                if(block.size < size) {
+                    continue;
+                }
+                const u64 offset = block.offset;
+                block.offset += size;
+                block.size -= size;
+                if(!block.size) {
+                    _free_blocks.erase_unordered(_free_blocks.begin() + i);
+                    _should_compact = true;
+                }
+                return Ok(offset);
+            }
+            return Err();
+        }
+
+        void free(u64 offset, u64 size) {
+            _free_blocks << FreeBlock{offset, (size + granularity - 1) & ~(granularity - 1)};
+            _should_compact = true;
+        }
+
+        TLSFAllocator::Stats stats() {
+            sort_and_compact_blocks();
+            TLSFAllocator::Stats stats;
+            for(const FreeBlock& block : _free_blocks) {
+                stats.free_size += block.size;
+                stats.largest_free_block = std::max(stats.largest_free_block, block.size);
+            }
+            stats.free_blocks = _free_blocks.size();
+            return stats;
+        }
+
+    private:
+        void sort_and_compact_blocks() {
+            if(!_should_compact || _free_blocks.size() < 2) {
+                return;
+            }
+            _should_compact = false;
+
+            std::sort(_free_blocks.begin(), _free_blocks.end(), [](const auto& a, const auto& b) { return a.offset < b.offset; });
+
+            usize dst = 0;
+            for(usize i = 1; i != _free_blocks.size(); ++i) {
+                if(_free_blocks[i].offset == _free_blocks[dst].offset + _free_blocks[dst].size) {
+                    _free_blocks[dst].size += _free_blocks[i].size;
+                } else {
+                    _free_blocks[++dst] = _free_blocks[i];
+                }
+            }
+            _free_blocks.shrink_to(dst + 1);
+        }
+
+        Vector<FreeBlock> _free_blocks;
+        bool _should_compact = false;
+};
+
+// Mostly small buffers with a few large images, freed in random order
+struct Trace {
+    Vector<u64> initial_sizes;
+    Vector<std::pair<usize, u64>> steps; // index of the live allocation to free, size of the allocation replacing it
+};
+
+static u64 random_size(math::FastRandom& rng) {
+    return rng() % 16 ? 1024 + rng() % (64 * 1024) : 256 * 1024 + rng() % (2 * 1024 * 1024);
+}
+
+static const Trace& streaming_trace() {
+    static const Trace trace = [] {
+        math::FastRandom rng(11);
+        Trace t;
+        for(usize i = 0; i != live_allocations; ++i) {
+            t.initial_sizes << random_size(rng);
+        }
+        for(usize i = 0; i != trace_length; ++i) {
+            t.steps.emplace_back(usize(rng() % live_allocations), random_size(rng));
+        }
+        return t;
+    }();
+    return trace;
+}
+
+template<typename Alloc, typename Free>
+static void replay(const Trace& trace, Alloc&& alloc, Free&& free) {
+    Vector<std::pair<u64, u64>> live;
+    for(const u64 size : trace.initial_sizes) {
+        live.emplace_back(alloc(size).unwrap(), size);
+    }
+    for(const auto& [index, size] : trace.steps) {
+        free(live[index].first, live[index].second);
+        live[index] = {alloc(size).unwrap(), size};
+    }
+    for(const auto& [offset, size] : live) {
+        free(offset, size);
+    }
+}
+
+static void log_fragmentation(const char* name, const TLSFAllocator::Stats& stats) {
+    log_msg(fmt("{}: {} free blocks, largest = {}KB, fragmentation = {:.3f}", name, stats.free_blocks, stats.largest_free_block / 1024, stats.fragmentation()), Log::Perf);
+}
+
+y_bench_func("TLSFAllocator streaming trace") {
+    const Trace& trace = streaming_trace();
+
+    {
+        TLSFAllocator allocator(heap_size, granularity);
+        Vector<std::pair<u64, u64>> live;
+        for(const u64 size : trace.initial_sizes) {
+            live.emplace_back(allocator.alloc(size).unwrap(), size);
+        }
+        for(const auto& [index, size] : trace.steps) {
+            allocator.free(live[index].first);
+            live[index] = {allocator.alloc(size).unwrap(), size};
+        }
+        log_fragmentation("TLSF", allocator.stats());
+        for(const auto& [offset, size] : live) {
+            allocator.free(offset);
+        }
+        y_always_assert(allocator.stats().free_blocks == 1, "TLSF allocator leaked");
+    }
+
+    bench.set_items_per_iteration(trace.initial_sizes.size() + trace.steps.size() * 2);
+    bench.run([&] {
+        TLSFAllocator allocator(heap_size, granularity);
+        replay(trace,
+            [&](u64 size) { return allocator.alloc(size); },
+            [&](u64 offset, u64) { allocator.free(offset); }
+        );
+        test::do_not_optimize(allocator);
+    });
+}
+
+y_bench_func("Free list streaming trace") {
+    const Trace& trace = streaming_trace();
+
+    {
+        FreeListAllocator allocator(heap_size);
+        Vector<std::pair<u64, u64>> live;
+        for(const u64 size : trace.initial_sizes) {
+            live.emplace_back(allocator.alloc(size).unwrap(), size);
+        }
+        for(const auto& [index, size] : trace.steps) {
+            allocator.free(live[index].first, live[index].second);
+            live[index] = {allocator.alloc(size).unwrap(), size};
+        }
+        log_fragmentation("Free list", allocator.stats());
+    }
+
+    bench.set_items_per_iteration(trace.initial_sizes.size() + trace.steps.size() * 2);
+    bench.run([&] {
+        FreeListAllocator allocator(heap_size);
+        replay(trace,
+            [&](u64 size) { return allocator.alloc(size); },
+            [&](u64 offset, u64 size) { allocator.free(offset, size); }
+        );
+        test::do_not_optimize(allocator);
+    });
+}
+
+}
@@ -0,0 +1,86 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include <y/test/bench.h>
+
+#include <y/core/Vector.h>
+#include <y/core/String.h>
+
+#include <vector>
+
+namespace {
+using namespace y;
+using namespace y::core;
+
+static constexpr usize element_count = 64 * 1024;
+
+y_bench_func("Vector push_back u32") {
+    bench.set_items_per_iteration(element_count);
+    bench.run([] {
+        Vector<u32> vec;
+        for(usize i = 0; i != element_count; ++i) {
+            vec.push_back(u32(i));
+        }
+        test::do_not_optimize(vec);
+    });
+}
+
+y_bench_func("std::vector push_back u32") {
+    bench.set_items_per_iteration(element_count);
+    bench.run([] {
+        std::vector<u32> vec;
+        for(usize i = 0; i != element_count; ++i) {
+            vec.push_back(u32(i));
+        }
+        test::do_not_optimize(vec);
+    });
+}
+
+y_bench_func("Vector push_back String") {
+    bench.set_items_per_iteration(element_count / 16);
+    bench.run([] {
+        Vector<String> vec;
+        for(usize i = 0; i != element_count / 16; ++i) {
+            vec.emplace_back("some string long enough not to be short");
+        }
+        test::do_not_optimize(vec);
+    });
+}
+
+y_bench_func("Vector iterate u32") {
+    Vector<u32> vec;
+    for(usize i = 0; i != element_count; ++i) {
+        vec.push_back(u32(i));
+    }
+
+    bench.set_items_per_iteration(element_count);
+    bench.set_bytes_per_iteration(element_count * sizeof(u32));
+    bench.run([&] {
+        u32 sum = 0;
+        for(const u32 i : vec) {
+            sum += i;
+        }
+        test::do_not_optimize(sum);
+    });
+}
+
+}
@@ -0,0 +1,155 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#include <y/test/bench.h>
+
+#include <y/math/Transform.h>
+#include <y/math/random.h>
+
+#include <tuple>
+
+namespace {
+using namespace y;
+using namespace y::math;
+
+// Roughly a skeleton worth of bones
+static constexpr usize count = 256;
+
+static core::Vector<Transform<>> random_transforms() {
+    FastRandom rng;
+    auto rand_float = [&] { return float(rng() % 2001) / 1000.0f - 1.0f; };
+
+    core::Vector<Transform<>> transforms;
+    for(usize i = 0; i != count; ++i) {
+        const Vec3 pos(rand_float(), rand_float(), rand_float());
+        const Quaternion<> rot = Quaternion<>::from_euler(rand_float(), rand_float(), rand_float());
+        transforms.emplace_back(pos * 10.0f, rot, Vec3(1.0f + rand_float() * 0.5f));
+    }
+    return transforms;
+}
+
+static core::Vector<Quaternion<>> random_quaternions() {
+    core::Vector<Quaternion<>> quats;
+    for(const Transform<>& tr : random_transforms()) {
+        quats.emplace_back(std::get<1>(tr.decompose()));
+    }
+    return quats;
+}
+
+template<typename F>
+static void bench_matrices(test::Bench& bench, F&& func) {
+    const auto a = random_transforms();
+    const auto b = random_transforms();
+    core::Vector<Matrix4<>> out(count, Matrix4<>());
+
+    bench.set_items_per_iteration(count);
+    bench.run([&] {
+        for(usize i = 0; i != count; ++i) {
+            out[i] = func(a[i], b[i]);
+        }
+        test::do_not_optimize(out);
+    });
+}
+
+y_bench_func("Matrix4 multiply") {
+    bench_matrices(bench, [](const Matrix4<>& a, const Matrix4<>& b) { return a * b; });
+}
+
+y_bench_func("Matrix4 multiply (generic)") {
+    bench_matrices(bench, [](const Matrix4<>& a, const Matrix4<>& b) { return math::detail::multiply(a, b); });
+}
+
+y_bench_func("Matrix4 inverse") {
+    bench_matrices(bench, [](const Matrix4<>& a, const Matrix4<>&) { return a.inverse(); });
+}
+
+y_bench_func("Matrix4 inverse (generic)") {
+    bench_matrices(bench, [](const Matrix4<>& a, const Matrix4<>&) { return math::detail::inverse(a); });
+}
+
+y_bench_func("Transform affine_inverse") {
+    bench_matrices(bench, [](const Transform<>& a, const Transform<>&) { return a.affine_inverse(); });
+}
+
+template<typename F>
+static void bench_points(test::Bench& bench, F&& func) {
+    const auto transforms = random_transforms();
+    core::Vector<Vec3> out(count, Vec3());
+
+    bench.set_items_per_iteration(count);
+    bench.run([&] {
+        for(usize i = 0; i != count; ++i) {
+            out[i] = func(transforms[i], transforms[count - i - 1].position());
+        }
+        test::do_not_optimize(out);
+    });
+}
+
+y_bench_func("Transform transform_point") {
+    bench_points(bench, [](const Transform<>& tr, const Vec3& p) { return tr.transform_point(p); });
+}
+
+y_bench_func("Transform transform_point (generic)") {
+    bench_points(bench, [](const Transform<>& tr, const Vec3& p) {
+        return tr.position() + tr.column(0).to<3>() * p.x() + tr.column(1).to<3>() * p.y() + tr.column(2).to<3>() * p.z();
+    });
+}
+
+template<typename F>
+static void bench_quaternions(test::Bench& bench, F&& func) {
+    const auto quats = random_quaternions();
+    core::Vector<Vec4> out(count, Vec4());
+
+    bench.set_items_per_iteration(count);
+    bench.run([&] {
+        for(usize i = 0; i != count; ++i) {
+            out[i] = func(quats[i], quats[count - i - 1]);
+        }
+        test::do_not_optimize(out);
+    });
+}
+
+y_bench_func("Quaternion multiply") {
+    bench_quaternions(bench, [](const Quaternion<>& a, const Quaternion<>& b) { return (a * b).as_vec(); });
+}
+
+y_bench_func("Quaternion multiply (generic)") {
+    bench_quaternions(bench, [](const Quaternion<>& a, const Quaternion<>& b) {
+        return Vec4(a.w() * b.x() + a.x() * b.w() + a.y() * b.z() - a.z() * b.y(),
+                    a.w() * b.y() + a.y() * b.w() + a.z() * b.x() - a.x() * b.z(),
+                    a.w() * b.z() + a.z() * b.w() + a.x() * b.y() - a.y() * b.x(),
+                    a.w() * b.w() - a.x() * b.x() - a.y() * b.y() - a.z() * b.z());
+    });
+}
+
+y_bench_func("Quaternion rotate") {
+    bench_quaternions(bench, [](const Quaternion<>& a, const Quaternion<>& b) { return Vec4(a(b.as_vec().to<3>()), 0.0f); });
+}
+
+y_bench_func("Quaternion rotate (generic)") {
+    bench_quaternions(bench, [](const Quaternion<>& a, const Quaternion<>& b) {
+        const Vec3 v = b.as_vec().to<3>();
+        const Vec3 u = a.as_vec().to<3>();
+        return Vec4(u * 2.0f * u.dot(v) + v * (a.w() * a.w() - u.length2()) + u.cross(v) * 2.0f * a.w(), 0.0f);
+    });
+}
+
+}
@@ -0,0 +1,90 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include <y/test/bench.h>
+
+#include <y/serde3/archives.h>
+#include <y/io2/Buffer.h>
+
+#include <y/core/Vector.h>
+#include <y/core/String.h>
+#include <y/math/Vec.h>
+
+namespace {
+using namespace y;
+using namespace y::core;
+
+struct Element {
+    math::Vec3 position;
+    math::Vec4 color;
+    u32 flags = 0;
+    String name;
+
+    y_reflect(Element, position, color, flags, name)
+};
+
+struct Document {
+    Vector<Element> elements;
+    Vector<u32> indices;
+
+    y_reflect(Document, elements, indices)
+};
+
+static Document create_document() {
+    Document doc;
+    for(u32 i = 0; i != 4096; ++i) {
+        doc.elements.emplace_back(Element{math::Vec3(float(i)), math::Vec4(1.0f), i, "element"});
+        doc.indices << i;
+    }
+    return doc;
+}
+
+y_bench_func("serde3 serialize") {
+    const Document doc = create_document();
+
+    io2::Buffer buffer;
+    bench.run([&] {
+        buffer.clear();
+        serde3::WritableArchive arc(buffer);
+        y_always_assert(arc.serialize(doc), "Serialization failed");
+    });
+    bench.set_bytes_per_iteration(buffer.size());
+}
+
+y_bench_func("serde3 deserialize") {
+    io2::Buffer buffer;
+    {
+        serde3::WritableArchive arc(buffer);
+        y_always_assert(arc.serialize(create_document()), "Serialization failed");
+    }
+
+    bench.set_bytes_per_iteration(buffer.size());
+    bench.run([&] {
+        buffer.reset();
+        Document doc;
+        serde3::ReadableArchive arc(buffer);
+        y_always_assert(arc.deserialize(doc), "Deserialization failed");
+        test::do_not_optimize(doc);
+    });
+}
+
+}
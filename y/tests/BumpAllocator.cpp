@@ -0,0 +1,124 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include <y/concurrent/BumpAllocator.h>
+#include <y/core/Vector.h>
+
+#include <y/test/test.h>
+
+#include <algorithm>
+#include <thread>
+
+namespace {
+using namespace y;
+using namespace y::concurrent;
+
+y_test_func("BumpAllocator basic") {
+    BumpAllocator allocator(1024);
+
+    y_test_assert(allocator.alloc(100).unwrap() == 0);
+    y_test_assert(allocator.alloc(200).unwrap() == 100);
+    y_test_assert(allocator.used() == 300);
+
+    y_test_assert(allocator.alloc(724).unwrap() == 300);
+    y_test_assert(allocator.used() == allocator.capacity());
+    y_test_assert(allocator.alloc(1).is_error());
+}
+
+y_test_func("BumpAllocator alignment") {
+    BumpAllocator allocator(1024);
+
+    y_test_assert(allocator.alloc(3).unwrap() == 0);
+    y_test_assert(allocator.alloc(16, 16).unwrap() == 16);
+    y_test_assert(allocator.alloc(1, 256).unwrap() == 256);
+    y_test_assert(allocator.used() == 257);
+}
+
+y_test_func("BumpAllocator failed allocations") {
+    BumpAllocator allocator(256);
+
+    y_test_assert(allocator.alloc(200).unwrap() == 0);
+    y_test_assert(allocator.alloc(100).is_error());
+    y_test_assert(allocator.alloc(8, 512).is_error());
+    y_test_assert(allocator.alloc(u64(-1)).is_error());
+    y_test_assert(allocator.used() == 200);
+
+    y_test_assert(allocator.alloc(56).unwrap() == 200);
+}
+
+y_test_func("BumpAllocator reset") {
+    BumpAllocator allocator(128);
+
+    y_test_assert(allocator.alloc(128).unwrap() == 0);
+    y_test_assert(allocator.alloc(1).is_error());
+
+    allocator.reset();
+    y_test_assert(allocator.used() == 0);
+    y_test_assert(allocator.alloc(64).unwrap() == 0);
+
+    allocator.reset(512);
+    y_test_assert(allocator.capacity() == 512);
+    y_test_assert(allocator.alloc(512).unwrap() == 0);
+}
+
+y_test_func("BumpAllocator concurrent") {
+    const usize thread_count = 8;
+    const u64 alloc_size = 24;
+    const u64 alignment = 8;
+    const u64 capacity = 4096 * alloc_size;
+
+    BumpAllocator allocator(capacity);
+
+    core::Vector<core::Vector<u64>> offsets(thread_count, core::Vector<u64>());
+    {
+        core::Vector<std::thread> threads;
+        for(usize i = 0; i != thread_count; ++i) {
+            threads.emplace_back([&, i] {
+                while(const auto offset = allocator.alloc(alloc_size, alignment)) {
+                    offsets[i] << offset.unwrap();
+                }
+            });
+        }
+
+        for(auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    core::Vector<u64> all;
+    for(const auto& thread_offsets : offsets) {
+        for(const u64 offset : thread_offsets) {
+            y_test_assert(offset % alignment == 0);
+            all << offset;
+        }
+    }
+
+    y_test_assert(all.size() == capacity / alloc_size);
+    y_test_assert(allocator.used() == capacity);
+
+    std::sort(all.begin(), all.end());
+    for(usize i = 0; i != all.size(); ++i) {
+        y_test_assert(all[i] == i * alloc_size);
+    }
+}
+
+}
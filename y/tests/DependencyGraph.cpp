@@ -0,0 +1,427 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include <y/core/DependencyGraph.h>
+
+#include <y/test/test.h>
+
+#include <algorithm>
+
+namespace {
+using namespace y;
+using namespace y::core;
+
+static bool is_before(const Vector<u32>& order, u32 a, u32 b) {
+    const auto it_a = std::find(order.begin(), order.end(), a);
+    const auto it_b = std::find(order.begin(), order.end(), b);
+    return it_a != order.end() && it_b != order.end() && it_a < it_b;
+}
+
+static bool is_valid_order(const DependencyGraph::Compiled& compiled) {
+    for(const u32 node : compiled.order) {
+        for(const u32 dep : compiled.dependencies[node]) {
+            if(!is_before(compiled.order, dep, node)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// A batch is synchronized with other if it, or an earlier batch of the same queue, waits on other or a later batch of other's queue
+static bool is_synchronized(const DependencyGraph::Compiled& compiled, u32 batch, u32 other) {
+    for(u32 i = 0; i <= batch; ++i) {
+        const auto& b = compiled.batches[i];
+        if(b.queue == compiled.batches[batch].queue && b.wait != DependencyGraph::invalid_batch && b.wait >= other) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool is_valid_batching(const DependencyGraph::Compiled& compiled) {
+    using Queue = DependencyGraph::Queue;
+
+    if(compiled.batches.is_empty() || compiled.batches[0].queue != Queue::Main || compiled.batches.last().queue != Queue::Main) {
+        return false;
+    }
+
+    usize node_count = 0;
+    for(u32 i = 0; i != compiled.batches.size(); ++i) {
+        const auto& batch = compiled.batches[i];
+        if(batch.wait != DependencyGraph::invalid_batch && (batch.wait >= i || compiled.batches[batch.wait].queue == batch.queue)) {
+            return false;
+        }
+        for(const u32 node : batch.nodes) {
+            if(compiled.node_batches[node] != i) {
+                return false;
+            }
+        }
+        node_count += batch.nodes.size();
+    }
+
+    if(node_count != compiled.order.size()) {
+        return false;
+    }
+
+    for(const u32 node : compiled.order) {
+        const u32 batch = compiled.node_batches[node];
+        for(const u32 dep : compiled.dependencies[node]) {
+            const u32 dep_batch = compiled.node_batches[dep];
+            if(compiled.batches[dep_batch].queue == compiled.batches[batch].queue) {
+                if(dep_batch > batch) {
+                    return false;
+                }
+            } else if(!is_synchronized(compiled, batch, dep_batch)) {
+                return false;
+            }
+        }
+    }
+
+    for(const auto& transfer : compiled.transfers) {
+        if(compiled.batches[transfer.release_batch].queue == compiled.batches[transfer.acquire_batch].queue) {
+            return false;
+        }
+        if(!is_synchronized(compiled, transfer.acquire_batch, transfer.release_batch)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+y_test_func("DependencyGraph chain") {
+    DependencyGraph graph;
+    const u32 a = graph.add_node();
+    const u32 b = graph.add_node();
+    const u32 c = graph.add_node();
+
+    graph.add_write(a, 0);
+    graph.add_read(b, 0);
+    graph.add_write(b, 1);
+    graph.add_read(c, 1);
+    graph.set_side_effects(c);
+
+    const auto compiled = graph.compile();
+    y_test_assert(compiled.culled_count() == 0);
+    y_test_assert(compiled.order.size() == 3);
+    y_test_assert(compiled.order[0] == a && compiled.order[1] == b && compiled.order[2] == c);
+    y_test_assert(compiled.dependencies[b].size() == 1 && compiled.dependencies[b][0] == a);
+    y_test_assert(compiled.dependencies[c].size() == 1 && compiled.dependencies[c][0] == b);
+}
+
+y_test_func("DependencyGraph culling") {
+    DependencyGraph graph;
+    const u32 gbuffer = graph.add_node();
+    const u32 debug = graph.add_node();
+    const u32 lighting = graph.add_node();
+    const u32 id = graph.add_node();
+    const u32 present = graph.add_node();
+
+    graph.add_write(gbuffer, 0);
+    graph.add_read(debug, 0);
+    graph.add_write(debug, 1);
+    graph.add_read(lighting, 0);
+    graph.add_write(lighting, 2);
+    graph.add_write(id, 3);
+    graph.add_read(present, 2);
+    graph.set_side_effects(present);
+
+    const auto compiled = graph.compile();
+    y_test_assert(compiled.culled_count() == 2);
+    y_test_assert(compiled.is_culled(debug));
+    y_test_assert(compiled.is_culled(id));
+    y_test_assert(!compiled.is_culled(gbuffer));
+    y_test_assert(!compiled.is_culled(lighting));
+    y_test_assert(!compiled.is_culled(present));
+    y_test_assert(compiled.order.size() == 3);
+    y_test_assert(is_valid_order(compiled));
+}
+
+y_test_func("DependencyGraph outputs") {
+    DependencyGraph graph;
+    const u32 history = graph.add_node();
+    const u32 unused = graph.add_node();
+
+    graph.add_write(history, 0);
+    graph.add_write(unused, 1);
+    graph.set_output(0);
+
+    const auto compiled = graph.compile();
+    y_test_assert(!compiled.is_culled(history));
+    y_test_assert(compiled.is_culled(unused));
+}
+
+y_test_func("DependencyGraph partial writes") {
+    DependencyGraph graph;
+    const u32 clear = graph.add_node();
+    const u32 first = graph.add_node();
+    const u32 second = graph.add_node();
+    const u32 present = graph.add_node();
+
+    // Both lights blend into the same target, the first one can not be dropped
+    graph.add_write(clear, 0);
+    graph.add_write(first, 0);
+    graph.add_write(second, 0);
+    graph.add_read(present, 0);
+    graph.set_side_effects(present);
+
+    const auto compiled = graph.compile();
+    y_test_assert(compiled.culled_count() == 0);
+    y_test_assert(compiled.order[0] == clear && compiled.order[1] == first && compiled.order[2] == second);
+}
+
+y_test_func("DependencyGraph write after read") {
+    DependencyGraph graph;
+    const u32 write = graph.add_node();
+    const u32 read = graph.add_node();
+    const u32 overwrite = graph.add_node();
+
+    graph.add_write(write, 0);
+    graph.add_read(read, 0);
+    graph.add_write(read, 1);
+    graph.add_write(overwrite, 0);
+    graph.set_output(0);
+    graph.set_output(1);
+
+    const auto compiled = graph.compile();
+    y_test_assert(compiled.culled_count() == 0);
+    y_test_assert(is_before(compiled.order, read, overwrite));
+
+    // overwrite -> write is implied by overwrite -> read -> write
+    y_test_assert(compiled.dependencies[overwrite].size() == 1);
+    y_test_assert(compiled.dependencies[overwrite][0] == read);
+}
+
+y_test_func("DependencyGraph transitive reduction") {
+    DependencyGraph graph;
+    const u32 a = graph.add_node();
+    const u32 b = graph.add_node();
+    const u32 c = graph.add_node();
+
+    graph.add_write(a, 0);
+    graph.add_read(b, 0);
+    graph.add_write(b, 1);
+    graph.add_read(c, 0);
+    graph.add_read(c, 1);
+    graph.set_side_effects(c);
+
+    const auto compiled = graph.compile();
+    y_test_assert(compiled.dependencies[c].size() == 1);
+    y_test_assert(compiled.dependencies[c][0] == b);
+}
+
+y_test_func("DependencyGraph interleaves independent nodes") {
+    DependencyGraph graph;
+    const u32 depth = graph.add_node();
+    const u32 lighting = graph.add_node();
+    const u32 shadows = graph.add_node();
+    const u32 present = graph.add_node();
+
+    graph.add_write(depth, 0);
+    graph.add_read(lighting, 0);
+    graph.add_write(lighting, 1);
+    graph.add_write(shadows, 2);
+    graph.add_read(present, 1);
+    graph.add_read(present, 2);
+    graph.set_side_effects(present);
+
+    const auto compiled = graph.compile();
+    y_test_assert(compiled.order.size() == 4);
+    y_test_assert(compiled.order[0] == depth);
+    y_test_assert(compiled.order[1] == shadows);
+    y_test_assert(compiled.order[2] == lighting);
+    y_test_assert(compiled.order[3] == present);
+    y_test_assert(is_valid_order(compiled));
+}
+
+y_test_func("DependencyGraph sequence points") {
+    DependencyGraph graph;
+    const u32 depth = graph.add_node();
+    const u32 lighting = graph.add_node();
+    const u32 shadows = graph.add_node();
+
+    graph.add_write(depth, 0);
+    graph.add_read(lighting, 0);
+    graph.add_write(lighting, 1);
+    graph.add_write(shadows, 2);
+    graph.set_output(1);
+    graph.set_output(2);
+    graph.add_sequence_point(shadows);
+
+    const auto compiled = graph.compile();
+    y_test_assert(compiled.order.size() == 3);
+    y_test_assert(compiled.order[0] == depth);
+    y_test_assert(compiled.order[1] == lighting);
+    y_test_assert(compiled.order[2] == shadows);
+}
+
+y_test_func("DependencyGraph side effects keep their order") {
+    DependencyGraph graph;
+    const u32 a = graph.add_node();
+    const u32 b = graph.add_node();
+    const u32 c = graph.add_node();
+
+    graph.set_side_effects(a);
+    graph.add_write(b, 0);
+    graph.set_side_effects(c);
+
+    const auto compiled = graph.compile();
+    y_test_assert(compiled.is_culled(b));
+    y_test_assert(compiled.order.size() == 2);
+    y_test_assert(compiled.order[0] == a && compiled.order[1] == c);
+}
+
+y_test_func("DependencyGraph empty") {
+    DependencyGraph graph;
+    const auto compiled = graph.compile();
+    y_test_assert(compiled.order.is_empty());
+    y_test_assert(compiled.culled_count() == 0);
+    y_test_assert(compiled.batches.size() == 1);
+}
+
+y_test_func("DependencyGraph single queue without async nodes") {
+    DependencyGraph graph;
+    const u32 depth = graph.add_node();
+    const u32 ao = graph.add_node();
+    const u32 lighting = graph.add_node();
+
+    graph.add_write(depth, 0);
+    graph.add_read(ao, 0);
+    graph.add_write(ao, 1);
+    graph.add_read(lighting, 1);
+    graph.set_side_effects(lighting);
+
+    const auto compiled = graph.compile();
+    y_test_assert(compiled.batches.size() == 1);
+    y_test_assert(compiled.batches[0].nodes.size() == 3);
+    y_test_assert(compiled.transfers.is_empty());
+    y_test_assert(compiled.queue(ao) == DependencyGraph::Queue::Main);
+    y_test_assert(is_valid_batching(compiled));
+}
+
+y_test_func("DependencyGraph async overlap") {
+    using Queue = DependencyGraph::Queue;
+
+    DependencyGraph graph;
+    const u32 depth = graph.add_node();
+    const u32 ao = graph.add_node();
+    const u32 shadows = graph.add_node();
+    const u32 lighting = graph.add_node();
+
+    graph.add_write(depth, 0);
+    graph.add_read(ao, 0);
+    graph.add_write(ao, 1);
+    graph.add_write(shadows, 2);
+    graph.add_read(lighting, 1);
+    graph.add_read(lighting, 2);
+    graph.set_side_effects(lighting);
+    graph.set_async(ao);
+
+    const auto compiled = graph.compile();
+    y_test_assert(is_valid_batching(compiled));
+    y_test_assert(compiled.queue(depth) == Queue::Main);
+    y_test_assert(compiled.queue(ao) == Queue::Async);
+    y_test_assert(compiled.queue(shadows) == Queue::Main);
+    y_test_assert(compiled.queue(lighting) == Queue::Main);
+
+    // Shadows don't wait on the async work
+    const u32 ao_batch = compiled.node_batches[ao];
+    y_test_assert(compiled.node_batches[shadows] < ao_batch);
+    y_test_assert(compiled.node_batches[lighting] > ao_batch);
+    y_test_assert(compiled.batches[ao_batch].wait == compiled.node_batches[depth]);
+
+    // Depth and AO go to the async queue and come back
+    const auto transfers_of = [&](u32 resource) {
+        return std::count_if(compiled.transfers.begin(), compiled.transfers.end(), [&](const auto& t) { return t.resource == resource; });
+    };
+    y_test_assert(transfers_of(0) == 2);
+    y_test_assert(transfers_of(1) == 2);
+    y_test_assert(transfers_of(2) == 0);
+}
+
+y_test_func("DependencyGraph async chain stays on the async queue") {
+    using Queue = DependencyGraph::Queue;
+
+    DependencyGraph graph;
+    const u32 depth = graph.add_node();
+    const u32 cull = graph.add_node();
+    const u32 compact = graph.add_node();
+    const u32 lighting = graph.add_node();
+
+    graph.add_write(depth, 0);
+    graph.add_read(cull, 0);
+    graph.add_write(cull, 1);
+    graph.add_read(compact, 1);
+    graph.add_write(compact, 2);
+    graph.add_read(lighting, 2);
+    graph.set_side_effects(lighting);
+    graph.set_async(cull);
+    graph.set_async(compact);
+
+    const auto compiled = graph.compile();
+    y_test_assert(is_valid_batching(compiled));
+    y_test_assert(compiled.queue(cull) == Queue::Async);
+    y_test_assert(compiled.node_batches[cull] == compiled.node_batches[compact]);
+    y_test_assert(compiled.batches.size() == 3);
+    y_test_assert(compiled.transfers.size() == 6);
+}
+
+y_test_func("DependencyGraph async without accesses") {
+    DependencyGraph graph;
+    const u32 async = graph.add_node();
+    const u32 main = graph.add_node();
+
+    graph.set_side_effects(async);
+    graph.set_side_effects(main);
+    graph.set_async(async);
+
+    const auto compiled = graph.compile();
+    y_test_assert(is_valid_batching(compiled));
+    y_test_assert(compiled.queue(async) == DependencyGraph::Queue::Async);
+    y_test_assert(compiled.node_batches[main] > compiled.node_batches[async]);
+}
+
+y_test_func("DependencyGraph async ping pong") {
+    DependencyGraph graph;
+    core::Vector<u32> nodes;
+    for(u32 i = 0; i != 8; ++i) {
+        const u32 node = graph.add_node();
+        graph.add_read(node, i);
+        graph.add_write(node, i + 1);
+        graph.add_read(node, 100);
+        if(i % 2) {
+            graph.set_async(node);
+        }
+        nodes.push_back(node);
+    }
+    graph.set_output(8);
+
+    const auto compiled = graph.compile();
+    y_test_assert(compiled.culled_count() == 0);
+    y_test_assert(is_valid_batching(compiled));
+    for(u32 i = 1; i != nodes.size(); ++i) {
+        y_test_assert(compiled.queue(nodes[i]) != compiled.queue(nodes[i - 1]));
+    }
+}
+
+}
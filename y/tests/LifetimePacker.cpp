@@ -0,0 +1,127 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include <y/core/LifetimePacker.h>
+#include <y/math/random.h>
+
+#include <y/test/test.h>
+
+namespace {
+using namespace y;
+using namespace y::core;
+
+static bool is_valid_packing(const LifetimePacker& packer, u64 total_size) {
+    const auto ranges = packer.ranges();
+    const auto offsets = packer.offsets();
+    for(usize i = 0; i != ranges.size(); ++i) {
+        if(offsets[i] % ranges[i].alignment || offsets[i] + ranges[i].size > total_size) {
+            return false;
+        }
+        for(usize j = i + 1; j != ranges.size(); ++j) {
+            const bool alive_together = ranges[i].first_use <= ranges[j].last_use && ranges[j].first_use <= ranges[i].last_use;
+            const bool memory_overlap = offsets[i] < offsets[j] + ranges[j].size && offsets[j] < offsets[i] + ranges[i].size;
+            if(alive_together && memory_overlap) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+y_test_func("LifetimePacker disjoint lifetimes share memory") {
+    LifetimePacker packer;
+    const usize a = packer.add(1024, 16, 0, 1);
+    const usize b = packer.add(1024, 16, 2, 3);
+    const usize c = packer.add(512, 16, 4, 4);
+
+    const u64 size = packer.pack();
+    y_test_assert(size == 1024);
+    y_test_assert(packer.offsets()[a] == 0);
+    y_test_assert(packer.offsets()[b] == 0);
+    y_test_assert(packer.offsets()[c] == 0);
+    y_test_assert(packer.shares_memory(a) && packer.shares_memory(b) && packer.shares_memory(c));
+    y_test_assert(packer.unaliased_size() == 2560);
+}
+
+y_test_func("LifetimePacker overlapping lifetimes") {
+    LifetimePacker packer;
+    packer.add(1024, 1, 0, 2);
+    packer.add(1024, 1, 2, 4);
+    packer.add(256, 1, 1, 3);
+
+    const u64 size = packer.pack();
+    y_test_assert(size == 2304);
+    y_test_assert(is_valid_packing(packer, size));
+    for(usize i = 0; i != 3; ++i) {
+        y_test_assert(!packer.shares_memory(i));
+    }
+}
+
+y_test_func("LifetimePacker fills gaps") {
+    LifetimePacker packer;
+    packer.add(1024, 1, 0, 1);
+    packer.add(1024, 1, 0, 3);
+    packer.add(512, 1, 2, 3);
+    packer.add(512, 1, 2, 3);
+
+    // Both small ranges fit where the first one was
+    const u64 size = packer.pack();
+    y_test_assert(size == 2048);
+    y_test_assert(is_valid_packing(packer, size));
+}
+
+y_test_func("LifetimePacker alignment") {
+    LifetimePacker packer;
+    const usize a = packer.add(100, 4, 0, 1);
+    const usize b = packer.add(50, 256, 0, 1);
+
+    const u64 size = packer.pack();
+    y_test_assert(packer.offsets()[a] == 0);
+    y_test_assert(packer.offsets()[b] == 256);
+    y_test_assert(size == 306);
+    y_test_assert(is_valid_packing(packer, size));
+}
+
+y_test_func("LifetimePacker empty") {
+    LifetimePacker packer;
+    y_test_assert(packer.pack() == 0);
+    y_test_assert(packer.offsets().is_empty());
+}
+
+y_test_func("LifetimePacker random") {
+    math::FastRandom rng(4);
+    for(usize k = 0; k != 16; ++k) {
+        LifetimePacker packer;
+        const usize count = 1 + rng() % 64;
+        for(usize i = 0; i != count; ++i) {
+            const u32 first = rng() % 32;
+            const u32 last = first + rng() % 8;
+            packer.add(1 + rng() % 4096, u64(1) << (rng() % 9), first, last);
+        }
+
+        const u64 size = packer.pack();
+        y_test_assert(is_valid_packing(packer, size));
+        y_test_assert(size <= packer.unaliased_size() + count * 256);
+    }
+}
+
+}
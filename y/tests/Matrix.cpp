@@ -21,12 +21,33 @@ SOFTWARE.
 **********************************/
 
 #include <y/math/Matrix.h>
+#include <y/math/random.h>
 #include <y/test/test.h>
 
 namespace {
 using namespace y;
 using namespace y::math;
 
+static Matrix4<> random_matrix(FastRandom& rng) {
+    Matrix4<> mat;
+    for(float& f : mat) {
+        f = float(rng() % 2001) / 100.0f - 10.0f;
+    }
+    // Keep it well conditioned
+    for(usize i = 0; i != 4; ++i) {
+        mat[i][i] += 25.0f;
+    }
+    return mat;
+}
+
+static float max_diff(const Matrix4<>& a, const Matrix4<double>& b) {
+    float diff = 0.0f;
+    for(usize i = 0; i != 16; ++i) {
+        diff = std::max(diff, float(std::abs(double(a.begin()[i]) - b.begin()[i])));
+    }
+    return diff;
+}
+
 y_test_func("Matrix vec multiply") {
     const Matrix3<> mat(1, 2, 3,
                   4, 5, 6,
@@ -91,6 +112,48 @@ y_test_func("Matrix asymetrical multiply") {
     y_test_assert((a * b).determinant() == 36);
 }
 
+y_test_func("Matrix4 multiply precision") {
+    FastRandom rng;
+    for(usize i = 0; i != 1000; ++i) {
+        const Matrix4<> a = random_matrix(rng);
+        const Matrix4<> b = random_matrix(rng);
+
+        const Matrix4<double> expected = Matrix4<double>(a) * Matrix4<double>(b);
+        y_test_assert(max_diff(a * b, expected) < 1e-3f);
+        y_test_assert(max_diff(math::detail::multiply(a, b), expected) < 1e-3f);
+
+        const Vec4 v(float(i), 1.0f, -2.0f, 0.5f);
+        const Vec4 r = a * v;
+        const Vec4 g = math::detail::multiply(a, Matrix<4, 1>(v)).column(0);
+        y_test_assert((r - g).length() < 1e-3f);
+    }
+}
+
+y_test_func("Matrix4 inverse precision") {
+    FastRandom rng;
+    for(usize i = 0; i != 1000; ++i) {
+        const Matrix4<> a = random_matrix(rng);
+
+        const Matrix4<double> expected = Matrix4<double>(a).inverse();
+        y_test_assert(max_diff(a.inverse(), expected) < 1e-5f);
+        y_test_assert(max_diff(a * a.inverse(), Matrix4<double>::identity()) < 1e-5f);
+    }
+
+    y_test_assert(Matrix4<>().inverse() == Matrix4<>());
+}
+
+y_test_func("Matrix4 constexpr") {
+    constexpr Matrix4<> a(2, 0, 0, 1,
+                          0, 4, 0, 2,
+                          0, 0, 8, 3,
+                          0, 0, 0, 1);
+
+    static_assert(a * Matrix4<>::identity() == a);
+    static_assert(a * a.inverse() == Matrix4<>::identity());
+
+    y_test_assert(a * a.inverse() == Matrix4<>::identity());
+}
+
 y_test_func("Matrix sub") {
     const Matrix<2, 3> mat(1, 2, 3,
                      4, 5, 6);
@@ -74,6 +74,38 @@ y_test_func("Quaternion rotation") {
     y_test_assert(((mat * Vec4(t1, 0.0f)).to<3>() - quat(t1)).length2() < 0.01f);
 }
 
+y_test_func("Quaternion multiply and rotate precision") {
+    const int step = 23;
+    for(int p = -180; p < 180; p += step) {
+        for(int y = -180; y < 180; y += step) {
+            const auto a = Quaternion<>::from_euler(to_rad(p), to_rad(y), to_rad(p + y));
+            const auto b = Quaternion<>::from_euler(to_rad(y), to_rad(p), 0.5f);
+
+            // Reference, in double
+            const Vec<4, double> qa = a.as_vec();
+            const Vec<4, double> qb = b.as_vec();
+            const Vec<4, double> expected(
+                qa.w() * qb.x() + qa.x() * qb.w() + qa.y() * qb.z() - qa.z() * qb.y(),
+                qa.w() * qb.y() + qa.y() * qb.w() + qa.z() * qb.x() - qa.x() * qb.z(),
+                qa.w() * qb.z() + qa.z() * qb.w() + qa.x() * qb.y() - qa.y() * qb.x(),
+                qa.w() * qb.w() - qa.x() * qb.x() - qa.y() * qb.y() - qa.z() * qb.z()
+            );
+
+            const Quaternion<> ab = a * b;
+            y_test_assert((Vec<4, double>(ab.as_vec()) - expected).length() < 1e-6);
+
+            const Vec3 v(0.5f, -0.75f, 10.0f);
+            const Vec<3, double> u = qa.to<3>();
+            const Vec<3, double> dv = v;
+            const Vec<3, double> expected_rot = u * 2.0 * u.dot(dv) + dv * (qa.w() * qa.w() - u.length2()) + u.cross(dv) * 2.0 * qa.w();
+            y_test_assert((Vec<3, double>(a(v)) - expected_rot).length() < 1e-5);
+
+            // Composition matches successive rotations
+            y_test_assert((ab(v) - a(b(v))).length() < 1e-4f);
+        }
+    }
+}
+
 y_test_func("Quaternion euler") {
     const int step = 7;
     for(int p = -180; p < 180; p += step) {
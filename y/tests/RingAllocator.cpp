@@ -0,0 +1,225 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include <y/core/RingAllocator.h>
+#include <y/core/Vector.h>
+#include <y/math/random.h>
+
+#include <y/test/test.h>
+
+#include <algorithm>
+
+namespace {
+using namespace y;
+using namespace y::core;
+
+struct Range {
+    u64 offset;
+    u64 size;
+    u64 frame;
+};
+
+static bool overlaps(const Vector<Range>& ranges) {
+    Vector<Range> sorted(ranges);
+    std::sort(sorted.begin(), sorted.end(), [](const Range& a, const Range& b) { return a.offset < b.offset; });
+    for(usize i = 1; i < sorted.size(); ++i) {
+        if(sorted[i - 1].offset + sorted[i - 1].size > sorted[i].offset) {
+            return true;
+        }
+    }
+    return false;
+}
+
+y_test_func("RingAllocator basic") {
+    RingAllocator allocator(1024);
+
+    y_test_assert(allocator.alloc(0, 100).unwrap() == 0);
+    y_test_assert(allocator.alloc(0, 100).unwrap() == 100);
+    y_test_assert(allocator.alloc(0, 100, 256).unwrap() == 256);
+    y_test_assert(allocator.used_size() == 356);
+    y_test_assert(allocator.pending_frames() == 1);
+
+    // Open frames are never released
+    allocator.release(u64(-1));
+    y_test_assert(allocator.used_size() == 356);
+
+    allocator.end_frame(0, 1);
+    allocator.release(0);
+    y_test_assert(allocator.used_size() == 356);
+
+    allocator.release(1);
+    y_test_assert(allocator.used_size() == 0);
+    y_test_assert(allocator.pending_frames() == 0);
+    y_test_assert(allocator.alloc(1, 1024).unwrap() == 0);
+}
+
+y_test_func("RingAllocator exhaustion") {
+    RingAllocator allocator(1024);
+
+    y_test_assert(allocator.alloc(0, 1000).is_ok());
+    y_test_assert(allocator.alloc(0, 100).is_error());
+    y_test_assert(allocator.alloc(0, 24).is_ok());
+    y_test_assert(allocator.free_size() == 0);
+    y_test_assert(allocator.alloc(0, 1).is_error());
+
+    allocator.release(u64(-1));
+    y_test_assert(allocator.alloc(1, 1).is_error());
+}
+
+y_test_func("RingAllocator wrap around") {
+    RingAllocator allocator(1024);
+
+    y_test_assert(allocator.alloc(1, 400).unwrap() == 0);
+    allocator.end_frame(1, 1);
+    y_test_assert(allocator.alloc(2, 400).unwrap() == 400);
+    allocator.end_frame(2, 2);
+
+    // Doesn't fit at the end and the first frame is still alive
+    y_test_assert(allocator.alloc(3, 300).is_error());
+
+    allocator.release(1);
+    y_test_assert(allocator.alloc(3, 300).unwrap() == 0);
+    y_test_assert(allocator.used_size() == 400 + 224 + 300);
+
+    // Between the head and the tail
+    y_test_assert(allocator.alloc(3, 100).unwrap() == 300);
+    y_test_assert(allocator.alloc(3, 1).is_error());
+    allocator.end_frame(3, 3);
+
+    allocator.release(2);
+    y_test_assert(allocator.used_size() == 624);
+    y_test_assert(allocator.alloc(4, 400).unwrap() == 400);
+    y_test_assert(allocator.free_size() == 0);
+
+    allocator.end_frame(4, 4);
+    allocator.release(4);
+    y_test_assert(allocator.used_size() == 0);
+    y_test_assert(allocator.alloc(5, 1024).unwrap() == 0);
+}
+
+y_test_func("RingAllocator empty frames") {
+    RingAllocator allocator(1024);
+
+    allocator.end_frame(0, 1);
+    y_test_assert(allocator.pending_frames() == 0);
+
+    y_test_assert(allocator.alloc(1, 10).is_ok());
+    allocator.end_frame(1, 2);
+    allocator.end_frame(2, 3);
+    y_test_assert(allocator.pending_frames() == 1);
+}
+
+y_test_func("RingAllocator overlapping frames") {
+    RingAllocator allocator(1024);
+
+    // Frames are always recorded concurrently: there is never a point where none is open
+    y_test_assert(allocator.alloc(0, 100).is_ok());
+    y_test_assert(allocator.alloc(1, 100).is_ok());
+    y_test_assert(allocator.alloc(0, 100).is_ok());
+    allocator.end_frame(0, 10);
+
+    y_test_assert(allocator.alloc(2, 100).is_ok());
+    y_test_assert(allocator.alloc(1, 100).is_ok());
+    allocator.end_frame(1, 11);
+    y_test_assert(allocator.pending_frames() == 3);
+
+    // Frame 0 owns the oldest allocations
+    allocator.release(9);
+    y_test_assert(allocator.used_size() == 500);
+
+    // Frame 1 is not done yet and holds back the second block of frame 0
+    allocator.release(10);
+    y_test_assert(allocator.used_size() == 400);
+
+    // Frame 2 is still open and holds back the last block of frame 1
+    allocator.release(11);
+    y_test_assert(allocator.used_size() == 200);
+    y_test_assert(allocator.pending_frames() == 2);
+
+    allocator.end_frame(2, 12);
+    allocator.release(12);
+    y_test_assert(allocator.used_size() == 0);
+    y_test_assert(allocator.pending_frames() == 0);
+}
+
+y_test_func("RingAllocator random frames") {
+    const u64 size = 64 * 1024;
+    RingAllocator allocator(size);
+    math::FastRandom rng(5);
+
+    // Several frames are recorded concurrently and are ended out of order, so one is always open
+    Vector<u64> open = {0, 1, 2};
+    Vector<u64> frame_tokens(open.size(), u64(-1));
+
+    Vector<Range> live;
+    u64 token = 0;
+    u64 released = 0;
+    for(usize i = 0; i != 20000; ++i) {
+        const u32 action = rng() % 16;
+        if(action == 0) {
+            const usize index = rng() % open.size();
+            allocator.end_frame(open[index], ++token);
+            frame_tokens[open[index]] = token;
+            open[index] = frame_tokens.size();
+            frame_tokens.emplace_back(u64(-1));
+        } else if(action == 1) {
+            // Frames in flight complete in order
+            released = std::min(token, released + 1 + rng() % 2);
+            allocator.release(released);
+            for(usize k = 0; k < live.size(); ++k) {
+                if(frame_tokens[live[k].frame] <= released) {
+                    live.erase_unordered(live.begin() + k--);
+                }
+            }
+        } else {
+            const u64 frame = open[rng() % open.size()];
+            const u64 alloc_size = 1 + rng() % (rng() % 8 ? 512 : 8 * 1024);
+            const u64 alignment = u64(1) << (rng() % 8);
+            if(const auto r = allocator.alloc(frame, alloc_size, alignment)) {
+                const u64 offset = r.unwrap();
+                y_test_assert(offset % alignment == 0);
+                y_test_assert(offset + alloc_size <= size);
+                live.emplace_back(Range{offset, alloc_size, frame});
+            } else {
+                // Everything fits once all pending frames are released
+                y_test_assert(!live.is_empty());
+            }
+        }
+
+        y_test_assert(!overlaps(live));
+
+        u64 live_size = 0;
+        for(const Range& r : live) {
+            live_size += r.size;
+        }
+        y_test_assert(live_size <= allocator.used_size());
+    }
+
+    for(const u64 frame : open) {
+        allocator.end_frame(frame, ++token);
+    }
+    allocator.release(token);
+    y_test_assert(allocator.used_size() == 0);
+    y_test_assert(allocator.pending_frames() == 0);
+}
+
+}
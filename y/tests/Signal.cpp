@@ -0,0 +1,139 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#include <y/concurrent/Signal.h>
+#include <y/core/String.h>
+#include <y/test/test.h>
+
+#include <thread>
+
+namespace {
+using namespace y;
+using namespace y::concurrent;
+
+y_test_func("Signal send") {
+    Signal<int> signal;
+
+    int sum = 0;
+    Subscription a = signal.subscribe([&](int x) { sum += x; });
+    Subscription b = signal.subscribe([&](int x) { sum += 10 * x; });
+
+    signal.send(1);
+    y_test_assert(sum == 11);
+
+    a.disconnect();
+    y_test_assert(!a.is_connected());
+    y_test_assert(b.is_connected());
+
+    signal.send(2);
+    y_test_assert(sum == 31);
+}
+
+y_test_func("Signal disconnect from receiver") {
+    Signal<> signal;
+
+    usize calls = 0;
+    Subscription sub;
+    sub = signal.subscribe([&] {
+        ++calls;
+        sub.disconnect();
+    });
+
+    usize other_calls = 0;
+    Subscription other = signal.subscribe([&] { ++other_calls; });
+
+    signal.send();
+    signal.send();
+    y_test_assert(calls == 1);
+    y_test_assert(other_calls == 2);
+}
+
+y_test_func("Signal outlives subscriptions") {
+    Subscription sub;
+    {
+        Signal<int> signal;
+        sub = signal.subscribe([](int) {});
+        y_test_assert(sub.is_connected());
+    }
+    y_test_assert(!sub.is_connected());
+    sub.disconnect();
+}
+
+y_test_func("Signal deferred") {
+    Signal<core::String> signal;
+
+    core::Vector<core::String> received;
+    Subscription sub = signal.subscribe([&](core::String str) { received.emplace_back(std::move(str)); });
+
+    signal.post("a");
+    signal.post("b");
+    y_test_assert(received.is_empty());
+
+    {
+        std::thread thread([&] { signal.post("c"); });
+        thread.join();
+    }
+
+    y_test_assert(signal.send_deferred() == 3);
+    y_test_assert(received.size() == 3);
+    y_test_assert(std::find(received.begin(), received.end(), "c") != received.end());
+
+    // Same thread events keep their order
+    const auto a = std::find(received.begin(), received.end(), "a");
+    const auto b = std::find(received.begin(), received.end(), "b");
+    y_test_assert(a < b);
+
+    y_test_assert(signal.send_deferred() == 0);
+}
+
+y_test_func("Signal concurrent send and subscribe") {
+    Signal<u32> signal;
+
+    std::atomic<u64> total = 0;
+    Subscription sub = signal.subscribe([&](u32 x) { total += x; });
+
+    std::atomic<bool> done = false;
+    std::thread churn([&] {
+        while(!done) {
+            Subscription tmp = signal.subscribe([&](u32) {});
+        }
+    });
+
+    core::Vector<std::thread> senders;
+    for(usize i = 0; i != 4; ++i) {
+        senders.emplace_back([&] {
+            for(u32 k = 0; k != 10000; ++k) {
+                signal.send(1);
+            }
+        });
+    }
+
+    for(std::thread& sender : senders) {
+        sender.join();
+    }
+
+    done = true;
+    churn.join();
+
+    y_test_assert(total == 40000);
+}
+
+}
@@ -0,0 +1,153 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include <y/core/TLSFAllocator.h>
+#include <y/math/random.h>
+
+#include <y/test/test.h>
+
+#include <algorithm>
+
+namespace {
+using namespace y;
+using namespace y::core;
+
+struct Range {
+    u64 offset;
+    u64 size;
+};
+
+static bool overlaps(const Vector<Range>& ranges) {
+    Vector<Range> sorted(ranges);
+    std::sort(sorted.begin(), sorted.end(), [](const Range& a, const Range& b) { return a.offset < b.offset; });
+    for(usize i = 1; i < sorted.size(); ++i) {
+        if(sorted[i - 1].offset + sorted[i - 1].size > sorted[i].offset) {
+            return true;
+        }
+    }
+    return false;
+}
+
+y_test_func("TLSFAllocator basic") {
+    TLSFAllocator allocator(1024);
+
+    const u64 a = allocator.alloc(100).unwrap();
+    const u64 b = allocator.alloc(200).unwrap();
+    const u64 c = allocator.alloc(300).unwrap();
+
+    y_test_assert(allocator.allocation_count() == 3);
+    y_test_assert(allocator.free_size() == 1024 - 600);
+    y_test_assert(!overlaps(Vector<Range>({Range{a, 100}, Range{b, 200}, Range{c, 300}})));
+
+    allocator.free(b);
+    y_test_assert(allocator.stats().free_blocks == 2);
+
+    // Freeing neighbours should coalesce everything back
+    allocator.free(a);
+    allocator.free(c);
+
+    const TLSFAllocator::Stats stats = allocator.stats();
+    y_test_assert(stats.allocations == 0);
+    y_test_assert(stats.free_blocks == 1);
+    y_test_assert(stats.largest_free_block == 1024);
+    y_test_assert(stats.fragmentation() == 0.0f);
+}
+
+y_test_func("TLSFAllocator exhaustion") {
+    TLSFAllocator allocator(256);
+
+    y_test_assert(allocator.alloc(257).is_error());
+
+    const u64 a = allocator.alloc(256).unwrap();
+    y_test_assert(a == 0);
+    y_test_assert(allocator.alloc(1).is_error());
+
+    allocator.free(a);
+    y_test_assert(allocator.alloc(256).unwrap() == 0);
+}
+
+y_test_func("TLSFAllocator alignment and granularity") {
+    TLSFAllocator allocator(64 * 1024, 256);
+
+    const u64 a = allocator.alloc(10).unwrap();
+    y_test_assert(allocator.allocated_size(a) == 256);
+
+    const u64 b = allocator.alloc(1000, 4096).unwrap();
+    y_test_assert(b % 4096 == 0);
+    y_test_assert(allocator.allocated_size(b) == 1024);
+
+    // The padding in front of b is still usable
+    const u64 c = allocator.alloc(256).unwrap();
+    y_test_assert(c < b);
+
+    allocator.free(a);
+    allocator.free(b);
+    allocator.free(c);
+    y_test_assert(allocator.stats().free_blocks == 1);
+    y_test_assert(allocator.free_size() == 64 * 1024);
+}
+
+y_test_func("TLSFAllocator random alloc and free") {
+    const u64 size = 1024 * 1024;
+    TLSFAllocator allocator(size, 16);
+
+    math::FastRandom rng(7);
+
+    Vector<Range> live;
+    u64 allocated = 0;
+
+    for(usize i = 0; i != 20000; ++i) {
+        if(live.is_empty() || rng() % 3) {
+            const u64 alloc_size = 1 + rng() % (rng() % 8 ? 512 : 16 * 1024);
+            const u64 alignment = u64(1) << (rng() % 10);
+            if(const auto offset = allocator.alloc(alloc_size, alignment)) {
+                y_test_assert(offset.unwrap() % std::max(alignment, u64(16)) == 0);
+                const u64 real_size = allocator.allocated_size(offset.unwrap());
+                y_test_assert(real_size >= alloc_size && real_size % 16 == 0);
+                y_test_assert(offset.unwrap() + real_size <= size);
+
+                live << Range{offset.unwrap(), real_size};
+                allocated += real_size;
+            }
+        } else {
+            const usize index = rng() % live.size();
+            allocator.free(live[index].offset);
+            allocated -= live[index].size;
+            live.erase_unordered(live.begin() + index);
+        }
+
+        y_test_assert(allocator.free_size() == size - allocated);
+        y_test_assert(allocator.allocation_count() == live.size());
+    }
+
+    y_test_assert(!overlaps(live));
+
+    for(const Range& range : live) {
+        allocator.free(range.offset);
+    }
+
+    const TLSFAllocator::Stats stats = allocator.stats();
+    y_test_assert(stats.free_blocks == 1);
+    y_test_assert(stats.largest_free_block == size);
+}
+
+}
@@ -47,6 +47,44 @@ y_test_func("Transform decompose basic") {
     y_test_assert(s == scale);
 }
 
+y_test_func("Transform point and direction") {
+    const int step = 31;
+    for(int ph = -180; ph < 180; ph += step) {
+        for(int y = -180; y < 180; y += step) {
+            const auto quat = Quaternion<>::from_euler(to_rad(ph), to_rad(y), to_rad(ph + y));
+            const Vec3 pos(y, ph, 3.0f);
+            const Transform<> tr(pos, quat, Vec3(0.5f, 2.0f, 3.0f));
+
+            const Vec3 v(0.5f, -0.75f, 10.0f);
+            const Vec4 expected_point = tr.matrix() * Vec4(v, 1.0f);
+            const Vec4 expected_dir = tr.matrix() * Vec4(v, 0.0f);
+
+            y_test_assert((tr.transform_point(v) - expected_point.to<3>()).length() < 0.0001f);
+            y_test_assert((tr.transform_direction(v) - expected_dir.to<3>()).length() < 0.0001f);
+        }
+    }
+}
+
+y_test_func("Transform affine inverse") {
+    const int step = 13;
+    for(int ph = -180; ph < 180; ph += step) {
+        for(int y = -180; y < 180; y += step) {
+            const auto quat = Quaternion<>::from_euler(to_rad(ph), to_rad(y), to_rad(ph - y));
+            const Vec3 pos(y, ph, -7.0f);
+            const Transform<> tr(pos, quat, Vec3(0.5f, 2.0f, 3.0f));
+
+            const Matrix4<> inv = tr.affine_inverse();
+            const Matrix4<> expected = tr.inverse();
+            for(usize i = 0; i != 16; ++i) {
+                y_test_assert(std::abs(inv.begin()[i] - expected.begin()[i]) < 0.0001f);
+            }
+
+            const Vec3 v(1.0f, 2.0f, 3.0f);
+            y_test_assert((Transform<>(inv).transform_point(tr.transform_point(v)) - v).length() < 0.0001f);
+        }
+    }
+}
+
 y_test_func("Transform decompose") {
     const int step = 7;
     for(int ph = -180; ph < 180; ph += step) {
@@ -0,0 +1,115 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#include <y/test/test.h>
+#include <y/math/keyframes.h>
+
+#include <cmath>
+
+namespace {
+
+using namespace y;
+using namespace y::math;
+
+static constexpr float frame_rate = 30.0f;
+static constexpr float tolerance = 0.001f;
+
+// Linear ramp over [0, 1], flat over [1, 2] then half a sine period over [2, 4]
+static float curve(float t) {
+    if(t <= 1.0f) {
+        return 2.0f * t;
+    }
+    if(t <= 2.0f) {
+        return 2.0f;
+    }
+    return 2.0f + std::sin(3.14159265f * 0.5f * (t - 2.0f));
+}
+
+static core::Vector<float> sample_curve(float duration) {
+    core::Vector<float> values;
+    for(usize i = 0; i <= usize(duration * frame_rate); ++i) {
+        values << curve(float(i) / frame_rate);
+    }
+    return values;
+}
+
+static float interpolation_error(core::Span<float> values, usize begin, usize end, usize i) {
+    const float factor = float(i - begin) / float(end - begin);
+    return std::abs(values[begin] * (1.0f - factor) + values[end] * factor - values[i]);
+}
+
+static core::Vector<usize> reduce(core::Span<float> values) {
+    return reduce_keys(values.size(), [&](usize begin, usize end) {
+        for(usize i = begin + 1; i < end; ++i) {
+            if(interpolation_error(values, begin, end, i) > tolerance) {
+                return false;
+            }
+        }
+        return true;
+    });
+}
+
+y_test_func("Keyframes reduce trivial") {
+    y_test_assert(reduce_keys(0, [](usize, usize) { return true; }).is_empty());
+    y_test_assert(reduce_keys(1, [](usize, usize) { return true; }).size() == 1);
+    y_test_assert(reduce_keys(2, [](usize, usize) { return true; }).size() == 2);
+
+    const auto all = reduce_keys(5, [](usize, usize) { return false; });
+    y_test_assert(all.size() == 5);
+    for(usize i = 0; i != all.size(); ++i) {
+        y_test_assert(all[i] == i);
+    }
+}
+
+y_test_func("Keyframes reduce linear") {
+    const core::Vector<float> values = sample_curve(1.0f);
+    const core::Vector<usize> kept = reduce(values);
+
+    y_test_assert(kept.size() == 2);
+    y_test_assert(kept[0] == 0);
+    y_test_assert(kept[1] == values.size() - 1);
+}
+
+y_test_func("Keyframes reduce error bound") {
+    const core::Vector<float> values = sample_curve(4.0f);
+    const core::Vector<usize> kept = reduce(values);
+
+    y_test_assert(values.size() == 121);
+    y_test_assert(kept.first() == 0);
+    y_test_assert(kept.last() == values.size() - 1);
+
+    // The ramp and the flat part only need their end points
+    y_test_assert(kept[1] == 30);
+    y_test_assert(kept[2] == 60);
+
+    y_test_assert(kept.size() < values.size() / 2);
+
+    float max_error = 0.0f;
+    for(usize k = 1; k != kept.size(); ++k) {
+        y_test_assert(kept[k - 1] < kept[k]);
+        for(usize i = kept[k - 1] + 1; i < kept[k]; ++i) {
+            max_error = std::max(max_error, interpolation_error(values, kept[k - 1], kept[k], i));
+        }
+    }
+    y_test_assert(max_error <= tolerance);
+}
+
+}
@@ -0,0 +1,65 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include <y/utils/memory.h>
+
+#include <y/test/test.h>
+
+#include <thread>
+
+namespace {
+using namespace y;
+
+y_test_func("memory tag registration") {
+    const u32 a = memory::register_tag("test tag a");
+    const u32 b = memory::register_tag("test tag b");
+
+    y_test_assert(a != 0);
+    y_test_assert(b != 0);
+    y_test_assert(a != b);
+    y_test_assert(memory::register_tag("test tag a") == a);
+    y_test_assert(std::string_view(memory::tag_name(a)) == "test tag a");
+    y_test_assert(std::string_view(memory::tag_name(0)) == "untagged");
+    y_test_assert(memory::tag_count() > b);
+}
+
+y_test_func("memory scoped tags") {
+    y_test_assert(memory::current_tag() == 0);
+    {
+        y_memory_tag("test tag outer");
+        const u32 outer = memory::current_tag();
+        y_test_assert(outer != 0);
+        {
+            y_memory_tag("test tag inner");
+            y_test_assert(memory::current_tag() != outer);
+            y_test_assert(std::string_view(memory::tag_name(memory::current_tag())) == "test tag inner");
+        }
+        y_test_assert(memory::current_tag() == outer);
+
+        u32 thread_tag = u32(-1);
+        std::thread([&] { thread_tag = memory::current_tag(); }).join();
+        y_test_assert(thread_tag == 0);
+    }
+    y_test_assert(memory::current_tag() == 0);
+}
+
+}
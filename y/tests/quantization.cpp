@@ -0,0 +1,209 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#include <y/test/test.h>
+#include <y/math/quantization.h>
+#include <y/math/random.h>
+
+namespace {
+
+using namespace y;
+using namespace y::math;
+
+static float random_float(FastRandom& rnd, float min, float max) {
+    return min + (max - min) * (float(rnd()) / float(std::numeric_limits<u32>::max()));
+}
+
+static Quaternion<> random_quaternion(FastRandom& rnd) {
+    return Quaternion<>(Vec4(random_float(rnd, -1.0f, 1.0f), random_float(rnd, -1.0f, 1.0f), random_float(rnd, -1.0f, 1.0f), random_float(rnd, -1.0f, 1.0f)));
+}
+
+// Angle of the rotation between a and b, computed from the vector part of conj(a) * b since acos is too imprecise for tiny angles
+static float angle_between(const Quaternion<>& a, const Quaternion<>& b) {
+    const double aw = a.w(), ax = a.x(), ay = a.y(), az = a.z();
+    const double bw = b.w(), bx = b.x(), by = b.y(), bz = b.z();
+
+    const double w = aw * bw + ax * bx + ay * by + az * bz;
+    const double x = aw * bx - ax * bw - ay * bz + az * by;
+    const double y = aw * by + ax * bz - ay * bw - az * bx;
+    const double z = aw * bz - ax * by + ay * bx - az * bw;
+
+    return float(2.0 * std::atan2(std::sqrt(x * x + y * y + z * z), std::abs(w)));
+}
+
+static Vec3 random_direction(FastRandom& rnd) {
+    for(;;) {
+        const Vec3 v(random_float(rnd, -1.0f, 1.0f), random_float(rnd, -1.0f, 1.0f), random_float(rnd, -1.0f, 1.0f));
+        if(const float len = v.length(); len > 0.01f && len <= 1.0f) {
+            return v / len;
+        }
+    }
+}
+
+static float angle_between(const Vec3& a, const Vec3& b) {
+    return std::atan2(a.cross(b).length(), a.dot(b));
+}
+
+template<usize Bits>
+static float max_octahedral_error(FastRandom& rnd) {
+    float max_angle = 0.0f;
+    for(usize i = 0; i != 100000; ++i) {
+        const Vec3 n = random_direction(rnd);
+        const Vec2 e = encode_octahedral(n);
+        const Vec2 q(dequantize_snorm<Bits>(quantize_snorm<Bits>(e.x())), dequantize_snorm<Bits>(quantize_snorm<Bits>(e.y())));
+        max_angle = std::max(max_angle, angle_between(n, decode_octahedral(q)));
+    }
+    return max_angle;
+}
+
+y_test_func("Quantization unorm16") {
+    y_test_assert(quantize_unorm16(0.0f) == 0);
+    y_test_assert(quantize_unorm16(1.0f) == 0xFFFF);
+    y_test_assert(quantize_unorm16(-1.0f) == 0);
+    y_test_assert(quantize_unorm16(2.0f) == 0xFFFF);
+
+    for(usize i = 0; i != 1000; ++i) {
+        const float x = float(i) / 999.0f;
+        y_test_assert(std::abs(dequantize_unorm16(quantize_unorm16(x)) - x) <= 0.5f / 65535.0f + epsilon<float>);
+    }
+}
+
+y_test_func("Quantization range error bound") {
+    FastRandom rnd;
+
+    const QuantizationRange range = QuantizationRange::from_bounds(Vec3(-10.0f, 0.5f, 3.0f), Vec3(25.0f, 0.5f, 3.25f));
+    const float max_error = range.max_error();
+
+    for(usize i = 0; i != 10000; ++i) {
+        const Vec3 v(random_float(rnd, -10.0f, 25.0f), 0.5f, random_float(rnd, 3.0f, 3.25f));
+        const Vec3 r = range.dequantize(range.quantize(v));
+        for(usize k = 0; k != 3; ++k) {
+            y_test_assert(std::abs(r[k] - v[k]) <= max_error * 1.01f);
+        }
+        // Flat axes are exact
+        y_test_assert(r.y() == 0.5f);
+    }
+}
+
+y_test_func("Quantization smallest three error bound") {
+    FastRandom rnd;
+
+    float max_angle = 0.0f;
+    for(usize i = 0; i != 100000; ++i) {
+        const Quaternion<> q = random_quaternion(rnd);
+        const Quaternion<> r = PackedQuaternion::pack(q).unpack();
+        max_angle = std::max(max_angle, angle_between(q, r));
+    }
+
+    // 15 bits per component is a few thousandths of a degree
+    y_test_assert(max_angle < to_rad(0.01f));
+}
+
+y_test_func("Quantization smallest three largest component") {
+    // Exercise every dropped component index, with both signs
+    for(usize i = 0; i != 4; ++i) {
+        for(float sign : {1.0f, -1.0f}) {
+            Vec4 v(0.1f, -0.2f, 0.3f, 0.05f);
+            v[i] = sign * 0.9f;
+            const Quaternion<> q(v);
+            const Quaternion<> r = PackedQuaternion::pack(q).unpack();
+
+            y_test_assert(angle_between(q, r) < to_rad(0.01f));
+
+            const Vec3 p(1.0f, 2.0f, 3.0f);
+            y_test_assert((q(p) - r(p)).length() < 0.001f);
+        }
+    }
+
+    // Identity survives untouched
+    const Quaternion<> id = PackedQuaternion::pack(Quaternion<>()).unpack();
+    y_test_assert(id.as_vec() == Vec4(0.0f, 0.0f, 0.0f, 1.0f));
+}
+
+y_test_func("Quantization snorm") {
+    y_test_assert(quantize_snorm<8>(0.0f) == 0);
+    y_test_assert(dequantize_snorm<8>(quantize_snorm<8>(0.0f)) == 0.0f);
+    y_test_assert(dequantize_snorm<8>(quantize_snorm<8>(1.0f)) == 1.0f);
+    y_test_assert(dequantize_snorm<8>(quantize_snorm<8>(-1.0f)) == -1.0f);
+    y_test_assert(dequantize_snorm<7>(quantize_snorm<7>(-2.0f)) == -1.0f);
+    y_test_assert(dequantize_snorm<8>(0x80) == -1.0f);
+    y_test_assert(quantize_snorm<7>(-1.0f) < (1u << 7));
+
+    for(usize i = 0; i != 1000; ++i) {
+        const float x = float(i) / 999.0f * 2.0f - 1.0f;
+        y_test_assert(std::abs(dequantize_snorm<8>(quantize_snorm<8>(x)) - x) <= 0.5f / 127.0f + epsilon<float>);
+        y_test_assert(std::abs(dequantize_snorm<16>(quantize_snorm<16>(x)) - x) <= 0.5f / 32767.0f + epsilon<float>);
+    }
+}
+
+y_test_func("Quantization half float") {
+    y_test_assert(float_to_half(0.0f) == 0x0000);
+    y_test_assert(float_to_half(-0.0f) == 0x8000);
+    y_test_assert(float_to_half(1.0f) == 0x3C00);
+    y_test_assert(float_to_half(-2.0f) == 0xC000);
+    y_test_assert(float_to_half(65504.0f) == 0x7BFF);
+    y_test_assert(float_to_half(65520.0f) == 0x7C00);
+    y_test_assert(float_to_half(std::numeric_limits<float>::infinity()) == 0x7C00);
+    y_test_assert(std::isnan(half_to_float(float_to_half(std::numeric_limits<float>::quiet_NaN()))));
+
+    // Smallest subnormal, and rounding to nearest even at the end of the subnormal range
+    y_test_assert(float_to_half(std::ldexp(1.0f, -24)) == 0x0001);
+    y_test_assert(float_to_half(std::ldexp(1.0f, -26)) == 0x0000);
+    y_test_assert(float_to_half(std::ldexp(1023.5f, -24)) == 0x0400);
+
+    // Every half survives the round trip
+    for(u32 h = 0; h != 0x10000; ++h) {
+        if((h & 0x7C00) == 0x7C00 && (h & 0x03FF)) {
+            continue;
+        }
+        y_test_assert(float_to_half(half_to_float(u16(h))) == h);
+    }
+
+    // Relative error of normal values is at most half an ulp
+    FastRandom rnd;
+    for(usize i = 0; i != 100000; ++i) {
+        const float x = random_float(rnd, -60000.0f, 60000.0f) * std::ldexp(1.0f, -i32(i % 24));
+        if(std::abs(x) < std::ldexp(1.0f, -14)) {
+            continue;
+        }
+        y_test_assert(std::abs(half_to_float(float_to_half(x)) - x) <= std::abs(x) * std::ldexp(1.0f, -11));
+    }
+}
+
+y_test_func("Quantization octahedral error bound") {
+    FastRandom rnd;
+
+    for(usize i = 0; i != 10000; ++i) {
+        const Vec3 n = random_direction(rnd);
+        y_test_assert(angle_between(n, decode_octahedral(encode_octahedral(n))) < to_rad(0.001f));
+    }
+
+    // Axes and the lower hemisphere folds
+    for(const Vec3& n : {Vec3(0.0f, 0.0f, 1.0f), Vec3(0.0f, 0.0f, -1.0f), Vec3(1.0f, 0.0f, 0.0f), Vec3(0.0f, -1.0f, 0.0f)}) {
+        y_test_assert(angle_between(n, decode_octahedral(encode_octahedral(n))) < to_rad(0.001f));
+    }
+
+    y_test_assert(max_octahedral_error<7>(rnd) < to_rad(2.0f));
+    y_test_assert(max_octahedral_error<8>(rnd) < to_rad(1.0f));
+    y_test_assert(max_octahedral_error<16>(rnd) < to_rad(0.005f));
+}
+
+}
@@ -0,0 +1,124 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include <y/utils.h>
+#include <y/utils/sort.h>
+#include <y/core/Vector.h>
+#include <y/math/random.h>
+
+#include <y/test/test.h>
+
+#include <tuple>
+
+namespace {
+using namespace y;
+using namespace y::core;
+
+struct Draw {
+    u32 format = 0;
+    u32 material = 0;
+
+    u32 run_index = 0;
+    u32 run_offset = 0;
+};
+
+struct Run {
+    u32 format = 0;
+    u32 material = 0;
+    u32 offset = 0;
+    u32 size = 0;
+};
+
+static bool same_run(const Draw& a, const Draw& b) {
+    return a.format == b.format && a.material == b.material;
+}
+
+y_test_func("for_each_run empty") {
+    Vector<u32> values;
+    usize runs = 0;
+    for_each_run(values.begin(), values.end(), std::equal_to<>(), [&](usize, usize) { ++runs; });
+    y_test_assert(runs == 0);
+}
+
+y_test_func("for_each_run basic") {
+    const Vector<u32> values = {1, 1, 2, 3, 3, 3, 7};
+
+    Vector<std::pair<usize, usize>> runs;
+    for_each_run(values.begin(), values.end(), std::equal_to<>(), [&](usize offset, usize size) { runs.emplace_back(offset, size); });
+
+    y_test_assert(runs.size() == 4);
+    y_test_assert((runs[0] == std::pair<usize, usize>(0, 2)));
+    y_test_assert((runs[1] == std::pair<usize, usize>(2, 1)));
+    y_test_assert((runs[2] == std::pair<usize, usize>(3, 3)));
+    y_test_assert((runs[3] == std::pair<usize, usize>(6, 1)));
+}
+
+// Same layout as the GPU culled static mesh draws: draws are sorted by vertex format and material,
+// every run owns the output slots [offset, offset + size) and draws know their run and its offset
+y_test_func("for_each_run draw layout") {
+    math::FastRandom rng(3);
+
+    Vector<Draw> draws;
+    for(usize i = 0; i != 4096; ++i) {
+        draws.emplace_back(Draw{u32(rng() % 3), u32(rng() % 37)});
+    }
+
+    std::sort(draws.begin(), draws.end(), [](const Draw& a, const Draw& b) {
+        return std::tuple(a.format, a.material) < std::tuple(b.format, b.material);
+    });
+
+    Vector<Run> runs;
+    for_each_run(draws.begin(), draws.end(), same_run, [&](usize offset, usize size) {
+        const Draw& first = draws[offset];
+        for(usize i = 0; i != size; ++i) {
+            draws[offset + i].run_index = u32(runs.size());
+            draws[offset + i].run_offset = u32(offset);
+        }
+        runs.emplace_back(Run{first.format, first.material, u32(offset), u32(size)});
+    });
+
+    y_test_assert(runs.size() <= 3 * 37);
+
+    u32 expected_offset = 0;
+    for(usize r = 0; r != runs.size(); ++r) {
+        y_test_assert(runs[r].offset == expected_offset);
+        y_test_assert(runs[r].size > 0);
+        expected_offset += runs[r].size;
+
+        if(r) {
+            y_test_assert(runs[r - 1].format != runs[r].format || runs[r - 1].material != runs[r].material);
+        }
+    }
+    y_test_assert(expected_offset == draws.size());
+
+    for(usize i = 0; i != draws.size(); ++i) {
+        const Draw& draw = draws[i];
+        y_test_assert(draw.run_index < runs.size());
+
+        const Run& run = runs[draw.run_index];
+        y_test_assert(draw.run_offset == run.offset);
+        y_test_assert(i >= run.offset && i < run.offset + run.size);
+        y_test_assert(draw.format == run.format && draw.material == run.material);
+    }
+}
+
+}
@@ -0,0 +1,68 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include "BumpAllocator.h"
+
+#include <y/utils/memory.h>
+
+namespace y {
+namespace concurrent {
+
+BumpAllocator::BumpAllocator(u64 capacity) : _capacity(capacity) {
+}
+
+core::Result<u64> BumpAllocator::alloc(u64 size, u64 alignment) {
+    y_debug_assert(alignment && (alignment & (alignment - 1)) == 0);
+
+    u64 offset = _offset.load(std::memory_order_relaxed);
+    for(;;) {
+        const u64 start = align_up_to(offset, alignment);
+        const u64 end = start + size;
+        if(end > _capacity || end < start) {
+            return core::Err();
+        }
+
+        if(_offset.compare_exchange_weak(offset, end, std::memory_order_relaxed)) {
+            return core::Ok(start);
+        }
+    }
+}
+
+void BumpAllocator::reset() {
+    _offset.store(0, std::memory_order_relaxed);
+}
+
+void BumpAllocator::reset(u64 capacity) {
+    _capacity = capacity;
+    reset();
+}
+
+u64 BumpAllocator::capacity() const {
+    return _capacity;
+}
+
+u64 BumpAllocator::used() const {
+    return _offset.load(std::memory_order_relaxed);
+}
+
+}
+}
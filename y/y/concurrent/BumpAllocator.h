@@ -0,0 +1,56 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#ifndef Y_CONCURRENT_BUMPALLOCATOR_H
+#define Y_CONCURRENT_BUMPALLOCATOR_H
+
+#include <y/core/Result.h>
+
+#include <atomic>
+
+namespace y {
+namespace concurrent {
+
+// Lock-free linear allocator for ranges of [0, capacity)
+// Like TLSFAllocator it only manages offsets. Allocations can not be freed individually:
+// the whole range is released at once with reset(), which must not race with alloc().
+class BumpAllocator : NonMovable {
+    public:
+        BumpAllocator(u64 capacity = 0);
+
+        // Alignment should be a power of 2. Failed allocations do not consume any space.
+        core::Result<u64> alloc(u64 size, u64 alignment = 1);
+
+        void reset();
+        void reset(u64 capacity);
+
+        u64 capacity() const;
+        u64 used() const;
+
+    private:
+        std::atomic<u64> _offset = 0;
+        u64 _capacity = 0;
+};
+
+}
+}
+
+#endif // Y_CONCURRENT_BUMPALLOCATOR_H
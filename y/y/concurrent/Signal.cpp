@@ -24,6 +24,112 @@ SOFTWARE.
 
 namespace y {
 namespace concurrent {
+namespace detail {
+
+struct alignas(64) EpochRecord {
+    // 0 when the owning thread is not sending
+    std::atomic<u64> epoch = 0;
+    std::atomic<bool> in_use = false;
+    EpochRecord* next = nullptr;
+
+    // Only touched by the owning thread
+    u32 nesting = 0;
+};
+
+struct Retired {
+    void* ptr = nullptr;
+    void (*deleter)(void*) = nullptr;
+    u64 epoch = 0;
+};
+
+static std::atomic<u64> global_epoch = 1;
+static std::atomic<EpochRecord*> epoch_records = nullptr;
+
+static std::mutex retired_lock;
+static core::Vector<Retired> retired;
+
+static EpochRecord* acquire_epoch_record() {
+    for(EpochRecord* record = epoch_records.load(std::memory_order_acquire); record; record = record->next) {
+        bool expected = false;
+        if(record->in_use.compare_exchange_strong(expected, true)) {
+            return record;
+        }
+    }
+
+    // Records are never freed, threads that exit give theirs back
+    EpochRecord* record = new EpochRecord();
+    record->in_use = true;
+    record->next = epoch_records.load();
+    while(!epoch_records.compare_exchange_weak(record->next, record)) {
+    }
+    return record;
+}
+
+struct ThreadEpochRecord : NonMovable {
+    EpochRecord* record = acquire_epoch_record();
+
+    ~ThreadEpochRecord() {
+        y_debug_assert(!record->nesting);
+        record->in_use.store(false, std::memory_order_release);
+    }
+};
+
+static thread_local ThreadEpochRecord thread_epoch_record;
+
+static u64 min_active_epoch() {
+    u64 min_epoch = u64(-1);
+    for(EpochRecord* record = epoch_records.load(std::memory_order_acquire); record; record = record->next) {
+        if(const u64 epoch = record->epoch.load()) {
+            min_epoch = std::min(min_epoch, epoch);
+        }
+    }
+    return min_epoch;
+}
+
+
+EpochGuard::EpochGuard() {
+    EpochRecord* record = thread_epoch_record.record;
+    if(!record->nesting++) {
+        record->epoch.store(global_epoch.load());
+    }
+    _record = record;
+}
+
+EpochGuard::~EpochGuard() {
+    EpochRecord* record = static_cast<EpochRecord*>(_record);
+    if(!--record->nesting) {
+        record->epoch.store(0, std::memory_order_release);
+    }
+}
+
+void retire(void* ptr, void (*deleter)(void*)) {
+    // Readers that entered before this point might still see ptr, those that enter after can not
+    const u64 epoch = global_epoch.fetch_add(1) + 1;
+
+    core::Vector<Retired> to_delete;
+    {
+        const auto lock = std::unique_lock(retired_lock);
+        retired.emplace_back(ptr, deleter, epoch);
+
+        const u64 min_epoch = min_active_epoch();
+        for(usize i = 0; i < retired.size();) {
+            if(retired[i].epoch <= min_epoch) {
+                to_delete.emplace_back(retired[i]);
+                retired.erase_unordered(retired.begin() + i);
+            } else {
+                ++i;
+            }
+        }
+    }
+
+    // Deleters may run arbitrary destructors (that might retire things), so don't hold the lock
+    for(const Retired& r : to_delete) {
+        r.deleter(r.ptr);
+    }
+}
+
+}
+
 
 Subscription::~Subscription() {
     disconnect();
@@ -19,16 +19,19 @@ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
 OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 **********************************/
-
 #ifndef Y_CONCURRENT_SIGNAL_H
 #define Y_CONCURRENT_SIGNAL_H
 
-#include "Mutexed.h"
+#include "SpinLock.h"
+#include "concurrent.h"
 
 #include <y/core/Vector.h>
 
 #include <memory>
 #include <functional>
+#include <mutex>
+#include <tuple>
+#include <array>
 
 namespace y {
 namespace concurrent {
@@ -39,6 +42,26 @@ struct SignalDataBase {
 
     virtual void disconnect(u32 index) = 0;
 };
+
+// Epoch based reclamation for receiver lists:
+// readers only publish the epoch they entered in, retired objects are freed once no reader can still see them
+class EpochGuard : NonMovable {
+    public:
+        EpochGuard();
+        ~EpochGuard();
+
+    private:
+        void* _record = nullptr;
+};
+
+void retire(void* ptr, void (*deleter)(void*));
+
+template<typename T>
+void retire(const T* ptr) {
+    if(ptr) {
+        retire(const_cast<T*>(ptr), [](void* p) { delete static_cast<T*>(p); });
+    }
+}
 }
 
 
@@ -68,26 +91,107 @@ class [[nodiscard]] Subscription : NonCopyable {
 };
 
 
-
+// Receivers are stored in an immutable list that is copied on subscribe/disconnect,
+// so send() never locks nor waits: it only reads the current list.
+// A receiver that is disconnected while a send() is running on another thread may still be called by that send().
+// post() queues events (per thread) that are sent in a batch by the next call to send_deferred().
 template<typename... Args>
 class Signal {
     struct Data : detail::SignalDataBase {
         struct Slot {
             std::function<void(Args...)> func;
-            u32 index;
+            u32 index = 0;
+            std::atomic<bool> connected = true;
         };
 
-        Mutexed<core::Vector<Slot>, std::shared_mutex> _receivers;
-        std::atomic<u32> counter = 0;
+        using SlotList = core::Vector<Slot*>;
+
+        struct alignas(64) DeferredQueue {
+            SpinLock lock;
+            core::Vector<std::tuple<std::decay_t<Args>...>> events;
+        };
+
+        static constexpr usize deferred_queue_count = 16;
+        using DeferredQueues = std::array<DeferredQueue, deferred_queue_count>;
+
+        std::atomic<const SlotList*> receivers = nullptr;
+        std::atomic<DeferredQueues*> deferred = nullptr;
+
+        std::mutex write_lock;
+        u32 counter = 0;
+
+        ~Data() override {
+            // No one can be sending anymore
+            if(const SlotList* list = receivers.load()) {
+                for(Slot* slot : *list) {
+                    delete slot;
+                }
+                delete list;
+            }
+            delete deferred.load();
+        }
+
+        u32 connect(std::function<void(Args...)> func) {
+            Slot* slot = new Slot();
+            slot->func = std::move(func);
+
+            const SlotList* old_list = nullptr;
+            {
+                const auto lock = std::unique_lock(write_lock);
+                slot->index = ++counter;
+
+                old_list = receivers.load();
+                SlotList* new_list = old_list ? new SlotList(*old_list) : new SlotList();
+                new_list->emplace_back(slot);
+                receivers.store(new_list);
+            }
+
+            detail::retire(old_list);
+            return slot->index;
+        }
 
         void disconnect(u32 index) override {
-            _receivers.locked([&](auto&& receivers) {
-                auto it = std::find_if(receivers.begin(), receivers.end(), [&](const auto& rec) {
-                    return rec.index == index;
-                });
-                y_debug_assert(it != receivers.end());
-                receivers.erase_unordered(it);
-            });
+            const SlotList* old_list = nullptr;
+            Slot* removed = nullptr;
+            {
+                const auto lock = std::unique_lock(write_lock);
+
+                old_list = receivers.load();
+                y_debug_assert(old_list);
+
+                SlotList* new_list = new SlotList();
+                new_list->set_min_capacity(old_list->size());
+                for(Slot* slot : *old_list) {
+                    if(slot->index == index) {
+                        removed = slot;
+                    } else {
+                        new_list->emplace_back(slot);
+                    }
+                }
+
+                y_debug_assert(removed);
+                receivers.store(new_list);
+            }
+
+            if(removed) {
+                removed->connected = false;
+            }
+
+            detail::retire(old_list);
+            detail::retire(removed);
+        }
+
+        DeferredQueues& deferred_queues() {
+            if(DeferredQueues* queues = deferred.load(std::memory_order_acquire)) {
+                return *queues;
+            }
+
+            auto queues = std::make_unique<DeferredQueues>();
+            DeferredQueues* expected = nullptr;
+            if(deferred.compare_exchange_strong(expected, queues.get(), std::memory_order_acq_rel)) {
+                return *queues.release();
+            }
+            return *expected;
         }
     };
 
@@ -97,19 +201,48 @@ class Signal {
 
         template<typename F>
         Subscription subscribe(F&& func) {
-            const u32 index = ++_data->counter;
-            _data->_receivers.locked([&](auto&& receivers) {
-                receivers.emplace_back(y_fwd(func), index);
-            });
+            const u32 index = _data->connect(y_fwd(func));
             return Subscription(_data, index);
         }
 
         void send(Args... args) const {
-            _data->_receivers.locked_shared([&](const auto& receivers) {
-                for(const auto& rec : receivers) {
-                    rec.func(args...);
+            const detail::EpochGuard guard;
+            if(const auto* receivers = _data->receivers.load()) {
+                for(const auto* slot : *receivers) {
+                    if(slot->connected.load(std::memory_order_relaxed)) {
+                        slot->func(args...);
+                    }
+                }
+            }
+        }
+
+        void post(Args... args) {
+            auto& queue = _data->deferred_queues()[thread_id() % Data::deferred_queue_count];
+            const auto lock = std::unique_lock(queue.lock);
+            queue.events.emplace_back(std::move(args)...);
+        }
+
+        // Events posted from the same thread are sent in order
+        usize send_deferred() {
+            typename Data::DeferredQueues* queues = _data->deferred.load(std::memory_order_acquire);
+            if(!queues) {
+                return 0;
+            }
+
+            usize count = 0;
+            for(auto& queue : *queues) {
+                core::Vector<std::tuple<std::decay_t<Args>...>> events;
+                {
+                    const auto lock = std::unique_lock(queue.lock);
+                    std::swap(events, queue.events);
                 }
-            });
+
+                for(auto& event : events) {
+                    std::apply([this](auto&... event_args) { send(event_args...); }, event);
+                }
+                count += events.size();
+            }
+            return count;
         }
 
     private:
@@ -122,4 +255,3 @@ class Signal {
 }
 
 #endif // Y_CONCURRENT_SIGNAL_H
-
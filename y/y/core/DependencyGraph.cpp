@@ -0,0 +1,425 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include "DependencyGraph.h"
+
+#include <algorithm>
+#include <array>
+
+namespace y {
+namespace core {
+
+bool DependencyGraph::Compiled::is_culled(u32 node) const {
+    return !live[node];
+}
+
+usize DependencyGraph::Compiled::culled_count() const {
+    return live.size() - order.size();
+}
+
+DependencyGraph::Queue DependencyGraph::Compiled::queue(u32 node) const {
+    y_debug_assert(!is_culled(node));
+    return batches[node_batches[node]].queue;
+}
+
+
+u32 DependencyGraph::add_node() {
+    const u32 index = u32(_nodes.size());
+    _nodes.emplace_back();
+    return index;
+}
+
+void DependencyGraph::add_read(u32 node, u32 resource) {
+    _nodes[node].accesses.push_back({resource, false});
+}
+
+void DependencyGraph::add_write(u32 node, u32 resource) {
+    _nodes[node].accesses.push_back({resource, true});
+}
+
+void DependencyGraph::set_side_effects(u32 node) {
+    _nodes[node].side_effects = true;
+}
+
+void DependencyGraph::set_output(u32 resource) {
+    _outputs.push_back(resource);
+}
+
+void DependencyGraph::add_sequence_point(u32 node) {
+    _sequence_points.push_back(node);
+}
+
+void DependencyGraph::set_async(u32 node) {
+    _nodes[node].async = true;
+}
+
+usize DependencyGraph::node_count() const {
+    return _nodes.size();
+}
+
+DependencyGraph::Compiled DependencyGraph::compile() const {
+    u32 resource_count = 0;
+    for(const Node& node : _nodes) {
+        for(const Access& access : node.accesses) {
+            resource_count = std::max(resource_count, access.resource + 1);
+        }
+    }
+    for(const u32 resource : _outputs) {
+        resource_count = std::max(resource_count, resource + 1);
+    }
+
+    Compiled compiled;
+    compiled.live = compute_live(resource_count);
+    compiled.dependencies = compute_dependencies(compiled.live, resource_count);
+    compiled.order = schedule(compiled.live, compiled.dependencies);
+    split_batches(compiled, resource_count);
+    return compiled;
+}
+
+// Walks the nodes backward: a node is live if it has side effects or writes something a later live node uses.
+// Writes are not assumed to be complete, so a live writer keeps earlier writers of the same resource alive.
+core::FixedArray<bool> DependencyGraph::compute_live(u32 resource_count) const {
+    core::FixedArray<bool> needed(resource_count);
+    for(const u32 resource : _outputs) {
+        needed[resource] = true;
+    }
+
+    core::FixedArray<bool> live(_nodes.size());
+    for(usize i = _nodes.size(); i != 0; --i) {
+        const Node& node = _nodes[i - 1];
+
+        bool is_live = node.side_effects;
+        for(const Access& access : node.accesses) {
+            is_live |= access.written && needed[access.resource];
+        }
+
+        if(is_live) {
+            live[i - 1] = true;
+            for(const Access& access : node.accesses) {
+                needed[access.resource] = true;
+            }
+        }
+    }
+
+    return live;
+}
+
+core::FixedArray<core::Vector<u32>> DependencyGraph::compute_dependencies(const core::FixedArray<bool>& live, u32 resource_count) const {
+    struct ResourceState {
+        u32 last_writer = invalid_node;
+        core::Vector<u32> readers;
+    };
+
+    core::FixedArray<ResourceState> states(resource_count);
+    core::FixedArray<core::Vector<u32>> dependencies(_nodes.size());
+
+    u32 last_side_effects = invalid_node;
+    for(u32 i = 0; i != _nodes.size(); ++i) {
+        if(!live[i]) {
+            continue;
+        }
+
+        const Node& node = _nodes[i];
+        core::Vector<u32>& deps = dependencies[i];
+
+        if(node.side_effects) {
+            if(last_side_effects != invalid_node) {
+                deps.push_back(last_side_effects);
+            }
+            last_side_effects = i;
+        }
+
+        // Read after write, write after write and write after read
+        for(const Access& access : node.accesses) {
+            const ResourceState& state = states[access.resource];
+            if(state.last_writer != invalid_node) {
+                deps.push_back(state.last_writer);
+            }
+            if(access.written) {
+                deps.push_back(state.readers.begin(), state.readers.end());
+            }
+        }
+
+        for(const Access& access : node.accesses) {
+            ResourceState& state = states[access.resource];
+            if(access.written) {
+                state.last_writer = i;
+                state.readers.clear();
+            } else if(state.last_writer != i) {
+                state.readers.push_back(i);
+            }
+        }
+
+        std::sort(deps.begin(), deps.end());
+        const usize unique_count = usize(std::unique(deps.begin(), deps.end()) - deps.begin());
+        while(deps.size() != unique_count) {
+            deps.pop();
+        }
+    }
+
+    // Transitive reduction: only keep the dependencies that are not already implied by another one.
+    // Dependencies always point to previously declared nodes, so ancestors can be computed in declaration order.
+    core::FixedArray<core::FixedArray<bool>> ancestors(_nodes.size());
+    for(u32 i = 0; i != _nodes.size(); ++i) {
+        if(!live[i]) {
+            continue;
+        }
+
+        core::FixedArray<bool>& ancestor = ancestors[i];
+        ancestor = core::FixedArray<bool>(_nodes.size());
+
+        core::Vector<u32>& deps = dependencies[i];
+        for(const u32 dep : deps) {
+            ancestor[dep] = true;
+            for(u32 j = 0; j != dep; ++j) {
+                ancestor[j] |= ancestors[dep][j];
+            }
+        }
+
+        core::Vector<u32> reduced;
+        for(const u32 dep : deps) {
+            const bool implied = std::any_of(deps.begin(), deps.end(), [&](u32 other) { return other != dep && ancestors[other][dep]; });
+            if(!implied) {
+                reduced.push_back(dep);
+            }
+        }
+        deps = std::move(reduced);
+    }
+
+    return dependencies;
+}
+
+// List scheduling: among the nodes that are ready, pick the first one that doesn't depend on the node that was just scheduled
+// so that the GPU has some unrelated work to do while waiting on the dependency.
+core::Vector<u32> DependencyGraph::schedule(const core::FixedArray<bool>& live, const core::FixedArray<core::Vector<u32>>& dependencies) const {
+    core::FixedArray<core::Vector<u32>> dependents(_nodes.size());
+    core::FixedArray<u32> remaining(_nodes.size());
+    for(u32 i = 0; i != _nodes.size(); ++i) {
+        remaining[i] = u32(dependencies[i].size());
+        for(const u32 dep : dependencies[i]) {
+            dependents[dep].push_back(i);
+        }
+    }
+
+    core::Vector<u32> sequence_points(_sequence_points);
+    sequence_points.push_back(u32(_nodes.size()));
+    std::sort(sequence_points.begin(), sequence_points.end());
+
+    core::Vector<u32> order;
+    core::Vector<u32> ready;
+
+    u32 segment_begin = 0;
+    for(u32 segment_end : sequence_points) {
+        segment_end = std::min(segment_end, u32(_nodes.size()));
+        if(segment_end <= segment_begin) {
+            continue;
+        }
+
+        // Dependencies always point backward, so everything outside of the segment has already been scheduled
+        for(u32 i = segment_begin; i != segment_end; ++i) {
+            if(live[i] && !remaining[i]) {
+                ready.push_back(i);
+            }
+        }
+
+        while(!ready.is_empty()) {
+            auto next = ready.begin();
+            if(!order.is_empty()) {
+                const u32 last = order.last();
+                const auto independent = std::find_if(ready.begin(), ready.end(), [&](u32 node) {
+                    return !std::binary_search(dependencies[node].begin(), dependencies[node].end(), last);
+                });
+                if(independent != ready.end()) {
+                    next = independent;
+                }
+            }
+
+            const u32 node = *next;
+            ready.erase(next);
+            order.push_back(node);
+
+            for(const u32 dependent : dependents[node]) {
+                // Nodes from later segments are picked up when we get to them
+                if(!--remaining[dependent] && dependent < segment_end) {
+                    ready.insert(std::lower_bound(ready.begin(), ready.end(), dependent), dependent);
+                }
+            }
+        }
+
+        segment_begin = segment_end;
+    }
+
+    return order;
+}
+
+// Walks the schedule and cuts a queue's current batch whenever the other queue needs to wait on it.
+// Batches are only ever waited on once they are closed, so submitting them in creation order never deadlocks.
+// Resources are owned by a single queue at a time: using a resource on the other queue transfers it, which also synchronizes the queues.
+void DependencyGraph::split_batches(Compiled& compiled, u32 resource_count) const {
+    compiled.node_batches = core::FixedArray<u32>(_nodes.size());
+    std::fill(compiled.node_batches.begin(), compiled.node_batches.end(), invalid_batch);
+
+    const bool has_async = std::any_of(compiled.order.begin(), compiled.order.end(), [&](u32 node) { return _nodes[node].async; });
+    if(!has_async) {
+        Batch& batch = compiled.batches.emplace_back();
+        batch.nodes = core::Vector<u32>(compiled.order);
+        for(const u32 node : compiled.order) {
+            compiled.node_batches[node] = 0;
+        }
+        return;
+    }
+
+    auto other_queue = [](Queue queue) {
+        return queue == Queue::Main ? Queue::Async : Queue::Main;
+    };
+
+    std::array<u32, 2> open = {invalid_batch, invalid_batch};
+    std::array<u32, 2> latest = {invalid_batch, invalid_batch};
+
+    // Last batch of the other queue each queue has waited on
+    std::array<u32, 2> synced = {invalid_batch, invalid_batch};
+
+    // Resources belong to the main queue before the graph
+    core::FixedArray<Queue> owners(resource_count);
+    std::fill(owners.begin(), owners.end(), Queue::Main);
+
+    // Last batch using each resource
+    core::FixedArray<u32> last_batches(resource_count);
+    std::fill(last_batches.begin(), last_batches.end(), invalid_batch);
+
+    auto open_batch = [&](Queue queue) {
+        u32& batch = open[usize(queue)];
+        if(batch == invalid_batch) {
+            batch = u32(compiled.batches.size());
+            latest[usize(queue)] = batch;
+            compiled.batches.emplace_back().queue = queue;
+        }
+        return batch;
+    };
+
+    auto close_batch = [&](Queue queue) {
+        const u32 batch = open[usize(queue)];
+        open[usize(queue)] = invalid_batch;
+        return batch;
+    };
+
+    auto is_synced = [&](Queue queue, u32 batch) {
+        const u32 last = synced[usize(queue)];
+        return last != invalid_batch && last >= batch;
+    };
+
+    // Returns the batch that the next node of queue should be added to
+    auto wait_for = [&](Queue queue, u32 batch) {
+        if(batch == invalid_batch || is_synced(queue, batch)) {
+            return open_batch(queue);
+        }
+
+        synced[usize(queue)] = batch;
+
+        // An empty batch can start waiting, as long as it is submitted after the batch it waits on
+        const u32 current = open[usize(queue)];
+        if(current != invalid_batch && current > batch && compiled.batches[current].nodes.is_empty() && compiled.batches[current].wait == invalid_batch) {
+            compiled.batches[current].wait = batch;
+            return current;
+        }
+
+        close_batch(queue);
+        const u32 next = open_batch(queue);
+        compiled.batches[next].wait = batch;
+        return next;
+    };
+
+    // The first batch is on the main queue, even if it ends up empty
+    open_batch(Queue::Main);
+
+    core::Vector<std::pair<u32, u32>> to_transfer;
+    for(const u32 node : compiled.order) {
+        const Queue queue = _nodes[node].async ? Queue::Async : Queue::Main;
+        const Queue other = other_queue(queue);
+
+        // Resources are released by the last batch of the other queue we already waited on if possible,
+        // otherwise by its latest batch, which we will have to wait on
+        u32 wait = invalid_batch;
+        to_transfer.make_empty();
+        for(const Access& access : _nodes[node].accesses) {
+            const u32 resource = access.resource;
+            if(owners[resource] == queue || std::find_if(to_transfer.begin(), to_transfer.end(), [&](const auto& t) { return t.first == resource; }) != to_transfer.end()) {
+                continue;
+            }
+
+            const u32 last_batch = last_batches[resource];
+            const u32 synced_batch = synced[usize(queue)];
+            u32 release = synced_batch;
+            if(synced_batch == invalid_batch || (last_batch != invalid_batch && last_batch > synced_batch)) {
+                release = latest[usize(other)] != invalid_batch ? latest[usize(other)] : open_batch(other);
+                if(open[usize(other)] == release) {
+                    close_batch(other);
+                }
+                wait = wait == invalid_batch ? release : std::max(wait, release);
+            }
+
+            to_transfer.emplace_back(resource, release);
+        }
+
+        for(const u32 dep : compiled.dependencies[node]) {
+            const u32 dep_batch = compiled.node_batches[dep];
+            if(compiled.batches[dep_batch].queue == queue || is_synced(queue, dep_batch)) {
+                continue;
+            }
+            if(open[usize(other)] == dep_batch) {
+                close_batch(other);
+            }
+            wait = wait == invalid_batch ? dep_batch : std::max(wait, dep_batch);
+        }
+
+        const u32 batch = wait_for(queue, wait);
+        for(const auto& [resource, release] : to_transfer) {
+            compiled.transfers.push_back({resource, release, batch});
+            owners[resource] = queue;
+        }
+
+        for(const Access& access : _nodes[node].accesses) {
+            last_batches[access.resource] = batch;
+        }
+
+        compiled.batches[batch].nodes.push_back(node);
+        compiled.node_batches[node] = batch;
+    }
+
+    // Give everything back to the main queue, which also waits for all the async work to complete
+    {
+        const u32 last_async = latest[usize(Queue::Async)];
+        close_batch(Queue::Async);
+
+        const u32 batch = wait_for(Queue::Main, last_async);
+        for(u32 i = 0; i != resource_count; ++i) {
+            if(owners[i] == Queue::Async) {
+                compiled.transfers.push_back({i, last_async, batch});
+            }
+        }
+
+        y_debug_assert(batch + 1 == compiled.batches.size());
+    }
+}
+
+}
+}
@@ -0,0 +1,135 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#ifndef Y_CORE_DEPENDENCYGRAPH_H
+#define Y_CORE_DEPENDENCYGRAPH_H
+
+#include "Vector.h"
+#include "FixedArray.h"
+
+namespace y {
+namespace core {
+
+// Dependency graph between nodes that read and write abstract resources
+// Nodes are declared in an order that is valid for execution, compile() derives the hazards between them,
+// culls the nodes whose results are never consumed and computes a schedule that keeps dependent nodes apart.
+// Nodes marked as async run on a second queue: the schedule is then split in batches that synchronize with each other.
+class DependencyGraph : NonCopyable {
+    struct Access {
+        u32 resource = 0;
+        bool written = false;
+    };
+
+    struct Node {
+        core::Vector<Access> accesses;
+        bool side_effects = false;
+        bool async = false;
+    };
+
+    public:
+        static constexpr u32 invalid_node = u32(-1);
+        static constexpr u32 invalid_batch = u32(-1);
+
+        enum class Queue : u32 {
+            Main,
+            Async
+        };
+
+        // Nodes submitted together on a queue
+        struct Batch {
+            Queue queue = Queue::Main;
+
+            // In execution order, can be empty for batches that only release resources
+            core::Vector<u32> nodes;
+
+            // Batch of the other queue that has to complete before this one starts (earlier ones are implied)
+            u32 wait = invalid_batch;
+        };
+
+        // Resources move from one queue to the other: released at the end of a batch and acquired at the start of another one.
+        // All resources belong to the main queue before and after the graph.
+        struct Transfer {
+            u32 resource = 0;
+            u32 release_batch = invalid_batch;
+            u32 acquire_batch = invalid_batch;
+        };
+
+        struct Compiled {
+            // Live nodes, in execution order
+            core::Vector<u32> order;
+
+            // Nodes that need to be synchronized with the node, transitive dependencies are omitted
+            core::FixedArray<core::Vector<u32>> dependencies;
+
+            core::FixedArray<bool> live;
+
+            // In submission order. The first and last batches always run on the main queue.
+            // Without async nodes, all the nodes are in a single batch.
+            core::Vector<Batch> batches;
+            core::Vector<Transfer> transfers;
+
+            // Batch of each node, invalid_batch for culled nodes
+            core::FixedArray<u32> node_batches;
+
+            bool is_culled(u32 node) const;
+            usize culled_count() const;
+
+            Queue queue(u32 node) const;
+        };
+
+        DependencyGraph() = default;
+
+        u32 add_node();
+
+        void add_read(u32 node, u32 resource);
+        void add_write(u32 node, u32 resource);
+
+        // Nodes with effects outside of the graph are never culled and keep their declaration order relative to each other
+        void set_side_effects(u32 node);
+
+        // Resources that outlive the graph: everything contributing to them is kept
+        void set_output(u32 resource);
+
+        // Nodes can not be moved across a sequence point: all nodes declared before node are scheduled before it
+        void add_sequence_point(u32 node);
+
+        // Nodes that can run on the async queue, concurrently with the main one
+        void set_async(u32 node);
+
+        usize node_count() const;
+
+        Compiled compile() const;
+
+    private:
+        core::FixedArray<bool> compute_live(u32 resource_count) const;
+        core::FixedArray<core::Vector<u32>> compute_dependencies(const core::FixedArray<bool>& live, u32 resource_count) const;
+        core::Vector<u32> schedule(const core::FixedArray<bool>& live, const core::FixedArray<core::Vector<u32>>& dependencies) const;
+        void split_batches(Compiled& compiled, u32 resource_count) const;
+
+        core::Vector<Node> _nodes;
+        core::Vector<u32> _outputs;
+        core::Vector<u32> _sequence_points;
+};
+
+}
+}
+
+#endif // Y_CORE_DEPENDENCYGRAPH_H
@@ -0,0 +1,132 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include "LifetimePacker.h"
+
+#include <algorithm>
+
+namespace y {
+namespace core {
+
+static u64 align_up(u64 value, u64 alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static bool lifetimes_overlap(const LifetimePacker::Range& a, const LifetimePacker::Range& b) {
+    return a.first_use <= b.last_use && b.first_use <= a.last_use;
+}
+
+usize LifetimePacker::add(u64 size, u64 alignment, u32 first_use, u32 last_use) {
+    y_debug_assert(is_pow_of_2(alignment));
+    y_debug_assert(first_use <= last_use);
+
+    const usize index = _ranges.size();
+    _ranges.push_back({size, alignment, first_use, last_use});
+    return index;
+}
+
+u64 LifetimePacker::pack() {
+    core::Vector<u32> sorted;
+    sorted.set_min_capacity(_ranges.size());
+    for(u32 i = 0; i != _ranges.size(); ++i) {
+        sorted.push_back(i);
+    }
+
+    std::sort(sorted.begin(), sorted.end(), [&](u32 a, u32 b) {
+        if(_ranges[a].size != _ranges[b].size) {
+            return _ranges[a].size > _ranges[b].size;
+        }
+        return _ranges[a].first_use < _ranges[b].first_use;
+    });
+
+    _offsets.make_empty();
+    _offsets.set_min_size(_ranges.size(), u64(0));
+
+    u64 total_size = 0;
+
+    struct Placed {
+        u64 begin = 0;
+        u64 end = 0;
+    };
+
+    core::Vector<u32> placed;
+    core::Vector<Placed> conflicts;
+    for(const u32 index : sorted) {
+        const Range& range = _ranges[index];
+
+        conflicts.make_empty();
+        for(const u32 other : placed) {
+            if(lifetimes_overlap(range, _ranges[other])) {
+                conflicts.push_back({_offsets[other], _offsets[other] + _ranges[other].size});
+            }
+        }
+        std::sort(conflicts.begin(), conflicts.end(), [](const Placed& a, const Placed& b) { return a.begin < b.begin; });
+
+        // First fit: walk the conflicting ranges in memory order and take the first gap big enough
+        u64 offset = 0;
+        for(const Placed& conflict : conflicts) {
+            if(offset + range.size <= conflict.begin) {
+                break;
+            }
+            offset = std::max(offset, align_up(conflict.end, range.alignment));
+        }
+
+        _offsets[index] = offset;
+        total_size = std::max(total_size, offset + range.size);
+        placed.push_back(index);
+    }
+
+    _shared.make_empty();
+    _shared.set_min_size(_ranges.size(), false);
+    for(usize i = 0; i != _ranges.size(); ++i) {
+        for(usize j = i + 1; j != _ranges.size(); ++j) {
+            if(_offsets[i] < _offsets[j] + _ranges[j].size && _offsets[j] < _offsets[i] + _ranges[i].size) {
+                _shared[i] = _shared[j] = true;
+            }
+        }
+    }
+
+    return total_size;
+}
+
+core::Span<u64> LifetimePacker::offsets() const {
+    return _offsets;
+}
+
+core::Span<LifetimePacker::Range> LifetimePacker::ranges() const {
+    return _ranges;
+}
+
+bool LifetimePacker::shares_memory(usize index) const {
+    return _shared[index];
+}
+
+u64 LifetimePacker::unaliased_size() const {
+    u64 size = 0;
+    for(const Range& range : _ranges) {
+        size += range.size;
+    }
+    return size;
+}
+
+}
+}
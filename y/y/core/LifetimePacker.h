@@ -0,0 +1,67 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#ifndef Y_CORE_LIFETIMEPACKER_H
+#define Y_CORE_LIFETIMEPACKER_H
+
+#include "Vector.h"
+
+namespace y {
+namespace core {
+
+// Places ranges in memory so that ranges whose lifetimes overlap never overlap in memory
+// Lifetimes are inclusive intervals of abstract time (pass indices for instance).
+// Ranges are placed from the largest to the smallest, each one in the lowest gap left by the ranges already placed
+// that are alive at the same time, which is close to optimal for the kind of interval graphs a frame produces.
+class LifetimePacker {
+    public:
+        struct Range {
+            u64 size = 0;
+            u64 alignment = 1;
+            u32 first_use = 0;
+            u32 last_use = 0;
+        };
+
+        // Alignment should be a power of 2
+        usize add(u64 size, u64 alignment, u32 first_use, u32 last_use);
+
+        // Returns the total memory size, offsets() is valid afterward
+        u64 pack();
+
+        core::Span<u64> offsets() const;
+        core::Span<Range> ranges() const;
+
+        // True if some of the range's memory is used by another range, valid after pack()
+        bool shares_memory(usize index) const;
+
+        // Memory needed without any aliasing
+        u64 unaliased_size() const;
+
+    private:
+        core::Vector<Range> _ranges;
+        core::Vector<u64> _offsets;
+        core::Vector<bool> _shared;
+};
+
+}
+}
+
+#endif // Y_CORE_LIFETIMEPACKER_H
@@ -0,0 +1,143 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include "RingAllocator.h"
+
+#include <y/utils/memory.h>
+
+namespace y {
+namespace core {
+
+RingAllocator::RingAllocator(u64 size) : _size(size) {
+}
+
+RingAllocator::Frame* RingAllocator::find_frame(u64 id) {
+    for(Frame& frame : _frames) {
+        if(frame.id == id) {
+            return &frame;
+        }
+    }
+    return nullptr;
+}
+
+Result<u64> RingAllocator::alloc(u64 frame, u64 size, u64 alignment) {
+    y_debug_assert(is_pow_of_2(alignment));
+    y_debug_assert(size);
+
+    if(_used == _size) {
+        return Err();
+    }
+
+    const u64 offset = align_up_to(_head, alignment);
+
+    auto commit = [&](u64 begin, u64 consumed) -> Result<u64> {
+        _used += consumed;
+        _head = begin + size;
+
+        // Consecutive allocations of the same frame share a block
+        if(!_blocks.is_empty() && _blocks.last().frame == frame) {
+            _blocks.last().end = _head;
+            _blocks.last().size += consumed;
+        } else {
+            Frame* f = find_frame(frame);
+            if(!f) {
+                f = &_frames.emplace_back(Frame{frame});
+            }
+            y_debug_assert(!f->ended);
+            ++f->blocks;
+            _blocks.push_back(Block{frame, _head, consumed});
+        }
+
+        return Ok(begin);
+    };
+
+    // Free space is [head, tail) or, when the ring is wrapped, [head, size) + [0, tail)
+    if(_head < _tail) {
+        if(offset + size <= _tail) {
+            return commit(offset, offset + size - _head);
+        }
+        return Err();
+    }
+
+    if(offset + size <= _size) {
+        return commit(offset, offset + size - _head);
+    }
+
+    // The end of the range is wasted until the frame is released
+    if(size <= _tail) {
+        return commit(0, _size - _head + size);
+    }
+
+    return Err();
+}
+
+void RingAllocator::end_frame(u64 frame, u64 token) {
+    // Frames that never allocated anything have nothing to release
+    if(Frame* f = find_frame(frame)) {
+        y_debug_assert(!f->ended);
+        f->token = token;
+        f->ended = true;
+    }
+}
+
+void RingAllocator::release(u64 token) {
+    while(!_blocks.is_empty()) {
+        Frame* frame = find_frame(_blocks.first().frame);
+        y_debug_assert(frame);
+        if(!frame->ended || frame->token > token) {
+            break;
+        }
+
+        const Block block = _blocks.pop_front();
+        _tail = block.end;
+        _used -= block.size;
+
+        if(!--frame->blocks) {
+            _frames.erase_unordered(_frames.begin() + (frame - _frames.data()));
+        }
+    }
+
+    // Nothing is alive: start over from the beginning to avoid wasting the end of the range
+    if(!_used) {
+        y_debug_assert(_blocks.is_empty());
+        _head = _tail = 0;
+    }
+}
+
+u64 RingAllocator::size() const {
+    return _size;
+}
+
+u64 RingAllocator::used_size() const {
+    return _used;
+}
+
+u64 RingAllocator::free_size() const {
+    return _size - _used;
+}
+
+usize RingAllocator::pending_frames() const {
+    return _frames.size();
+}
+
+}
+}
@@ -0,0 +1,87 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#ifndef Y_CORE_RINGALLOCATOR_H
+#define Y_CORE_RINGALLOCATOR_H
+
+#include "RingQueue.h"
+#include "Vector.h"
+#include "Result.h"
+
+namespace y {
+namespace core {
+
+// FIFO allocator for ranges of [0, size), meant for per-frame uploads into a persistent buffer.
+// Allocations belong to a frame identified by the caller. Frames can overlap: each one is ended with its own token
+// (a fence value for example) and its allocations are released once that token is reached.
+// Memory is reclaimed in allocation order, so a frame only holds back the allocations made after its own.
+// Like TLSFAllocator it only manages offsets.
+class RingAllocator : NonCopyable {
+    struct Block {
+        u64 frame = 0;
+        u64 end = 0;
+        u64 size = 0;
+    };
+
+    struct Frame {
+        u64 id = 0;
+        u64 token = 0;
+        usize blocks = 0;
+        bool ended = false;
+    };
+
+    public:
+        RingAllocator() = default;
+        RingAllocator(u64 size);
+
+        // Alignment should be a power of 2. Allocations never wrap around the end of the range.
+        Result<u64> alloc(u64 frame, u64 size, u64 alignment = 1);
+
+        // Closes the frame, its allocations will be released by release(token)
+        void end_frame(u64 frame, u64 token);
+
+        // Releases the allocations of ended frames with a token lower or equal to token, in allocation order
+        void release(u64 token);
+
+        u64 size() const;
+        u64 used_size() const;
+        u64 free_size() const;
+        usize pending_frames() const;
+
+    private:
+        u64 _size = 0;
+        u64 _used = 0;
+
+        u64 _head = 0;
+        u64 _tail = 0;
+
+        Frame* find_frame(u64 id);
+
+        RingQueue<Block> _blocks;
+
+        // Frames that still own at least one block
+        Vector<Frame> _frames;
+};
+
+}
+}
+
+#endif // Y_CORE_RINGALLOCATOR_H
@@ -0,0 +1,309 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include "TLSFAllocator.h"
+
+#include <bit>
+
+namespace y {
+namespace core {
+
+static u64 align_up(u64 value, u64 alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+std::pair<u32, u32> TLSFAllocator::bin_index(u64 size) {
+    if(size < sl_count) {
+        return {0, u32(size)};
+    }
+
+    const u32 msb = u32(std::bit_width(size)) - 1;
+    return {msb - sl_bits + 1, u32(size >> (msb - sl_bits)) ^ sl_count};
+}
+
+// Rounds the size up to the next bin so that any block from the returned bin is big enough
+std::pair<u32, u32> TLSFAllocator::search_bin_index(u64 size) {
+    if(size >= sl_count) {
+        const u32 msb = u32(std::bit_width(size)) - 1;
+        const u64 round = (u64(1) << (msb - sl_bits)) - 1;
+        size = size > ~round ? ~u64(0) : size + round;
+    }
+    return bin_index(size);
+}
+
+
+TLSFAllocator::TLSFAllocator(u64 size, u64 granularity) : _size(size), _granularity(granularity) {
+    y_always_assert(is_pow_of_2(granularity), "Granularity should be a power of 2");
+    y_always_assert(size % granularity == 0, "Size is not a multiple of granularity");
+
+    if(size) {
+        insert_free(create_node(0, size));
+    }
+}
+
+TLSFAllocator::TLSFAllocator(TLSFAllocator&& other) {
+    swap(other);
+}
+
+TLSFAllocator& TLSFAllocator::operator=(TLSFAllocator&& other) {
+    swap(other);
+    return *this;
+}
+
+void TLSFAllocator::swap(TLSFAllocator& other) {
+    std::swap(_size, other._size);
+    std::swap(_granularity, other._granularity);
+    std::swap(_free_size, other._free_size);
+    std::swap(_fl_bitmap, other._fl_bitmap);
+    std::swap(_sl_bitmaps, other._sl_bitmaps);
+    std::swap(_free_heads, other._free_heads);
+    _nodes.swap(other._nodes);
+    _unused_nodes.swap(other._unused_nodes);
+    _allocated.swap(other._allocated);
+}
+
+Result<u64> TLSFAllocator::alloc(u64 size, u64 alignment) {
+    y_debug_assert(is_pow_of_2(alignment));
+
+    size = align_up(std::max(size, u64(1)), _granularity);
+
+    // Offsets are always aligned on the granularity, so only larger alignments need padding
+    const u64 padding = alignment > _granularity ? alignment - _granularity : 0;
+
+    u32 index = find_free(size + padding);
+    if(index == invalid_node) {
+        return Err();
+    }
+
+    remove_free(index);
+
+    const u64 block_offset = _nodes[index].offset;
+    if(const u64 aligned_offset = align_up(block_offset, alignment); aligned_offset != block_offset) {
+        const u32 aligned = split(index, aligned_offset - block_offset);
+        insert_free(index);
+        index = aligned;
+    }
+
+    if(_nodes[index].size > size) {
+        insert_free(split(index, size));
+    }
+
+    const u64 offset = _nodes[index].offset;
+    _allocated.insert({offset, index});
+    return Ok(offset);
+}
+
+void TLSFAllocator::free(u64 offset) {
+    const auto it = _allocated.find(offset);
+    y_always_assert(it != _allocated.end(), "Invalid free: offset was not allocated");
+
+    const u32 index = it->second;
+    _allocated.erase(it);
+
+    insert_free(merge(index));
+}
+
+u64 TLSFAllocator::allocated_size(u64 offset) const {
+    const auto it = _allocated.find(offset);
+    y_always_assert(it != _allocated.end(), "Offset was not allocated");
+    return _nodes[it->second].size;
+}
+
+u64 TLSFAllocator::size() const {
+    return _size;
+}
+
+u64 TLSFAllocator::free_size() const {
+    return _free_size;
+}
+
+usize TLSFAllocator::allocation_count() const {
+    return _allocated.size();
+}
+
+TLSFAllocator::Stats TLSFAllocator::stats() const {
+    Stats stats;
+    stats.free_size = _free_size;
+    stats.allocations = _allocated.size();
+
+    for(u32 fl = 0; fl != fl_count; ++fl) {
+        for(u32 sl = 0; sl != sl_count; ++sl) {
+            if(!(_sl_bitmaps[fl] & (1u << sl))) {
+                continue;
+            }
+            for(u32 index = _free_heads[fl][sl]; index != invalid_node; index = _nodes[index].next_free) {
+                stats.largest_free_block = std::max(stats.largest_free_block, _nodes[index].size);
+                ++stats.free_blocks;
+            }
+        }
+    }
+
+    return stats;
+}
+
+
+u32 TLSFAllocator::create_node(u64 offset, u64 size) {
+    u32 index = invalid_node;
+    if(_unused_nodes.is_empty()) {
+        index = u32(_nodes.size());
+        _nodes.emplace_back();
+    } else {
+        index = _unused_nodes.pop();
+    }
+
+    _nodes[index] = Node{};
+    _nodes[index].offset = offset;
+    _nodes[index].size = size;
+    return index;
+}
+
+void TLSFAllocator::destroy_node(u32 index) {
+    _unused_nodes << index;
+}
+
+void TLSFAllocator::insert_free(u32 index) {
+    Node& node = _nodes[index];
+    y_debug_assert(!node.is_free);
+
+    const auto [fl, sl] = bin_index(node.size);
+    const bool has_head = _sl_bitmaps[fl] & (1u << sl);
+
+    node.is_free = true;
+    node.prev_free = invalid_node;
+    node.next_free = has_head ? _free_heads[fl][sl] : invalid_node;
+    if(has_head) {
+        _nodes[node.next_free].prev_free = index;
+    }
+
+    _free_heads[fl][sl] = index;
+    _sl_bitmaps[fl] |= 1u << sl;
+    _fl_bitmap |= u64(1) << fl;
+
+    _free_size += node.size;
+}
+
+void TLSFAllocator::remove_free(u32 index) {
+    Node& node = _nodes[index];
+    y_debug_assert(node.is_free);
+
+    const auto [fl, sl] = bin_index(node.size);
+
+    if(node.prev_free != invalid_node) {
+        _nodes[node.prev_free].next_free = node.next_free;
+    } else {
+        y_debug_assert(_free_heads[fl][sl] == index);
+        _free_heads[fl][sl] = node.next_free;
+        if(node.next_free == invalid_node) {
+            _sl_bitmaps[fl] &= ~(1u << sl);
+            if(!_sl_bitmaps[fl]) {
+                _fl_bitmap &= ~(u64(1) << fl);
+            }
+        }
+    }
+
+    if(node.next_free != invalid_node) {
+        _nodes[node.next_free].prev_free = node.prev_free;
+    }
+
+    node.is_free = false;
+    node.prev_free = invalid_node;
+    node.next_free = invalid_node;
+
+    _free_size -= node.size;
+}
+
+u32 TLSFAllocator::find_free(u64 size) const {
+    auto [fl, sl] = search_bin_index(size);
+    if(fl >= fl_count) {
+        return invalid_node;
+    }
+
+    u32 sl_map = _sl_bitmaps[fl] & (~0u << sl);
+    if(!sl_map) {
+        const u64 fl_map = fl + 1 < 64 ? _fl_bitmap & (~u64(0) << (fl + 1)) : 0;
+        if(!fl_map) {
+            return invalid_node;
+        }
+
+        fl = u32(std::countr_zero(fl_map));
+        sl_map = _sl_bitmaps[fl];
+    }
+
+    sl = u32(std::countr_zero(sl_map));
+    y_debug_assert(_nodes[_free_heads[fl][sl]].size >= size);
+    return _free_heads[fl][sl];
+}
+
+// Splits the block at index in two, the first part keeps the index, returns the second part
+u32 TLSFAllocator::split(u32 index, u64 size) {
+    y_debug_assert(!_nodes[index].is_free);
+    y_debug_assert(_nodes[index].size > size);
+
+    const u32 rest = create_node(_nodes[index].offset + size, _nodes[index].size - size);
+
+    Node& node = _nodes[index];
+    node.size = size;
+
+    _nodes[rest].prev_phys = index;
+    _nodes[rest].next_phys = node.next_phys;
+    if(node.next_phys != invalid_node) {
+        _nodes[node.next_phys].prev_phys = rest;
+    }
+    node.next_phys = rest;
+
+    return rest;
+}
+
+// Coalesces the block at index with its free physical neighbours, returns the merged block
+u32 TLSFAllocator::merge(u32 index) {
+    if(const u32 prev = _nodes[index].prev_phys; prev != invalid_node && _nodes[prev].is_free) {
+        remove_free(prev);
+
+        const u32 next = _nodes[index].next_phys;
+        _nodes[prev].size += _nodes[index].size;
+        _nodes[prev].next_phys = next;
+        if(next != invalid_node) {
+            _nodes[next].prev_phys = prev;
+        }
+
+        destroy_node(index);
+        index = prev;
+    }
+
+    if(const u32 next = _nodes[index].next_phys; next != invalid_node && _nodes[next].is_free) {
+        remove_free(next);
+
+        const u32 next_next = _nodes[next].next_phys;
+        _nodes[index].size += _nodes[next].size;
+        _nodes[index].next_phys = next_next;
+        if(next_next != invalid_node) {
+            _nodes[next_next].prev_phys = index;
+        }
+
+        destroy_node(next);
+    }
+
+    return index;
+}
+
+}
+}
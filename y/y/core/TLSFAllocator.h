@@ -0,0 +1,121 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#ifndef Y_CORE_TLSFALLOCATOR_H
+#define Y_CORE_TLSFALLOCATOR_H
+
+#include "Vector.h"
+#include "HashMap.h"
+#include "Result.h"
+
+#include <array>
+
+namespace y {
+namespace core {
+
+// Two-level segregated fit allocator for ranges of [0, size)
+// It only manages offsets: callers own the underlying memory and are responsible for synchronisation.
+// Allocation and deallocation are O(1), free blocks are coalesced immediately.
+class TLSFAllocator : NonCopyable {
+    static constexpr u32 sl_bits = 4;
+    static constexpr u32 sl_count = 1 << sl_bits;
+    static constexpr u32 fl_count = 64 - sl_bits + 1;
+
+    static constexpr u32 invalid_node = u32(-1);
+
+    struct Node {
+        u64 offset = 0;
+        u64 size = 0;
+
+        u32 prev_phys = invalid_node;
+        u32 next_phys = invalid_node;
+
+        u32 prev_free = invalid_node;
+        u32 next_free = invalid_node;
+
+        bool is_free = false;
+    };
+
+    public:
+        struct Stats {
+            u64 free_size = 0;
+            u64 largest_free_block = 0;
+            usize free_blocks = 0;
+            usize allocations = 0;
+
+            // 0 when all the free memory is contiguous, tends toward 1 as it gets split in small blocks
+            float fragmentation() const {
+                return free_size ? 1.0f - float(double(largest_free_block) / double(free_size)) : 0.0f;
+            }
+        };
+
+        TLSFAllocator() = default;
+        TLSFAllocator(u64 size, u64 granularity = 1);
+
+        TLSFAllocator(TLSFAllocator&& other);
+        TLSFAllocator& operator=(TLSFAllocator&& other);
+
+        // Alignment should be a power of 2, sizes are rounded up to the granularity
+        Result<u64> alloc(u64 size, u64 alignment = 1);
+        void free(u64 offset);
+
+        u64 allocated_size(u64 offset) const;
+
+        u64 size() const;
+        u64 free_size() const;
+        usize allocation_count() const;
+
+        // Walks all free lists
+        Stats stats() const;
+
+    private:
+        static std::pair<u32, u32> bin_index(u64 size);
+        static std::pair<u32, u32> search_bin_index(u64 size);
+
+        void swap(TLSFAllocator& other);
+
+        u32 create_node(u64 offset, u64 size);
+        void destroy_node(u32 index);
+
+        void insert_free(u32 index);
+        void remove_free(u32 index);
+
+        u32 find_free(u64 size) const;
+        u32 split(u32 index, u64 size);
+        u32 merge(u32 index);
+
+        u64 _size = 0;
+        u64 _granularity = 1;
+        u64 _free_size = 0;
+
+        u64 _fl_bitmap = 0;
+        std::array<u32, fl_count> _sl_bitmaps = {};
+        std::array<std::array<u32, sl_count>, fl_count> _free_heads = {};
+
+        Vector<Node> _nodes;
+        Vector<u32> _unused_nodes;
+        FlatHashMap<u64, u32> _allocated;
+};
+
+}
+}
+
+#endif // Y_CORE_TLSFALLOCATOR_H
@@ -24,6 +24,7 @@ SOFTWARE.
 
 #include <y/utils.h>
 #include "Vec.h"
+#include "simd.h"
 
 #include <algorithm>
 
@@ -43,6 +44,17 @@ namespace detail {
 
     template<typename T>
     inline constexpr T determinant(const Matrix<1, 1, T>& mat);
+
+    template<usize N, usize M, usize P, typename T, typename U>
+    inline constexpr auto multiply(const Matrix<N, M, T>& a, const Matrix<M, P, U>& b);
+
+    template<usize N, typename T>
+    inline constexpr Matrix<N, N, T> inverse(const Matrix<N, N, T>& mat);
+
+    template<usize N, usize M, typename T, typename U>
+    inline constexpr bool use_simd() {
+        return N == 4 && M == 4 && std::is_same_v<T, float> && std::is_same_v<U, float>;
+    }
 }
 
 
@@ -196,19 +208,16 @@ class Matrix {
         }
 
         inline constexpr Matrix inverse() const {
-            T d = determinant();
-            if(d == 0) {
-                return Matrix();
-            }
-            Matrix inv;
-            d = 1 / d;
-            for(usize i = 0; i != N; ++i) {
-                for(usize j = 0; j != N; ++j) {
-                    const auto s = sub(i, j).determinant() * d * (i % 2 == j % 2 ? 1 : -1);
-                    inv._vecs[i][j] = s;
+#ifdef Y_MATH_SSE
+            if constexpr(detail::use_simd<N, M, T, T>()) {
+                if(!std::is_constant_evaluated()) {
+                    Matrix inv;
+                    simd::inverse_mat4(begin(), inv.begin());
+                    return inv;
                 }
             }
-            return inv;
+#endif
+            return detail::inverse(*this);
         }
 
         inline static constexpr Matrix identity() {
@@ -245,6 +254,15 @@ class Matrix {
         }
 
         inline constexpr Column operator*(const Row& v) const {
+#ifdef Y_MATH_SSE
+            if constexpr(detail::use_simd<N, M, T, T>()) {
+                if(!std::is_constant_evaluated()) {
+                    Column tr;
+                    simd::mul_mat4_vec4(begin(), v.begin(), tr.begin());
+                    return tr;
+                }
+            }
+#endif
             Column tr;
             for(usize i = 0; i != M; ++i) {
                 tr += column(i) * v[i];
@@ -254,17 +272,16 @@ class Matrix {
 
         template<typename U, usize P>
         inline constexpr auto operator*(const Matrix<M, P, U>& m) const {
-            Matrix<N, P, decltype(std::declval<T>() * std::declval<U>())> mat;
-            for(usize i = 0; i != N; ++i) {
-                for(usize j = 0; j != P; ++j) {
-                    decltype(std::declval<T>() * std::declval<U>()) tmp(0);
-                    for(usize k = 0; k != M; ++k) {
-                        tmp = tmp + _vecs[k][i] * m._vecs[j][k];
-                    }
-                    mat._vecs[j][i] = tmp;
+#ifdef Y_MATH_SSE
+            if constexpr(P == 4 && detail::use_simd<N, M, T, U>()) {
+                if(!std::is_constant_evaluated()) {
+                    Matrix mat;
+                    simd::mul_mat4(begin(), m.begin(), mat.begin());
+                    return mat;
                 }
             }
-            return mat;
+#endif
+            return detail::multiply(*this, m);
         }
 
         template<typename U, usize P>
@@ -314,6 +331,39 @@ namespace detail {
     constexpr T determinant(const Matrix<1, 1, T>& mat) {
         return mat[0][0];
     }
+
+    // Generic versions, used when no specialized path exists
+    template<usize N, usize M, usize P, typename T, typename U>
+    constexpr auto multiply(const Matrix<N, M, T>& a, const Matrix<M, P, U>& b) {
+        Matrix<N, P, decltype(std::declval<T>() * std::declval<U>())> mat;
+        for(usize i = 0; i != N; ++i) {
+            for(usize j = 0; j != P; ++j) {
+                decltype(std::declval<T>() * std::declval<U>()) tmp(0);
+                for(usize k = 0; k != M; ++k) {
+                    tmp = tmp + a[k][i] * b[j][k];
+                }
+                mat[j][i] = tmp;
+            }
+        }
+        return mat;
+    }
+
+    template<usize N, typename T>
+    constexpr Matrix<N, N, T> inverse(const Matrix<N, N, T>& mat) {
+        T d = mat.determinant();
+        if(d == 0) {
+            return Matrix<N, N, T>();
+        }
+        Matrix<N, N, T> inv;
+        d = 1 / d;
+        for(usize i = 0; i != N; ++i) {
+            for(usize j = 0; j != N; ++j) {
+                const auto s = mat.sub(i, j).determinant() * d * (i % 2 == j % 2 ? 1 : -1);
+                inv[i][j] = s;
+            }
+        }
+        return inv;
+    }
 }
 
 
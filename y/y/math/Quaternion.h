@@ -24,6 +24,7 @@ SOFTWARE.
 
 #include "math.h"
 #include "Vec.h"
+#include "simd.h"
 
 #include <limits>
 
@@ -95,6 +96,15 @@ class Quaternion {
         }
 
         inline constexpr Vec<3, T> operator()(const Vec<3, T>& v) const {
+#ifdef Y_MATH_SSE
+            if constexpr(std::is_same_v<T, float>) {
+                if(!std::is_constant_evaluated()) {
+                    Vec<3, T> r;
+                    simd::quat_rotate(_quat.begin(), v.begin(), r.begin());
+                    return r;
+                }
+            }
+#endif
             Vec<3, T> u = _quat.template to<3>();
             return u * T(2.0f) * u.dot(v) +
                    v * (w() * w() - u.length2()) +
@@ -110,6 +120,16 @@ class Quaternion {
         }
 
         inline constexpr Quaternion& operator*=(const Quaternion& q) {
+#ifdef Y_MATH_SSE
+            if constexpr(std::is_same_v<T, float>) {
+                if(!std::is_constant_evaluated()) {
+                    Vec<4, T> r;
+                    simd::quat_mul(_quat.begin(), q._quat.begin(), r.begin());
+                    _quat = r;
+                    return *this;
+                }
+            }
+#endif
             _quat = {w() * q.x() + x() * q.w() + y() * q.z() - z() * q.y(),
                      w() * q.y() + y() * q.w() + z() * q.x() - x() * q.z(),
                      w() * q.z() + z() * q.w() + x() * q.y() - y() * q.x(),
@@ -60,16 +60,55 @@ struct Transform : Matrix4<T> {
     }
 
     inline constexpr math::Vec<3, T> transform_point(const Vec<3, T>& p) const {
+#ifdef Y_MATH_SSE
+        if constexpr(std::is_same_v<T, float>) {
+            if(!std::is_constant_evaluated()) {
+                math::Vec<3, T> r;
+                simd::transform_point(this->begin(), p.begin(), r.begin());
+                return r;
+            }
+        }
+#endif
         return position() + transform_direction(p);
     }
 
     inline constexpr math::Vec<3, T> transform_direction(const Vec<3, T>& p) const {
+#ifdef Y_MATH_SSE
+        if constexpr(std::is_same_v<T, float>) {
+            if(!std::is_constant_evaluated()) {
+                math::Vec<3, T> r;
+                simd::transform_direction(this->begin(), p.begin(), r.begin());
+                return r;
+            }
+        }
+#endif
         return
             this->column(0).template to<3>() * p.x() +
             this->column(1).template to<3>() * p.y() +
             this->column(2).template to<3>() * p.z();
     }
 
+    // Only valid if the last row is (0, 0, 0, 1), which is the case for any combination of translations, rotations and scales
+    inline constexpr Transform affine_inverse() const {
+#ifdef Y_MATH_SSE
+        if constexpr(std::is_same_v<T, float>) {
+            if(!std::is_constant_evaluated()) {
+                Transform inv;
+                if(simd::affine_inverse_mat4(this->begin(), inv.begin())) {
+                    return inv;
+                }
+            }
+        }
+#endif
+        const Matrix3<T> inv = this->template to<3, 3>().inverse();
+        Transform tr;
+        for(usize i = 0; i != 3; ++i) {
+            tr.column(i) = Vec<4, T>(inv.column(i), T(0));
+        }
+        tr.position() = -(inv * position());
+        return tr;
+    }
+
     // Y forward
     inline constexpr const auto& forward() const {
         return this->column(1).template to<3>();
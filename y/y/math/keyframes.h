@@ -0,0 +1,60 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#ifndef Y_MATH_KEYFRAMES_H
+#define Y_MATH_KEYFRAMES_H
+
+#include <y/core/Vector.h>
+
+namespace y {
+namespace math {
+
+// Greedy key reduction: extends each segment for as long as its end points rebuild every key in between.
+// can_interpolate(begin, end) must return true if every key strictly between begin and end is rebuilt within tolerance.
+// Returns the indices of the kept keys, the first and last keys are always kept.
+template<typename F>
+core::Vector<usize> reduce_keys(usize key_count, F&& can_interpolate) {
+    core::Vector<usize> kept;
+    if(!key_count) {
+        return kept;
+    }
+
+    kept << 0;
+
+    usize begin = 0;
+    for(usize end = 2; end < key_count; ++end) {
+        if(!can_interpolate(begin, end)) {
+            begin = end - 1;
+            kept << begin;
+        }
+    }
+
+    if(key_count > 1) {
+        kept << key_count - 1;
+    }
+
+    return kept;
+}
+
+}
+}
+
+#endif // Y_MATH_KEYFRAMES_H
@@ -0,0 +1,223 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#ifndef Y_MATH_QUANTIZATION_H
+#define Y_MATH_QUANTIZATION_H
+
+#include "Quaternion.h"
+
+#include <array>
+#include <bit>
+
+namespace y {
+namespace math {
+
+// Maps [0, 1] onto the full u16 range. The error is at most half a step (1 / 131070)
+inline u16 quantize_unorm16(float x) {
+    return u16(std::clamp(x, 0.0f, 1.0f) * 65535.0f + 0.5f);
+}
+
+inline float dequantize_unorm16(u16 x) {
+    return float(x) * (1.0f / 65535.0f);
+}
+
+
+// Maps [-1, 1] onto the low Bits bits, as two's complement. 0 is exact and -1 has two encodings.
+template<usize Bits>
+inline u32 quantize_snorm(float x) {
+    static_assert(Bits >= 2 && Bits <= 16);
+    constexpr float max_value = float((1 << (Bits - 1)) - 1);
+    return u32(i32(std::round(std::clamp(x, -1.0f, 1.0f) * max_value))) & ((1u << Bits) - 1);
+}
+
+template<usize Bits>
+inline float dequantize_snorm(u32 x) {
+    static_assert(Bits >= 2 && Bits <= 16);
+    constexpr float max_value = float((1 << (Bits - 1)) - 1);
+    const i32 value = i32(x << (32 - Bits)) >> (32 - Bits);
+    return std::max(float(value) / max_value, -1.0f);
+}
+
+
+// IEEE 754 binary16, rounded to nearest even. Values too large for half precision become infinities.
+inline u16 float_to_half(float f) {
+    const u32 bits = std::bit_cast<u32>(f);
+    const u32 sign = (bits >> 16) & 0x8000;
+    const u32 abs_bits = bits & 0x7FFFFFFF;
+
+    if(abs_bits >= 0x7F800000) {
+        // Keep NaNs quiet
+        return u16(sign | 0x7C00 | (abs_bits > 0x7F800000 ? 0x0200 : 0));
+    }
+
+    if(abs_bits >= 0x477FF000) {
+        // Rounds above 65504
+        return u16(sign | 0x7C00);
+    }
+
+    if(abs_bits < 0x38800000) {
+        // Subnormal halves are multiples of 2^-24
+        return u16(sign | u32(std::nearbyint(std::bit_cast<float>(abs_bits) * 16777216.0f)));
+    }
+
+    const u32 rounded = abs_bits + 0x0FFF + ((abs_bits >> 13) & 0x01);
+    return u16(sign | ((rounded - 0x38000000) >> 13));
+}
+
+inline float half_to_float(u16 h) {
+    const u32 sign = u32(h & 0x8000) << 16;
+    const u32 exponent = (h >> 10) & 0x1F;
+    const u32 mantissa = h & 0x03FF;
+
+    if(!exponent) {
+        const float f = float(mantissa) * (1.0f / 16777216.0f);
+        return sign ? -f : f;
+    }
+
+    if(exponent == 0x1F) {
+        return std::bit_cast<float>(sign | 0x7F800000 | (mantissa << 13));
+    }
+
+    return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+
+// Octahedral mapping of unit vectors onto [-1, 1]^2 (Meyer et al., "On Floating-Point Normal Vectors")
+inline Vec2 encode_octahedral(const Vec3& n) {
+    const Vec3 v = n / (std::abs(n.x()) + std::abs(n.y()) + std::abs(n.z()));
+    if(v.z() >= 0.0f) {
+        return v.to<2>();
+    }
+    return Vec2(
+        (1.0f - std::abs(v.y())) * (v.x() >= 0.0f ? 1.0f : -1.0f),
+        (1.0f - std::abs(v.x())) * (v.y() >= 0.0f ? 1.0f : -1.0f)
+    );
+}
+
+inline Vec3 decode_octahedral(const Vec2& e) {
+    Vec3 n(e.x(), e.y(), 1.0f - std::abs(e.x()) - std::abs(e.y()));
+    const float t = std::max(-n.z(), 0.0f);
+    n.x() += n.x() >= 0.0f ? -t : t;
+    n.y() += n.y() >= 0.0f ? -t : t;
+    return n.normalized();
+}
+
+
+// Axis aligned range used to reduce vectors to 16 bits per component.
+// Flat axes (extent of 0) dequantize exactly to min.
+struct QuantizationRange {
+    Vec3 min;
+    Vec3 extent;
+
+    static QuantizationRange from_bounds(const Vec3& min, const Vec3& max) {
+        return QuantizationRange{min, max - min};
+    }
+
+    Vec<3, u16> quantize(const Vec3& v) const {
+        Vec<3, u16> q;
+        for(usize i = 0; i != 3; ++i) {
+            q[i] = extent[i] > 0.0f ? quantize_unorm16((v[i] - min[i]) / extent[i]) : u16(0);
+        }
+        return q;
+    }
+
+    Vec3 dequantize(const Vec<3, u16>& q) const {
+        return min + Vec3(dequantize_unorm16(q.x()), dequantize_unorm16(q.y()), dequantize_unorm16(q.z())) * extent;
+    }
+
+    // Maximum error introduced by quantize + dequantize on any component
+    float max_error() const {
+        return std::max({extent.x(), extent.y(), extent.z()}) / (2.0f * 65535.0f);
+    }
+};
+
+
+// Smallest three encoding: the largest component is dropped (it can be recovered from the unit length)
+// and the 3 others, all in [-1/sqrt(2), 1/sqrt(2)], are stored on 15 bits each.
+// The 2 bits index of the dropped component go in the high bits of the first two values.
+struct PackedQuaternion {
+    std::array<u16, 3> data = {};
+
+    static constexpr float component_range = 0.70710678118654752440f;
+
+    // Components are stored as 16383 + round(x * 16383) so that 0 is exact
+    static constexpr float half_steps = 16383.0f;
+
+    // Maximum error on the three stored components, the recomputed one can be off by about twice as much
+    static constexpr float max_error = component_range / (2.0f * half_steps);
+
+    static PackedQuaternion pack(const Quaternion<>& quat) {
+        Vec4 q = quat.as_vec();
+
+        usize largest = 0;
+        for(usize i = 1; i != 4; ++i) {
+            if(std::abs(q[i]) > std::abs(q[largest])) {
+                largest = i;
+            }
+        }
+
+        // q and -q are the same rotation: make the dropped component positive
+        if(q[largest] < 0.0f) {
+            q = -q;
+        }
+
+        PackedQuaternion packed;
+        for(usize i = 0, k = 0; i != 4; ++i) {
+            if(i != largest) {
+                const float x = std::clamp(q[i] / component_range, -1.0f, 1.0f);
+                packed.data[k++] = u16(half_steps + std::round(x * half_steps));
+            }
+        }
+
+        packed.data[0] |= u16((largest & 0x01) << 15);
+        packed.data[1] |= u16((largest & 0x02) << 14);
+        return packed;
+    }
+
+    Quaternion<> unpack() const {
+        const usize largest = usize(data[0] >> 15) | usize((data[1] >> 14) & 0x02);
+
+        const float scale = component_range / half_steps;
+        const float a = (float(data[0] & 0x7FFF) - half_steps) * scale;
+        const float b = (float(data[1] & 0x7FFF) - half_steps) * scale;
+        const float c = (float(data[2] & 0x7FFF) - half_steps) * scale;
+        const float d = std::sqrt(std::max(0.0f, 1.0f - (a * a + b * b + c * c)));
+
+        // Insert the recomputed component without branching: the index is effectively random from one key to the next.
+        // The result is already unit length (up to quantization), so skip the normalization of Quaternion's constructors.
+        const std::array<float, 3> abc = {a, b, c};
+        Quaternion<> quat;
+        for(usize i = 0; i != 4; ++i) {
+            quat.as_vec()[i] = i == largest ? d : abc[i < largest ? i : i - 1];
+        }
+        return quat;
+    }
+
+    bool operator==(const PackedQuaternion&) const = default;
+};
+
+static_assert(sizeof(PackedQuaternion) == 6);
+static_assert(std::is_trivially_copyable_v<PackedQuaternion>);
+
+}
+}
+
+#endif // Y_MATH_QUANTIZATION_H
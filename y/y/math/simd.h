@@ -0,0 +1,291 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#ifndef Y_MATH_SIMD_H
+#define Y_MATH_SIMD_H
+
+#include <y/utils.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define Y_MATH_SSE
+#include <immintrin.h>
+#endif
+
+// SSE (and AVX/FMA when enabled at compile time) kernels for float 4x4 matrices and quaternions.
+// Matrices are column major, like math::Matrix. Pointers don't need to be aligned but outputs must not alias inputs.
+// Callers are expected to fall back to the generic code when Y_MATH_SSE is not defined or in constant evaluation.
+
+namespace y {
+namespace math {
+namespace simd {
+
+#ifdef Y_MATH_SSE
+
+namespace detail {
+inline __m128 madd(__m128 a, __m128 b, __m128 c) {
+#ifdef __FMA__
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+template<int X, int Y, int Z, int W>
+inline __m128 swizzle(__m128 v) {
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(W, Z, Y, X));
+}
+
+template<int I>
+inline __m128 splat(__m128 v) {
+    return swizzle<I, I, I, I>(v);
+}
+
+// The w component of the result is 0
+inline __m128 cross3(__m128 a, __m128 b) {
+    const __m128 a_yzx = swizzle<1, 2, 0, 3>(a);
+    const __m128 b_yzx = swizzle<1, 2, 0, 3>(b);
+    const __m128 c = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+    return swizzle<1, 2, 0, 3>(c);
+}
+
+// Sums each of the 4 vectors
+inline __m128 horizontal_sums(__m128 a, __m128 b, __m128 c, __m128 d) {
+    _MM_TRANSPOSE4_PS(a, b, c, d);
+    return _mm_add_ps(_mm_add_ps(a, b), _mm_add_ps(c, d));
+}
+
+inline __m128 load3(const float* v) {
+    return _mm_setr_ps(v[0], v[1], v[2], 0.0f);
+}
+
+inline void store3(float* out, __m128 v) {
+    alignas(16) float tmp[4];
+    _mm_store_ps(tmp, v);
+    out[0] = tmp[0];
+    out[1] = tmp[1];
+    out[2] = tmp[2];
+}
+
+inline __m128 mul_mat4_vec4(__m128 c0, __m128 c1, __m128 c2, __m128 c3, __m128 v) {
+    __m128 r = _mm_mul_ps(c0, splat<0>(v));
+    r = madd(c1, splat<1>(v), r);
+    r = madd(c2, splat<2>(v), r);
+    r = madd(c3, splat<3>(v), r);
+    return r;
+}
+}
+
+inline void mul_mat4(const float* a, const float* b, float* out) {
+#ifdef __AVX__
+    // Two columns per iteration
+    const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 0));
+    const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 4));
+    const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 8));
+    const __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(a + 12));
+    for(usize i = 0; i != 16; i += 8) {
+        const __m256 col = _mm256_loadu_ps(b + i);
+        __m256 r = _mm256_mul_ps(a0, _mm256_permute_ps(col, 0x00));
+        r = _mm256_add_ps(r, _mm256_mul_ps(a1, _mm256_permute_ps(col, 0x55)));
+        r = _mm256_add_ps(r, _mm256_mul_ps(a2, _mm256_permute_ps(col, 0xAA)));
+        r = _mm256_add_ps(r, _mm256_mul_ps(a3, _mm256_permute_ps(col, 0xFF)));
+        _mm256_storeu_ps(out + i, r);
+    }
+#else
+    const __m128 a0 = _mm_loadu_ps(a + 0);
+    const __m128 a1 = _mm_loadu_ps(a + 4);
+    const __m128 a2 = _mm_loadu_ps(a + 8);
+    const __m128 a3 = _mm_loadu_ps(a + 12);
+    for(usize i = 0; i != 16; i += 4) {
+        _mm_storeu_ps(out + i, detail::mul_mat4_vec4(a0, a1, a2, a3, _mm_loadu_ps(b + i)));
+    }
+#endif
+}
+
+inline void mul_mat4_vec4(const float* m, const float* v, float* out) {
+    const __m128 r = detail::mul_mat4_vec4(
+        _mm_loadu_ps(m + 0), _mm_loadu_ps(m + 4), _mm_loadu_ps(m + 8), _mm_loadu_ps(m + 12),
+        _mm_loadu_ps(v)
+    );
+    _mm_storeu_ps(out, r);
+}
+
+// Returns false if the matrix is singular, out is left untouched
+inline bool inverse_mat4(const float* m, float* out) {
+    using namespace detail;
+
+    // From Lengyel, Foundations of Game Engine Development, Vol 1, 1.7.5
+    const __m128 a = _mm_loadu_ps(m + 0);
+    const __m128 b = _mm_loadu_ps(m + 4);
+    const __m128 c = _mm_loadu_ps(m + 8);
+    const __m128 d = _mm_loadu_ps(m + 12);
+
+    const __m128 x = splat<3>(a);
+    const __m128 y = splat<3>(b);
+    const __m128 z = splat<3>(c);
+    const __m128 w = splat<3>(d);
+
+    // All have 0 as w
+    __m128 s = cross3(a, b);
+    __m128 t = cross3(c, d);
+    __m128 u = _mm_sub_ps(_mm_mul_ps(y, a), _mm_mul_ps(x, b));
+    __m128 v = _mm_sub_ps(_mm_mul_ps(w, c), _mm_mul_ps(z, d));
+
+    const __m128 det_v = horizontal_sums(_mm_add_ps(_mm_mul_ps(s, v), _mm_mul_ps(t, u)), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps());
+    const float det = _mm_cvtss_f32(det_v);
+    if(det == 0.0f) {
+        return false;
+    }
+
+    const __m128 inv_det = _mm_div_ps(_mm_set1_ps(1.0f), splat<0>(det_v));
+    s = _mm_mul_ps(s, inv_det);
+    t = _mm_mul_ps(t, inv_det);
+    u = _mm_mul_ps(u, inv_det);
+    v = _mm_mul_ps(v, inv_det);
+
+    __m128 r0 = madd(t, y, cross3(b, v));
+    __m128 r1 = _mm_sub_ps(cross3(v, a), _mm_mul_ps(t, x));
+    __m128 r2 = madd(s, w, cross3(d, u));
+    __m128 r3 = _mm_sub_ps(cross3(u, c), _mm_mul_ps(s, z));
+
+    // Last column of the inverse
+    const __m128 dots = horizontal_sums(_mm_mul_ps(b, t), _mm_mul_ps(a, t), _mm_mul_ps(d, s), _mm_mul_ps(c, s));
+    const __m128 col3 = _mm_mul_ps(dots, _mm_setr_ps(-1.0f, 1.0f, -1.0f, 1.0f));
+
+    // r0-r3 are the rows of the inverse
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    _mm_storeu_ps(out + 0, r0);
+    _mm_storeu_ps(out + 4, r1);
+    _mm_storeu_ps(out + 8, r2);
+    _mm_storeu_ps(out + 12, col3);
+    return true;
+}
+
+// Assumes that the last row is (0, 0, 0, 1)
+// Returns false if the matrix is singular, out is left untouched
+inline bool affine_inverse_mat4(const float* m, float* out) {
+    using namespace detail;
+
+    const __m128 a = _mm_loadu_ps(m + 0);
+    const __m128 b = _mm_loadu_ps(m + 4);
+    const __m128 c = _mm_loadu_ps(m + 8);
+    const __m128 d = _mm_loadu_ps(m + 12);
+
+    // Rows of the inverse of the upper 3x3
+    __m128 r0 = cross3(b, c);
+    __m128 r1 = cross3(c, a);
+    __m128 r2 = cross3(a, b);
+    __m128 r3 = _mm_setzero_ps();
+
+    const __m128 det_v = horizontal_sums(_mm_mul_ps(r2, c), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps());
+    const float det = _mm_cvtss_f32(det_v);
+    if(det == 0.0f) {
+        return false;
+    }
+
+    const __m128 inv_det = _mm_div_ps(_mm_set1_ps(1.0f), splat<0>(det_v));
+    r0 = _mm_mul_ps(r0, inv_det);
+    r1 = _mm_mul_ps(r1, inv_det);
+    r2 = _mm_mul_ps(r2, inv_det);
+
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    // -inverse(upper 3x3) * translation, with 1 as w
+    __m128 col3 = _mm_mul_ps(r0, splat<0>(d));
+    col3 = madd(r1, splat<1>(d), col3);
+    col3 = madd(r2, splat<2>(d), col3);
+    col3 = _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), col3);
+
+    _mm_storeu_ps(out + 0, r0);
+    _mm_storeu_ps(out + 4, r1);
+    _mm_storeu_ps(out + 8, r2);
+    _mm_storeu_ps(out + 12, col3);
+    return true;
+}
+
+// v and out are 3 floats
+inline void transform_direction(const float* m, const float* v, float* out) {
+    using namespace detail;
+
+    const __m128 vec = load3(v);
+    __m128 r = _mm_mul_ps(_mm_loadu_ps(m + 0), splat<0>(vec));
+    r = madd(_mm_loadu_ps(m + 4), splat<1>(vec), r);
+    r = madd(_mm_loadu_ps(m + 8), splat<2>(vec), r);
+    store3(out, r);
+}
+
+// v and out are 3 floats
+inline void transform_point(const float* m, const float* v, float* out) {
+    using namespace detail;
+
+    const __m128 vec = load3(v);
+    __m128 r = _mm_loadu_ps(m + 12);
+    r = madd(_mm_loadu_ps(m + 0), splat<0>(vec), r);
+    r = madd(_mm_loadu_ps(m + 4), splat<1>(vec), r);
+    r = madd(_mm_loadu_ps(m + 8), splat<2>(vec), r);
+    store3(out, r);
+}
+
+// Quaternions are stored as (x, y, z, w)
+inline void quat_mul(const float* a, const float* b, float* out) {
+    using namespace detail;
+
+    const __m128 qa = _mm_loadu_ps(a);
+    const __m128 qb = _mm_loadu_ps(b);
+    const __m128 neg_w = _mm_setr_ps(1.0f, 1.0f, 1.0f, -1.0f);
+
+    // x = aw * bx + ax * bw + ay * bz - az * by
+    // y = aw * by + ay * bw + az * bx - ax * bz
+    // z = aw * bz + az * bw + ax * by - ay * bx
+    // w = aw * bw - ax * bx - ay * by - az * bz
+    __m128 r = _mm_mul_ps(splat<3>(qa), qb);
+    r = madd(_mm_mul_ps(swizzle<0, 1, 2, 0>(qa), swizzle<3, 3, 3, 0>(qb)), neg_w, r);
+    r = madd(_mm_mul_ps(swizzle<1, 2, 0, 1>(qa), swizzle<2, 0, 1, 1>(qb)), neg_w, r);
+    r = _mm_sub_ps(r, _mm_mul_ps(swizzle<2, 0, 1, 2>(qa), swizzle<1, 2, 0, 2>(qb)));
+    _mm_storeu_ps(out, r);
+}
+
+// v and out are 3 floats
+inline void quat_rotate(const float* q, const float* v, float* out) {
+    using namespace detail;
+
+    const __m128 quat = _mm_loadu_ps(q);
+    const __m128 u = _mm_and_ps(quat, _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0)));
+    const __m128 vec = load3(v);
+    const __m128 w = splat<3>(quat);
+
+    // u * 2 * u.dot(v) + v * (w * w - u.length2()) + u.cross(v) * 2 * w
+    const __m128 dots = horizontal_sums(_mm_mul_ps(u, vec), _mm_mul_ps(u, u), _mm_setzero_ps(), _mm_setzero_ps());
+    const __m128 two = _mm_set1_ps(2.0f);
+
+    __m128 r = _mm_mul_ps(u, _mm_mul_ps(two, splat<0>(dots)));
+    r = madd(vec, _mm_sub_ps(_mm_mul_ps(w, w), splat<1>(dots)), r);
+    r = madd(cross3(u, vec), _mm_mul_ps(two, w), r);
+    store3(out, r);
+}
+
+#endif
+
+}
+}
+}
+
+#endif // Y_MATH_SIMD_H
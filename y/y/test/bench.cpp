@@ -0,0 +1,217 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include "bench.h"
+
+#include <y/utils/log.h>
+#include <y/utils/format.h>
+
+#include <algorithm>
+#include <cstring>
+#include <cmath>
+
+#include <iostream>
+
+namespace y {
+namespace test {
+namespace detail {
+
+static BenchItem* first_bench = nullptr;
+
+void register_bench(BenchItem* bench) {
+    bench->next = first_bench;
+    first_bench = bench;
+}
+
+static const char* pretty_time(double ns) {
+    if(ns < 1000.0) {
+        return fmt_c_str("{:.2f} ns", ns);
+    }
+    if(ns < 1000000.0) {
+        return fmt_c_str("{:.2f} us", ns / 1000.0);
+    }
+    if(ns < 1000000000.0) {
+        return fmt_c_str("{:.2f} ms", ns / 1000000.0);
+    }
+    return fmt_c_str("{:.2f} s", ns / 1000000000.0);
+}
+
+static BenchResult run_bench(const BenchItem* item, const BenchSettings& settings) {
+    y::detail::setup_console();
+
+    std::cout << item->name << ":";
+    for(usize size = std::strlen(item->name) + 1; size < 80 - 11; ++size) {
+        std::cout << " ";
+    }
+    std::cout << std::flush;
+
+    Bench bench(item->name, settings);
+    (item->bench_func)(bench);
+
+    const BenchResult& result = bench.result();
+    std::cout << pretty_time(result.median_ns);
+    if(const double items = result.items_per_second(); items > 0.0) {
+        std::cout << fmt(" ({:.2f} Mitems/s)", items / 1000000.0);
+    }
+    if(const double bytes = result.bytes_per_second(); bytes > 0.0) {
+        std::cout << fmt(" ({:.2f} MB/s)", bytes / (1024.0 * 1024.0));
+    }
+    std::cout << std::endl;
+
+    return result;
+}
+
+}
+
+
+double BenchResult::items_per_second() const {
+    return median_ns > 0.0 ? items_per_iteration * 1000000000.0 / median_ns : 0.0;
+}
+
+double BenchResult::bytes_per_second() const {
+    return median_ns > 0.0 ? bytes_per_iteration * 1000000000.0 / median_ns : 0.0;
+}
+
+
+
+Bench::Bench(const char* name, const BenchSettings& settings) : _settings(settings) {
+    _result.name = name;
+}
+
+void Bench::set_items_per_iteration(u64 items) {
+    _result.items_per_iteration = items;
+}
+
+void Bench::set_bytes_per_iteration(u64 bytes) {
+    _result.bytes_per_iteration = bytes;
+}
+
+const BenchResult& Bench::result() const {
+    return _result;
+}
+
+void Bench::measure_internal(u64 (*timed)(void*, void*, u64), void* loop, void* setup) {
+    const u64 min_sample_ns = std::max(_settings.min_sample_time.to_nanos(), u64(1));
+
+    // Calibrate so that each sample lasts at least min_sample_time
+    u64 iterations = 1;
+    for(;;) {
+        const u64 ns = timed(loop, setup, iterations);
+        if(ns >= min_sample_ns) {
+            break;
+        }
+        const double factor = ns ? std::clamp(1.2 * double(min_sample_ns) / double(ns), 2.0, 10.0) : 10.0;
+        iterations = u64(std::ceil(double(iterations) * factor));
+    }
+
+    {
+        core::Chrono warmup;
+        while(warmup.elapsed() < _settings.warmup) {
+            timed(loop, setup, iterations);
+        }
+    }
+
+    core::Vector<double> samples;
+    {
+        u64 total_ns = 0;
+        const u64 max_total_ns = _settings.max_total_time.to_nanos();
+        while(samples.size() < _settings.max_samples && (samples.size() < _settings.min_samples || total_ns < max_total_ns)) {
+            const u64 ns = timed(loop, setup, iterations);
+            total_ns += ns;
+            samples << double(ns) / double(iterations);
+        }
+    }
+
+    y_always_assert(!samples.is_empty(), "No benchmark sample");
+
+    std::sort(samples.begin(), samples.end());
+
+    double sum = 0.0;
+    for(const double s : samples) {
+        sum += s;
+    }
+
+    const usize p99_index = std::min(samples.size() - 1, usize(std::ceil(samples.size() * 0.99)) - 1);
+
+    _result.samples = samples.size();
+    _result.iterations = iterations * samples.size();
+    _result.min_ns = samples[0];
+    _result.median_ns = samples[samples.size() / 2];
+    _result.p99_ns = samples[p99_index];
+    _result.mean_ns = sum / samples.size();
+}
+
+
+
+usize bench_count() {
+    usize count = 0;
+    for(detail::BenchItem* bench = detail::first_bench; bench; bench = bench->next) {
+        ++count;
+    }
+    return count;
+}
+
+core::Vector<BenchResult> run_benchmarks(const BenchSettings& settings) {
+    core::Vector<BenchResult> results;
+    for(detail::BenchItem* bench = detail::first_bench; bench; bench = bench->next) {
+        if(!settings.filter.empty() && std::string_view(bench->name).find(settings.filter) == std::string_view::npos) {
+            continue;
+        }
+        results << detail::run_bench(bench, settings);
+    }
+    return results;
+}
+
+core::String results_to_json(core::Span<BenchResult> results) {
+    core::String json = "{\n    \"benchmarks\": [";
+
+    bool separator = false;
+    for(const BenchResult& result : results) {
+        core::String name;
+        for(const char c : result.name) {
+            if(c == '"' || c == '\\') {
+                name.push_back('\\');
+            }
+            name.push_back(c);
+        }
+
+        fmt_into(json, "{}\n        {{\n", separator ? "," : "");
+        fmt_into(json, "            \"name\": \"{}\",\n", name);
+        fmt_into(json, "            \"samples\": {},\n", result.samples);
+        fmt_into(json, "            \"iterations\": {},\n", result.iterations);
+        fmt_into(json, "            \"min_ns\": {},\n", result.min_ns);
+        fmt_into(json, "            \"median_ns\": {},\n", result.median_ns);
+        fmt_into(json, "            \"p99_ns\": {},\n", result.p99_ns);
+        fmt_into(json, "            \"mean_ns\": {},\n", result.mean_ns);
+        fmt_into(json, "            \"items_per_second\": {},\n", result.items_per_second());
+        fmt_into(json, "            \"bytes_per_second\": {}\n", result.bytes_per_second());
+        json += "        }";
+
+        separator = true;
+    }
+
+    json += "\n    ]\n}\n";
+    return json;
+}
+
+}
+}
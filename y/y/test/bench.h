@@ -0,0 +1,202 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#ifndef Y_TEST_BENCH_H
+#define Y_TEST_BENCH_H
+
+#include <y/core/Vector.h>
+#include <y/core/String.h>
+#include <y/core/Chrono.h>
+
+#include <atomic>
+
+namespace y {
+namespace test {
+
+class Bench;
+
+namespace detail {
+struct BenchItem {
+    const char* name = "Unknown benchmark";
+    void (*bench_func)(Bench&) = nullptr;
+    BenchItem* next = nullptr;
+};
+
+void register_bench(BenchItem* bench);
+}
+
+
+// Prevents the compiler from optimizing away the computation of t
+template<typename T>
+inline void do_not_optimize(T& t) {
+#if defined(Y_GNU)
+    asm volatile("" : "+m"(t) : : "memory");
+#else
+    static volatile const void* sink = nullptr;
+    sink = &t;
+#endif
+}
+
+template<typename T>
+inline void do_not_optimize(const T& t) {
+#if defined(Y_GNU)
+    asm volatile("" : : "r"(&t) : "memory");
+#else
+    static volatile const void* sink = nullptr;
+    sink = &t;
+#endif
+}
+
+// Forces all pending writes to memory to be considered observable
+inline void clobber_memory() {
+#if defined(Y_GNU)
+    asm volatile("" : : : "memory");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+
+struct BenchSettings {
+    core::Duration warmup = core::Duration::milliseconds(50.0);
+    core::Duration min_sample_time = core::Duration::milliseconds(2.0);
+    core::Duration max_total_time = core::Duration::seconds(1.0);
+
+    usize min_samples = 16;
+    usize max_samples = 256;
+
+    std::string_view filter;
+};
+
+struct BenchResult {
+    core::String name;
+
+    usize samples = 0;
+    u64 iterations = 0;
+
+    // All timings are per iteration
+    double min_ns = 0.0;
+    double median_ns = 0.0;
+    double p99_ns = 0.0;
+    double mean_ns = 0.0;
+
+    u64 items_per_iteration = 0;
+    u64 bytes_per_iteration = 0;
+
+    double items_per_second() const;
+    double bytes_per_second() const;
+};
+
+
+class Bench : NonMovable {
+    public:
+        Bench(const char* name, const BenchSettings& settings);
+
+        // Runs f in a loop: f is called once per iteration, timings are reported per iteration
+        template<typename F>
+        void run(F&& f) {
+            measure([&](u64 iterations) {
+                for(u64 i = 0; i != iterations; ++i) {
+                    f();
+                    clobber_memory();
+                }
+            });
+        }
+
+        // Like run, but setup is called (untimed) before each sample, with the number of iterations it will cover
+        template<typename S, typename F>
+        void run(S&& setup, F&& f) {
+            measure([&](u64 iterations) {
+                for(u64 i = 0; i != iterations; ++i) {
+                    f();
+                    clobber_memory();
+                }
+            }, [&](u64 iterations) {
+                setup(iterations);
+            });
+        }
+
+        void set_items_per_iteration(u64 items);
+        void set_bytes_per_iteration(u64 bytes);
+
+        const BenchResult& result() const;
+
+    private:
+        template<typename F>
+        void measure(F&& loop) {
+            measure(loop, [](u64) {});
+        }
+
+        template<typename F, typename S>
+        void measure(F&& loop, S&& setup) {
+            u64 (*timed)(void*, void*, u64) = [](void* l, void* s, u64 iterations) -> u64 {
+                (*static_cast<std::remove_reference_t<S>*>(s))(iterations);
+                core::Chrono chrono;
+                (*static_cast<std::remove_reference_t<F>*>(l))(iterations);
+                return chrono.elapsed().to_nanos();
+            };
+            measure_internal(timed, &loop, &setup);
+        }
+
+        void measure_internal(u64 (*timed)(void*, void*, u64), void* loop, void* setup);
+
+        BenchSettings _settings;
+        BenchResult _result;
+};
+
+
+usize bench_count();
+core::Vector<BenchResult> run_benchmarks(const BenchSettings& settings = {});
+
+core::String results_to_json(core::Span<BenchResult> results);
+
+}
+}
+
+#define Y_BENCH_FUNC y_create_name_with_prefix(bench_func)
+#define Y_BENCH_RUNNER y_create_name_with_prefix(bench_runner)
+
+#ifdef Y_BUILD_BENCHMARKS
+
+// The benchmark body receives a y::test::Bench& named "bench"
+#define y_bench_func(name)                                                                              \
+static void Y_BENCH_FUNC(y::test::Bench&);                                                              \
+namespace {                                                                                             \
+    class Y_BENCH_RUNNER {                                                                              \
+        Y_BENCH_RUNNER() : bench_item({name, &Y_BENCH_FUNC, nullptr}) {                                 \
+            y::test::detail::register_bench(&bench_item);                                               \
+        }                                                                                               \
+        y::test::detail::BenchItem bench_item;                                                          \
+        static Y_BENCH_RUNNER runner;                                                                   \
+    };                                                                                                  \
+    Y_BENCH_RUNNER Y_BENCH_RUNNER::runner = Y_BENCH_RUNNER();                                           \
+}                                                                                                       \
+void Y_BENCH_FUNC([[maybe_unused]] y::test::Bench& bench)
+
+#else
+
+#define y_bench_func(name)                                                                              \
+[[maybe_unused]]                                                                                        \
+static void Y_BENCH_FUNC([[maybe_unused]] y::test::Bench& bench)
+
+#endif
+
+#endif // Y_TEST_BENCH_H
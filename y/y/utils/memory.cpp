@@ -0,0 +1,81 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include "memory.h"
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+
+namespace y {
+namespace memory {
+
+static constinit thread_local u32 this_thread_tag = 0;
+
+static std::array<std::atomic<const char*>, max_tags> tag_names = {};
+static std::atomic<usize> registered_tags = 1;
+
+
+u32 register_tag(const char* name) {
+    static std::mutex lock;
+
+    const std::unique_lock l(lock);
+
+    const usize count = registered_tags;
+    for(usize i = 1; i != count; ++i) {
+        if(std::strcmp(tag_names[i], name) == 0) {
+            return u32(i);
+        }
+    }
+
+    y_always_assert(count < max_tags, "Too many memory tags");
+
+    tag_names[count] = name;
+    registered_tags = count + 1;
+
+    return u32(count);
+}
+
+const char* tag_name(u32 tag) {
+    if(!tag || tag >= registered_tags) {
+        return "untagged";
+    }
+    return tag_names[tag];
+}
+
+usize tag_count() {
+    return registered_tags;
+}
+
+u32 current_tag() {
+    return this_thread_tag;
+}
+
+namespace detail {
+u32 set_current_tag(u32 tag) {
+    return std::exchange(this_thread_tag, tag);
+}
+}
+
+}
+}
@@ -49,7 +49,45 @@ constexpr U align_up_to_max(U size) {
     return align_up_to(size, U(max_alignment));
 }
 
+
+namespace memory {
+
+// Allocation tags: allocation hooks (like the editor's global new/delete) can
+// attribute heap allocations to the tag that is active on the allocating thread.
+// Tag 0 is reserved for untagged allocations.
+
+static constexpr usize max_tags = 32;
+
+u32 register_tag(const char* name);
+const char* tag_name(u32 tag);
+usize tag_count();
+
+u32 current_tag();
+
+namespace detail {
+u32 set_current_tag(u32 tag);
+}
+
+class ScopedTag : NonMovable {
+    public:
+        inline ScopedTag(u32 tag) : _previous(detail::set_current_tag(tag)) {
+        }
+
+        inline ~ScopedTag() {
+            detail::set_current_tag(_previous);
+        }
+
+    private:
+        u32 _previous = 0;
+};
+
 }
 
+}
+
+#define y_memory_tag(name)                                                                                  \
+    static const u32 y_create_name_with_prefix(mem_tag_index) = y::memory::register_tag(name);              \
+    const y::memory::ScopedTag y_create_name_with_prefix(mem_tag)(y_create_name_with_prefix(mem_tag_index))
+
 #endif // Y_UTILS_MEMORY_H
 
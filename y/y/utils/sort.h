@@ -26,6 +26,7 @@ SOFTWARE.
 
 #include <array>
 #include <algorithm>
+#include <functional>
 
 
 namespace y {
@@ -71,6 +72,23 @@ static constexpr void ct_sort(std::array<T, N>& arr, usize left, usize right, C
 }
 }
 
+// Splits a sorted range into runs of consecutive elements for which same_run(first_of_run, elem) is true.
+// Calls on_run(offset, size) for every run, in order. Runs are contiguous and cover the whole range.
+template<typename It, typename E, typename F>
+inline void for_each_run(It b, It e, E&& same_run, F&& on_run) {
+    usize offset = 0;
+    while(b != e) {
+        usize size = 1;
+        It next = b;
+        while(++next != e && same_run(*b, *next)) {
+            ++size;
+        }
+        on_run(offset, size);
+        offset += size;
+        b = next;
+    }
+}
+
 template <typename T, usize N, typename C = std::less<>>
 constexpr std::array<T, N> ct_sort(std::array<T, N> arr, C comp = C()) {
     const std::array<T, N> sorted = arr;
@@ -24,34 +24,143 @@ SOFTWARE.
 
 namespace yave {
 
-AnimationChannel::AnimationChannel(const core::String& name, core::Vector<BoneKey>&& keys) : _name(name), _keys(keys) {
-    if(_keys.is_empty()) {
+template<typename T>
+static void collapse_constant_track(core::Vector<T>& track) {
+    if(std::all_of(track.begin(), track.end(), [&](const T& k) { return k == track[0]; })) {
+        track.shrink_to(1);
+        track.squeeze();
+    }
+}
+
+template<typename T>
+static const T& track_key(const core::Vector<T>& track, usize index) {
+    return track[track.size() == 1 ? 0 : index];
+}
+
+template<typename F>
+static math::QuantizationRange compute_range(core::Span<AnimationChannel::BoneKey> keys, F&& get) {
+    math::Vec3 min(std::numeric_limits<float>::max());
+    math::Vec3 max(-std::numeric_limits<float>::max());
+    for(const AnimationChannel::BoneKey& key : keys) {
+        const math::Vec3 v = get(key.local_transform);
+        for(usize i = 0; i != 3; ++i) {
+            min[i] = std::min(min[i], v[i]);
+            max[i] = std::max(max[i], v[i]);
+        }
+    }
+    return math::QuantizationRange::from_bounds(min, max);
+}
+
+
+AnimationChannel::AnimationChannel(const core::String& name, core::Vector<BoneKey>&& keys) : _name(name) {
+    if(keys.is_empty()) {
         y_fatal("Empty animation channel.");
     }
+
+    y_debug_assert(std::is_sorted(keys.begin(), keys.end(), [](const BoneKey& a, const BoneKey& b) { return a.time < b.time; }));
+
+    _position_range = compute_range(keys, [](const BoneTransform& tr) { return tr.position; });
+    _scale_range = compute_range(keys, [](const BoneTransform& tr) { return tr.scale; });
+
+    _times.set_min_capacity(keys.size());
+    _positions.set_min_capacity(keys.size());
+    _rotations.set_min_capacity(keys.size());
+    _scales.set_min_capacity(keys.size());
+
+    for(const BoneKey& key : keys) {
+        _times << key.time;
+        _positions << _position_range.quantize(key.local_transform.position);
+        _rotations << math::PackedQuaternion::pack(key.local_transform.rotation);
+        _scales << _scale_range.quantize(key.local_transform.scale);
+    }
+
+    collapse_constant_track(_positions);
+    collapse_constant_track(_rotations);
+    collapse_constant_track(_scales);
 }
 
 math::Transform<> AnimationChannel::bone_transform(float time) const {
-    auto key = std::find_if(_keys.begin(), _keys.end(), [=](const auto& k) { return k.time > time; });
+    u32 cursor = 0;
+    return sample(time, cursor).to_transform();
+}
+
+BoneTransform AnimationChannel::sample(float time, u32& cursor) const {
+    y_debug_assert(!_times.is_empty());
 
-    const auto next = key == _keys.end() ? _keys.begin() : key;
-    key = key == _keys.begin() ? key : std::prev(key);
+    const usize key = find_key(time, cursor);
+    const usize next = std::min(key + 1, _times.size() - 1);
+    cursor = u32(key);
 
-    float delta = next->time - key->time;
-    delta = delta < 0.0f ? delta + _keys.last().time : delta;
+    const float delta = _times[next] - _times[key];
+    const float factor = delta > 0.0f ? std::clamp((time - _times[key]) / delta, 0.0f, 1.0f) : 0.0f;
+    const float q = 1.0f - factor;
 
-    const float factor = (time - key->time) / delta;
+    BoneTransform tr;
+    tr.position = _position_range.dequantize(track_key(_positions, key)) * q + _position_range.dequantize(track_key(_positions, next)) * factor;
+    tr.scale = _scale_range.dequantize(track_key(_scales, key)) * q + _scale_range.dequantize(track_key(_scales, next)) * factor;
 
-    return key->local_transform.lerp(next->local_transform, factor);
+    const math::PackedQuaternion& rot = track_key(_rotations, key);
+    const math::PackedQuaternion& next_rot = track_key(_rotations, next);
+    tr.rotation = rot == next_rot ? rot.unpack() : rot.unpack().slerp(next_rot.unpack(), factor);
+
+    return tr;
 }
 
+// Index of the last key at or before time, 0 if time is before the first key
+usize AnimationChannel::find_key(float time, u32 cursor) const {
+    const usize count = _times.size();
+
+    usize key = cursor < count ? cursor : 0;
+    if(_times[key] <= time) {
+        static constexpr usize max_linear_steps = 4;
+        for(usize i = 0; i != max_linear_steps; ++i) {
+            if(key + 1 == count || _times[key + 1] > time) {
+                return key;
+            }
+            ++key;
+        }
+    }
+
+    const auto it = std::upper_bound(_times.begin(), _times.end(), time);
+    return it == _times.begin() ? 0 : usize(it - _times.begin()) - 1;
+}
 
 const core::String& AnimationChannel::name() const {
     return _name;
 }
 
-core::Span<AnimationChannel::BoneKey> AnimationChannel::keys() const {
-    return _keys;
+usize AnimationChannel::key_count() const {
+    return _times.size();
+}
+
+AnimationChannel::BoneKey AnimationChannel::key(usize index) const {
+    BoneKey key = {};
+    key.time = _times[index];
+    key.local_transform.position = _position_range.dequantize(track_key(_positions, index));
+    key.local_transform.rotation = track_key(_rotations, index).unpack();
+    key.local_transform.scale = _scale_range.dequantize(track_key(_scales, index));
+    return key;
 }
 
+core::Span<float> AnimationChannel::times() const {
+    return _times;
 }
 
+float AnimationChannel::max_position_error() const {
+    return _position_range.max_error();
+}
+
+float AnimationChannel::max_scale_error() const {
+    return _scale_range.max_error();
+}
+
+usize AnimationChannel::byte_size() const {
+    return sizeof(*this) +
+        _name.size() +
+        _times.size() * sizeof(float) +
+        _positions.size() * sizeof(math::Vec<3, u16>) +
+        _rotations.size() * sizeof(math::PackedQuaternion) +
+        _scales.size() * sizeof(math::Vec<3, u16>);
+}
+
+}
@@ -25,6 +25,7 @@ SOFTWARE.
 #include <yave/meshes/Bone.h>
 
 #include <y/core/Vector.h>
+#include <y/math/quantization.h>
 
 namespace yave {
 
@@ -40,18 +41,44 @@ class AnimationChannel {
 
         math::Transform<> bone_transform(float time) const;
 
+        // cursor is the index of the last sampled key, it is updated so that playing forward only moves it a little.
+        // Seeking backward falls back to a binary search.
+        BoneTransform sample(float time, u32& cursor) const;
+
         const core::String& name() const;
-        core::Span<BoneKey> keys() const;
+
+        usize key_count() const;
+        BoneKey key(usize index) const;
+
+        core::Span<float> times() const;
+
+        // Maximum error introduced by quantization on positions and scales. Rotations are bounded by math::PackedQuaternion::max_error
+        float max_position_error() const;
+        float max_scale_error() const;
+
+        usize byte_size() const;
 
 
-        y_reflect(AnimationChannel, _name, _keys)
+        y_reflect(AnimationChannel, _name, _times, _position_range, _scale_range, _positions, _rotations, _scales)
 
     private:
+        usize find_key(float time, u32 cursor) const;
+
         core::String _name;
-        core::Vector<BoneKey> _keys;
+
+        // Keys are stored per component to keep sampling cache friendly.
+        // Positions and scales are reduced to 16 bits per component over the channel's range and rotations use the smallest three encoding.
+        // A track that doesn't change over the whole channel only stores its first key.
+        core::Vector<float> _times;
+
+        math::QuantizationRange _position_range;
+        math::QuantizationRange _scale_range;
+
+        core::Vector<math::Vec<3, u16>> _positions;
+        core::Vector<math::PackedQuaternion> _rotations;
+        core::Vector<math::Vec<3, u16>> _scales;
 };
 
 }
 
 #endif // YAVE_ANIMATIONS_ANIMATIONCHANNEL_H
-
@@ -0,0 +1,87 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include "AnimationClip.h"
+
+#include <y/core/HashMap.h>
+
+namespace yave {
+
+AnimationClip::AnimationClip(const Animation* animation, const Skeleton* skeleton) : _animation(animation), _skeleton(skeleton) {
+    y_debug_assert(_animation && _skeleton);
+
+    const core::Span<AnimationChannel> channels = _animation->channels();
+
+    core::FlatHashMap<std::string_view, u32> channel_indices;
+    channel_indices.reserve(channels.size());
+    for(usize i = 0; i != channels.size(); ++i) {
+        channel_indices.insert({channels[i].name(), u32(i)});
+    }
+
+    const core::Span<Bone> bones = _skeleton->bones();
+    _bone_channels.set_min_capacity(bones.size());
+    for(const Bone& bone : bones) {
+        const auto it = channel_indices.find(std::string_view(bone.name));
+        _bone_channels << (it == channel_indices.end() ? no_channel : it->second);
+    }
+}
+
+bool AnimationClip::is_null() const {
+    return !_animation;
+}
+
+const Animation* AnimationClip::animation() const {
+    return _animation;
+}
+
+const Skeleton* AnimationClip::skeleton() const {
+    return _skeleton;
+}
+
+float AnimationClip::duration() const {
+    return _animation ? _animation->duration() : 0.0f;
+}
+
+usize AnimationClip::bone_count() const {
+    return _bone_channels.size();
+}
+
+core::Span<u32> AnimationClip::bone_channels() const {
+    return _bone_channels;
+}
+
+void AnimationClip::sample(float time, core::MutableSpan<u32> cursors, core::MutableSpan<BoneTransform> local_pose) const {
+    y_debug_assert(cursors.size() >= _bone_channels.size());
+    y_debug_assert(local_pose.size() >= _bone_channels.size());
+
+    const core::Span<AnimationChannel> channels = _animation->channels();
+    const core::Span<Bone> bones = _skeleton->bones();
+
+    for(usize i = 0; i != _bone_channels.size(); ++i) {
+        const u32 channel = _bone_channels[i];
+        local_pose[i] = channel == no_channel
+            ? bones[i].local_transform
+            : channels[channel].sample(time, cursors[i]);
+    }
+}
+
+}
@@ -0,0 +1,64 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#ifndef YAVE_ANIMATIONS_ANIMATIONCLIP_H
+#define YAVE_ANIMATIONS_ANIMATIONCLIP_H
+
+#include "Animation.h"
+
+#include <yave/meshes/Skeleton.h>
+
+namespace yave {
+
+// An animation bound to a skeleton: channels are matched to bones once, by name, so that sampling only deals with indices.
+class AnimationClip {
+    public:
+        static constexpr u32 no_channel = u32(-1);
+
+        AnimationClip() = default;
+        AnimationClip(const Animation* animation, const Skeleton* skeleton);
+
+        bool is_null() const;
+
+        const Animation* animation() const;
+        const Skeleton* skeleton() const;
+
+        float duration() const;
+
+        usize bone_count() const;
+
+        // Channel index for each bone, or no_channel if the bone isn't animated
+        core::Span<u32> bone_channels() const;
+
+        // Writes the local transform of every bone at the given time. Bones without channel use their bind pose.
+        // cursors should be kept between calls (one per bone, zero initialized) to make sampling incremental.
+        void sample(float time, core::MutableSpan<u32> cursors, core::MutableSpan<BoneTransform> local_pose) const;
+
+    private:
+        const Animation* _animation = nullptr;
+        const Skeleton* _skeleton = nullptr;
+
+        core::Vector<u32> _bone_channels;
+};
+
+}
+
+#endif // YAVE_ANIMATIONS_ANIMATIONCLIP_H
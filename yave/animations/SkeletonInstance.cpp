@@ -24,52 +24,57 @@ SOFTWARE.
 
 namespace yave {
 
-SkeletonInstance::SkeletonInstance(const Skeleton* skeleton) :
-        _skeleton(skeleton),
-        _bone_transforms(new std::array<math::Transform<>, Skeleton::max_bones>()),
-        _bone_transform_buffer(Skeleton::max_bones),
-        _descriptor_set(Descriptor(_bone_transform_buffer)) {
-
-    flush_data();
+SkeletonInstance::SkeletonInstance(const Skeleton* skeleton) : _skeleton(skeleton) {
 }
 
 void SkeletonInstance::animate(const AssetPtr<Animation>& anim) {
     _animation = anim;
-    _anim_timer.reset();
+    _clip = AnimationClip();
+    _time = 0.0f;
 }
 
-void SkeletonInstance::update() {
-    if(!_animation) {
-        return;
-    }
-
-    const float time = std::fmod(float(_anim_timer.elapsed().to_secs()), _animation->duration());
-
-    const auto& anim = *_animation;
-    const auto& bones = _skeleton->bones();
-    const auto& bone_transforms = _skeleton->bone_transforms();
-    const auto& invs = _skeleton->inverse_absolute_transforms();
+bool SkeletonInstance::is_animated() const {
+    return _skeleton && _animation;
+}
 
-    auto& out_transforms = *_bone_transforms;
+const Skeleton* SkeletonInstance::skeleton() const {
+    return _skeleton;
+}
 
+usize SkeletonInstance::bone_count() const {
+    return _skeleton ? _skeleton->bones().size() : 0;
+}
 
-    for(usize i = 0; i != bones.size(); ++i) {
-        const auto& bone = bones[i];
-        auto bone_tr = anim.bone_transform(bone.name, time).value_or(bone_transforms[i]);
+u32 SkeletonInstance::bone_offset() const {
+    return _bone_offset;
+}
 
-        out_transforms[i] = (bone.has_parent() ? out_transforms[bone.parent] * bone_tr : bone_tr);
+bool SkeletonInstance::advance(float dt) {
+    if(!is_animated()) {
+        return false;
     }
-    for(usize i = 0; i != bones.size(); ++i) {
-        out_transforms[i] *= invs[i];
+
+    if(_clip.animation() != _animation.get()) {
+        _clip = AnimationClip(_animation.get(), _skeleton);
+        _key_cursors = core::Vector<u32>(_clip.bone_count(), 0);
     }
 
-    flush_data();
-}
+    const float duration = _clip.duration();
+    _time = duration > 0.0f ? std::fmod(_time + dt, duration) : 0.0f;
 
-void SkeletonInstance::flush_data() {
-    auto map = _bone_transform_buffer.map(MappingAccess::WriteOnly);
-    std::copy(_bone_transforms->begin(), _bone_transforms->end(), map.begin());
+    return true;
 }
 
+PoseJob SkeletonInstance::pose_job(core::MutableSpan<math::Transform<>> palette) {
+    y_debug_assert(!_clip.is_null());
+    y_debug_assert(palette.size() >= bone_count());
+
+    return PoseJob {
+        &_clip,
+        _time,
+        _key_cursors,
+        palette,
+    };
 }
 
+}
@@ -22,20 +22,22 @@ SOFTWARE.
 #ifndef YAVE_ANIMATIONS_SKELETONINSTANCE_H
 #define YAVE_ANIMATIONS_SKELETONINSTANCE_H
 
-#include <y/core/Chrono.h>
-
 #include <yave/assets/AssetPtr.h>
 #include <yave/meshes/Skeleton.h>
-#include <yave/graphics/buffers/Buffer.h>
-#include <yave/graphics/descriptors/DescriptorSet.h>
 
-#include "Animation.h"
+#include "pose.h"
+
+#include <y/serde3/serde.h>
 
 namespace yave {
 
+// Animation state of one skinned entity. Palettes aren't stored here:
+// AnimationSystem evaluates every instance in one batch and writes them to a single shared bone buffer.
 class SkeletonInstance {
 
     public:
+        static constexpr u32 no_bone_offset = u32(-1);
+
         SkeletonInstance() = default;
 
         // this seems unsafe...
@@ -43,27 +45,34 @@ class SkeletonInstance {
 
         void animate(const AssetPtr<Animation>& anim);
 
-        void update();
+        bool is_animated() const;
+
+        const Skeleton* skeleton() const;
+        usize bone_count() const;
+
+        // Index of the first bone of this instance in AnimationSystem's bone buffer, or no_bone_offset if it wasn't evaluated
+        u32 bone_offset() const;
 
-        const auto& descriptor_set() const {
-            return _descriptor_set;
-        }
+        // Advances the animation and binds it to the skeleton if it changed. Returns false if there is nothing to evaluate.
+        bool advance(float dt);
+
+        PoseJob pose_job(core::MutableSpan<math::Transform<>> palette);
+
+        y_no_serde3()
 
     private:
-        void flush_data();
+        friend class AnimationSystem;
 
         const Skeleton* _skeleton = nullptr;
-        std::unique_ptr<std::array<math::Transform<>, Skeleton::max_bones>> _bone_transforms;
-
-        TypedUniformBuffer<math::Transform<>, MemoryType::CpuVisible> _bone_transform_buffer;
-        DescriptorSet _descriptor_set;
 
         AssetPtr<Animation> _animation;
-        core::Chrono _anim_timer;
+        AnimationClip _clip;
+        core::Vector<u32> _key_cursors;
 
+        float _time = 0.0f;
+        u32 _bone_offset = no_bone_offset;
 };
 
 }
 
 #endif // YAVE_ANIMATIONS_SKELETONINSTANCE_H
-
@@ -0,0 +1,100 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#include "pose.h"
+
+#include <y/core/ScratchPad.h>
+
+namespace yave {
+
+// Small chunks aren't worth a task: a typical 100 bones skeleton takes a few µs to evaluate
+static constexpr usize min_jobs_per_chunk = 16;
+
+void compute_skinning_palette(const Skeleton& skeleton, core::Span<BoneTransform> local_pose, core::MutableSpan<math::Transform<>> palette) {
+    const core::Span<Bone> bones = skeleton.bones();
+    const core::Span<math::Transform<>> inverses = skeleton.inverse_absolute_transforms();
+
+    y_debug_assert(local_pose.size() >= bones.size());
+    y_debug_assert(palette.size() >= bones.size());
+
+    // The palette is usually mapped GPU memory which is very slow to read back,
+    // so model space transforms are built on the side and each palette entry is written once
+    core::ScratchPad<math::Transform<>> model(bones.size());
+
+    // Parents always come before their children, so model[parent] is already in model space
+    for(usize i = 0; i != bones.size(); ++i) {
+        const Bone& bone = bones[i];
+        const math::Transform<> local = local_pose[i].to_transform();
+        model[i] = bone.has_parent() ? model[bone.parent] * local : local;
+        palette[i] = model[i] * inverses[i];
+    }
+}
+
+static void evaluate_chunk(core::Span<PoseJob> jobs) {
+    core::ScratchPad<BoneTransform> local_pose(Skeleton::max_bones);
+
+    for(const PoseJob& job : jobs) {
+        y_debug_assert(job.clip && !job.clip->is_null());
+        y_debug_assert(job.clip->bone_count() <= local_pose.size());
+
+        job.clip->sample(job.time, job.key_cursors, local_pose);
+        compute_skinning_palette(*job.clip->skeleton(), local_pose, job.palette);
+    }
+}
+
+void evaluate_pose(const PoseJob& job) {
+    evaluate_chunk(core::Span<PoseJob>(&job, 1));
+}
+
+void evaluate_poses(core::Span<PoseJob> jobs, concurrent::StaticThreadPool* thread_pool) {
+    y_profile();
+
+    const usize max_chunks = thread_pool ? thread_pool->concurency() + 1 : 1;
+    const usize chunk_count = std::clamp(jobs.size() / min_jobs_per_chunk, usize(1), max_chunks);
+
+    if(chunk_count == 1) {
+        evaluate_chunk(jobs);
+        return;
+    }
+
+    const usize chunk_size = (jobs.size() + chunk_count - 1) / chunk_count;
+
+    // The calling thread takes the first chunk, the others go to the pool
+    core::Vector<concurrent::DependencyGroup> chunks_done(chunk_count - 1, concurrent::DependencyGroup());
+    for(usize i = 1; i != chunk_count; ++i) {
+        const usize begin = i * chunk_size;
+        const usize end = std::min(begin + chunk_size, jobs.size());
+        if(begin >= end) {
+            continue;
+        }
+
+        thread_pool->schedule([=] {
+            y_profile_zone("evaluate poses");
+            evaluate_chunk(core::Span<PoseJob>(jobs.data() + begin, end - begin));
+        }, &chunks_done[i - 1]);
+    }
+
+    evaluate_chunk(core::Span<PoseJob>(jobs.data(), std::min(chunk_size, jobs.size())));
+
+    thread_pool->process_until_complete(chunks_done);
+}
+
+}
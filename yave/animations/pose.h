@@ -0,0 +1,53 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#ifndef YAVE_ANIMATIONS_POSE_H
+#define YAVE_ANIMATIONS_POSE_H
+
+#include "AnimationClip.h"
+
+#include <y/concurrent/StaticThreadPool.h>
+
+namespace yave {
+
+// Everything needed to evaluate the skinning palette of one skeleton instance.
+// Jobs don't own anything: cursors and palette usually live in the instance and in the shared bone buffer respectively.
+struct PoseJob {
+    const AnimationClip* clip = nullptr;
+    float time = 0.0f;
+
+    core::MutableSpan<u32> key_cursors;
+    core::MutableSpan<math::Transform<>> palette;
+};
+
+// Composes a local pose into model space and applies the inverse bind pose, giving the transforms used for skinning.
+void compute_skinning_palette(const Skeleton& skeleton, core::Span<BoneTransform> local_pose, core::MutableSpan<math::Transform<>> palette);
+
+// Samples and skins a single job.
+void evaluate_pose(const PoseJob& job);
+
+// Evaluates all jobs, in parallel chunks if a thread pool is provided.
+// This doesn't touch the GPU and blocks until every palette has been written.
+void evaluate_poses(core::Span<PoseJob> jobs, concurrent::StaticThreadPool* thread_pool = nullptr);
+
+}
+
+#endif // YAVE_ANIMATIONS_POSE_H
@@ -25,6 +25,7 @@ SOFTWARE.
 #include "AssetLoader.h"
 
 #include <y/concurrent/concurrent.h>
+#include <y/utils/memory.h>
 
 #include <y/utils/log.h>
 #include <y/utils/format.h>
@@ -92,6 +93,7 @@ bool AssetLoadingThreadPool::is_processing() const {
 
 void AssetLoadingThreadPool::process_one(std::unique_lock<std::mutex> lock) {
     y_profile();
+    y_memory_tag("assets");
     y_debug_assert(lock.owns_lock());
 
     ++_processing;
@@ -0,0 +1,247 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include "AssetPathTree.h"
+
+namespace yave {
+
+static std::pair<std::string_view, std::string_view> split_first(std::string_view path) {
+    const usize delim = path.find('/');
+    if(delim == std::string_view::npos) {
+        return {path, std::string_view()};
+    }
+    return {path.substr(0, delim), path.substr(delim + 1)};
+}
+
+static std::pair<std::string_view, std::string_view> split_last(std::string_view path) {
+    const usize delim = path.rfind('/');
+    if(delim == std::string_view::npos) {
+        return {std::string_view(), path};
+    }
+    return {path.substr(0, delim), path.substr(delim + 1)};
+}
+
+
+AssetPathTree::AssetPathTree() {
+    clear();
+}
+
+const AssetPathTree::Node* AssetPathTree::root() const {
+    return _root.get();
+}
+
+const AssetPathTree::Node* AssetPathTree::find(std::string_view path) const {
+    return const_cast<AssetPathTree*>(this)->find_mut(path);
+}
+
+const AssetPathTree::Node* AssetPathTree::find(AssetId id) const {
+    if(const auto it = _ids.find(id); it != _ids.end()) {
+        return it->second;
+    }
+    return nullptr;
+}
+
+core::String AssetPathTree::path(const Node* node) const {
+    usize size = 0;
+    for(const Node* n = node; n->_parent; n = n->_parent) {
+        size += n->_name.size() + 1;
+    }
+
+    if(!size) {
+        return core::String();
+    }
+
+    core::String path;
+    path.set_min_capacity(size);
+    path.resize(size - 1);
+
+    char* end = path.data() + path.size();
+    for(const Node* n = node; n->_parent; n = n->_parent) {
+        end -= n->_name.size();
+        std::copy(n->_name.begin(), n->_name.end(), end);
+        if(end != path.data()) {
+            *(--end) = '/';
+        }
+    }
+
+    y_debug_assert(end == path.data());
+    return path;
+}
+
+const AssetPathTree::Node* AssetPathTree::create_folder(std::string_view path) {
+    return find_or_create_folder(path);
+}
+
+const AssetPathTree::Node* AssetPathTree::add_asset(std::string_view path, const AssetData& data) {
+    const auto [parent_path, name] = split_last(path);
+    if(name.empty() || _ids.contains(data.id)) {
+        return nullptr;
+    }
+
+    Node* parent = find_mut(parent_path);
+    if(!parent || !parent->_is_folder || parent->_children.find(name) != parent->_children.end()) {
+        return nullptr;
+    }
+
+    Node* node = create_child(parent, name, false);
+    node->_asset = data;
+    _ids[data.id] = node;
+    return node;
+}
+
+bool AssetPathTree::move(const Node* node, std::string_view new_path) {
+    y_debug_assert(node);
+    if(!node->_parent) {
+        return false;
+    }
+
+    {
+        const core::String old_path = path(node);
+        if(new_path.starts_with(old_path) && (new_path.size() == old_path.size() || new_path[old_path.size()] == '/')) {
+            return false;
+        }
+    }
+
+    const auto [parent_path, name] = split_last(new_path);
+    if(name.empty()) {
+        return false;
+    }
+
+    Node* new_parent = find_or_create_folder(parent_path);
+    if(!new_parent || new_parent->_children.find(name) != new_parent->_children.end()) {
+        return false;
+    }
+
+    Node* moved = const_cast<Node*>(node);
+    auto handle = moved->_parent->_children.extract(moved->_name);
+    y_debug_assert(!handle.empty());
+
+    moved->_name = name;
+    moved->_parent = new_parent;
+    handle.key() = moved->_name;
+
+    new_parent->_children.insert(std::move(handle));
+    return true;
+}
+
+void AssetPathTree::remove(const Node* node) {
+    y_debug_assert(node);
+    if(!node->_parent) {
+        clear();
+        return;
+    }
+
+    unindex(node);
+
+    auto& siblings = node->_parent->_children;
+    const auto it = siblings.find(node->_name);
+    y_debug_assert(it != siblings.end());
+    siblings.erase(it);
+}
+
+void AssetPathTree::clear() {
+    _root = std::make_unique<Node>();
+    _ids.clear();
+    _folder_count = 0;
+}
+
+usize AssetPathTree::asset_count() const {
+    return _ids.size();
+}
+
+usize AssetPathTree::folder_count() const {
+    return _folder_count;
+}
+
+AssetPathTree::Node* AssetPathTree::find_mut(std::string_view path) {
+    Node* node = _root.get();
+    while(!path.empty()) {
+        if(!node->_is_folder) {
+            return nullptr;
+        }
+
+        const auto [segment, tail] = split_first(path);
+        const auto it = node->_children.find(segment);
+        if(it == node->_children.end()) {
+            return nullptr;
+        }
+
+        node = it->second.get();
+        path = tail;
+    }
+    return node;
+}
+
+AssetPathTree::Node* AssetPathTree::find_or_create_folder(std::string_view path) {
+    Node* node = _root.get();
+    while(!path.empty()) {
+        const auto [segment, tail] = split_first(path);
+        if(segment.empty()) {
+            return nullptr;
+        }
+
+        if(const auto it = node->_children.find(segment); it != node->_children.end()) {
+            node = it->second.get();
+            if(!node->_is_folder) {
+                return nullptr;
+            }
+        } else {
+            node = create_child(node, segment, true);
+        }
+
+        path = tail;
+    }
+    return node;
+}
+
+AssetPathTree::Node* AssetPathTree::create_child(Node* parent, std::string_view name, bool is_folder) {
+    y_debug_assert(parent->_is_folder);
+    y_debug_assert(!name.empty());
+
+    auto child = std::make_unique<Node>();
+    child->_name = name;
+    child->_parent = parent;
+    child->_is_folder = is_folder;
+
+    Node* node = child.get();
+    parent->_children.emplace(node->_name, std::move(child));
+
+    if(is_folder) {
+        ++_folder_count;
+    }
+
+    return node;
+}
+
+void AssetPathTree::unindex(const Node* node) {
+    if(node->_is_folder) {
+        y_debug_assert(_folder_count);
+        --_folder_count;
+        for(const auto& [name, child] : node->_children) {
+            unindex(child.get());
+        }
+    } else {
+        _ids.erase(node->_asset.id);
+    }
+}
+
+}
@@ -0,0 +1,152 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#ifndef YAVE_ASSETS_ASSETPATHTREE_H
+#define YAVE_ASSETS_ASSETPATHTREE_H
+
+#include "AssetId.h"
+#include "AssetType.h"
+
+#include <y/core/String.h>
+#include <y/core/HashMap.h>
+
+#include <memory>
+#include <map>
+
+namespace yave {
+
+// In-memory index of an asset store's folders and assets.
+// Every path segment is a node holding its direct children, so listing a folder only touches its children
+// and moving a folder is a relink of a single node, whatever the number of assets below it.
+class AssetPathTree : NonMovable {
+    public:
+        struct AssetData {
+            AssetId id;
+            AssetType type = AssetType::Unknown;
+            usize file_size = 0;
+        };
+
+        class Node : NonMovable {
+            public:
+                bool is_folder() const {
+                    return _is_folder;
+                }
+
+                std::string_view name() const {
+                    return _name;
+                }
+
+                const Node* parent() const {
+                    return _parent;
+                }
+
+                const AssetData& asset() const {
+                    y_debug_assert(!_is_folder);
+                    return _asset;
+                }
+
+                usize child_count() const {
+                    return _children.size();
+                }
+
+                template<typename F>
+                void for_each_child(F&& func) const {
+                    for(const auto& [name, child] : _children) {
+                        func(*child);
+                    }
+                }
+
+            private:
+                friend class AssetPathTree;
+
+                core::String _name;
+                Node* _parent = nullptr;
+
+                // Keys point into the children's names
+                std::map<std::string_view, std::unique_ptr<Node>> _children;
+
+                AssetData _asset;
+                bool _is_folder = true;
+        };
+
+        AssetPathTree();
+
+        const Node* root() const;
+
+        // Paths are '/' separated and relative to the root, the empty path being the root itself
+        const Node* find(std::string_view path) const;
+        const Node* find(AssetId id) const;
+
+        core::String path(const Node* node) const;
+
+        // Returns nullptr if an asset is in the way
+        const Node* create_folder(std::string_view path);
+
+        // Returns nullptr if the parent folder does not exist or if the path already exists
+        const Node* add_asset(std::string_view path, const AssetData& data);
+
+        // Returns false if the destination exists or is inside the moved node
+        bool move(const Node* node, std::string_view new_path);
+
+        void remove(const Node* node);
+
+        void clear();
+
+        usize asset_count() const;
+        usize folder_count() const;
+
+        template<typename F>
+        void for_each_asset(const Node* node, F&& func) const {
+            if(!node->is_folder()) {
+                func(*node);
+                return;
+            }
+            for(const auto& [name, child] : node->_children) {
+                for_each_asset(child.get(), func);
+            }
+        }
+
+        // Depth first, parents are always visited before their children
+        template<typename F>
+        void for_each_folder(const Node* node, F&& func) const {
+            for(const auto& [name, child] : node->_children) {
+                if(child->is_folder()) {
+                    func(*child);
+                    for_each_folder(child.get(), func);
+                }
+            }
+        }
+
+    private:
+        Node* find_mut(std::string_view path);
+        Node* find_or_create_folder(std::string_view path);
+
+        Node* create_child(Node* parent, std::string_view name, bool is_folder);
+        void unindex(const Node* node);
+
+        std::unique_ptr<Node> _root;
+        core::FlatHashMap<AssetId, Node*> _ids;
+        usize _folder_count = 0;
+};
+
+}
+
+#endif // YAVE_ASSETS_ASSETPATHTREE_H
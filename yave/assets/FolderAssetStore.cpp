@@ -32,6 +32,7 @@ SOFTWARE.
 #include <y/serde3/archives.h>
 
 #include <charconv>
+#include <atomic>
 
 namespace yave {
 
@@ -54,21 +55,6 @@ static std::string_view strict_parent_path(std::string_view path) {
     return std::string_view();
 }
 
-static bool is_strict_direct_parent(std::string_view parent, std::string_view path) {
-    return strict_parent_path(path) == parent;
-}
-
-static bool is_strict_indirect_parent(std::string_view parent, std::string_view path) {
-    parent = strict_path(parent);
-    if(parent.size() >= path.size()) {
-        return false;
-    }
-    if(!is_delimiter(path[parent.size()])) {
-        return false;
-    }
-    return path.substr(0, parent.size()) == parent;
-}
-
 static bool is_valid_name_char(char c) {
     return std::isprint(static_cast<unsigned char>(c)) && c != '\\';
 }
@@ -96,6 +82,28 @@ static bool is_valid_path(std::string_view name) {
     return true;
 }
 
+// Writes to a temporary file and renames it so readers never see a partially written file.
+// Temporaries are unique per call since writes to the same file can run concurrently.
+// replace is called to move the temporary over the destination, and can refuse to do so.
+template<typename F, typename R>
+static bool replace_file(const core::String& file_name, F&& write, R&& replace) {
+    static std::atomic<u64> tmp_index = 0;
+    const core::String tmp_file = fmt_to_owned("{}_{}", file_name, tmp_index++);
+
+    if(!write(tmp_file) || !replace(tmp_file, file_name)) {
+        FileSystemModel::local_filesystem()->remove(tmp_file).ignore();
+        return false;
+    }
+    return true;
+}
+
+template<typename F>
+static bool replace_file(const core::String& file_name, F&& write) {
+    return replace_file(file_name, write, [](const core::String& tmp_file, const core::String& file_name) {
+        return bool(FileSystemModel::local_filesystem()->rename(tmp_file, file_name));
+    });
+}
+
 
 
 
@@ -147,7 +155,8 @@ FileSystemModel::Result<bool> FolderAssetStore::FolderFileSystemModel::exists(st
     const std::string_view no_delim(path.data(), path.size() - has_delim);
 
     const auto lock = std::unique_lock(_parent->_lock);
-    return core::Ok(_parent->_folders.find(no_delim) != _parent->_folders.end() || (!has_delim && _parent->_assets.find(no_delim) != _parent->_assets.end()));
+    const AssetPathTree::Node* node = _parent->_tree.find(no_delim);
+    return core::Ok(node && (node->is_folder() || !has_delim));
 }
 
 FileSystemModel::Result<FileSystemModel::EntryType> FolderAssetStore::FolderFileSystemModel::entry_type(std::string_view path) const {
@@ -158,7 +167,8 @@ FileSystemModel::Result<FileSystemModel::EntryType> FolderAssetStore::FolderFile
     }
 
     const auto lock = std::unique_lock(_parent->_lock);
-    const bool is_dir = _parent->_folders.find(strict_path(path)) != _parent->_folders.end();
+    const AssetPathTree::Node* node = _parent->_tree.find(strict_path(path));
+    const bool is_dir = node && node->is_folder();
     return core::Ok(is_dir ? EntryType::Directory : EntryType::File);
 }
 
@@ -171,38 +181,36 @@ FileSystemModel::Result<> FolderAssetStore::FolderFileSystemModel::for_each(std:
 
     path = strict_path(path);
 
-    const bool is_root = path.empty();
-
     const auto lock = std::unique_lock(_parent->_lock);
 
-    for(auto it = _parent->_folders.lower_bound(path); it != _parent->_folders.end(); ++it) {
-        if(is_strict_direct_parent(path, *it)) {
+    const AssetPathTree::Node* node = _parent->_tree.find(path);
+    if(!node || !node->is_folder()) {
+        return core::Ok();
+    }
+
+    node->for_each_child([&](const AssetPathTree::Node& child) {
+        if(child.is_folder()) {
             const EntryInfo info = {
                 EntryType::Directory,
-                it->sub_str(path.size() + !is_root),
+                child.name(),
                 0
             };
             func(info);
-        } else if(!it->starts_with(path)) {
-            break;
         }
-    }
+    });
 
-    for(auto it = _parent->_assets.lower_bound(path); it != _parent->_assets.end(); ++it) {
-        if(is_strict_direct_parent(path, it->first)) {
+    node->for_each_child([&](const AssetPathTree::Node& child) {
+        if(!child.is_folder()) {
             const EntryInfo info = {
                 EntryType::File,
-                it->first.sub_str(path.size() + !is_root),
-                it->second.file_size
+                child.name(),
+                child.asset().file_size
             };
             func(info);
-        } else if(!it->first.starts_with(path)) {
-            break;
         }
-    }
+    });
 
     return core::Ok();
-
 }
 
 FileSystemModel::Result<> FolderAssetStore::FolderFileSystemModel::create_directory(std::string_view path) const {
@@ -216,17 +224,19 @@ FileSystemModel::Result<> FolderAssetStore::FolderFileSystemModel::create_direct
 
     const auto lock = std::unique_lock(_parent->_lock);
 
-    const auto parent = strict_parent_path(path);
-    if(!is_directory(parent).unwrap_or(false)) {
-        y_try(create_directory(parent));
+    if(const AssetPathTree::Node* node = _parent->_tree.find(path)) {
+        if(!node->is_folder()) {
+            return core::Err();
+        }
+        return core::Ok();
     }
 
-    if(_parent->_folders.emplace(path).second) {
-        log_msg(fmt("Folder created: {}", path));
-        return _parent->save_or_restore_tree();
+    if(!_parent->_tree.create_folder(path)) {
+        return core::Err();
     }
 
-    return core::Ok();
+    log_msg(fmt("Folder created: {}", path));
+    return _parent->save_or_restore_tree();
 }
 
 FileSystemModel::Result<> FolderAssetStore::FolderFileSystemModel::remove(std::string_view path) const {
@@ -236,39 +246,25 @@ FileSystemModel::Result<> FolderAssetStore::FolderFileSystemModel::remove(std::s
 
     const auto lock = std::unique_lock(_parent->_lock);
 
-    core::Vector<core::String> files_to_delete;
-
-    std::set<core::String> new_folders;
-    {
-        y_profile_zone("folders");
-        for(const core::String& folder : _parent->_folders) {
-            if(is_strict_indirect_parent(path, folder) || folder == path) {
-                // Remove
-            } else {
-                y_debug_assert(!is_strict_direct_parent(path, folder));
-                new_folders.insert(folder);
-            }
-        }
+    const AssetPathTree::Node* node = _parent->_tree.find(path);
+    if(!node || node == _parent->_tree.root()) {
+        return core::Ok();
     }
 
-    std::map<core::String, AssetData> new_assets;
-    {
-        y_profile_zone("assets");
-        for(const auto &[name, data] : _parent->_assets) {
-            if(is_strict_indirect_parent(path, name) || name == path) {
-                const AssetId id = data.id;
-                const core::String filename = _parent->asset_desc_file_name(id);
-                if(auto r = FileSystemModel::local_filesystem()->remove(filename); !r) {
-                    log_msg(fmt("Unable to remove {}", filename), Log::Error);
-                    _parent->reload_all().ignore();
-                    return r;
-                }
-                files_to_delete << _parent->asset_data_file_name(id);
-            } else {
-                y_debug_assert(!is_strict_direct_parent(path, name));
-                new_assets[name] = data;
-            }
+    core::Vector<AssetId> removed_ids;
+    _parent->_tree.for_each_asset(node, [&](const AssetPathTree::Node& asset) {
+        removed_ids << asset.asset().id;
+    });
+
+    core::Vector<core::String> files_to_delete;
+    for(const AssetId id : removed_ids) {
+        const core::String filename = _parent->asset_desc_file_name(id);
+        if(auto r = FileSystemModel::local_filesystem()->remove(filename); !r) {
+            log_msg(fmt("Unable to remove {}", filename), Log::Error);
+            _parent->reload_all().ignore();
+            return r;
         }
+        files_to_delete << _parent->asset_data_file_name(id);
     }
 
     if(!files_to_delete.is_empty()) {
@@ -278,11 +274,9 @@ FileSystemModel::Result<> FolderAssetStore::FolderFileSystemModel::remove(std::s
         }
     }
 
-    log_msg(fmt("Removed {} assets", _parent->_assets.size() - new_assets.size()));
+    log_msg(fmt("Removed {} assets", removed_ids.size()));
 
-    _parent->_ids = nullptr;
-    std::swap(new_folders, _parent->_folders);
-    std::swap(new_assets, _parent->_assets);
+    _parent->_tree.remove(node);
 
     return _parent->save_or_restore_tree();
 }
@@ -299,53 +293,24 @@ FileSystemModel::Result<> FolderAssetStore::FolderFileSystemModel::rename(std::s
 
     const auto lock = std::unique_lock(_parent->_lock);
 
-    std::map<core::String, AssetData> new_assets;
-    {
-        for(const auto &[name, data] : _parent->_assets) {
-            if(is_strict_indirect_parent(from, name) || from == name) {
-                const std::string_view end = name.sub_str(from.size() + 1);
-                const core::String new_name = end.empty() ? core::String(to) : join(to, end);
-
-                if(_parent->_assets.emplace(new_name, data).second) {
-                    if(auto r = _parent->load_desc(data.id)) {
-                        AssetDesc desc = std::move(r.unwrap());
-                        desc.name = new_name;
-                        if(_parent->save_desc(data.id, desc)) {
-                            new_assets[new_name] = data;
-                            continue;
-                        }
-                    }
-                }
-
-                _parent->reload_all().ignore();
-                return core::Err();
-            } else {
-                y_debug_assert(!is_strict_direct_parent(from, name));
-                new_assets[name] = data;
-            }
-        }
+    const AssetPathTree::Node* node = _parent->_tree.find(from);
+    if(!node || !_parent->_tree.move(node, to)) {
+        return core::Err();
     }
 
-    std::set<core::String> new_folders;
-    {
-        for(const core::String& folder : _parent->_folders) {
-            core::String new_name = folder;
-
-            if(is_strict_indirect_parent(from, folder)) {
-                const std::string_view end = folder.sub_str(from.size() + 1);
-                new_name = join(to, end);
-                y_debug_assert(!end.empty());
-            } else if(from == folder) {
-                new_name = to;
-            }
-
-            new_folders.insert(new_name);
+    // Descs store the full asset name so they have to follow the move
+    bool descs_saved = true;
+    _parent->_tree.for_each_asset(node, [&](const AssetPathTree::Node& asset) {
+        if(descs_saved) {
+            const AssetDesc desc = { _parent->_tree.path(&asset), asset.asset().type };
+            descs_saved = _parent->save_desc(asset.asset().id, desc).is_ok();
         }
-    }
+    });
 
-    _parent->_ids = nullptr;
-    std::swap(new_folders, _parent->_folders);
-    std::swap(new_assets, _parent->_assets);
+    if(!descs_saved) {
+        _parent->reload_all().ignore();
+        return core::Err();
+    }
 
     return _parent->save_or_restore_tree();
 }
@@ -426,33 +391,24 @@ AssetStore::Result<> FolderAssetStore::save_desc(AssetId id, const AssetDesc& de
 
     const std::string_view data = fmt("{}\n{}\n", desc.name, desc.type);
 
-    const core::String file_name = asset_desc_file_name(id);
-    const core::String tmp_file = file_name + "_";
+    const bool written = replace_file(asset_desc_file_name(id), [&](const core::String& tmp_file) {
+        auto file = io2::File::create(tmp_file);
+        return file.is_ok() && file.unwrap().write_array(data.data(), data.size()).is_ok();
+    });
 
-    if(auto file = io2::File::create(tmp_file);
-       file.is_error() || file.unwrap().write_array(data.data(), data.size()).is_error()) {
-        return core::Err(ErrorType::FilesytemError);
-    }
-    if(!FileSystemModel::local_filesystem()->rename(tmp_file, file_name)) {
+    if(!written) {
         return core::Err(ErrorType::FilesytemError);
     }
 
     return core::Ok();
 }
 
-void FolderAssetStore::rebuild_id_map() const {
+bool FolderAssetStore::write_data_file(AssetId id, io2::Reader& data) const {
     y_profile();
 
-    const auto lock = std::unique_lock(_lock);
-
-    if(!_ids) {
-        _ids = std::make_unique<std::remove_reference_t<decltype(*_ids)>>();
-        _ids->reserve(_assets.size());
-
-        for(auto it = _assets.begin(); it != _assets.end(); ++it) {
-            (*_ids)[it->second.id] = it;
-        }
-    }
+    return replace_file(asset_data_file_name(id), [&](const core::String& tmp_file) {
+        return bool(io2::File::copy(data, tmp_file));
+    });
 }
 
 const FileSystemModel* FolderAssetStore::filesystem() const {
@@ -464,36 +420,63 @@ AssetStore::Result<AssetId> FolderAssetStore::import(io2::Reader& data, std::str
 
     dst_name = strict_path(dst_name);
 
-    if(!is_valid_path(dst_name)) {
+    if(!is_valid_path(dst_name) || dst_name.empty()) {
         return core::Err(ErrorType::InvalidName);
     }
 
-    const auto lock = std::unique_lock(_lock);
+    AssetId id;
+    {
+        const auto lock = std::unique_lock(_lock);
 
-    if(!_filesystem.create_directory(strict_parent_path(dst_name))) {
-        return core::Err(ErrorType::FilesytemError);
-    }
+        if(!_filesystem.create_directory(strict_parent_path(dst_name))) {
+            return core::Err(ErrorType::FilesytemError);
+        }
+
+        if(_tree.find(dst_name)) {
+            return core::Err(ErrorType::NameAlreadyExists);
+        }
 
-    if(_assets.find(dst_name) != _assets.end()) {
-        return core::Err(ErrorType::NameAlreadyExists);
+        id = next_id();
     }
 
-    const AssetId id = next_id();
-    const core::String data_file_name = asset_data_file_name(id);
+    // Files are written without holding the lock so that concurrent imports don't serialize on IO.
+    // The asset only becomes visible once added to the tree, and its files are removed if that fails.
+    const auto remove_files = [&] {
+        FileSystemModel::local_filesystem()->remove(asset_data_file_name(id)).ignore();
+        FileSystemModel::local_filesystem()->remove(asset_desc_file_name(id)).ignore();
+    };
 
     {
         y_profile_zone("writing");
-        if(!io2::File::copy(data, data_file_name)) {
+        if(!write_data_file(id, data)) {
             return core::Err(ErrorType::FilesytemError);
         }
     }
 
     const AssetDesc desc = { dst_name, type };
-    y_try(save_desc(id, desc));
+    if(auto r = save_desc(id, desc); r.is_error()) {
+        remove_files();
+        return std::move(r.err_object());
+    }
+
+    {
+        const auto lock = std::unique_lock(_lock);
 
-    const auto it = _assets.emplace(dst_name, AssetData{id, type}).first;
-    if(_ids) {
-        (*_ids)[id] = it;
+        // The folder might have been removed while writing
+        if(!_filesystem.create_directory(strict_parent_path(dst_name))) {
+            remove_files();
+            return core::Err(ErrorType::FilesytemError);
+        }
+
+        if(_tree.find(dst_name)) {
+            remove_files();
+            return core::Err(ErrorType::NameAlreadyExists);
+        }
+
+        if(!_tree.add_asset(dst_name, AssetData{id, type, 0})) {
+            remove_files();
+            return core::Err(ErrorType::InvalidName);
+        }
     }
 
     return core::Ok(id);
@@ -506,14 +489,33 @@ AssetStore::Result<> FolderAssetStore::write(AssetId id, io2::Reader& data) {
         return core::Err(ErrorType::UnknownID);
     }
 
-    const auto lock = std::unique_lock(_lock);
+    const core::String file_name = asset_data_file_name(id);
+    const FileSystemModel* fs = FileSystemModel::local_filesystem();
+
+    if(!fs->exists(file_name).unwrap_or(false)) {
+        return core::Err(ErrorType::UnknownID);
+    }
+
+    // The data is written without holding the lock, but the asset might be removed in the meantime.
+    // Checking again under the lock ensures that the rename never recreates the file of a removed asset.
+    bool removed = false;
+    const bool written = replace_file(file_name, [&](const core::String& tmp_file) {
+        y_profile_zone("writing");
+        return bool(io2::File::copy(data, tmp_file));
+    }, [&](const core::String& tmp_file, const core::String& file_name) {
+        const auto lock = std::unique_lock(_lock);
+        if(!fs->exists(file_name).unwrap_or(false)) {
+            removed = true;
+            return false;
+        }
+        return bool(fs->rename(tmp_file, file_name));
+    });
 
-    const core::String data_file_name = asset_data_file_name(id);
-    if(!io2::File::open(data_file_name)) {
+    if(removed) {
         return core::Err(ErrorType::UnknownID);
     }
 
-    if(!io2::File::copy(data, data_file_name)) {
+    if(!written) {
         return core::Err(ErrorType::FilesytemError);
     }
 
@@ -540,8 +542,8 @@ AssetStore::Result<AssetId> FolderAssetStore::id(std::string_view name) const {
 
     const auto lock = std::unique_lock(_lock);
 
-    if(const auto it = _assets.find(name); it != _assets.end()) {
-        return core::Ok(it->second.id);
+    if(const AssetPathTree::Node* node = _tree.find(strict_path(name)); node && !node->is_folder()) {
+        return core::Ok(node->asset().id);
     }
 
     return core::Err(ErrorType::UnknownID);
@@ -556,9 +558,8 @@ AssetStore::Result<core::String> FolderAssetStore::name(AssetId id) const {
 
     const auto lock = std::unique_lock(_lock);
 
-    rebuild_id_map();
-    if(const auto it = _ids->find(id); it != _ids->end()) {
-        return core::Ok(core::String(it->second->first));
+    if(const AssetPathTree::Node* node = _tree.find(id)) {
+        return core::Ok(_tree.path(node));
     }
 
     return core::Err(ErrorType::UnknownID);
@@ -627,9 +628,8 @@ AssetStore::Result<AssetType> FolderAssetStore::asset_type(AssetId id) const {
 
     const auto lock = std::unique_lock(_lock);
 
-    rebuild_id_map();
-    if(const auto it = _ids->find(id); it != _ids->end()) {
-        return core::Ok(it->second->second.type);
+    if(const AssetPathTree::Node* node = _tree.find(id)) {
+        return core::Ok(node->asset().type);
     }
 
     return core::Err(ErrorType::UnknownID);
@@ -653,8 +653,6 @@ FolderAssetStore::Result<> FolderAssetStore::load_tree() {
 
     const auto lock = std::unique_lock(_lock);
 
-    _folders.clear();
-
     core::Vector<u8> tree_data;
     if(auto file = io2::File::open(tree_file_name()); file.is_error() || file.unwrap().read_all(tree_data).is_error()) {
         log_msg("Unable to open folder index", Log::Error);
@@ -667,7 +665,9 @@ FolderAssetStore::Result<> FolderAssetStore::load_tree() {
         auto push_folder = [&] {
             if(!line.is_empty()) {
                 y_debug_assert(is_valid_path(line));
-                _folders.insert(std::move(line));
+                if(!_tree.create_folder(line)) {
+                    log_msg(fmt("\"{}\" could not be added to the folder database", line), Log::Error);
+                }
                 line.make_empty();
             }
         };
@@ -692,26 +692,24 @@ FolderAssetStore::Result<> FolderAssetStore::save_tree() const {
 
     core::String tree_data;
     {
-        for(const core::String& folder : _folders) {
+        _tree.for_each_folder(_tree.root(), [&](const AssetPathTree::Node& node) {
+            const core::String folder = _tree.path(&node);
             y_debug_assert(is_valid_path(folder));
             y_debug_assert(std::string_view(folder) == strict_path(folder));
-            y_debug_assert(_filesystem.is_directory(strict_parent_path(folder)).unwrap_or(false));
 
             tree_data += folder;
             tree_data += "\n";
-        }
+        });
     }
 
     {
-        const core::String file_name = tree_file_name();
-        const core::String tmp_file = file_name + "_";
-
         Y_TODO(Openning file is slow, maybe we should cache it)
-        if(auto file = io2::File::create(tmp_file); file.is_error() || file.unwrap().write_array(tree_data.data(), tree_data.size()).is_error()) {
-            return core::Err(ErrorType::FilesytemError);
-        }
+        const bool written = replace_file(tree_file_name(), [&](const core::String& tmp_file) {
+            auto file = io2::File::create(tmp_file);
+            return file.is_ok() && file.unwrap().write_array(tree_data.data(), tree_data.size()).is_ok();
+        });
 
-        if(!FileSystemModel::local_filesystem()->rename(tmp_file, file_name)) {
+        if(!written) {
             return core::Err(ErrorType::FilesytemError);
         }
     }
@@ -725,8 +723,8 @@ FolderAssetStore::Result<> FolderAssetStore::save_or_restore_tree() {
     const auto lock = std::unique_lock(_lock);
 
     if(!save_tree()) {
-        load_tree().unwrap();
         log_msg("Failed to save tree", Log::Error);
+        reload_all().unwrap();
         return core::Err(ErrorType::FilesytemError);
     }
     return core::Ok();
@@ -739,9 +737,6 @@ FolderAssetStore::Result<> FolderAssetStore::load_asset_descs() {
 
     const auto lock = std::unique_lock(_lock);
 
-    _ids = nullptr;
-    _assets.clear();
-
     core::Vector<u64> desc_ids;
     core::FlatHashMap<u64, usize> asset_sizes;
 
@@ -823,25 +818,32 @@ FolderAssetStore::Result<> FolderAssetStore::load_asset_descs() {
     {
         y_profile_zone("Merging descs");
         usize emergency_id = 1;
+        bool created_folders = false;
         for(auto& a : assets) {
             for(auto& [desc, data] : a) {
-                if(!_assets.emplace(desc.name, data).second) {
+                const std::string_view parent = strict_parent_path(desc.name);
+                if(!parent.empty() && !_tree.find(parent)) {
+                    log_msg(fmt("\"{}\" was not found in folder database", parent), Log::Warning);
+                    created_folders |= _tree.create_folder(parent) != nullptr;
+                }
+
+                if(!_tree.add_asset(desc.name, data)) {
                     log_msg(fmt("\"{}\" already exists in asset database", desc.name), Log::Error);
 
                     {
                         fmt_into(desc.name, "_({})", emergency_id++);
-                        _assets.emplace(desc.name, data);
-                        save_desc(data.id, desc).ignore();
-                    }
-                }
-
-                if(auto parent = _filesystem.parent_path(desc.name); parent && !parent.unwrap().is_empty()) {
-                    if(_folders.insert(parent.unwrap()).second) {
-                        log_msg(fmt("\"{}\" was not found in folder database", parent.unwrap()), Log::Warning);
+                        if(_tree.add_asset(desc.name, data)) {
+                            save_desc(data.id, desc).ignore();
+                        }
                     }
                 }
             }
         }
+
+        // Save recreated folders so that they don't go missing again on the next load
+        if(created_folders && !save_tree()) {
+            log_msg("Failed to save tree", Log::Error);
+        }
     }
 
     return core::Ok();
@@ -853,11 +855,11 @@ FolderAssetStore::Result<> FolderAssetStore::reload_all() {
     const auto lock = std::unique_lock(_lock);
 
     _next_id = u64(std::time(nullptr)) << 32;
+
+    _tree.clear();
     load_tree().unwrap();
     load_asset_descs().unwrap();
 
-    rebuild_id_map();
-
     return core::Ok();
 }
 
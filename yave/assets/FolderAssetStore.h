@@ -25,13 +25,11 @@ SOFTWARE.
 #include <yave/utils/FileSystemModel.h>
 
 #include "AssetStore.h"
+#include "AssetPathTree.h"
 
 #include <y/core/String.h>
-#include <y/core/HashMap.h>
 
 #include <mutex>
-#include <set>
-#include <map>
 
 namespace yave {
 
@@ -65,11 +63,7 @@ class FolderAssetStore final : NonMovable, public AssetStore {
             FolderAssetStore* _parent = nullptr;
     };
 
-    struct AssetData {
-        AssetId id;
-        AssetType type;
-        usize file_size;
-    };
+    using AssetData = AssetPathTree::AssetData;
 
     struct AssetDesc {
         core::String name;
@@ -99,7 +93,6 @@ class FolderAssetStore final : NonMovable, public AssetStore {
 
     private:
         AssetId next_id();
-        void rebuild_id_map() const;
 
         core::String tree_file_name() const;
         core::String next_id_file_name() const;
@@ -108,6 +101,7 @@ class FolderAssetStore final : NonMovable, public AssetStore {
 
         Result<AssetDesc> load_desc(AssetId id) const;
         Result<> save_desc(AssetId id, const AssetDesc& desc) const;
+        bool write_data_file(AssetId id, io2::Reader& data) const;
 
         Result<> save_or_restore_tree();
 
@@ -121,10 +115,7 @@ class FolderAssetStore final : NonMovable, public AssetStore {
         core::String _root;
 
         u64 _next_id = 0;
-        std::set<core::String> _folders;
-        std::map<core::String, AssetData> _assets;
-
-        mutable std::unique_ptr<core::FlatHashMap<AssetId, std::map<core::String, AssetData>::const_iterator>> _ids;
+        AssetPathTree _tree;
 
         mutable std::recursive_mutex _lock;
 
@@ -179,7 +179,7 @@ Camera::operator shader::Camera() const {
     camera_data.inv_proj = camera_data.proj.inverse();
 
     camera_data.view = view_matrix();
-    camera_data.inv_view = camera_data.view.inverse();
+    camera_data.inv_view = math::Transform<>(camera_data.view).affine_inverse();
 
     camera_data.position = position();
     camera_data.forward = forward();
@@ -125,11 +125,15 @@ TickId EntityWorld::tick_id() const {
 }
 
 void EntityWorld::tick(concurrent::StaticThreadPool& thread_pool) {
+    y_memory_tag("ecs");
+
     _tick_id = _tick_id.next();
     _system_manager.run_schedule(thread_pool);
 }
 
 void EntityWorld::process_deferred_changes() {
+    y_memory_tag("ecs");
+
     _groups.locked([&](auto&& groups) {
         y_profile_zone("Clear removed groups");
         for(auto& group : groups) {
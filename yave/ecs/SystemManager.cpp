@@ -29,6 +29,7 @@ SOFTWARE.
 
 #include <y/utils/log.h>
 #include <y/utils/format.h>
+#include <y/utils/memory.h>
 
 #include <numeric>
 
@@ -47,6 +48,11 @@ SystemScheduler::ArgumentResolver::operator SystemScheduler::FirstTime() const {
     return FirstTime { _parent->_world->tick_id() == _parent->_first_tick };
 }
 
+SystemScheduler::ArgumentResolver::operator concurrent::StaticThreadPool&() const {
+    y_debug_assert(_parent->_thread_pool);
+    return *_parent->_thread_pool;
+}
+
 SystemScheduler::SystemScheduler(System* sys, EntityWorld* world) : _system(sys), _world(world), _first_tick(_world->tick_id().next()) {
 }
 
@@ -71,6 +77,10 @@ void SystemManager::run_schedule(concurrent::StaticThreadPool& thread_pool) cons
     core::ScratchVector<DependencyGroup> stage_deps(dep_count);
     DependencyGroup previous_stage;
 
+    for(const auto& scheduler : _schedulers) {
+        scheduler->_thread_pool = &thread_pool;
+    }
+
     for(usize i = 0; i != usize(SystemSchedule::Max); ++i) {
         for(const auto& scheduler : _schedulers) {
 
@@ -91,6 +101,7 @@ void SystemManager::run_schedule(concurrent::StaticThreadPool& thread_pool) cons
                 const SystemScheduler::Task& task = sched.tasks[k];
                 thread_pool.schedule([&]() {
                     y_profile_dyn_zone(fmt_c_str("{}: {}", scheduler->_system->name(), task.name));
+                    y_memory_tag("ecs");
                     task.func();
                     ++completed;
                 }, &signal, wait);
@@ -81,6 +81,9 @@ class SystemScheduler : NonMovable {
                 operator const EntityWorld&() const;
                 operator FirstTime() const;
 
+                // The pool running the schedule: tasks can fork work on it and wait with process_until_complete
+                operator concurrent::StaticThreadPool&() const;
+
                 template<typename... Ts>
                 operator EntityGroup<Ts...>() const;
 
@@ -103,6 +106,7 @@ class SystemScheduler : NonMovable {
 
         System* _system = nullptr;
         EntityWorld* _world = nullptr;
+        concurrent::StaticThreadPool* _thread_pool = nullptr;
 
         TickId _first_tick;
 };
@@ -25,12 +25,18 @@ SOFTWARE.
 #include "FrameGraphFrameResources.h"
 
 #include <yave/graphics/commands/CmdQueue.h>
+#include <yave/graphics/commands/CmdBufferPool.h>
+#include <yave/graphics/graphics.h>
 
 #include <yave/utils/color.h>
 
+#include <y/concurrent/StaticThreadPool.h>
+#include <y/core/FixedArray.h>
 #include <y/core/ScratchPad.h>
+#include <y/core/Range.h>
 #include <y/utils/log.h>
 #include <y/utils/format.h>
+#include <y/utils/memory.h>
 
 namespace yave {
 
@@ -89,6 +95,25 @@ static auto&& check_exists(C& c, T t) {
     y_fatal("Resource doesn't exist");
 }
 
+// Aliased images share their memory, so they are handled like a single resource
+template<typename C>
+static FrameGraphImageId alias_root(const C& images, FrameGraphImageId res) {
+    const auto* info = &check_exists(images, res);
+    while(info->alias.is_valid()) {
+        res = info->alias;
+        info = &check_exists(images, res);
+    }
+    return res;
+}
+
+// infos have to be sorted by pass index
+template<typename C>
+static auto pass_infos(C& infos, usize pass_index) {
+    const auto begin = std::lower_bound(infos.begin(), infos.end(), pass_index, [](const auto& info, usize index) { return info.pass_index < index; });
+    const auto end = std::find_if(begin, infos.end(), [&](const auto& info) { return info.pass_index != pass_index; });
+    return core::Range(begin, end);
+}
+
 template<typename C, typename B, typename H>
 static void build_barriers(const C& resources, B& barriers, H& to_barrier, const FrameGraphFrameResources& frame_res) {
     for(auto&& [res, info] : resources) {
@@ -193,15 +218,15 @@ void FrameGraph::end_region(usize index) {
 
 void FrameGraph::render(CmdBufferRecorder& recorder, CmdTimingRecorder* time_rec) {
     y_profile();
-    Y_TODO(Pass culling)
-    Y_TODO(Ensure that pass are always recorded in order)
+    y_memory_tag("framegraph");
+
+    using Queue = core::DependencyGraph::Queue;
 
     // -------------------- region stuff --------------------
     const math::Vec4 region_color = math::Vec4(0.7f, 0.7f, 0.7f, 1.0f);
-    const auto frame_region = recorder.region("Framegraph render", time_rec, region_color);
 
     struct RuntimeRegion {
-        Region region;
+        usize index;
         CmdBufferRegion cmd;
         math::Vec4 color;
 
@@ -211,49 +236,71 @@ void FrameGraph::render(CmdBufferRecorder& recorder, CmdTimingRecorder* time_rec
         }
     };
 
-    usize next_region_index = 0;
-    core::ScratchVector<RuntimeRegion> regions(_passes.size());
+    // Position in the batch of the first and last live pass of each region
+    using RegionBounds = core::ScratchPad<std::pair<usize, usize>>;
+
+    // The current pass is on top of the region stack so that regions end in the reverse order they began
+    static constexpr usize pass_region = usize(-1);
+
+    core::ScratchVector<RuntimeRegion> regions(_regions.size() + 1);
+    core::FixedArray<math::Vec4> region_colors(_regions.size());
 
     auto next_color = [id = 0]() mutable {
         return math::Vec4(identifying_color(id++), 1.0f);
     };
 
-    auto begin_pass_region = [&](const FrameGraphPass& pass) {
-        while(true) {
-            if(next_region_index < _regions.size() && _regions[next_region_index].begin_pass == pass._index) {
-                const math::Vec4 color = next_color();
-                regions.emplace_back(RuntimeRegion{_regions[next_region_index], recorder.region(_regions[next_region_index].name.data(), time_rec, color), color});
-                ++next_region_index;
-            } else {
-                break;
+    // Bounds are computed after culling: a region only opens at its first live pass and never around unrelated passes.
+    // Passes are never moved across region boundaries, regions are opened again in every batch that contains some of their passes.
+    auto compute_region_bounds = [&](const core::DependencyGraph::Batch& batch) {
+        RegionBounds bounds(_regions.size(), usize(-1), usize(0));
+        for(usize n = 0; n != batch.nodes.size(); ++n) {
+            const usize pass_index = _passes[batch.nodes[n]]->_index;
+            for(usize i = 0; i != _regions.size(); ++i) {
+                if(pass_index >= _regions[i].begin_pass && pass_index <= _regions[i].end_pass) {
+                    bounds[i].first = std::min(bounds[i].first, n);
+                    bounds[i].second = n;
+                }
             }
         }
+        return bounds;
+    };
+
+    // Outer regions are created first, so opening in index order nests them properly
+    auto begin_pass_region = [&](CmdBufferRecorder& rec, CmdTimingRecorder* rec_time_rec, const FrameGraphPass& pass, const RegionBounds& bounds, usize n) {
+        for(usize i = 0; i != _regions.size(); ++i) {
+            if(bounds[i].first != n) {
+                continue;
+            }
+            if(region_colors[i].w() == 0.0f) {
+                region_colors[i] = next_color();
+            }
+            regions.emplace_back(RuntimeRegion{i, rec.region(_regions[i].name.data(), rec_time_rec, region_colors[i]), region_colors[i]});
+        }
 
         const math::Vec4 color = regions.is_empty() ? next_color() : regions.last().next_color();
-        return recorder.region(pass.name().data(), time_rec, color);
+        regions.emplace_back(RuntimeRegion{pass_region, rec.region(pass.name().data(), rec_time_rec, color), color});
     };
 
-    auto end_pass_region = [&](const FrameGraphPass& pass) {
-        for(usize i = 0; i != regions.size(); ++i) {
-            if(regions[i].region.end_pass <= pass._index) {
-                regions.erase_unordered(regions.begin() + i);
-                --i;
-            }
+    auto end_pass_region = [&](const RegionBounds& bounds, usize n) {
+        y_debug_assert(regions.last().index == pass_region);
+        regions.pop();
+
+        while(!regions.is_empty() && bounds[regions.last().index].second == n) {
+            regions.pop();
         }
     };
 
 
 
     // -------------------- resource management --------------------
-    alloc_resources();
+    alias_copied_images();
 
-    usize image_copy_index = 0;
-    std::sort(_image_copies.begin(), _image_copies.end(), [&](const auto& a, const auto& b) { return a.pass_index < b.pass_index; });
+    const core::DependencyGraph::Compiled compiled = compile();
 
-    usize buffer_copy_index = 0;
-    std::sort(_buffer_copies.begin(), _buffer_copies.end(), [&](const auto& a, const auto& b) { return a.pass_index < b.pass_index; });
+    alloc_resources(compiled);
 
-    usize image_clear_index = 0;
+    std::sort(_image_copies.begin(), _image_copies.end(), [&](const auto& a, const auto& b) { return a.pass_index < b.pass_index; });
+    std::sort(_buffer_copies.begin(), _buffer_copies.end(), [&](const auto& a, const auto& b) { return a.pass_index < b.pass_index; });
     std::sort(_image_clears.begin(), _image_clears.end(), [&](const auto& a, const auto& b) { return a.pass_index < b.pass_index; });
 
     using hash_t = std::hash<FrameGraphResourceId>;
@@ -266,74 +313,326 @@ void FrameGraph::render(CmdBufferRecorder& recorder, CmdTimingRecorder* time_rec
 
     {
         y_profile_zone("init");
-        for(const auto& pass : _passes) {
+        for(const u32 index : compiled.order) {
+            const auto& pass = _passes[index];
             y_profile_dyn_zone(pass->name().data());
             pass->init_framebuffer(*_resources);
             pass->init_descriptor_sets(*_resources);
         }
     }
 
+    // Render pass bodies only depend on the resources being allocated, so they can be recorded while we resolve barriers.
+    // Compute passes are recorded inline since they can do about anything with the command buffer.
+    core::FixedArray<std::unique_ptr<ParallelRenderPass>> render_passes(_passes.size());
+    core::FixedArray<concurrent::DependencyGroup> recorded(_passes.size());
+    if constexpr(parallel_recording) {
+        y_profile_zone("schedule recording");
+        concurrent::StaticThreadPool& thread_pool = recording_thread_pool();
+        for(const u32 i : compiled.order) {
+            FrameGraphPass* pass = _passes[i].get();
+            if(!pass->_render) {
+                continue;
+            }
+
+            render_passes[i] = std::make_unique<ParallelRenderPass>(pass->_framebuffer, &thread_pool);
+            thread_pool.schedule([pass, render_pass = render_passes[i].get()] {
+                y_profile_dyn_zone(pass->name().data());
+                pass->render(*render_pass);
+            }, &recorded[i]);
+        }
+    }
+
+    core::FixedArray<u32> positions(_passes.size());
+    for(u32 k = 0; k != compiled.order.size(); ++k) {
+        positions[compiled.order[k]] = k;
+    }
+
+    auto discards_at = [](const auto& discards, u32 position) {
+        const auto begin = std::lower_bound(discards.begin(), discards.end(), position, [](const auto& d, u32 p) { return d.first < p; });
+        const auto end = std::find_if(begin, discards.end(), [&](const auto& d) { return d.first != position; });
+        return core::Range(begin, end);
+    };
+
+
+    // -------------------- queues --------------------
+    const auto& batches = compiled.batches;
+    CmdQueue* async_queue = async_compute_queue();
+    y_debug_assert(batches.size() == 1 || async_queue);
+
+    auto queue_of = [&](u32 batch) -> CmdQueue& {
+        return batches[batch].queue == Queue::Main ? command_queue() : *async_queue;
+    };
+
+    // The first batch is recorded in the caller's command buffer, the last one is handed back to it
+    core::FixedArray<std::unique_ptr<CmdBufferRecorder>> batch_recorders(batches.size());
+    auto batch_recorder = [&](u32 batch) -> CmdBufferRecorder& {
+        if(batch == 0) {
+            return recorder;
+        }
+        if(!batch_recorders[batch]) {
+            batch_recorders[batch] = std::make_unique<CmdBufferRecorder>(queue_of(batch).cmd_pool_for_thread().create_cmd_buffer());
+        }
+        return *batch_recorders[batch];
+    };
+
+    const u32 volume_offset = u32(_images.size());
+    const u32 buffer_offset = volume_offset + u32(_volumes.size());
+
+    // Acquired resources are synchronized with everything that happened on the other queue, so pending barriers are dropped
+    auto transfer_ownership = [&](CmdBufferRecorder& rec, u32 batch, bool release) {
+        y_profile_zone("ownership transfers");
+
+        core::ScratchVector<BufferBarrier> buffer_barriers(compiled.transfers.size());
+        core::ScratchVector<ImageBarrier> image_barriers(compiled.transfers.size());
+        for(const auto& transfer : compiled.transfers) {
+            if((release ? transfer.release_batch : transfer.acquire_batch) != batch) {
+                continue;
+            }
+
+            const u32 src_family = queue_of(transfer.release_batch).family_index();
+            const u32 dst_family = queue_of(transfer.acquire_batch).family_index();
+            auto ownership_barrier = [&](const auto& resource) {
+                using barrier_t = std::conditional_t<std::is_base_of_v<BufferBase, std::remove_cvref_t<decltype(resource)>>, BufferBarrier, ImageBarrier>;
+                return release
+                    ? barrier_t::release_barrier(resource, src_family, dst_family)
+                    : barrier_t::acquire_barrier(resource, src_family, dst_family);
+            };
+
+            const u32 resource = transfer.resource;
+            if(resource < volume_offset) {
+                const FrameGraphImageId res = _images[resource].first;
+                image_barriers.emplace_back(ownership_barrier(_resources->image_base(res)));
+                if(!release) {
+                    core::ScratchVector<FrameGraphImageId> aliases(images_to_barrier.size());
+                    for(const auto& [other, stage] : images_to_barrier) {
+                        if(alias_root(_images, other) == res) {
+                            aliases.push_back(other);
+                        }
+                    }
+                    for(const FrameGraphImageId other : aliases) {
+                        images_to_barrier.erase(other);
+                    }
+                }
+            } else if(resource < buffer_offset) {
+                const FrameGraphVolumeId res = _volumes[resource - volume_offset].first;
+                image_barriers.emplace_back(ownership_barrier(_resources->volume_base(res)));
+                if(!release) {
+                    volumes_to_barrier.erase(res);
+                }
+            } else {
+                const FrameGraphBufferId res = _buffers[resource - buffer_offset].first;
+                buffer_barriers.emplace_back(ownership_barrier(_resources->buffer_base(res)));
+                if(!release) {
+                    buffers_to_barrier.erase(res);
+                }
+            }
+        }
+        rec.barriers(buffer_barriers, image_barriers);
+    };
+
     {
         y_profile_zone("render");
-        for(const auto& pass : _passes) {
-            y_profile_dyn_zone(pass->name().data());
-            const auto region = begin_pass_region(*pass);
-
-            {
-                y_profile_zone("prepare");
-                for(const auto& [res, data] : pass->_map_data) {
-                    auto mapping = _resources->map_buffer_bytes(res);
-                    std::memcpy(mapping.data(), data.data(), data.size());
+        for(u32 b = 0; b != batches.size(); ++b) {
+            const core::DependencyGraph::Batch& batch = batches[b];
+            CmdBufferRecorder& rec = batch_recorder(b);
+
+            // Timings can only be recorded in the command buffer the timing recorder was created with
+            CmdTimingRecorder* rec_time_rec = b == 0 ? time_rec : nullptr;
+            const auto batch_region = rec.region(batch.queue == Queue::Main ? "Framegraph render" : "Framegraph async compute", rec_time_rec, region_color);
+
+            transfer_ownership(rec, b, false);
+
+            const RegionBounds region_bounds = compute_region_bounds(batch);
+
+            for(usize n = 0; n != batch.nodes.size(); ++n) {
+                const u32 i = batch.nodes[n];
+                const auto& pass = _passes[i];
+                y_profile_dyn_zone(pass->name().data());
+                begin_pass_region(rec, rec_time_rec, *pass, region_bounds, n);
+
+                {
+                    // Before copies and clears, which might write to discarded resources
+                    y_profile_zone("discard");
+
+                    const auto image_discards = discards_at(_image_discards, positions[i]);
+                    const auto buffer_discards = discards_at(_buffer_discards, positions[i]);
+
+                    core::ScratchVector<ImageBarrier> image_barriers(image_discards.size());
+                    core::ScratchVector<BufferBarrier> buffer_barriers(buffer_discards.size());
+                    for(const auto& [position, res] : image_discards) {
+                        image_barriers.emplace_back(_resources->discard_barrier(res));
+                    }
+                    for(const auto& [position, res] : buffer_discards) {
+                        buffer_barriers.emplace_back(_resources->discard_barrier(res));
+                    }
+                    rec.barriers(buffer_barriers, image_barriers);
                 }
 
-                while(image_copy_index < _image_copies.size() && _image_copies[image_copy_index].pass_index == pass->_index) {
-                    // copie_image will not do anything if the two are aliased
-                    copy_image(recorder, _image_copies[image_copy_index].src, _image_copies[image_copy_index].dst, images_to_barrier, *_resources);
-                    ++image_copy_index;
+                {
+                    y_profile_zone("prepare");
+                    for(const ImageCopyInfo& copy : pass_infos(_image_copies, pass->_index)) {
+                        // copie_image will not do anything if the two are aliased
+                        copy_image(rec, copy.src, copy.dst, images_to_barrier, *_resources);
+                    }
+
+                    for(const BufferCopyInfo& copy : pass_infos(_buffer_copies, pass->_index)) {
+                        copy_buffer(rec, copy.src, copy.dst, buffers_to_barrier, pass->_buffers, *_resources);
+                    }
+
+                    for(const ImageClearInfo& clear : pass_infos(_image_clears, pass->_index)) {
+                        clear_image(rec, clear.dst, images_to_barrier, *_resources);
+                    }
                 }
 
-                while(buffer_copy_index < _buffer_copies.size() && _buffer_copies[buffer_copy_index].pass_index == pass->_index) {
-                    copy_buffer(recorder, _buffer_copies[buffer_copy_index].src, _buffer_copies[buffer_copy_index].dst, buffers_to_barrier, pass->_buffers, *_resources);
-                    ++buffer_copy_index;
+                {
+                    y_profile_zone("barriers");
+
+                    core::ScratchVector<BufferBarrier> buffer_barriers(pass->_buffers.size());
+                    core::ScratchVector<ImageBarrier> image_barriers(pass->_images.size() + pass->_volumes.size());
+                    build_barriers(pass->_buffers, buffer_barriers, buffers_to_barrier, *_resources);
+                    build_barriers(pass->_volumes, image_barriers, volumes_to_barrier, *_resources);
+                    build_barriers(pass->_images, image_barriers, images_to_barrier, *_resources);
+                    rec.barriers(buffer_barriers, image_barriers);
                 }
 
-                while(image_clear_index < _image_clears.size() && _image_clears[image_clear_index].pass_index == pass->_index) {
-                    clear_image(recorder, _image_clears[image_clear_index].dst, images_to_barrier, *_resources);
-                    ++image_clear_index;
+                {
+                    y_profile_zone("render");
+                    if(render_passes[i]) {
+                        // Helps recording other passes if this one isn't done yet
+                        recording_thread_pool().process_until_complete(recorded[i]);
+                        render_passes[i]->execute(rec);
+                    } else {
+                        pass->render(rec);
+                    }
                 }
+
+                end_pass_region(region_bounds, n);
             }
 
-            {
-                y_profile_zone("barriers");
+            transfer_ownership(rec, b, true);
+            y_debug_assert(regions.is_empty());
+        }
+    }
+
+    TimelineFence upload_fence;
+    {
+        TransferCmdBufferRecorder prepare = create_disposable_transfer_cmd_buffer();
+        _resources->flush_mapped_buffers(prepare);
+        upload_fence = prepare.submit_async();
+        _resources->set_upload_fence(upload_fence);
+    }
+
+    // Mapped buffers are written while recording, so nothing can be submitted before all batches have been recorded.
+    // Batches only wait on previous ones, so submitting them in order never stalls.
+    // Waits are attached to the command buffers themselves, since the last one is submitted by the caller, much later.
+    if(batches.size() > 1) {
+        y_profile_zone("submit batches");
+
+        core::FixedArray<TimelineFence> fences(batches.size());
+        for(u32 b = 0; b != batches.size(); ++b) {
+            const core::DependencyGraph::Batch& batch = batches[b];
+            if(batch.wait != core::DependencyGraph::invalid_batch) {
+                batch_recorder(b).wait_on(fences[batch.wait]);
+            } else if(batch.queue == Queue::Async) {
+                // Main batches are ordered after the upload by the main queue, async ones have to wait for it explicitly
+                batch_recorder(b).wait_on(upload_fence);
+            }
 
-                core::ScratchVector<BufferBarrier> buffer_barriers(pass->_buffers.size());
-                core::ScratchVector<ImageBarrier> image_barriers(pass->_images.size() + pass->_volumes.size());
-                build_barriers(pass->_buffers, buffer_barriers, buffers_to_barrier, *_resources);
-                build_barriers(pass->_volumes, image_barriers, volumes_to_barrier, *_resources);
-                build_barriers(pass->_images, image_barriers, images_to_barrier, *_resources);
-                recorder.barriers(buffer_barriers, image_barriers);
+            if(b + 1 == batches.size()) {
+                y_debug_assert(batch.queue == Queue::Main);
+                recorder = std::move(batch_recorder(b));
+            } else {
+#ifdef YAVE_GPU_PROFILING
+                if(batch.queue == Queue::Async) {
+                    TracyVkCollect(queue_of(b).profiling_context(), batch_recorder(b).vk_cmd_buffer());
+                }
+#endif
+                fences[b] = batch_recorder(b).submit();
             }
+        }
+    }
+
+    Y_TODO(Put ressource barriers at the end of the graph to prevent clash with whatever comes after)
+}
+
+core::DependencyGraph::Compiled FrameGraph::compile() const {
+    y_profile();
+
+    const u32 volume_offset = u32(_images.size());
+    const u32 buffer_offset = volume_offset + u32(_volumes.size());
+
+    auto image_resource = [&](FrameGraphImageId res) {
+        return alias_root(_images, res).id();
+    };
+
+    const bool has_async_queue = async_compute_queue() != nullptr;
 
-            {
-                y_profile_zone("render");
-                pass->render(recorder);
+    core::DependencyGraph graph;
+    for(const auto& pass : _passes) {
+        const u32 node = graph.add_node();
+        y_debug_assert(node + 1 == pass->_index);
+
+        bool has_outputs = false;
+        auto add_access = [&](u32 resource, bool written) {
+            if(written) {
+                graph.add_write(node, resource);
+                has_outputs = true;
+            } else {
+                graph.add_read(node, resource);
             }
+        };
 
-            end_pass_region(*pass);
+        for(auto&& [res, info] : pass->_images) {
+            add_access(image_resource(res), info.written_to);
+        }
+        for(auto&& [res, info] : pass->_volumes) {
+            add_access(volume_offset + res.id(), info.written_to);
+        }
+        for(auto&& [res, info] : pass->_buffers) {
+            add_access(buffer_offset + res.id(), info.written_to);
+        }
+        for(const FrameGraphMutableBufferId res : pass->_mapped_buffers) {
+            add_access(buffer_offset + res.id(), true);
+        }
 
+        // Compute passes can do about anything with the command buffer (copy to external images, readbacks...)
+        // and passes that don't output anything to the graph only exist for their side effects.
+        // Async compute passes only touch graph resources, so they are treated like render passes.
+        if((pass->_compute_render && !pass->_async_compute) || !has_outputs) {
+            graph.set_side_effects(node);
+        }
+
+        if(pass->_async_compute && has_async_queue) {
+            graph.set_async(node);
         }
     }
 
-    {
-        TransferCmdBufferRecorder prepare = create_disposable_transfer_cmd_buffer();
-        _resources->flush_mapped_buffers(prepare);
-        prepare.submit_async();
+    for(auto&& [res, info] : _images) {
+        if(res.is_valid() && info.is_persistent()) {
+            graph.set_output(image_resource(res));
+        }
+    }
+    for(auto&& [res, info] : _volumes) {
+        if(res.is_valid() && info.is_persistent()) {
+            graph.set_output(volume_offset + res.id());
+        }
+    }
+    for(auto&& [res, info] : _buffers) {
+        if(res.is_valid() && info.is_persistent()) {
+            graph.set_output(buffer_offset + res.id());
+        }
     }
 
-    Y_TODO(Put ressource barriers at the end of the graph to prevent clash with whatever comes after)
+    // Keep GPU regions meaningful
+    for(const Region& region : _regions) {
+        graph.add_sequence_point(u32(region.begin_pass - 1));
+        graph.add_sequence_point(u32(region.end_pass));
+    }
+
+    return graph.compile();
 }
 
-void FrameGraph::alloc_resources() {
+void FrameGraph::alias_copied_images() {
     y_profile();
 
     if constexpr(allow_image_aliasing) {
@@ -364,11 +663,121 @@ void FrameGraph::alloc_resources() {
             }
         }
     }
+}
+
+void FrameGraph::alloc_resources(const core::DependencyGraph::Compiled& compiled) {
+    y_profile();
+
+    // Lifetimes are positions in the execution order, so that culled passes don't extend them
+    struct Lifetime {
+        u32 first = u32(-1);
+        u32 last = 0;
+
+        bool is_used() const {
+            return first != u32(-1);
+        }
+
+        void add(u32 position) {
+            first = std::min(first, position);
+            last = std::max(last, position);
+        }
+    };
+
+    core::FixedArray<Lifetime> image_lifetimes(_images.size());
+    core::FixedArray<Lifetime> buffer_lifetimes(_buffers.size());
+    for(u32 k = 0; k != compiled.order.size(); ++k) {
+        const u32 index = compiled.order[k];
+        const auto& pass = _passes[index];
+
+        // Async passes run concurrently with the rest of the frame: their resources must not share memory with anything
+        const bool is_async = compiled.queue(index) == core::DependencyGraph::Queue::Async;
+        auto add_use = [&](Lifetime& lifetime) {
+            lifetime.add(is_async ? 0 : k);
+            lifetime.add(is_async ? u32(compiled.order.size() - 1) : k);
+        };
+
+        for(auto&& [res, info] : pass->_images) {
+            add_use(image_lifetimes[alias_root(_images, res).id()]);
+        }
+        for(auto&& [res, info] : pass->_buffers) {
+            add_use(buffer_lifetimes[res.id()]);
+        }
+        for(const FrameGraphMutableBufferId res : pass->_mapped_buffers) {
+            add_use(buffer_lifetimes[res.id()]);
+        }
+    }
 
     core::ScratchVector<std::pair<FrameGraphImageId, ImageCreateInfo>> images(_images.size());
     std::copy_if(_images.begin(), _images.end(), std::back_inserter(images), [](const auto& p) { return p.first.is_valid(); });
     std::sort(images.begin(), images.end(), [](const auto& a, const auto& b) { return a.second.first_use < b.second.first_use; });
 
+    for(auto&& [res, info] : images) {
+        if(!info.is_prev() && !info.alias.is_valid() && !info.has_usage()) {
+            log_msg(fmt("Image declared by {} has no usage", pass_name(info.first_use)), Log::Warning);
+            // All images should support texturing, hopefully
+            info.usage = info.usage | ImageUsage::TextureBit;
+        }
+    }
+
+    for(auto&& [res, info] : _buffers) {
+        if(info.is_prev()) {
+            continue;
+        }
+        if(info.last_read < info.last_write) {
+            log_msg(fmt("Buffer written by {} is never consumed", pass_name(info.last_write)), Log::Warning);
+        }
+        if(is_none(info.usage)) {
+            log_msg("Unused frame graph buffer resource", Log::Warning);
+            info.usage = info.usage | BufferUsage::StorageBit;
+        }
+    }
+
+    // Transient resources that are used during the frame live in a single heap where they can share memory.
+    // Resources that outlive the frame, volumes, and buffers backed by the staging buffer keep their own memory.
+    if constexpr(allow_memory_aliasing) {
+        core::ScratchVector<FrameGraphImageId> heap_image_ids(images.size());
+        core::ScratchVector<TransientHeap::ImageDesc> heap_images(images.size());
+        for(auto&& [res, info] : images) {
+            const Lifetime& lifetime = image_lifetimes[res.id()];
+            if(info.is_prev() || info.alias.is_valid() || info.is_persistent() || !lifetime.is_used()) {
+                continue;
+            }
+            heap_image_ids.push_back(res);
+            heap_images.push_back({info.format, info.size.to<2>(), info.usage, lifetime.first, lifetime.last});
+        }
+
+        core::ScratchVector<FrameGraphBufferId> heap_buffer_ids(_buffers.size());
+        core::ScratchVector<TransientHeap::BufferDesc> heap_buffers(_buffers.size());
+        for(auto&& [res, info] : _buffers) {
+            if(!res.is_valid()) {
+                continue;
+            }
+            const Lifetime& lifetime = buffer_lifetimes[res.id()];
+            if(info.is_prev() || info.is_persistent() || info.mapped || !lifetime.is_used()) {
+                continue;
+            }
+            heap_buffer_ids.push_back(res);
+            heap_buffers.push_back({info.byte_size, info.usage, lifetime.first, lifetime.last});
+        }
+
+        _resources->create_heap(heap_image_ids, heap_images, heap_buffer_ids, heap_buffers);
+
+        if(const TransientHeap* heap = _resources->heap()) {
+            for(usize i = 0; i != heap_image_ids.size(); ++i) {
+                if(heap->is_image_aliased(i)) {
+                    _image_discards.emplace_back(heap_images[i].first_use, heap_image_ids[i]);
+                }
+            }
+            for(usize i = 0; i != heap_buffer_ids.size(); ++i) {
+                if(heap->is_buffer_aliased(i)) {
+                    _buffer_discards.emplace_back(heap_buffers[i].first_use, heap_buffer_ids[i]);
+                }
+            }
+            std::sort(_image_discards.begin(), _image_discards.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+            std::sort(_buffer_discards.begin(), _buffer_discards.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        }
+    }
+
     for(auto&& [res, info] : images) {
         if(info.is_prev()) {
             y_debug_assert(_resources->is_alive(res));
@@ -378,12 +787,7 @@ void FrameGraph::alloc_resources() {
         if(info.alias.is_valid()) {
             y_debug_assert(allow_image_aliasing);
             _resources->create_alias(res, info.alias);
-        } else {
-            if(!info.has_usage()) {
-                log_msg(fmt("Image declared by {} has no usage", pass_name(info.first_use)), Log::Warning);
-                // All images should support texturing, hopefully
-                info.usage = info.usage | ImageUsage::TextureBit;
-            }
+        } else if(!_resources->is_alive(res)) {
             _resources->create_image(res, info.format, info.size.to<2>(), info.usage, info.persistent);
         }
     }
@@ -405,18 +809,11 @@ void FrameGraph::alloc_resources() {
 
 
     auto init_buffer = [&](FrameGraphMutableBufferId& res, BufferCreateInfo& info, bool exact) {
-        if(info.is_prev()) {
-            y_debug_assert(_resources->is_alive(res));
+        if(_resources->is_alive(res)) {
+            // Previous frame or heap
             return true;
         }
-        if(info.last_read < info.last_write) {
-            log_msg(fmt("Buffer written by {} is never consumed", pass_name(info.last_write)), Log::Warning);
-        }
-        if(is_none(info.usage)) {
-            log_msg("Unused frame graph buffer resource", Log::Warning);
-            info.usage = info.usage | BufferUsage::StorageBit;
-        }
-        return _resources->create_buffer(res, info.byte_size, info.usage, info.memory_type, info.persistent, exact);
+        return _resources->create_buffer(res, info.byte_size, info.usage, info.mapped, info.persistent, exact);
     };
 
     core::ScratchVector<usize> not_exact(_buffers.size());
@@ -431,8 +828,6 @@ void FrameGraph::alloc_resources() {
         auto& [res, info] = _buffers[i];
         y_always_assert(init_buffer(res, info, false), "Unable to allocate buffer");
     }
-
-    _resources->init_staging_buffer();
 }
 
 const core::String& FrameGraph::pass_name(usize pass_index) const {
@@ -699,8 +1094,10 @@ InlineDescriptor FrameGraph::copy_inline_descriptor(InlineDescriptor desc) {
 void FrameGraph::map_buffer(FrameGraphMutableBufferId res, const FrameGraphPass* pass) {
     auto& info = check_exists(_buffers, res);
     info.usage = info.usage | BufferUsage::TransferDstBit;
-    info.memory_type = MemoryType::Staging;
+    info.memory_type = MemoryType::DeviceLocal;
+    info.mapped = true;
     info.register_use(pass->_index, true);
+    _resources->create_upload(res, info.byte_size);
 }
 
 bool FrameGraph::is_attachment(FrameGraphImageId res) const {
@@ -27,6 +27,7 @@ SOFTWARE.
 #include <y/core/Vector.h>
 #include <y/core/String.h>
 #include <y/core/HashMap.h>
+#include <y/core/DependencyGraph.h>
 
 #include <memory>
 
@@ -85,6 +86,9 @@ class FrameGraph : NonMovable {
         u64 byte_size = 0;
         BufferUsage usage = BufferUsage::None;
         MemoryType memory_type = MemoryType::DontCare;
+
+        // Written from the CPU through the upload ring and copied before the first batch, so never aliased
+        bool mapped = false;
     };
 
     struct ImageClearInfo {
@@ -112,6 +116,8 @@ class FrameGraph : NonMovable {
     };
 
     static constexpr bool allow_image_aliasing = true;
+    static constexpr bool allow_memory_aliasing = true;
+    static constexpr bool parallel_recording = true;
 
     public:
         FrameGraph(std::shared_ptr<FrameGraphResourcePool> pool);
@@ -122,6 +128,8 @@ class FrameGraph : NonMovable {
 
         FrameGraphRegion region(std::string_view name);
 
+        // When passes run on the async compute queue, recorder is submitted and replaced by the command buffer of the last batch,
+        // which the caller submits as usual
         void render(CmdBufferRecorder& recorder, CmdTimingRecorder* time_rec = nullptr);
 
         FrameGraphPassBuilder add_pass(std::string_view name);
@@ -184,7 +192,10 @@ class FrameGraph : NonMovable {
 
         FrameGraphPass* create_pass(std::string_view name);
 
-        void alloc_resources();
+        core::DependencyGraph::Compiled compile() const;
+
+        void alias_copied_images();
+        void alloc_resources(const core::DependencyGraph::Compiled& compiled);
         void alloc_image(FrameGraphImageId res, const ImageCreateInfo& info) const;
 
         std::unique_ptr<FrameGraphFrameResources> _resources;
@@ -200,6 +211,10 @@ class FrameGraph : NonMovable {
 
         core::Vector<ImageClearInfo> _image_clears;
 
+        // Resources sharing memory in the transient heap, with the position of their first use in the execution order
+        core::Vector<std::pair<u32, FrameGraphImageId>> _image_discards;
+        core::Vector<std::pair<u32, FrameGraphBufferId>> _buffer_discards;
+
         core::Vector<InlineStorage> _inline_storage;
 
         usize _pass_index = 0;
@@ -24,11 +24,8 @@ SOFTWARE.
 #include "FrameGraphResourcePool.h"
 
 #include <yave/graphics/commands/CmdBufferRecorder.h>
+#include <yave/graphics/commands/CmdQueue.h>
 #include <yave/graphics/buffers/Buffer.h>
-#include <yave/graphics/device/DeviceProperties.h>
-#include <yave/graphics/device/extensions/DebugUtils.h>
-
-#include <y/utils/memory.h>
 
 namespace yave {
 
@@ -45,6 +42,13 @@ FrameGraphFrameResources::~FrameGraphFrameResources() {
     for(auto&& res : _buffer_storage) {
         _pool->release(std::move(res.first), res.second);
     }
+    if(_heap) {
+        _pool->release(std::move(_heap));
+    }
+    if(_has_uploads) {
+        // If the graph was never rendered, nothing has been submitted that reads from the upload memory
+        _pool->end_upload_frame(_upload_frame, _upload_fence.is_valid() ? _upload_fence : command_queue().timeline().current_timeline());
+    }
     _pool->garbage_collect();
 }
 
@@ -64,20 +68,6 @@ u32 FrameGraphFrameResources::create_buffer_id() {
     return _next_buffer_id++;
 }
 
-void FrameGraphFrameResources::init_staging_buffer() {
-    y_profile();
-    
-    if(_staging_buffer_len) {
-        _staging_buffer = StagingBuffer(_staging_buffer_len, MemoryAllocFlags::NoDedicatedAllocBit);
-
-#ifdef Y_DEBUG
-        if(const auto* debug = debug_utils()) {
-            debug->set_resource_name(_staging_buffer.vk_buffer(), "Frame graph staging buffer");
-        }
-#endif
-    }
-}
-
 void FrameGraphFrameResources::create_image(FrameGraphImageId res, TransientImage&& image, FrameGraphPersistentResourceId persistent_id) {
     res.check_valid();
     y_debug_assert(!image.is_null());
@@ -121,22 +111,71 @@ void FrameGraphFrameResources::create_volume(FrameGraphVolumeId res, ImageFormat
     create_volume(res, _pool->create_volume(format, size, usage), persistent_id);
 }
 
-bool FrameGraphFrameResources::create_buffer(FrameGraphBufferId res, u64 byte_size, BufferUsage usage, MemoryType memory, FrameGraphPersistentResourceId persistent_id, bool exact) {
+bool FrameGraphFrameResources::create_buffer(FrameGraphBufferId res, u64 byte_size, BufferUsage usage, bool mapped, FrameGraphPersistentResourceId persistent_id, bool exact) {
     TransientBuffer transient = _pool->create_buffer(byte_size, usage, MemoryType::DeviceLocal, exact);
     if(transient.is_null()) {
         return false;
     }
 
-    const u64 transient_byte_size = transient.byte_size();
-    BufferData& buffer = create_buffer(res, std::move(transient), persistent_id);
+    const BufferData& buffer = create_buffer(res, std::move(transient), persistent_id);
+    y_always_assert(!mapped || buffer.is_mapped(), "Mapped buffer has no staging memory");
+
+    return true;
+}
+
+void FrameGraphFrameResources::create_upload(FrameGraphMutableBufferId res, u64 byte_size) {
+    res.check_valid();
+
+    _buffers.set_min_size(res.id() + 1);
 
-    if(is_cpu_visible(memory)) {
-        y_debug_assert(_staging_buffer.is_null());
-        buffer.staging_buffer_offset = _staging_buffer_len;
-        _staging_buffer_len += align_up_to(transient_byte_size, device_properties().non_coherent_atom_size);
+    BufferData& buffer = _buffers[res.id()];
+    if(buffer.is_mapped()) {
+        y_debug_assert(buffer.staging.byte_size() == byte_size);
+        return;
     }
 
-    return true;
+    if(!_has_uploads) {
+        _upload_frame = _pool->begin_upload_frame();
+        _has_uploads = true;
+    }
+
+    buffer.staging = _pool->alloc_upload(_upload_frame, byte_size);
+}
+
+void FrameGraphFrameResources::create_heap(core::Span<FrameGraphImageId> image_ids, core::Span<TransientHeap::ImageDesc> images,
+                                           core::Span<FrameGraphBufferId> buffer_ids, core::Span<TransientHeap::BufferDesc> buffers) {
+    y_debug_assert(image_ids.size() == images.size());
+    y_debug_assert(buffer_ids.size() == buffers.size());
+    y_always_assert(!_heap, "Heap already exists");
+
+    if(images.is_empty() && buffers.is_empty()) {
+        return;
+    }
+
+    _heap = _pool->create_heap(images, buffers);
+    TransientHeap::set_last_frame_stats(_heap->stats());
+
+    for(usize i = 0; i != image_ids.size(); ++i) {
+        const FrameGraphImageId res = image_ids[i];
+        res.check_valid();
+
+        _images.set_min_size(res.id() + 1);
+        y_always_assert(!_images[res.id()], "Image already exists");
+        _images[res.id()] = &_heap->image(i);
+    }
+
+    for(usize i = 0; i != buffer_ids.size(); ++i) {
+        const FrameGraphBufferId res = buffer_ids[i];
+        res.check_valid();
+
+        _buffers.set_min_size(res.id() + 1);
+        y_always_assert(!_buffers[res.id()].buffer, "Buffer already exists");
+        _buffers[res.id()].buffer = &_heap->buffer(i);
+    }
+}
+
+const TransientHeap* FrameGraphFrameResources::heap() const {
+    return _heap.get();
 }
 
 void FrameGraphFrameResources::create_prev_image(FrameGraphImageId res, FrameGraphPersistentResourceId persistent_id) {
@@ -184,6 +223,14 @@ BufferBarrier FrameGraphFrameResources::barrier(FrameGraphBufferId res, Pipeline
     return BufferBarrier(*_buffers[res.id()].buffer, src, dst);
 }
 
+ImageBarrier FrameGraphFrameResources::discard_barrier(FrameGraphImageId res) const {
+    return ImageBarrier::discard_barrier(find(res));
+}
+
+BufferBarrier FrameGraphFrameResources::discard_barrier(FrameGraphBufferId res) const {
+    return BufferBarrier::discard_barrier(find(res));
+}
+
 const ImageBase& FrameGraphFrameResources::image_base(FrameGraphImageId res) const {
     return find(res);
 }
@@ -200,17 +247,27 @@ BufferMapping<u8> FrameGraphFrameResources::map_buffer_bytes(FrameGraphMutableBu
     return staging_buffer(res).map_bytes(access);
 }
 
+DescriptorSetBase FrameGraphFrameResources::descriptor_set(core::Span<Descriptor> descriptors) const {
+    return _pool->descriptor_set(descriptors);
+}
+
 void FrameGraphFrameResources::flush_mapped_buffers(TransferCmdBufferRecorder& recorder) {
     y_profile();
     const auto region = recorder.region("Flush buffers");
 
     for(const auto& buffer : _buffers) {
         if(buffer.buffer && buffer.is_mapped()) {
-            recorder.unbarriered_copy(staging_buffer(buffer), TransientSubBuffer<BufferUsage::TransferDstBit>(*buffer.buffer));
+            // Pooled buffers might be bigger than requested
+            const TransientSubBuffer<BufferUsage::TransferDstBit> dst(*buffer.buffer);
+            recorder.unbarriered_copy(buffer.staging, SubBuffer<BufferUsage::TransferDstBit>(dst, buffer.staging.byte_size(), 0));
         }
     }
 }
 
+void FrameGraphFrameResources::set_upload_fence(TimelineFence fence) {
+    _upload_fence = fence;
+}
+
 void FrameGraphFrameResources::create_alias(FrameGraphImageId dst, FrameGraphImageId src) {
     dst.check_valid();
     src.check_valid();
@@ -268,24 +325,12 @@ const TransientBuffer& FrameGraphFrameResources::find(FrameGraphBufferId res) co
 
 StagingSubBuffer FrameGraphFrameResources::staging_buffer(FrameGraphMutableBufferId res) const {
     y_always_assert(res.is_valid(), "Invalid buffer resource");
-    y_always_assert(!_staging_buffer.is_null(), "Staging buffer has not been initialized");
 
-    if(!is_alive(res)) {
-        y_fatal("Buffer resource doesn't exist");
-    }
-
-    const auto buffer = _buffers[res.id()];
-    if(!buffer.is_mapped()) {
+    if(res.id() >= _buffers.size() || !_buffers[res.id()].is_mapped()) {
         y_fatal("Buffer has not been mapped");
     }
 
-    return staging_buffer(buffer);
-}
-
-
-StagingSubBuffer FrameGraphFrameResources::staging_buffer(const BufferData& buffer) const {
-    y_debug_assert(buffer.is_mapped());
-    return StagingSubBuffer(_staging_buffer, buffer.buffer->byte_size(), buffer.staging_buffer_offset);
+    return _buffers[res.id()].staging;
 }
 
 
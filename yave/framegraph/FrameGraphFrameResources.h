@@ -25,9 +25,12 @@ SOFTWARE.
 #include "FrameGraphResourceId.h"
 #include "TransientImage.h"
 #include "TransientBuffer.h"
+#include "TransientHeap.h"
 
 #include <yave/graphics/barriers/Barrier.h>
 #include <yave/graphics/buffers/Buffer.h>
+#include <yave/graphics/commands/Timeline.h>
+#include <yave/graphics/descriptors/DescriptorSetBase.h>
 
 #include <y/core/Vector.h>
 #include <y/core/HashMap.h>
@@ -39,10 +42,10 @@ namespace yave {
 class FrameGraphFrameResources final : NonMovable {
     struct BufferData {
         TransientBuffer* buffer = nullptr;
-        u64 staging_buffer_offset = u64(-1);
+        StagingSubBuffer staging;
 
         bool is_mapped() const {
-            return staging_buffer_offset != u64(-1);
+            return !staging.is_null();
         }
     };
 
@@ -58,12 +61,17 @@ class FrameGraphFrameResources final : NonMovable {
         ImageBarrier barrier(FrameGraphVolumeId res, PipelineStage src, PipelineStage dst) const;
         BufferBarrier barrier(FrameGraphBufferId res, PipelineStage src, PipelineStage dst) const;
 
+        ImageBarrier discard_barrier(FrameGraphImageId res) const;
+        BufferBarrier discard_barrier(FrameGraphBufferId res) const;
+
         const ImageBase& image_base(FrameGraphImageId res) const;
         const ImageBase& volume_base(FrameGraphVolumeId res) const;
         const BufferBase& buffer_base(FrameGraphBufferId res) const;
 
         BufferMapping<u8> map_buffer_bytes(FrameGraphMutableBufferId res, MappingAccess access = MappingAccess::WriteOnly) const;
 
+        DescriptorSetBase descriptor_set(core::Span<Descriptor> descriptors) const;
+
         template<ImageUsage Usage>
         ImageView<Usage> image(FrameGraphImageId res) const {
             return TransientImageView<Usage>(find(res));
@@ -95,8 +103,6 @@ class FrameGraphFrameResources final : NonMovable {
     private:
         friend class FrameGraph;
 
-        void init_staging_buffer();
-
         u32 create_image_id();
         u32 create_volume_id();
         u32 create_buffer_id();
@@ -104,7 +110,12 @@ class FrameGraphFrameResources final : NonMovable {
         void create_image(FrameGraphImageId res, ImageFormat format, const math::Vec2ui& size, ImageUsage usage, FrameGraphPersistentResourceId persistent_id);
         void create_volume(FrameGraphVolumeId res, ImageFormat format, const math::Vec3ui& size, ImageUsage usage, FrameGraphPersistentResourceId persistent_id);
         
-        [[nodiscard]] bool create_buffer(FrameGraphBufferId res, u64 byte_size, BufferUsage usage, MemoryType memory, FrameGraphPersistentResourceId persistent_id, bool exact);
+        [[nodiscard]] bool create_buffer(FrameGraphBufferId res, u64 byte_size, BufferUsage usage, bool mapped, FrameGraphPersistentResourceId persistent_id, bool exact);
+
+        void create_heap(core::Span<FrameGraphImageId> image_ids, core::Span<TransientHeap::ImageDesc> images,
+                         core::Span<FrameGraphBufferId> buffer_ids, core::Span<TransientHeap::BufferDesc> buffers);
+
+        const TransientHeap* heap() const;
 
         void create_prev_image(FrameGraphImageId res, FrameGraphPersistentResourceId persistent_id);
         void create_prev_buffer(FrameGraphBufferId res, FrameGraphPersistentResourceId persistent_id);
@@ -118,7 +129,11 @@ class FrameGraphFrameResources final : NonMovable {
 
         void create_alias(FrameGraphImageId dst, FrameGraphImageId src);
 
+        // Mapped buffers get their staging memory as soon as they are mapped, so it can be written to during setup
+        void create_upload(FrameGraphMutableBufferId res, u64 byte_size);
+
         void flush_mapped_buffers(TransferCmdBufferRecorder& recorder);
+        void set_upload_fence(TimelineFence fence);
 
         const TransientImage& find(FrameGraphImageId res) const;
         const TransientVolume& find(FrameGraphVolumeId res) const;
@@ -129,7 +144,6 @@ class FrameGraphFrameResources final : NonMovable {
         BufferData& create_buffer(FrameGraphBufferId res, TransientBuffer&& buffer, FrameGraphPersistentResourceId persistent_id);
 
         StagingSubBuffer staging_buffer(FrameGraphMutableBufferId res) const;
-        StagingSubBuffer staging_buffer(const BufferData& buffer) const;
 
         u32 _next_image_id = 0;
         u32 _next_volume_id = 0;
@@ -146,8 +160,11 @@ class FrameGraphFrameResources final : NonMovable {
         std::deque<std::pair<TransientVolume, FrameGraphPersistentResourceId>> _volume_storage;
         std::deque<std::pair<TransientBuffer, FrameGraphPersistentResourceId>> _buffer_storage;
 
-        StagingBuffer _staging_buffer;
-        u64 _staging_buffer_len = 0;
+        std::unique_ptr<TransientHeap> _heap;
+
+        bool _has_uploads = false;
+        u64 _upload_frame = 0;
+        TimelineFence _upload_fence;
 };
 
 }
@@ -50,7 +50,7 @@ const Framebuffer& FrameGraphPass::framebuffer() const {
     return _framebuffer;
 }
 
-core::Span<DescriptorSet> FrameGraphPass::descriptor_sets() const {
+core::Span<DescriptorSetBase> FrameGraphPass::descriptor_sets() const {
     return _descriptor_sets;
 }
 
@@ -66,6 +66,12 @@ void FrameGraphPass::render(CmdBufferRecorder& recorder) {
     }
 }
 
+void FrameGraphPass::render(ParallelRenderPass& render_pass) {
+    y_debug_assert(_render);
+    y_debug_assert(!_compute_render);
+    render_pass.record([this](RenderPassRecorder& recorder) { _render(recorder, this); });
+}
+
 void FrameGraphPass::init_framebuffer(const FrameGraphFrameResources& resources) {
     y_profile();
 
@@ -115,7 +121,9 @@ void FrameGraphPass::init_descriptor_sets(const FrameGraphFrameResources& resour
         core::ScratchVector<Descriptor> bindings(set.size());
 
         std::transform(set.begin(), set.end(), std::back_inserter(bindings), [&](const FrameGraphDescriptorBinding& d) { return d.create_descriptor(resources); });
-        _descriptor_sets << DescriptorSet(bindings);
+
+        // Most passes bind the same resources every frame, so their sets are reused from previous frames
+        _descriptor_sets << resources.descriptor_set(bindings);
 
 #ifdef Y_DEBUG
         if(const auto* debug = debug_utils()) {
@@ -55,9 +55,10 @@ class FrameGraphPass final : NonMovable {
         const FrameGraphFrameResources& resources() const;
 
         const Framebuffer& framebuffer() const;
-        core::Span<DescriptorSet> descriptor_sets() const;
+        core::Span<DescriptorSetBase> descriptor_sets() const;
 
         void render(CmdBufferRecorder& recorder);
+        void render(ParallelRenderPass& render_pass);
 
     private:
         friend class FrameGraph;
@@ -72,6 +73,7 @@ class FrameGraphPass final : NonMovable {
 
         render_func _render = nullptr;
         compute_render_func _compute_render = nullptr;
+        bool _async_compute = false;
 
         core::String _name;
 
@@ -84,9 +86,9 @@ class FrameGraphPass final : NonMovable {
         core::FlatHashMap<FrameGraphBufferId, ResourceUsageInfo, hash_t> _buffers;
 
         core::SmallVector<core::SmallVector<FrameGraphDescriptorBinding, 8>, 4> _bindings;
-        core::SmallVector<DescriptorSet, 4> _descriptor_sets;
+        core::SmallVector<DescriptorSetBase, 4> _descriptor_sets;
 
-        core::SmallVector<std::pair<FrameGraphMutableBufferId, InlineDescriptor>, 4> _map_data;
+        core::SmallVector<FrameGraphMutableBufferId, 4> _mapped_buffers;
 
         Attachment _depth;
         core::SmallVector<Attachment, 6> _colors;
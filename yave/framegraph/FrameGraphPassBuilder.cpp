@@ -23,6 +23,7 @@ SOFTWARE.
 #include "FrameGraphPassBuilder.h"
 #include "FrameGraphPass.h"
 #include "FrameGraph.h"
+#include "FrameGraphFrameResources.h"
 
 #include <y/utils/format.h>
 
@@ -55,6 +56,10 @@ void FrameGraphPassBuilderBase::set_compute_render_func(compute_render_func &&fu
     _pass->_compute_render = std::move(func);
 }
 
+void FrameGraphPassBuilderBase::set_async_compute() {
+    _pass->_async_compute = true;
+}
+
 PipelineStage FrameGraphPassBuilderBase::or_default(PipelineStage stage) const {
     return stage == PipelineStage::None ? _default_stage : stage;
 }
@@ -309,8 +314,11 @@ void FrameGraphPassBuilderBase::add_descriptor_binding(FrameGraphDescriptorBindi
 
 void FrameGraphPassBuilderBase::map_buffer_internal(FrameGraphMutableBufferId res, InlineDescriptor desc) {
     parent()->map_buffer(res, _pass);
+    _pass->_mapped_buffers << res;
     if(desc.data()) {
-        _pass->_map_data.emplace_back(res, parent()->copy_inline_descriptor(desc));
+        // Written directly in the upload memory, which is copied to the buffer at the start of the frame
+        auto mapping = parent()->resources().map_buffer_bytes(res);
+        std::memcpy(mapping.data(), desc.data(), desc.size());
     }
 }
 
@@ -110,6 +110,7 @@ class FrameGraphPassBuilderBase {
 
         void set_render_func(render_func&& func);
         void set_compute_render_func(compute_render_func&& func);
+        void set_async_compute();
 
     private:
         void add_to_pass(FrameGraphImageId res, ImageUsage usage, bool is_written, PipelineStage stage);
@@ -150,6 +151,12 @@ class FrameGraphComputePassBuilder : public FrameGraphPassBuilderBase {
             FrameGraphPassBuilderBase::set_compute_render_func(compute_render_func(std::move(func)));
         }
 
+        // The pass may run on the async compute queue, concurrently with the rest of the graph.
+        // It should only dispatch and access resources declared in the graph: unlike other compute passes, it can be culled.
+        void allow_async_compute() {
+            FrameGraphPassBuilderBase::set_async_compute();
+        }
+
     private:
         friend class FrameGraph;
 
@@ -22,11 +22,25 @@ SOFTWARE.
 
 #include "FrameGraphResourcePool.h"
 
+#include <yave/graphics/commands/CmdQueue.h>
+#include <yave/graphics/device/DeviceProperties.h>
+#include <yave/graphics/device/extensions/DebugUtils.h>
+
 #include <y/utils/log.h>
 #include <y/utils/format.h>
+#include <y/utils/hash.h>
+#include <y/utils/memory.h>
+
+#include <algorithm>
 
 namespace yave {
 
+static std::atomic<u64> total_hits = 0;
+static std::atomic<u64> total_misses = 0;
+static std::atomic<u64> total_aged_out = 0;
+static std::atomic<u64> total_evicted = 0;
+static std::atomic<u64> total_pooled_bytes = 0;
+
 template<typename U>
 static void check_usage(U u) {
     if(u == U::None) {
@@ -34,10 +48,111 @@ static void check_usage(U u) {
     }
 }
 
+static u64 image_key(ImageFormat format, const math::Vec3ui& size, ImageUsage usage) {
+    u64 key = hash(u64(format.vk_format()));
+    hash_combine(key, u64(hash(u64(size.x()) | (u64(size.y()) << 32))));
+    hash_combine(key, u64(hash(u64(size.z()) | (u64(usage) << 32))));
+    return key;
+}
+
+// Buffers are only reused if they are at most twice as big as requested, so power of two classes are enough
+static u64 buffer_size_class(u64 byte_size) {
+    return byte_size <= 1 ? 0 : log2ui(byte_size - 1) + 1;
+}
+
+static u64 buffer_key(u64 size_class, BufferUsage usage, MemoryType memory) {
+    u64 key = hash(size_class);
+    hash_combine(key, u64(hash(u64(usage) | (u64(memory) << 32))));
+    return key;
+}
+
+static u64 heap_key(core::Span<TransientHeap::ImageDesc> images, core::Span<TransientHeap::BufferDesc> buffers) {
+    u64 key = hash(u64(images.size()) | (u64(buffers.size()) << 32));
+    for(const auto& desc : images) {
+        hash_combine(key, image_key(desc.format, math::Vec3ui(desc.size, 1), desc.usage));
+        hash_combine(key, u64(hash(u64(desc.first_use) | (u64(desc.last_use) << 32))));
+    }
+    for(const auto& desc : buffers) {
+        hash_combine(key, u64(hash(desc.byte_size)));
+        hash_combine(key, u64(hash(u64(desc.usage))));
+        hash_combine(key, u64(hash(u64(desc.first_use) | (u64(desc.last_use) << 32))));
+    }
+    return key;
+}
+
+template<typename T>
+static u64 pooled_byte_size(const T& res) {
+    return res.device_memory().vk_size();
+}
+
+static u64 pooled_byte_size(const std::unique_ptr<TransientHeap>& heap) {
+    return heap->stats().heap_size;
+}
+
 FrameGraphResourcePool::FrameGraphResourcePool() {
 }
 
 FrameGraphResourcePool::~FrameGraphResourcePool() {
+    total_pooled_bytes -= _pooled_bytes;
+}
+
+template<typename T, typename F>
+bool FrameGraphResourcePool::take_from_pool(Buckets<T>& buckets, u64 key, T& res, F&& matches) {
+    const auto bucket = buckets.find(key);
+    if(bucket != buckets.end()) {
+        auto& entries = bucket->second;
+        // Most recently released first, older entries are the first to go
+        for(usize i = entries.size(); i != 0; --i) {
+            Pooled<T>& entry = entries[i - 1];
+            if(matches(entry.resource)) {
+                res = std::move(entry.resource);
+                on_removed(entry.byte_size);
+                entries.erase(entries.begin() + (i - 1));
+
+                ++_hits;
+                ++total_hits;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+template<typename T>
+void FrameGraphResourcePool::add_to_pool(Buckets<T>& buckets, u64 key, T res, u64 byte_size) {
+    buckets[key].emplace_back(Pooled<T>{std::move(res), _frame_id, byte_size});
+    _pooled_bytes += byte_size;
+    total_pooled_bytes += byte_size;
+}
+
+template<typename T>
+void FrameGraphResourcePool::age_out(Buckets<T>& buckets, u64 frame_id) {
+    core::Vector<u64> empty_buckets;
+    for(auto& [key, entries] : buckets) {
+        for(usize i = 0; i < entries.size(); ++i) {
+            if(entries[i].released + max_unused_frames < frame_id) {
+                on_removed(entries[i].byte_size);
+                entries.erase(entries.begin() + i);
+                --i;
+
+                ++_aged_out;
+                ++total_aged_out;
+            }
+        }
+        if(entries.is_empty()) {
+            empty_buckets << key;
+        }
+    }
+
+    for(const u64 key : empty_buckets) {
+        buckets.erase(key);
+    }
+}
+
+void FrameGraphResourcePool::on_removed(u64 byte_size) {
+    y_debug_assert(_pooled_bytes >= byte_size);
+    _pooled_bytes -= byte_size;
+    total_pooled_bytes -= byte_size;
 }
 
 TransientImage FrameGraphResourcePool::create_image(ImageFormat format, const math::Vec2ui& size, ImageUsage usage) {
@@ -46,24 +161,44 @@ TransientImage FrameGraphResourcePool::create_image(ImageFormat format, const ma
     check_usage(usage);
 
     TransientImage image;
-    if(create_image_from_pool(image, format, size, usage)) {
+    const bool found = _pool.locked([&](Pool& pool) {
+        return take_from_pool(pool.images, image_key(format, math::Vec3ui(size, 1), usage), image, [&](const TransientImage& img) {
+            return img.format() == format && img.size() == size && img.usage() == usage;
+        });
+    });
+
+    if(found) {
+        y_debug_assert(!image.is_null());
         return image;
     }
 
+    ++_misses;
+    ++total_misses;
+
     y_profile_zone("create image");
     return TransientImage(format, usage, size);
 }
 
-TransientVolume FrameGraphResourcePool::FrameGraphResourcePool::create_volume(ImageFormat format, const math::Vec3ui& size, ImageUsage usage) {
+TransientVolume FrameGraphResourcePool::create_volume(ImageFormat format, const math::Vec3ui& size, ImageUsage usage) {
     y_profile();
 
     check_usage(usage);
 
     TransientVolume volume;
-    if(create_volume_from_pool(volume, format, size, usage)) {
+    const bool found = _pool.locked([&](Pool& pool) {
+        return take_from_pool(pool.volumes, image_key(format, size, usage), volume, [&](const TransientVolume& vol) {
+            return vol.format() == format && vol.size() == size && vol.usage() == usage;
+        });
+    });
+
+    if(found) {
+        y_debug_assert(!volume.is_null());
         return volume;
     }
 
+    ++_misses;
+    ++total_misses;
+
     y_profile_zone("create volume");
     return TransientVolume(format, usage, size);
 }
@@ -78,7 +213,22 @@ TransientBuffer FrameGraphResourcePool::create_buffer(u64 byte_size, BufferUsage
     }
 
     TransientBuffer buffer;
-    if(create_buffer_from_pool(buffer, byte_size, usage, memory, exact)) {
+    const bool found = _pool.locked([&](Pool& pool) {
+        const u64 size_class = buffer_size_class(byte_size);
+        const auto matches = [&](const TransientBuffer& b) {
+            return b.usage() == usage && b.memory_type() == memory && (exact ? b.byte_size() == byte_size : (b.byte_size() >= byte_size && b.byte_size() <= byte_size * 2));
+        };
+
+        if(take_from_pool(pool.buffers, buffer_key(size_class, usage, memory), buffer, matches)) {
+            return true;
+        }
+
+        // Anything up to twice the size lives in the next class at most
+        return !exact && take_from_pool(pool.buffers, buffer_key(size_class + 1, usage, memory), buffer, matches);
+    });
+
+    if(found) {
+        y_debug_assert(!buffer.is_null());
         return buffer;
     }
 
@@ -86,72 +236,33 @@ TransientBuffer FrameGraphResourcePool::create_buffer(u64 byte_size, BufferUsage
         return {};
     }
 
+    ++_misses;
+    ++total_misses;
+
     y_profile_zone("create buffer");
     return TransientBuffer(byte_size, usage, memory);
 }
 
-bool FrameGraphResourcePool::create_image_from_pool(TransientImage& res, ImageFormat format, const math::Vec2ui& size, ImageUsage usage) {
-    return _images.locked([&](auto&& images) {
-        for(auto it = images.begin(); it != images.end(); ++it) {
-            auto& img = it->first;
-
-            if(img.format() == format && img.size() == size && img.usage() == usage) {
-
-                res = std::move(img);
-                images.erase(it);
-
-                y_debug_assert(!res.is_null());
+std::unique_ptr<TransientHeap> FrameGraphResourcePool::create_heap(core::Span<TransientHeap::ImageDesc> images, core::Span<TransientHeap::BufferDesc> buffers) {
+    y_profile();
 
-                return true;
-            }
-        }
-        return false;
+    // Heaps are only reused for the exact same set of resources and lifetimes, which is the common case from one frame to the next
+    std::unique_ptr<TransientHeap> heap;
+    const bool found = _pool.locked([&](Pool& pool) {
+        return take_from_pool(pool.heaps, heap_key(images, buffers), heap, [&](const std::unique_ptr<TransientHeap>& h) {
+            return h->matches(images, buffers);
+        });
     });
-}
-
-bool FrameGraphResourcePool::create_volume_from_pool(TransientVolume& res, ImageFormat format, const math::Vec3ui& size, ImageUsage usage) {
-    return _volumes.locked([&](auto&& volumes) {
-        for(auto it = volumes.begin(); it != volumes.end(); ++it) {
-            auto& vol = it->first;
 
-            if(vol.format() == format && vol.size() == size && vol.usage() == usage) {
-
-                res = std::move(vol);
-                volumes.erase(it);
+    if(found) {
+        return heap;
+    }
 
-                y_debug_assert(!res.is_null());
+    ++_misses;
+    ++total_misses;
 
-                return true;
-            }
-        }
-        return false;
-    });
-}
-
-bool FrameGraphResourcePool::create_buffer_from_pool(TransientBuffer& res, usize byte_size, BufferUsage usage, MemoryType memory, bool exact) {
-    return _buffers.locked([&](auto&& buffers) {
-        for(auto it = buffers.begin(); it != buffers.end(); ++it) {
-            auto& buffer = it->first;
-
-            bool matches_size = buffer.byte_size() == byte_size;
-            if(!exact) {
-                matches_size |= buffer.byte_size() >= byte_size && buffer.byte_size() <= byte_size * 2;
-            }
-
-            if(matches_size &&
-               buffer.usage() == usage &&
-               (buffer.memory_type() == memory || memory == MemoryType::DontCare)) {
-
-                res = std::move(buffer);
-                buffers.erase(it);
-
-                y_debug_assert(!res.is_null());
-
-                return true;
-            }
-        }
-        return false;
-    });
+    y_profile_zone("create heap");
+    return std::make_unique<TransientHeap>(images, buffers);
 }
 
 void FrameGraphResourcePool::release(TransientImage image, FrameGraphPersistentResourceId persistent_id) {
@@ -167,14 +278,18 @@ void FrameGraphResourcePool::release(TransientImage image, FrameGraphPersistentR
             images[index] = std::move(image);
         });
     } else {
-        _images.locked([&](auto&& images) { images.emplace_back(std::move(image), _frame_id); });
+        const u64 key = image_key(image.format(), image.image_size(), image.usage());
+        const u64 byte_size = pooled_byte_size(image);
+        _pool.locked([&](Pool& pool) { add_to_pool(pool.images, key, std::move(image), byte_size); });
     }
 }
 
 void FrameGraphResourcePool::release(TransientVolume volume, FrameGraphPersistentResourceId persistent_id) {
     y_always_assert(!persistent_id.is_valid(), "Persistent volumes not supported");
     y_debug_assert(!volume.is_null());
-    _volumes.locked([&](auto&& volumes) { volumes.emplace_back(std::move(volume), _frame_id); });
+    const u64 key = image_key(volume.format(), volume.image_size(), volume.usage());
+    const u64 byte_size = pooled_byte_size(volume);
+    _pool.locked([&](Pool& pool) { add_to_pool(pool.volumes, key, std::move(volume), byte_size); });
 }
 
 void FrameGraphResourcePool::release(TransientBuffer buffer, FrameGraphPersistentResourceId persistent_id) {
@@ -190,10 +305,19 @@ void FrameGraphResourcePool::release(TransientBuffer buffer, FrameGraphPersisten
             buffers[index] = std::move(buffer);
         });
     } else {
-        _buffers.locked([&](auto&& buffers) { buffers.emplace_back(std::move(buffer), _frame_id); });
+        const u64 key = buffer_key(buffer_size_class(buffer.byte_size()), buffer.usage(), buffer.memory_type());
+        const u64 byte_size = pooled_byte_size(buffer);
+        _pool.locked([&](Pool& pool) { add_to_pool(pool.buffers, key, std::move(buffer), byte_size); });
     }
 }
 
+void FrameGraphResourcePool::release(std::unique_ptr<TransientHeap> heap) {
+    y_debug_assert(heap);
+    const u64 key = heap_key(heap->image_descs(), heap->buffer_descs());
+    const u64 byte_size = pooled_byte_size(heap);
+    _pool.locked([&](Pool& pool) { add_to_pool(pool.heaps, key, std::move(heap), byte_size); });
+}
+
 bool FrameGraphResourcePool::has_persistent_image(FrameGraphPersistentResourceId persistent_id) const {
     return _persistent_images.locked([&](auto&& images) {
         return persistent_id.id() < images.size() && !images[persistent_id.id()].is_null();
@@ -226,43 +350,200 @@ TransientBuffer FrameGraphResourcePool::persistent_buffer(FrameGraphPersistentRe
     });
 }
 
-void FrameGraphResourcePool::garbage_collect() {
-    y_profile();
+DescriptorSetBase FrameGraphResourcePool::descriptor_set(core::Span<Descriptor> descriptors) {
+    return _descriptor_sets.descriptor_set(descriptors);
+}
 
-    const u64 max_col_count = 6;
-    const u64 frame_id = _frame_id++;
+u64 FrameGraphResourcePool::begin_upload_frame() {
+    return _upload_arena.locked([&](UploadArena& arena) {
+        return arena.next_frame++;
+    });
+}
 
-    _images.locked([&](auto&& images) {
-        for(usize i = 0; i < images.size(); ++i) {
-            if(images[i].second + max_col_count < frame_id) {
-                images.erase(images.begin() + i);
-                --i;
-            }
+StagingSubBuffer FrameGraphResourcePool::alloc_upload(u64 frame, u64 byte_size) {
+    y_debug_assert(byte_size);
+
+    // Mapped ranges are flushed with non coherent atom granularity, so allocations should never share an atom
+    const u64 atom_size = device_properties().non_coherent_atom_size;
+    const u64 alloc_size = align_up_to(byte_size, atom_size);
+
+    return _upload_arena.locked([&](UploadArena& arena) {
+        y_debug_assert(frame < arena.next_frame);
+
+        UploadRing& ring = arena.ring;
+        if(const auto offset = ring.allocator.alloc(frame, alloc_size, atom_size)) {
+            return StagingSubBuffer(ring.buffer, byte_size, offset.unwrap());
+        }
+
+        ring.allocator.release(command_queue().timeline().last_ready().value());
+        if(const auto offset = ring.allocator.alloc(frame, alloc_size, atom_size)) {
+            return StagingSubBuffer(ring.buffer, byte_size, offset.unwrap());
+        }
+
+        y_profile_zone("grow upload buffer");
+
+        const u64 buffer_size = std::max({min_upload_buffer_size, ring.allocator.size() * 2, next_pow_of_2(alloc_size)});
+        log_msg(fmt("Growing frame graph upload buffer to {}KB", buffer_size / 1024), Log::Perf);
+
+        if(ring.allocator.used_size()) {
+            arena.retired.emplace_back(std::move(ring));
+        }
+
+        ring = UploadRing{StagingBuffer(buffer_size), core::RingAllocator(buffer_size)};
+
+#ifdef Y_DEBUG
+        if(const auto* debug = debug_utils()) {
+            debug->set_resource_name(ring.buffer.vk_buffer(), "Frame graph upload buffer");
         }
+#endif
+
+        return StagingSubBuffer(ring.buffer, byte_size, ring.allocator.alloc(frame, alloc_size, atom_size).unwrap());
     });
+}
 
-    _volumes.locked([&](auto&& volumes) {
-        for(usize i = 0; i < volumes.size(); ++i) {
-            if(volumes[i].second + max_col_count < frame_id) {
-                volumes.erase(volumes.begin() + i);
-                --i;
+void FrameGraphResourcePool::end_upload_frame(u64 frame, TimelineFence fence) {
+    y_profile();
+
+    const u64 last_ready = command_queue().timeline().last_ready().value();
+
+    _upload_arena.locked([&](UploadArena& arena) {
+        y_debug_assert(frame < arena.next_frame);
+
+        arena.ring.allocator.end_frame(frame, fence.value());
+        arena.ring.allocator.release(last_ready);
+
+        // Buffer destruction is deferred until the GPU is done with them
+        for(usize i = 0; i < arena.retired.size(); ++i) {
+            UploadRing& ring = arena.retired[i];
+            ring.allocator.end_frame(frame, fence.value());
+            ring.allocator.release(last_ready);
+            if(!ring.allocator.used_size()) {
+                arena.retired.erase_unordered(arena.retired.begin() + i--);
             }
         }
     });
+}
 
-    _buffers.locked([&](auto&& buffers) {
-        for(usize i = 0; i < buffers.size(); ++i) {
-            if(buffers[i].second + max_col_count < frame_id) {
-                buffers.erase(buffers.begin() + i);
-                --i;
+u64 FrameGraphResourcePool::upload_buffer_size() const {
+    return _upload_arena.locked([&](const UploadArena& arena) {
+        return arena.ring.allocator.size();
+    });
+}
+
+void FrameGraphResourcePool::garbage_collect() {
+    y_profile();
+
+    const u64 frame_id = _frame_id++;
+
+    _descriptor_sets.next_frame();
+
+    _pool.locked([&](Pool& pool) {
+        age_out(pool.images, frame_id);
+        age_out(pool.volumes, frame_id);
+        age_out(pool.buffers, frame_id);
+        age_out(pool.heaps, frame_id);
+
+        enforce_budget(pool);
+    });
+}
+
+template<typename T>
+void FrameGraphResourcePool::evict_oldest(Buckets<T>& buckets, u64 key) {
+    const auto bucket = buckets.find(key);
+    y_debug_assert(bucket != buckets.end() && !bucket->second.is_empty());
+
+    auto& entries = bucket->second;
+    on_removed(entries[0].byte_size);
+    entries.erase(entries.begin());
+
+    if(entries.is_empty()) {
+        buckets.erase(bucket);
+    }
+
+    ++_evicted;
+    ++total_evicted;
+}
+
+void FrameGraphResourcePool::enforce_budget(Pool& pool) {
+    const u64 budget = _budget;
+    if(_pooled_bytes <= budget) {
+        return;
+    }
+
+    y_profile();
+
+    struct Candidate {
+        u64 released = 0;
+        u64 key = 0;
+        u32 kind = 0;
+    };
+
+    // Entries are appended on release, so each bucket is sorted from the least to the most recently released
+    core::Vector<Candidate> candidates;
+    auto collect = [&](const auto& buckets, u32 kind) {
+        for(const auto& [key, entries] : buckets) {
+            for(const auto& entry : entries) {
+                candidates.push_back({entry.released, key, kind});
             }
         }
-    });
+    };
+
+    collect(pool.images, 0);
+    collect(pool.volumes, 1);
+    collect(pool.buffers, 2);
+    collect(pool.heaps, 3);
+
+    std::stable_sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.released < b.released; });
+
+    for(const Candidate& candidate : candidates) {
+        if(_pooled_bytes <= budget) {
+            break;
+        }
+
+        switch(candidate.kind) {
+            case 0: evict_oldest(pool.images, candidate.key); break;
+            case 1: evict_oldest(pool.volumes, candidate.key); break;
+            case 2: evict_oldest(pool.buffers, candidate.key); break;
+            default: evict_oldest(pool.heaps, candidate.key); break;
+        }
+    }
 }
 
 u64 FrameGraphResourcePool::frame_id() const {
     return _frame_id;
 }
 
+void FrameGraphResourcePool::set_budget(u64 byte_budget) {
+    _budget = byte_budget;
+}
+
+u64 FrameGraphResourcePool::budget() const {
+    return _budget;
+}
+
+FrameGraphResourcePool::Stats FrameGraphResourcePool::stats() const {
+    Stats stats;
+    stats.hits = _hits;
+    stats.misses = _misses;
+    stats.aged_out = _aged_out;
+    stats.evicted = _evicted;
+    stats.pooled_bytes = _pooled_bytes;
+    return stats;
+}
+
+FrameGraphResourcePool::Stats FrameGraphResourcePool::total_stats() {
+    Stats stats;
+    stats.hits = total_hits;
+    stats.misses = total_misses;
+    stats.aged_out = total_aged_out;
+    stats.evicted = total_evicted;
+    stats.pooled_bytes = total_pooled_bytes;
+    return stats;
+}
+
+const DescriptorSetCache& FrameGraphResourcePool::descriptor_set_cache() const {
+    return _descriptor_sets;
+}
+
 }
 
@@ -24,18 +24,43 @@ SOFTWARE.
 
 #include "TransientBuffer.h"
 #include "TransientImage.h"
+#include "TransientHeap.h"
 #include "FrameGraphResourceId.h"
 
+#include <yave/graphics/descriptors/DescriptorSetCache.h>
+#include <yave/graphics/buffers/Buffer.h>
+#include <yave/graphics/commands/Timeline.h>
+
 #include <y/core/Vector.h>
+#include <y/core/HashMap.h>
+#include <y/core/RingAllocator.h>
 #include <y/concurrent/Mutexed.h>
 
 #include <atomic>
 
 namespace yave {
 
+// Recycles transient resources across frames.
+// Released resources are bucketed by (format, size, usage) for images and by size class for buffers.
+// They age out after max_unused_frames and the least recently released ones are evicted when the pool grows past its budget.
+// Mapped buffers are staged in a persistently mapped ring buffer, recycled once the GPU is done with the frames that wrote to it.
 class FrameGraphResourcePool : NonMovable {
 
     public:
+        static constexpr u64 max_unused_frames = 6;
+        static constexpr u64 default_budget = 512 * 1024 * 1024;
+        static constexpr u64 min_upload_buffer_size = 4 * 1024 * 1024;
+
+        struct Stats {
+            u64 hits = 0;
+            u64 misses = 0;
+            u64 aged_out = 0;
+            u64 evicted = 0;
+
+            // Memory held by unused resources
+            u64 pooled_bytes = 0;
+        };
+
         FrameGraphResourcePool();
         ~FrameGraphResourcePool();
 
@@ -43,9 +68,12 @@ class FrameGraphResourcePool : NonMovable {
         TransientVolume create_volume(ImageFormat format, const math::Vec3ui& size, ImageUsage usage);
         TransientBuffer create_buffer(u64 byte_size, BufferUsage usage, MemoryType memory, bool exact = true);
 
+        std::unique_ptr<TransientHeap> create_heap(core::Span<TransientHeap::ImageDesc> images, core::Span<TransientHeap::BufferDesc> buffers);
+
         void release(TransientImage image, FrameGraphPersistentResourceId persistent_id = {});
         void release(TransientVolume volume, FrameGraphPersistentResourceId persistent_id = {});
         void release(TransientBuffer buffer, FrameGraphPersistentResourceId persistent_id = {});
+        void release(std::unique_ptr<TransientHeap> heap);
 
         bool has_persistent_image(FrameGraphPersistentResourceId persistent_id) const;
         bool has_persistent_buffer(FrameGraphPersistentResourceId persistent_id) const;
@@ -53,24 +81,93 @@ class FrameGraphResourcePool : NonMovable {
         TransientImage persistent_image(FrameGraphPersistentResourceId persistent_id);
         TransientBuffer persistent_buffer(FrameGraphPersistentResourceId persistent_id);
 
+        DescriptorSetBase descriptor_set(core::Span<Descriptor> descriptors);
+
+        // Every upload frame should be ended once it has been submitted, with the fence that signals the end of its uploads.
+        // Frames are retired by their own fence, regardless of other frames being recorded concurrently.
+        u64 begin_upload_frame();
+        StagingSubBuffer alloc_upload(u64 frame, u64 byte_size);
+        void end_upload_frame(u64 frame, TimelineFence fence);
+
+        u64 upload_buffer_size() const;
+
         void garbage_collect();
 
         u64 frame_id() const;
 
+        void set_budget(u64 byte_budget);
+        u64 budget() const;
+
+        Stats stats() const;
+        static Stats total_stats();
+
+        const DescriptorSetCache& descriptor_set_cache() const;
+
     private:
-        bool create_image_from_pool(TransientImage& res, ImageFormat format, const math::Vec2ui& size, ImageUsage usage);
-        bool create_volume_from_pool(TransientVolume& res, ImageFormat format, const math::Vec3ui& size, ImageUsage usage);
-        bool create_buffer_from_pool(TransientBuffer& res, usize byte_size, BufferUsage usage, MemoryType memory, bool exact);
+        template<typename T>
+        struct Pooled {
+            T resource;
+            u64 released = 0;
+            u64 byte_size = 0;
+        };
+
+        template<typename T>
+        using Buckets = core::FlatHashMap<u64, core::Vector<Pooled<T>>>;
+
+        struct Pool {
+            Buckets<TransientImage> images;
+            Buckets<TransientVolume> volumes;
+            Buckets<TransientBuffer> buffers;
+            Buckets<std::unique_ptr<TransientHeap>> heaps;
+        };
 
-        // That's a lot of locking....
-        concurrent::Mutexed<core::Vector<std::pair<TransientImage, u64>>, std::recursive_mutex> _images;
-        concurrent::Mutexed<core::Vector<std::pair<TransientVolume, u64>>, std::recursive_mutex> _volumes;
-        concurrent::Mutexed<core::Vector<std::pair<TransientBuffer, u64>>, std::recursive_mutex> _buffers;
+        template<typename T, typename F>
+        bool take_from_pool(Buckets<T>& buckets, u64 key, T& res, F&& matches);
+
+        template<typename T>
+        void add_to_pool(Buckets<T>& buckets, u64 key, T res, u64 byte_size);
+
+        template<typename T>
+        void age_out(Buckets<T>& buckets, u64 frame_id);
+
+        template<typename T>
+        void evict_oldest(Buckets<T>& buckets, u64 key);
+
+        void enforce_budget(Pool& pool);
+
+        void on_removed(u64 byte_size);
+
+        struct UploadRing {
+            StagingBuffer buffer;
+            core::RingAllocator allocator;
+        };
+
+        struct UploadArena {
+            UploadRing ring;
+
+            // Rings that were outgrown are kept until all the frames that allocated from them are done
+            core::Vector<UploadRing> retired;
+
+            u64 next_frame = 0;
+        };
+
+        concurrent::Mutexed<Pool, std::recursive_mutex> _pool;
 
         concurrent::Mutexed<core::Vector<TransientImage>, std::recursive_mutex> _persistent_images;
         concurrent::Mutexed<core::Vector<TransientBuffer>, std::recursive_mutex> _persistent_buffers;
 
+        DescriptorSetCache _descriptor_sets;
+
+        concurrent::Mutexed<UploadArena> _upload_arena;
+
         std::atomic<u64> _frame_id = 0;
+        std::atomic<u64> _budget = default_budget;
+
+        std::atomic<u64> _hits = 0;
+        std::atomic<u64> _misses = 0;
+        std::atomic<u64> _aged_out = 0;
+        std::atomic<u64> _evicted = 0;
+        std::atomic<u64> _pooled_bytes = 0;
 };
 
 }
@@ -40,6 +40,10 @@ class TransientBuffer final : public BufferBase {
             _memory_type = type;
         }
 
+        TransientBuffer(usize byte_size, BufferUsage usage, VkDeviceMemory memory, u64 memory_offset) :
+                BufferBase(byte_size, usage, memory, memory_offset) {
+        }
+
         MemoryType memory_type() const {
             return _memory_type;
         }
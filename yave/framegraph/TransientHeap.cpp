@@ -0,0 +1,195 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include "TransientHeap.h"
+
+#include <yave/graphics/barriers/Barrier.h>
+#include <yave/graphics/commands/CmdBufferRecorder.h>
+#include <yave/graphics/memory/DeviceMemoryAllocator.h>
+
+#include <y/core/LifetimePacker.h>
+
+#include <algorithm>
+#include <atomic>
+
+namespace yave {
+
+static std::atomic<u64> last_heap_size = 0;
+static std::atomic<u64> last_resource_size = 0;
+
+// Images and buffers never share a block so we don't have to care about bufferImageGranularity
+struct HeapBlock {
+    u32 memory_type_bits = 0;
+    bool images = false;
+    u64 alignment = 1;
+    core::LifetimePacker packer;
+};
+
+struct Placement {
+    usize block = 0;
+    usize index = 0;
+};
+
+static Placement place(core::Vector<HeapBlock>& blocks, const VkMemoryRequirements& reqs, bool image, u32 first_use, u32 last_use) {
+    usize block = 0;
+    for(; block != blocks.size(); ++block) {
+        if(blocks[block].memory_type_bits == reqs.memoryTypeBits && blocks[block].images == image) {
+            break;
+        }
+    }
+
+    if(block == blocks.size()) {
+        blocks.emplace_back().memory_type_bits = reqs.memoryTypeBits;
+        blocks.last().images = image;
+    }
+
+    HeapBlock& heap_block = blocks[block];
+    heap_block.alignment = std::max(heap_block.alignment, u64(reqs.alignment));
+    return {block, heap_block.packer.add(reqs.size, reqs.alignment, first_use, last_use)};
+}
+
+TransientHeap::TransientHeap(core::Span<ImageDesc> images, core::Span<BufferDesc> buffers) :
+        _image_descs(images.begin(), images.end()),
+        _buffer_descs(buffers.begin(), buffers.end()) {
+
+    y_profile();
+
+    core::Vector<HeapBlock> blocks;
+
+    auto image_placements = core::Vector<Placement>::with_capacity(images.size());
+    for(const ImageDesc& desc : images) {
+        const VkMemoryRequirements reqs = ImageBase::memory_requirements(desc.format, desc.usage, math::Vec3ui(desc.size, 1));
+        image_placements << place(blocks, reqs, true, desc.first_use, desc.last_use);
+    }
+
+    auto buffer_placements = core::Vector<Placement>::with_capacity(buffers.size());
+    for(const BufferDesc& desc : buffers) {
+        const VkMemoryRequirements reqs = BufferBase::memory_requirements(desc.byte_size, desc.usage);
+        buffer_placements << place(blocks, reqs, false, desc.first_use, desc.last_use);
+    }
+
+    _blocks.set_min_capacity(blocks.size());
+    for(HeapBlock& block : blocks) {
+        VkMemoryRequirements2 reqs = vk_struct();
+        reqs.memoryRequirements.size = block.packer.pack();
+        reqs.memoryRequirements.alignment = block.alignment;
+        reqs.memoryRequirements.memoryTypeBits = block.memory_type_bits;
+
+        _blocks << device_allocator().alloc(reqs, MemoryType::DeviceLocal, MemoryAllocFlags::None);
+
+        _stats.heap_size += reqs.memoryRequirements.size;
+        _stats.resource_size += block.packer.unaliased_size();
+    }
+
+    auto memory_offset = [&](const Placement& placement) {
+        return _blocks[placement.block].vk_offset() + blocks[placement.block].packer.offsets()[placement.index];
+    };
+
+    _images.set_min_capacity(images.size());
+    _aliased_images.set_min_capacity(images.size());
+    for(usize i = 0; i != images.size(); ++i) {
+        const Placement& placement = image_placements[i];
+        _images.emplace_back(images[i].format, images[i].usage, images[i].size, _blocks[placement.block].vk_memory(), memory_offset(placement));
+        _aliased_images << blocks[placement.block].packer.shares_memory(placement.index);
+    }
+
+    _buffers.set_min_capacity(buffers.size());
+    _aliased_buffers.set_min_capacity(buffers.size());
+    for(usize i = 0; i != buffers.size(); ++i) {
+        const Placement& placement = buffer_placements[i];
+        _buffers.emplace_back(buffers[i].byte_size, buffers[i].usage, _blocks[placement.block].vk_memory(), memory_offset(placement));
+        _aliased_buffers << blocks[placement.block].packer.shares_memory(placement.index);
+    }
+
+    // Images that don't share their memory keep their layout from one frame to the next, so they are only transitioned once
+    {
+        auto barriers = core::Vector<ImageBarrier>::with_capacity(_images.size());
+        for(usize i = 0; i != _images.size(); ++i) {
+            if(!_aliased_images[i]) {
+                barriers << ImageBarrier::transition_barrier(_images[i], VK_IMAGE_LAYOUT_UNDEFINED, vk_image_layout(_images[i].usage()));
+            }
+        }
+
+        if(!barriers.is_empty()) {
+            TransferCmdBufferRecorder recorder = create_disposable_transfer_cmd_buffer();
+            recorder.barriers(barriers);
+            recorder.submit_async();
+        }
+    }
+}
+
+TransientHeap::~TransientHeap() {
+    // Resources have to go before the memory they are bound to
+    _images.clear();
+    _buffers.clear();
+
+    for(DeviceMemory& block : _blocks) {
+        destroy_graphic_resource(std::move(block));
+    }
+}
+
+bool TransientHeap::matches(core::Span<ImageDesc> images, core::Span<BufferDesc> buffers) const {
+    return std::equal(images.begin(), images.end(), _image_descs.begin(), _image_descs.end()) &&
+           std::equal(buffers.begin(), buffers.end(), _buffer_descs.begin(), _buffer_descs.end());
+}
+
+core::Span<TransientHeap::ImageDesc> TransientHeap::image_descs() const {
+    return _image_descs;
+}
+
+core::Span<TransientHeap::BufferDesc> TransientHeap::buffer_descs() const {
+    return _buffer_descs;
+}
+
+TransientImage& TransientHeap::image(usize index) {
+    return _images[index];
+}
+
+TransientBuffer& TransientHeap::buffer(usize index) {
+    return _buffers[index];
+}
+
+bool TransientHeap::is_image_aliased(usize index) const {
+    return _aliased_images[index];
+}
+
+bool TransientHeap::is_buffer_aliased(usize index) const {
+    return _aliased_buffers[index];
+}
+
+TransientHeap::Stats TransientHeap::stats() const {
+    return _stats;
+}
+
+TransientHeap::Stats TransientHeap::last_frame_stats() {
+    Stats stats;
+    stats.heap_size = last_heap_size;
+    stats.resource_size = last_resource_size;
+    return stats;
+}
+
+void TransientHeap::set_last_frame_stats(const Stats& stats) {
+    last_heap_size = stats.heap_size;
+    last_resource_size = stats.resource_size;
+}
+
+}
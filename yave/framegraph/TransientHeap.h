@@ -0,0 +1,101 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#ifndef YAVE_FRAMEGRAPH_TRANSIENTHEAP_H
+#define YAVE_FRAMEGRAPH_TRANSIENTHEAP_H
+
+#include "TransientBuffer.h"
+#include "TransientImage.h"
+
+#include <y/core/Vector.h>
+
+namespace yave {
+
+// Transient images and buffers placed in a few shared memory blocks.
+// Resources that are never alive at the same time can end up in the same memory:
+// the content of aliased resources is undefined on first use and they need to be discarded every frame.
+class TransientHeap : NonMovable {
+    public:
+        struct ImageDesc {
+            ImageFormat format;
+            math::Vec2ui size;
+            ImageUsage usage = ImageUsage::None;
+            u32 first_use = 0;
+            u32 last_use = 0;
+
+            bool operator==(const ImageDesc& other) const = default;
+        };
+
+        struct BufferDesc {
+            u64 byte_size = 0;
+            BufferUsage usage = BufferUsage::None;
+            u32 first_use = 0;
+            u32 last_use = 0;
+
+            bool operator==(const BufferDesc& other) const = default;
+        };
+
+        struct Stats {
+            // Memory actually allocated
+            u64 heap_size = 0;
+            // Memory that would be needed without aliasing
+            u64 resource_size = 0;
+        };
+
+        TransientHeap(core::Span<ImageDesc> images, core::Span<BufferDesc> buffers);
+        ~TransientHeap();
+
+        bool matches(core::Span<ImageDesc> images, core::Span<BufferDesc> buffers) const;
+
+        core::Span<ImageDesc> image_descs() const;
+        core::Span<BufferDesc> buffer_descs() const;
+
+        TransientImage& image(usize index);
+        TransientBuffer& buffer(usize index);
+
+        bool is_image_aliased(usize index) const;
+        bool is_buffer_aliased(usize index) const;
+
+        Stats stats() const;
+
+        // Stats of the last heap used by a frame graph
+        static Stats last_frame_stats();
+        static void set_last_frame_stats(const Stats& stats);
+
+    private:
+        core::Vector<ImageDesc> _image_descs;
+        core::Vector<BufferDesc> _buffer_descs;
+
+        core::Vector<DeviceMemory> _blocks;
+
+        // Never grows after construction, frame resources keep pointers into these
+        core::Vector<TransientImage> _images;
+        core::Vector<TransientBuffer> _buffers;
+
+        core::Vector<bool> _aliased_images;
+        core::Vector<bool> _aliased_buffers;
+
+        Stats _stats;
+};
+
+}
+
+#endif // YAVE_FRAMEGRAPH_TRANSIENTHEAP_H
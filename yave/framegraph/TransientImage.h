@@ -46,6 +46,10 @@ class TransientImageBase final : public ImageBase {
         TransientImageBase(ImageFormat format, ImageUsage usage, const size_type& image_size) : ImageBase(format, usage, to_3d_size(image_size), Type) {
         }
 
+        TransientImageBase(ImageFormat format, ImageUsage usage, const size_type& image_size, VkDeviceMemory memory, u64 memory_offset) :
+                ImageBase(format, usage, to_3d_size(image_size), Type, memory, memory_offset) {
+        }
+
         TransientImageBase(TransientImageBase&&) = default;
         TransientImageBase& operator=(TransientImageBase&&) = default;
 
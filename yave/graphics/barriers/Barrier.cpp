@@ -215,6 +215,40 @@ ImageBarrier ImageBarrier::transition_barrier(const ImageBase& image, VkImageLay
     return barrier;
 }
 
+ImageBarrier ImageBarrier::discard_barrier(const ImageBase& image) {
+    ImageBarrier barrier = transition_barrier(image, VK_IMAGE_LAYOUT_UNDEFINED, vk_image_layout(image.usage()));
+    barrier._barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+    barrier._src = PipelineStage::All;
+
+    return barrier;
+}
+
+ImageBarrier ImageBarrier::release_barrier(const ImageBase& image, u32 src_family, u32 dst_family) {
+    ImageBarrier barrier;
+    barrier._barrier = create_barrier(image.vk_image(), image.format(), image.layers(), image.mipmaps(), image.usage(), PipelineStage::EndOfPipe, PipelineStage::EndOfPipe);
+    barrier._barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+    barrier._barrier.dstAccessMask = 0;
+    barrier._barrier.srcQueueFamilyIndex = src_family;
+    barrier._barrier.dstQueueFamilyIndex = dst_family;
+    barrier._src = PipelineStage::All;
+    barrier._dst = PipelineStage::EndOfPipe;
+
+    return barrier;
+}
+
+ImageBarrier ImageBarrier::acquire_barrier(const ImageBase& image, u32 src_family, u32 dst_family) {
+    ImageBarrier barrier;
+    barrier._barrier = create_barrier(image.vk_image(), image.format(), image.layers(), image.mipmaps(), image.usage(), PipelineStage::EndOfPipe, PipelineStage::EndOfPipe);
+    barrier._barrier.srcAccessMask = 0;
+    barrier._barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    barrier._barrier.srcQueueFamilyIndex = src_family;
+    barrier._barrier.dstQueueFamilyIndex = dst_family;
+    barrier._src = PipelineStage::BeginOfPipe;
+    barrier._dst = PipelineStage::All;
+
+    return barrier;
+}
+
 ImageBarrier ImageBarrier::transition_to_barrier(const ImageBase& image, VkImageLayout dst_layout) {
     return transition_barrier(image, vk_image_layout(image.usage()), dst_layout);
 }
@@ -247,6 +281,41 @@ BufferBarrier::BufferBarrier(const SubBufferBase& buffer, PipelineStage src, Pip
         _src(src), _dst(dst) {
 }
 
+BufferBarrier BufferBarrier::discard_barrier(const BufferBase& buffer) {
+    BufferBarrier barrier;
+    barrier._barrier = create_barrier(buffer.vk_buffer(), buffer.byte_size(), 0, PipelineStage::EndOfPipe, PipelineStage::EndOfPipe);
+    barrier._barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    barrier._src = PipelineStage::All;
+    barrier._dst = PipelineStage::All;
+
+    return barrier;
+}
+
+BufferBarrier BufferBarrier::release_barrier(const BufferBase& buffer, u32 src_family, u32 dst_family) {
+    BufferBarrier barrier;
+    barrier._barrier = create_barrier(buffer.vk_buffer(), buffer.byte_size(), 0, PipelineStage::EndOfPipe, PipelineStage::EndOfPipe);
+    barrier._barrier.dstAccessMask = 0;
+    barrier._barrier.srcQueueFamilyIndex = src_family;
+    barrier._barrier.dstQueueFamilyIndex = dst_family;
+    barrier._src = PipelineStage::All;
+    barrier._dst = PipelineStage::EndOfPipe;
+
+    return barrier;
+}
+
+BufferBarrier BufferBarrier::acquire_barrier(const BufferBase& buffer, u32 src_family, u32 dst_family) {
+    BufferBarrier barrier;
+    barrier._barrier = create_barrier(buffer.vk_buffer(), buffer.byte_size(), 0, PipelineStage::EndOfPipe, PipelineStage::EndOfPipe);
+    barrier._barrier.srcAccessMask = 0;
+    barrier._barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    barrier._barrier.srcQueueFamilyIndex = src_family;
+    barrier._barrier.dstQueueFamilyIndex = dst_family;
+    barrier._src = PipelineStage::BeginOfPipe;
+    barrier._dst = PipelineStage::All;
+
+    return barrier;
+}
+
 VkBufferMemoryBarrier BufferBarrier::vk_barrier() const {
     return _barrier;
 }
@@ -40,6 +40,13 @@ class ImageBarrier {
         static ImageBarrier transition_to_barrier(const ImageBase& image, VkImageLayout dst_layout);
         static ImageBarrier transition_from_barrier(const ImageBase& image, VkImageLayout src_layout);
 
+        // For images whose memory might have been used by another resource: waits on everything before and drops the content
+        static ImageBarrier discard_barrier(const ImageBase& image);
+
+        // Queue family ownership transfer: the release is recorded on the source queue and the acquire on the destination one
+        static ImageBarrier release_barrier(const ImageBase& image, u32 src_family, u32 dst_family);
+        static ImageBarrier acquire_barrier(const ImageBase& image, u32 src_family, u32 dst_family);
+
 
         VkImageMemoryBarrier vk_barrier() const;
 
@@ -59,6 +66,10 @@ class BufferBarrier {
         BufferBarrier(const BufferBase& buffer, PipelineStage src, PipelineStage dst);
         BufferBarrier(const SubBufferBase& buffer, PipelineStage src, PipelineStage dst);
 
+        static BufferBarrier discard_barrier(const BufferBase& buffer);
+
+        static BufferBarrier release_barrier(const BufferBase& buffer, u32 src_family, u32 dst_family);
+        static BufferBarrier acquire_barrier(const BufferBase& buffer, u32 src_family, u32 dst_family);
 
         VkBufferMemoryBarrier vk_barrier() const;
 
@@ -66,6 +77,8 @@ class BufferBarrier {
         PipelineStage src_stage() const;
 
     private:
+        BufferBarrier() = default;
+
         VkBufferMemoryBarrier _barrier;
         PipelineStage _src;
         PipelineStage _dst;
@@ -30,7 +30,7 @@ SOFTWARE.
 
 namespace yave {
 
-static VkBuffer create_buffer(u64 byte_size, VkBufferUsageFlags usage) {
+static VkBufferCreateInfo buffer_create_info(u64 byte_size, VkBufferUsageFlags usage) {
     y_debug_assert(byte_size);
     if(usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT) {
         if(byte_size > device_properties().max_uniform_buffer_size) {
@@ -44,6 +44,11 @@ static VkBuffer create_buffer(u64 byte_size, VkBufferUsageFlags usage) {
         create_info.usage = usage;
         create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
     }
+    return create_info;
+}
+
+static VkBuffer create_buffer(u64 byte_size, VkBufferUsageFlags usage) {
+    const VkBufferCreateInfo create_info = buffer_create_info(byte_size, usage);
 
     VkBuffer buffer = {};
     vk_check(vkCreateBuffer(vk_device(), &create_info, vk_allocation_callbacks(), &buffer));
@@ -151,6 +156,11 @@ BufferBase::BufferBase(u64 byte_size, BufferUsage usage, MemoryType type, Memory
     std::tie(*_buffer.get_ptr_for_init(), _memory) = alloc_buffer(byte_size, VkBufferUsageFlagBits(usage), type, alloc_flags);
 }
 
+BufferBase::BufferBase(u64 byte_size, BufferUsage usage, VkDeviceMemory memory, u64 memory_offset) : _size(byte_size), _usage(usage) {
+    *_buffer.get_ptr_for_init() = create_buffer(byte_size, VkBufferUsageFlagBits(usage));
+    vk_check(vkBindBufferMemory(vk_device(), _buffer, memory, memory_offset));
+}
+
 BufferBase::~BufferBase() {
     destroy_graphic_resource(std::move(_buffer));
     destroy_graphic_resource(std::move(_memory));
@@ -176,6 +186,17 @@ const DeviceMemory& BufferBase::device_memory() const {
     return _memory;
 }
 
+VkMemoryRequirements BufferBase::memory_requirements(u64 byte_size, BufferUsage usage) {
+    const VkBufferCreateInfo create_info = buffer_create_info(byte_size, VkBufferUsageFlagBits(usage));
+
+    VkDeviceBufferMemoryRequirements infos = vk_struct();
+    infos.pCreateInfo = &create_info;
+
+    VkMemoryRequirements2 reqs = vk_struct();
+    vkGetDeviceBufferMemoryRequirements(vk_device(), &infos, &reqs);
+    return reqs.memoryRequirements;
+}
+
 VkDescriptorBufferInfo BufferBase::vk_descriptor_info() const {
     VkDescriptorBufferInfo info = {};
     {
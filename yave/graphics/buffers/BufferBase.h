@@ -79,6 +79,8 @@ class BufferBase : NonCopyable {
 
         VkBuffer vk_buffer() const;
 
+        static VkMemoryRequirements memory_requirements(u64 byte_size, BufferUsage usage);
+
     protected:
         BufferBase() = default;
         BufferBase(BufferBase&&) = default;
@@ -86,6 +88,9 @@ class BufferBase : NonCopyable {
 
         BufferBase(u64 byte_size, BufferUsage usage, MemoryType type, MemoryAllocFlags alloc_flags = MemoryAllocFlags::None);
 
+        // Binds to memory owned by someone else
+        BufferBase(u64 byte_size, BufferUsage usage, VkDeviceMemory memory, u64 memory_offset);
+
     private:
         u64 _size = 0;
         BufferUsage _usage = BufferUsage::None;
@@ -24,6 +24,10 @@ SOFTWARE.
 
 #include <yave/graphics/commands/CmdBufferPool.h>
 #include <yave/graphics/device/LifetimeManager.h>
+#include <yave/graphics/descriptors/DescriptorSetAllocator.h>
+#include <yave/graphics/descriptors/Descriptor.h>
+
+#include <y/core/ScratchPad.h>
 
 namespace yave {
 
@@ -58,6 +62,7 @@ CmdBufferData::CmdBufferData(VkCommandBuffer buffer, CmdBufferPool* pool, VkComm
 
 CmdBufferData::~CmdBufferData() {
     y_debug_assert(!_pool || is_ready());
+    recycle_transient_pools();
     destroy_graphic_resource(std::move(_semaphore));
 }
 
@@ -66,6 +71,36 @@ void CmdBufferData::push_secondary(CmdBufferData* data) {
     _secondaries << data;
 }
 
+void CmdBufferData::push_wait_fence(TimelineFence fence) {
+    y_debug_assert(!is_secondary());
+    y_debug_assert(fence.is_valid());
+    _wait_fences << fence;
+}
+
+VkDescriptorSet CmdBufferData::create_transient_descriptor_set(core::Span<Descriptor> descriptors) {
+    y_profile();
+
+    core::ScratchPad<VkDescriptorSetLayoutBinding> layout_bindings(descriptors.size());
+    for(usize i = 0; i != descriptors.size(); ++i) {
+        layout_bindings[i] = descriptors[i].descriptor_set_layout_binding(u32(i));
+    }
+
+    const DescriptorSetLayout& layout = descriptor_set_allocator().descriptor_set_layout(layout_bindings);
+
+    // Only the recording thread touches the pools, so they don't need any synchronization
+    if(!_transient_pools.is_empty()) {
+        if(const VkDescriptorSet set = _transient_pools.last()->alloc(layout, descriptors)) {
+            return set;
+        }
+    }
+
+    _transient_pools << transient_descriptor_set_allocator().claim_pool();
+
+    const VkDescriptorSet set = _transient_pools.last()->alloc(layout, descriptors);
+    y_always_assert(set, "Descriptor set is too big for a transient descriptor pool");
+    return set;
+}
+
 bool CmdBufferData::is_null() const {
     return !_cmd_buffer;
 }
@@ -105,6 +140,16 @@ void CmdBufferData::reset() {
 
     _resource_fence = lifetime_manager().create_fence();
     _timeline_fence = {};
+    _wait_fences.make_empty();
+
+    y_debug_assert(_transient_pools.is_empty());
+}
+
+void CmdBufferData::recycle_transient_pools() {
+    if(!_transient_pools.is_empty()) {
+        transient_descriptor_set_allocator().recycle(_transient_pools);
+        _transient_pools.make_empty();
+    }
 }
 
 
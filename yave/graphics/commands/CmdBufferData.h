@@ -57,6 +57,12 @@ class CmdBufferData final : NonMovable {
 
         void push_secondary(CmdBufferData* data);
 
+        // The command buffer will not start before fence, which can belong to another queue, is signaled
+        void push_wait_fence(TimelineFence fence);
+
+        // Allocated from transient descriptor pools owned by the command buffer until it has completed
+        VkDescriptorSet create_transient_descriptor_set(core::Span<Descriptor> descriptors);
+
         bool is_null() const;
         bool is_secondary() const;
 
@@ -75,6 +81,7 @@ class CmdBufferData final : NonMovable {
         friend class CmdQueue;
 
         void reset();
+        void recycle_transient_pools();
 
         // These are owned by the command pool
         const VkCommandBuffer _cmd_buffer;
@@ -87,6 +94,8 @@ class CmdBufferData final : NonMovable {
         TimelineFence _timeline_fence;
 
         core::SmallVector<CmdBufferData*, 8> _secondaries;
+        core::SmallVector<TimelineFence, 2> _wait_fences;
+        core::SmallVector<TransientDescriptorPool*, 2> _transient_pools;
         const VkCommandBufferLevel _level;
 };
 
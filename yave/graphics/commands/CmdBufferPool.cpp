@@ -90,6 +90,9 @@ void CmdBufferPool::release(CmdBufferData* data) {
     y_debug_assert(data->is_ready());
     y_debug_assert(data->_secondaries.is_empty());
 
+    // The GPU is done with the command buffer, so are the descriptor sets it used
+    data->recycle_transient_pools();
+
     (data->is_secondary() ? _secondary : _primary).released.locked([&](auto&& released) { released << data; });
 }
 
@@ -132,6 +135,10 @@ CmdBufferRecorder CmdBufferPool::create_cmd_buffer(bool secondary) {
     return CmdBufferRecorder(alloc(secondary ? _secondary : _primary));
 }
 
+CmdBufferRecorder CmdBufferPool::create_render_pass_cmd_buffer(const Framebuffer& framebuffer) {
+    return CmdBufferRecorder(alloc(_secondary), framebuffer);
+}
+
 ComputeCmdBufferRecorder CmdBufferPool::create_compute_cmd_buffer() {
     return ComputeCmdBufferRecorder(alloc(_primary));
 }
@@ -43,6 +43,7 @@ class CmdBufferPool : NonMovable {
         CmdQueue* queue() const;
 
         CmdBufferRecorder create_cmd_buffer(bool secondary = false);
+        CmdBufferRecorder create_render_pass_cmd_buffer(const Framebuffer& framebuffer);
         ComputeCmdBufferRecorder create_compute_cmd_buffer();
         TransferCmdBufferRecorder create_transfer_cmd_buffer();
 
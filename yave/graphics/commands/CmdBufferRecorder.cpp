@@ -23,6 +23,7 @@ SOFTWARE.
 #include "CmdBufferRecorder.h"
 #include "CmdTimingRecorder.h"
 #include "CmdQueue.h"
+#include "CmdBufferPool.h"
 
 #include <yave/material/Material.h>
 #include <yave/material/MaterialTemplate.h>
@@ -35,7 +36,11 @@ SOFTWARE.
 #include <yave/meshes/MeshDrawData.h>
 
 #include <yave/graphics/device/extensions/DebugUtils.h>
+#include <yave/graphics/device/DeviceProperties.h>
+#include <yave/graphics/graphics.h>
 
+#include <y/concurrent/StaticThreadPool.h>
+#include <y/core/FixedArray.h>
 #include <y/core/ScratchPad.h>
 
 
@@ -104,7 +109,7 @@ void CmdBufferRegion::swap(CmdBufferRegion& other) {
 
 // -------------------------------------------------- RenderPassRecorder --------------------------------------------------
 
-RenderPassRecorder::RenderPassRecorder(CmdBufferRecorder& cmd_buffer, const Viewport& viewport) : _cmd_buffer(cmd_buffer) {
+RenderPassRecorder::RenderPassRecorder(CmdBufferRecorder& cmd_buffer, const Viewport& viewport, ParallelRenderPass* parallel) : _cmd_buffer(cmd_buffer), _parallel(parallel) {
     set_viewport(viewport);
     set_scissor(math::Vec2i(viewport.offset), math::Vec2ui(viewport.extent));
 }
@@ -113,15 +118,36 @@ RenderPassRecorder::~RenderPassRecorder() {
     _cmd_buffer.end_renderpass();
 }
 
-void RenderPassRecorder::bind_material_template(const MaterialTemplate* material_template, core::Span<DescriptorSetBase> sets, bool bind_main_ds) {
-    if(material_template != _cache.material) {
-        const GraphicPipeline& pipeline = material_template->compile(*_cmd_buffer._render_pass);
-        vkCmdBindPipeline(vk_cmd_buffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.vk_pipeline());
+void RenderPassRecorder::bind_material_template(const MaterialTemplate* material_template, core::Span<DescriptorSetBase> sets, bool bind_main_ds, MeshVertexFormat vertex_format) {
+    if(material_template != _cache.material || vertex_format != _cache.vertex_format) {
+        bind_pipeline(material_template, material_template->compile(*_cmd_buffer._render_pass, vertex_format), vertex_format);
+    }
+
+    bind_descriptor_sets(sets, bind_main_ds);
+}
 
-        _cache.material = material_template;
-        _cache.pipeline_layout = pipeline.vk_pipeline_layout();
+bool RenderPassRecorder::try_bind_material_template(const MaterialTemplate* material_template, core::Span<DescriptorSetBase> sets, bool bind_main_ds, MeshVertexFormat vertex_format) {
+    if(material_template != _cache.material || vertex_format != _cache.vertex_format) {
+        const GraphicPipeline* pipeline = material_template->compile_async(*_cmd_buffer._render_pass, vertex_format);
+        if(!pipeline) {
+            return false;
+        }
+        bind_pipeline(material_template, *pipeline, vertex_format);
     }
 
+    bind_descriptor_sets(sets, bind_main_ds);
+    return true;
+}
+
+void RenderPassRecorder::bind_pipeline(const MaterialTemplate* material_template, const GraphicPipeline& pipeline, MeshVertexFormat vertex_format) {
+    vkCmdBindPipeline(vk_cmd_buffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.vk_pipeline());
+
+    _cache.material = material_template;
+    _cache.vertex_format = vertex_format;
+    _cache.pipeline_layout = pipeline.vk_pipeline_layout();
+}
+
+void RenderPassRecorder::bind_descriptor_sets(core::Span<DescriptorSetBase> sets, bool bind_main_ds) {
     if(_main_descriptor_set && bind_main_ds) {
         vkCmdBindDescriptorSets(
             vk_cmd_buffer(),
@@ -186,6 +212,20 @@ void RenderPassRecorder::draw_indirect(TypedSubBuffer<VkDrawIndexedIndirectComma
     );
 }
 
+void RenderPassRecorder::draw_indirect_count(TypedSubBuffer<VkDrawIndexedIndirectCommand, BufferUsage::IndirectBit> indirect, TypedSubBuffer<u32, BufferUsage::IndirectBit> count) {
+    y_debug_assert(device_properties().draw_indirect_count);
+    y_debug_assert(count.size() == 1);
+
+    vkCmdDrawIndexedIndirectCount(vk_cmd_buffer(),
+        indirect.vk_buffer(),
+        indirect.byte_offset(),
+        count.vk_buffer(),
+        count.byte_offset(),
+        u32(indirect.size()),
+        sizeof(VkDrawIndexedIndirectCommand)
+    );
+}
+
 void RenderPassRecorder::draw_indexed(usize index_count) {
     VkDrawIndexedIndirectCommand command = {};
     command.indexCount = u32(index_count);
@@ -202,16 +242,16 @@ void RenderPassRecorder::draw_array(usize vertex_count, usize instance_count) {
 
 void RenderPassRecorder::bind_mesh_buffers(const MeshDrawBuffers& mesh_buffers) {
     if(_cache.mesh_buffers != &mesh_buffers) {
-        bind_index_buffer(mesh_buffers.triangle_buffer());
+        bind_index_buffer(mesh_buffers.index_buffer(), mesh_buffers.index_type());
         bind_attrib_buffers(mesh_buffers.attrib_buffers());
         _cache.mesh_buffers = &mesh_buffers;
     }
 }
 
-void RenderPassRecorder::bind_index_buffer(IndexSubBuffer indices) {
+void RenderPassRecorder::bind_index_buffer(IndexSubBuffer indices, VkIndexType index_type) {
     _cache.mesh_buffers = nullptr;
 
-    vkCmdBindIndexBuffer(vk_cmd_buffer(), indices.vk_buffer(), indices.byte_offset(), VK_INDEX_TYPE_UINT32);
+    vkCmdBindIndexBuffer(vk_cmd_buffer(), indices.vk_buffer(), indices.byte_offset(), index_type);
 }
 
 void RenderPassRecorder::bind_attrib_buffers(core::Span<AttribSubBuffer> attribs) {
@@ -256,8 +296,55 @@ void RenderPassRecorder::set_scissor(const math::Vec2i& offset, const math::Vec2
     y_debug_assert(offset.x() >= 0.0f);
     y_debug_assert(offset.y() >= 0.0f);
 
-    const VkRect2D scissor = {{offset.x(), offset.y()}, {size.x(), size.y()}};
-    vkCmdSetScissor(vk_cmd_buffer(), 0, 1, &scissor);
+    _scissor = {{offset.x(), offset.y()}, {size.x(), size.y()}};
+    vkCmdSetScissor(vk_cmd_buffer(), 0, 1, &_scissor);
+}
+
+void RenderPassRecorder::record_parallel(usize count, const std::function<void(RenderPassRecorder&, usize)>& func) {
+    if(!_parallel || !_parallel->_thread_pool || count < 2) {
+        for(usize i = 0; i != count; ++i) {
+            func(*this, i);
+        }
+        return;
+    }
+
+    y_profile();
+
+    ParallelRenderPass& parallel = *_parallel;
+    concurrent::StaticThreadPool& thread_pool = *parallel._thread_pool;
+
+    // Everything recorded until now has to be executed first
+    parallel._secondaries << ParallelRenderPass::end_secondary(_cmd_buffer);
+
+    core::FixedArray<CmdBufferData*> recorded(count);
+    core::FixedArray<concurrent::DependencyGroup> groups(count);
+    for(usize i = 0; i != count; ++i) {
+        thread_pool.schedule([&, i] {
+            y_profile_zone("record secondary");
+
+            CmdBufferRecorder secondary = parallel.create_secondary();
+            {
+                RenderPassRecorder render_pass(secondary, _viewport);
+                render_pass.set_scissor(math::Vec2i(_scissor.offset.x, _scissor.offset.y), math::Vec2ui(_scissor.extent.width, _scissor.extent.height));
+                render_pass._main_descriptor_set = _main_descriptor_set;
+                func(render_pass, i);
+            }
+            recorded[i] = ParallelRenderPass::end_secondary(secondary);
+        }, &groups[i]);
+    }
+
+    // Helps with the recording instead of just waiting
+    thread_pool.process_until_complete(groups);
+
+    for(CmdBufferData* data : recorded) {
+        parallel._secondaries << data;
+    }
+
+    // Secondaries don't inherit any state
+    _cmd_buffer = parallel.create_secondary();
+    _cache = {};
+    set_viewport(_viewport);
+    vkCmdSetScissor(vk_cmd_buffer(), 0, 1, &_scissor);
 }
 
 
@@ -275,13 +362,33 @@ CmdBufferRecorderBase::CmdBufferRecorderBase(CmdBufferData* data) : _data(data)
     vk_check(vkBeginCommandBuffer(vk_cmd_buffer(), &begin_info));
 }
 
+CmdBufferRecorderBase::CmdBufferRecorderBase(CmdBufferData* data, const Framebuffer& framebuffer) : _data(data) {
+    y_debug_assert(_data->is_secondary());
+
+    VkCommandBufferInheritanceInfo inheritance_info = vk_struct();
+    {
+        inheritance_info.renderPass = framebuffer.render_pass().vk_render_pass();
+        inheritance_info.subpass = 0;
+        inheritance_info.framebuffer = framebuffer.vk_framebuffer();
+    }
+
+    VkCommandBufferBeginInfo begin_info = vk_struct();
+    {
+        begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+        begin_info.pInheritanceInfo = &inheritance_info;
+    }
+
+    vk_check(vkBeginCommandBuffer(vk_cmd_buffer(), &begin_info));
+    _render_pass = &framebuffer.render_pass();
+}
+
 CmdBufferRecorderBase::~CmdBufferRecorderBase() {
     check_no_renderpass();
     y_always_assert(!_data, "CmdBufferRecorder has not been submitted");
 }
 
 void CmdBufferRecorderBase::swap(CmdBufferRecorderBase& other) {
-    y_debug_assert(_data->is_secondary() == other._data->is_secondary());
+    y_debug_assert(!_data || !other._data || _data->is_secondary() == other._data->is_secondary());
 
     std::swap(_data, other._data);
     std::swap(_render_pass, other._render_pass);
@@ -313,7 +420,10 @@ CmdBufferRegion CmdBufferRecorderBase::region(const char* name, CmdTimingRecorde
 void CmdBufferRecorderBase::end_renderpass() {
     y_debug_assert(_render_pass);
 
-    vkCmdEndRenderPass(vk_cmd_buffer());
+    // Secondaries only continue a render pass started by the primary
+    if(!_data->is_secondary()) {
+        vkCmdEndRenderPass(vk_cmd_buffer());
+    }
     _render_pass = nullptr;
 }
 
@@ -515,19 +625,29 @@ void CmdBufferRecorderBase::dispatch_size(const ComputeProgram& program, const m
     dispatch_size(program, math::Vec3ui(size, 1), descriptor_sets);
 }
 
+void CmdBufferRecorderBase::wait_on(TimelineFence fence) {
+    _data->push_wait_fence(fence);
+}
+
 TimelineFence CmdBufferRecorderBase::submit() {
     return _data->queue()->submit(std::exchange(_data, nullptr));
 }
 
-void CmdBufferRecorderBase::submit_async() {
-    _data->queue()->submit_async_start(std::exchange(_data, nullptr));
+TimelineFence CmdBufferRecorderBase::submit_async() {
+    return _data->queue()->submit_async_start(std::exchange(_data, nullptr));
 }
 
 
 // -------------------------------------------------- CmdBufferRecorder --------------------------------------------------
 
 RenderPassRecorder CmdBufferRecorder::bind_framebuffer(const Framebuffer& framebuffer) {
+    begin_renderpass(framebuffer, VK_SUBPASS_CONTENTS_INLINE);
+    return RenderPassRecorder(*this, Viewport(framebuffer.size()));
+}
+
+void CmdBufferRecorder::begin_renderpass(const Framebuffer& framebuffer, VkSubpassContents contents) {
     check_no_renderpass();
+    y_debug_assert(!_data->is_secondary());
 
     auto clear_values = core::ScratchPad<VkClearValue>(framebuffer.attachment_count() + 1);
     for(usize i = 0; i != framebuffer.attachment_count(); ++i) {
@@ -550,10 +670,8 @@ RenderPassRecorder CmdBufferRecorder::bind_framebuffer(const Framebuffer& frameb
     }
 
 
-    vkCmdBeginRenderPass(vk_cmd_buffer(), &begin_info, VK_SUBPASS_CONTENTS_INLINE);
+    vkCmdBeginRenderPass(vk_cmd_buffer(), &begin_info, contents);
     _render_pass = &framebuffer.render_pass();
-
-    return RenderPassRecorder(*this, Viewport(framebuffer.size()));
 }
 
 void CmdBufferRecorder::execute(CmdBufferRecorder&& other) {
@@ -568,6 +686,61 @@ void CmdBufferRecorder::execute(CmdBufferRecorder&& other) {
     vkCmdExecuteCommands(vk_cmd_buffer(), 1, &secondary);
 
     _data->push_secondary(std::exchange(other._data, nullptr));
+    other._render_pass = nullptr;
+}
+
+
+
+// -------------------------------------------------- ParallelRenderPass --------------------------------------------------
+
+ParallelRenderPass::ParallelRenderPass(const Framebuffer& framebuffer, concurrent::StaticThreadPool* thread_pool) : _framebuffer(framebuffer), _thread_pool(thread_pool) {
+}
+
+ParallelRenderPass::~ParallelRenderPass() {
+    y_always_assert(_secondaries.is_empty(), "ParallelRenderPass has not been executed");
+}
+
+void ParallelRenderPass::record(const std::function<void(RenderPassRecorder&)>& func) {
+    CmdBufferRecorder secondary = create_secondary();
+    {
+        RenderPassRecorder render_pass(secondary, Viewport(_framebuffer.size()), this);
+        func(render_pass);
+    }
+    _secondaries << end_secondary(secondary);
+}
+
+void ParallelRenderPass::execute(CmdBufferRecorder& recorder) {
+    recorder.begin_renderpass(_framebuffer, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+    if(!_secondaries.is_empty()) {
+        core::ScratchPad<VkCommandBuffer> cmd_buffers(_secondaries.size());
+        for(usize i = 0; i != _secondaries.size(); ++i) {
+            cmd_buffers[i] = _secondaries[i]->vk_cmd_buffer();
+        }
+
+        vkCmdExecuteCommands(recorder.vk_cmd_buffer(), u32(cmd_buffers.size()), cmd_buffers.data());
+
+        for(CmdBufferData* data : _secondaries) {
+            recorder._data->push_secondary(data);
+        }
+        _secondaries.clear();
+    }
+
+    recorder.end_renderpass();
+}
+
+CmdBufferRecorder ParallelRenderPass::create_secondary() const {
+    // Command pools are per thread, so this is safe to call from any worker
+    return command_queue().cmd_pool_for_thread().create_render_pass_cmd_buffer(_framebuffer);
+}
+
+CmdBufferData* ParallelRenderPass::end_secondary(CmdBufferRecorder& secondary) {
+    y_debug_assert(secondary._data);
+    y_debug_assert(secondary._data->is_secondary());
+
+    vk_check(vkEndCommandBuffer(secondary.vk_cmd_buffer()));
+    secondary._render_pass = nullptr;
+    return std::exchange(secondary._data, nullptr);
 }
 
 }
@@ -28,6 +28,9 @@ SOFTWARE.
 #include <yave/graphics/images/ImageView.h>
 #include <yave/graphics/descriptors/DescriptorSetBase.h>
 #include <yave/graphics/buffers/Buffer.h>
+#include <yave/meshes/MeshVertexStreams.h>
+
+#include <functional>
 
 namespace yave {
 
@@ -59,10 +62,18 @@ class RenderPassRecorder final : NonMovable {
         ~RenderPassRecorder();
 
         // specific
-        void bind_material_template(const MaterialTemplate* material_template, core::Span<DescriptorSetBase> sets, bool bind_main_ds = false);
+        void bind_material_template(const MaterialTemplate* material_template, core::Span<DescriptorSetBase> sets, bool bind_main_ds = false, MeshVertexFormat vertex_format = MeshVertexFormat::Full);
+
+        // Returns false without binding anything if the pipeline is still being compiled, in which case the draw should be skipped
+        bool try_bind_material_template(const MaterialTemplate* material_template, core::Span<DescriptorSetBase> sets, bool bind_main_ds = false, MeshVertexFormat vertex_format = MeshVertexFormat::Full);
 
         void set_main_descriptor_set(DescriptorSetBase ds_set);
 
+        // Records func(recorder, i) for i in [0, count) and keeps the commands in that order.
+        // When recording for a ParallelRenderPass, each call is recorded on the thread pool in its own secondary command buffer.
+        // Pipeline, buffer bindings and dynamic state set by func are not visible to the caller afterward.
+        void record_parallel(usize count, const std::function<void(RenderPassRecorder&, usize)>& func);
+
         void draw(const MeshDrawData& draw_data, u32 instance_count = 1, u32 instance_index = 0);
 
         void draw(const VkDrawIndexedIndirectCommand& indirect);
@@ -70,11 +81,14 @@ class RenderPassRecorder final : NonMovable {
 
         void draw_indirect(TypedSubBuffer<VkDrawIndexedIndirectCommand, BufferUsage::IndirectBit> indirect);
 
+        // Draws the first count commands, with count read from the GPU. Requires DeviceProperties::draw_indirect_count
+        void draw_indirect_count(TypedSubBuffer<VkDrawIndexedIndirectCommand, BufferUsage::IndirectBit> indirect, TypedSubBuffer<u32, BufferUsage::IndirectBit> count);
+
         void draw_indexed(usize index_count);
         void draw_array(usize vertex_count, usize instance_count = 1);
 
         void bind_mesh_buffers(const MeshDrawBuffers& mesh_buffers);
-        void bind_index_buffer(IndexSubBuffer indices);
+        void bind_index_buffer(IndexSubBuffer indices, VkIndexType index_type = VK_INDEX_TYPE_UINT32);
         void bind_attrib_buffers(core::Span<AttribSubBuffer> attribs);
 
 
@@ -90,16 +104,25 @@ class RenderPassRecorder final : NonMovable {
 
     private:
         friend class CmdBufferRecorder;
+        friend class ParallelRenderPass;
+        friend class TransientDescriptorSet;
 
-        RenderPassRecorder(CmdBufferRecorder& cmd_buffer, const Viewport& viewport);
+        RenderPassRecorder(CmdBufferRecorder& cmd_buffer, const Viewport& viewport, ParallelRenderPass* parallel = nullptr);
+
+        void bind_pipeline(const MaterialTemplate* material_template, const GraphicPipeline& pipeline, MeshVertexFormat vertex_format);
+        void bind_descriptor_sets(core::Span<DescriptorSetBase> sets, bool bind_main_ds);
 
         CmdBufferRecorder& _cmd_buffer;
         Viewport _viewport;
+        VkRect2D _scissor = {};
         VkDescriptorSet _main_descriptor_set = {};
 
+        ParallelRenderPass* _parallel = nullptr;
+
         struct {
             const MeshDrawBuffers* mesh_buffers = nullptr;
             const MaterialTemplate* material = nullptr;
+            MeshVertexFormat vertex_format = MeshVertexFormat::Full;
             VkPipelineLayout pipeline_layout = {};
         } _cache;
 };
@@ -116,6 +139,9 @@ class CmdBufferRecorderBase : NonMovable {
 
         CmdQueue* queue() const;
 
+        // Once submitted, the command buffer will not start before fence, which can belong to another queue, is signaled
+        void wait_on(TimelineFence fence);
+
         VkCommandBuffer vk_cmd_buffer() const;
         ResourceFence resource_fence() const;
 
@@ -141,14 +167,19 @@ class CmdBufferRecorderBase : NonMovable {
         void dispatch_size(const ComputeProgram& program, const math::Vec2ui& size, core::Span<DescriptorSetBase> descriptor_sets);
 
         TimelineFence submit();
-        void submit_async();
+        TimelineFence submit_async();
 
     protected:
         friend class RenderPassRecorder;
+        friend class ParallelRenderPass;
+        friend class TransientDescriptorSet;
 
         CmdBufferRecorderBase() = default;
         CmdBufferRecorderBase(CmdBufferData* data);
 
+        // Secondary command buffer that continues the render pass of framebuffer
+        CmdBufferRecorderBase(CmdBufferData* data, const Framebuffer& framebuffer);
+
         void swap(CmdBufferRecorderBase& other);
 
         void end_renderpass();
@@ -170,7 +201,8 @@ class CmdBufferRecorderBase : NonMovable {
     protected:                                                                                              \
         friend class CmdBufferPool;                                                                         \
         CmdBufferType() = default;                                                                          \
-        CmdBufferType(CmdBufferData* data) : ParentType(data) {}
+        CmdBufferType(CmdBufferData* data) : ParentType(data) {}                                            \
+        CmdBufferType(CmdBufferData* data, const Framebuffer& fb) : ParentType(data, fb) {}
 
 
 
@@ -205,6 +237,39 @@ class CmdBufferRecorder final : public ComputeCapableCmdBufferRecorder {
         RenderPassRecorder bind_framebuffer(const Framebuffer& framebuffer);
 
         void execute(CmdBufferRecorder&& other);
+
+    private:
+        friend class ParallelRenderPass;
+
+        void begin_renderpass(const Framebuffer& framebuffer, VkSubpassContents contents);
+};
+
+
+
+// Render pass recorded into secondary command buffers, which are executed in recording order.
+// Recording can happen on any thread, work split with RenderPassRecorder::record_parallel runs on the thread pool.
+class ParallelRenderPass : NonMovable {
+    public:
+        ParallelRenderPass(const Framebuffer& framebuffer, concurrent::StaticThreadPool* thread_pool);
+        ~ParallelRenderPass();
+
+        // Must not be called concurrently
+        void record(const std::function<void(RenderPassRecorder&)>& func);
+
+        // Begins the render pass on the primary and executes everything recorded so far
+        void execute(CmdBufferRecorder& recorder);
+
+    private:
+        friend class RenderPassRecorder;
+
+        CmdBufferRecorder create_secondary() const;
+
+        static CmdBufferData* end_secondary(CmdBufferRecorder& secondary);
+
+        const Framebuffer& _framebuffer;
+        concurrent::StaticThreadPool* _thread_pool = nullptr;
+
+        core::Vector<CmdBufferData*> _secondaries;
 };
 
 static_assert(sizeof(ComputeCapableCmdBufferRecorder) == sizeof(CmdBufferRecorderBase));
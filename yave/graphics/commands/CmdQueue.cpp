@@ -75,7 +75,7 @@ static auto create_profiling_ctx(VkQueue queue, u32 family_index) {
 
 concurrent::Mutexed<core::Vector<CmdQueue*>> CmdQueue::_all_queues = {};
 
-CmdQueue::CmdQueue(u32 family_index, VkQueue queue) : _queue(queue), _family_index(family_index){
+CmdQueue::CmdQueue(u32 family_index, VkQueue queue, const char* name) : _queue(queue), _family_index(family_index){
     _all_queues.locked([&](auto&& all_queues) {
         y_debug_assert(std::find(all_queues.begin(), all_queues.end(), this) == all_queues.end());
         all_queues << this;
@@ -88,10 +88,12 @@ CmdQueue::CmdQueue(u32 family_index, VkQueue queue) : _queue(queue), _family_ind
 
 #ifdef Y_DEBUG
     if(const auto* debug = debug_utils()) {
-        debug->set_resource_name(queue, "Main queue");
+        debug->set_resource_name(queue, name);
     }
 #endif
 
+    unused(name);
+
 #ifdef YAVE_GPU_PROFILING
     _profiling_ctx = create_profiling_ctx(queue, family_index);
 #endif
@@ -165,12 +167,12 @@ void CmdQueue::clear_all_cmd_pools() {
     });
 }
 
-void CmdQueue::submit_async_start(CmdBufferData* data) {
+TimelineFence CmdQueue::submit_async_start(CmdBufferData* data) {
     if(!data->_semaphore) {
         data->_semaphore = create_cmd_buffer_semaphore();
     }
 
-    submit_internal(data, {}, {}, {}, false);
+    return submit_internal(data, {}, {}, {}, false);
 }
 
 TimelineFence CmdQueue::submit(CmdBufferData* data) {
@@ -215,6 +217,7 @@ TimelineFence CmdQueue::submit_internal(CmdBufferData* data, VkSemaphore wait, V
     if(async_start) {
         y_debug_assert(data->_semaphore);
         y_always_assert(!wait && !signal && !fence, "Invalid submit");
+        y_always_assert(data->_wait_fences.is_empty(), "Async start submits can not wait on fences");
 
         _queue.locked([&](auto&& queue) {
             _async_submit_data.locked([&](auto&& submit_data) {
@@ -263,6 +266,15 @@ TimelineFence CmdQueue::submit_internal(CmdBufferData* data, VkSemaphore wait, V
                 wait_values.push_back(current_fence.value());
             }
 
+            // Fences from other queues block everything, unlike the async start semaphores.
+            // They belong to this command buffer, so no other submission can consume them.
+            const usize fences_begin = wait_semaphores.size();
+            for(const TimelineFence& fence : data->_wait_fences) {
+                y_debug_assert(fence._parent != &_timeline);
+                wait_semaphores.push_back(fence._parent->vk_semaphore());
+                wait_values.push_back(fence.value());
+            }
+
             y_debug_assert(current_fence.value() + 1 == next_fence.value());
             y_debug_assert(wait_semaphores.size() == wait_values.size());
 
@@ -272,7 +284,10 @@ TimelineFence CmdQueue::submit_internal(CmdBufferData* data, VkSemaphore wait, V
             const u32 signal_count = signal_semaphores[1] ? 2 : 1;
             const u32 wait_count = u32(wait_semaphores.size());
 
-            const core::ScratchPad<VkPipelineStageFlags> wait_stages(wait_count, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+            core::ScratchPad<VkPipelineStageFlags> wait_stages(wait_count, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+            for(usize i = fences_begin; i != wait_count; ++i) {
+                wait_stages[i] = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+            }
 
             VkTimelineSemaphoreSubmitInfo timeline_info = vk_struct();
             {
@@ -59,7 +59,7 @@ namespace yave {
 
 class CmdQueue final : NonMovable {
     public:
-        CmdQueue(u32 family_index, VkQueue queue);
+        CmdQueue(u32 family_index, VkQueue queue, const char* name = "Main queue");
         ~CmdQueue();
 
         u32 family_index() const;
@@ -87,7 +87,7 @@ class CmdQueue final : NonMovable {
 
 
         // Does not wait for the completion of previous commands before starting
-        void submit_async_start(CmdBufferData* data);
+        TimelineFence submit_async_start(CmdBufferData* data);
         TimelineFence submit(CmdBufferData* data);
 
         TimelineFence submit_internal(CmdBufferData* data, VkSemaphore wait = {}, VkSemaphore signal = {}, VkFence fence = {}, bool async_start = false);
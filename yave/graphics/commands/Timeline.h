@@ -46,6 +46,7 @@ class TimelineFence {
 
     private:
         friend class Timeline;
+        friend class CmdQueue;
 
         TimelineFence(u64 value, const Timeline* parent);
 
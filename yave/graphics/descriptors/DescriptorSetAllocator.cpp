@@ -171,8 +171,7 @@ static VkHandle<VkDescriptorPool> create_descriptor_pool(const DescriptorSetLayo
 
 DescriptorSetPool::DescriptorSetPool(const DescriptorSetLayout& layout) :
     _pool(create_descriptor_pool(layout, pool_size)),
-    _layout(layout.vk_descriptor_set_layout()),
-    _inline_blocks(layout.inline_blocks()) {
+    _layout(layout.vk_descriptor_set_layout()) {
 
     std::array<VkDescriptorSetLayout, pool_size> layouts;
     std::fill_n(layouts.begin(), pool_size, _layout);
@@ -207,26 +206,27 @@ u64 DescriptorSetPool::inline_sub_buffer_alignment() const {
     return SubBuffer<BufferUsage::UniformBit>::byte_alignment();
 }
 
-void DescriptorSetPool::update_set(u32 id, core::Span<Descriptor> descriptors) {
+// alloc_fallback_block returns the uniform buffer backing inline blocks that are too big or not supported
+template<typename F>
+static void update_descriptor_set(VkDescriptorSet set, core::Span<Descriptor> descriptors, F&& alloc_fallback_block) {
     y_profile();
 
     const usize max_inline_uniform_size = device_properties().max_inline_uniform_size;
     const bool inline_uniform_supported = max_inline_uniform_size != 0;
-    const usize block_buffer_alignment = inline_sub_buffer_alignment();
+    const usize block_buffer_alignment = SubBuffer<BufferUsage::UniformBit>::byte_alignment();
 
     const usize descriptor_count = descriptors.size();
 
-    core::ScratchVector<VkWriteDescriptorSetInlineUniformBlock> inline_blocks(_inline_blocks ? descriptor_count : 0);
-    core::ScratchVector<VkDescriptorBufferInfo> inline_blocks_buffer_infos(!_inline_buffer.is_null() ? descriptor_count : 0);
+    core::ScratchVector<VkWriteDescriptorSetInlineUniformBlock> inline_blocks(descriptor_count);
+    core::ScratchVector<VkDescriptorBufferInfo> inline_blocks_buffer_infos(descriptor_count);
 
-    usize inline_buffer_offset = 0;
     auto writes = core::ScratchPad<VkWriteDescriptorSet>(descriptor_count);
     for(usize i = 0; i != descriptor_count; ++i) {
         const auto& desc = descriptors[i];
         const u32 count = desc.descriptor_set_layout_binding(0).descriptorCount;
         VkWriteDescriptorSet write = vk_struct();
         {
-            write.dstSet = _sets[id];
+            write.dstSet = set;
             write.dstBinding = u32(i);
             write.dstArrayElement = 0;
             write.descriptorCount = count;
@@ -242,9 +242,8 @@ void DescriptorSetPool::update_set(u32 id, core::Span<Descriptor> descriptors) {
             const Descriptor::InlineBlock block = desc.descriptor_info().inline_block;
             if(!inline_uniform_supported || block.size > max_inline_uniform_size) {
                 const usize aligned_block_size = align_up_to(block.size, block_buffer_alignment);
-                const usize buffer_start = id * _descriptor_buffer_size + inline_buffer_offset;
 
-                SubBuffer<BufferUsage::UniformBit, MemoryType::CpuVisible> block_buffer(_inline_buffer, aligned_block_size, buffer_start);
+                SubBuffer<BufferUsage::UniformBit, MemoryType::CpuVisible> block_buffer = alloc_fallback_block(aligned_block_size);
                 {
                     std::memcpy(block_buffer.map_bytes(MappingAccess::WriteOnly).data(), block.data, block.size);
                 }
@@ -252,8 +251,6 @@ void DescriptorSetPool::update_set(u32 id, core::Span<Descriptor> descriptors) {
                 write.pBufferInfo = &inline_blocks_buffer_infos.emplace_back(block_buffer.vk_descriptor_info());
                 write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
                 write.descriptorCount = 1;
-
-                inline_buffer_offset += aligned_block_size;
             } else {
                 VkWriteDescriptorSetInlineUniformBlock& inline_block = inline_blocks.emplace_back(VkWriteDescriptorSetInlineUniformBlock(vk_struct()));
                 inline_block.pData = block.data;
@@ -271,6 +268,15 @@ void DescriptorSetPool::update_set(u32 id, core::Span<Descriptor> descriptors) {
     vkUpdateDescriptorSets(vk_device(), u32(writes.size()), writes.data(), 0, nullptr);
 }
 
+void DescriptorSetPool::update_set(u32 id, core::Span<Descriptor> descriptors) {
+    usize inline_buffer_offset = 0;
+    update_descriptor_set(_sets[id], descriptors, [&](usize aligned_block_size) {
+        const usize buffer_start = id * _descriptor_buffer_size + inline_buffer_offset;
+        inline_buffer_offset += aligned_block_size;
+        return SubBuffer<BufferUsage::UniformBit, MemoryType::CpuVisible>(_inline_buffer, aligned_block_size, buffer_start);
+    });
+}
+
 DescriptorSetData DescriptorSetPool::alloc(core::Span<Descriptor> descriptors) {
     y_profile();
 
@@ -438,5 +444,187 @@ usize DescriptorSetAllocator::used_sets() const {
     });
 }
 
+
+
+static u32 transient_descriptor_capacity(usize type_index) {
+    if(type_index == inline_block_index) {
+        return device_properties().max_inline_uniform_size ? TransientDescriptorPool::inline_uniform_bytes : 0;
+    }
+    return TransientDescriptorPool::descriptors_per_type;
+}
+
+static VkHandle<VkDescriptorPool> create_transient_descriptor_pool() {
+    y_profile();
+
+    usize sizes_count = 0;
+    std::array<VkDescriptorPoolSize, DescriptorSetLayout::descriptor_type_count> sizes;
+
+    for(usize i = 0; i != DescriptorSetLayout::descriptor_type_count; ++i) {
+        if(const u32 capacity = transient_descriptor_capacity(i)) {
+            VkDescriptorPoolSize& pool_size = sizes[sizes_count++];
+            pool_size.type = index_descriptor_type(i);
+            pool_size.descriptorCount = capacity;
+        }
+    }
+
+    // No VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT: the pool is only ever reset as a whole
+    VkDescriptorPoolCreateInfo create_info = vk_struct();
+    {
+        create_info.poolSizeCount = u32(sizes_count);
+        create_info.pPoolSizes = sizes.data();
+        create_info.maxSets = TransientDescriptorPool::max_sets;
+    }
+
+    VkDescriptorPoolInlineUniformBlockCreateInfo inline_create_info = vk_struct();
+    if(transient_descriptor_capacity(inline_block_index)) {
+        inline_create_info.maxInlineUniformBlockBindings = TransientDescriptorPool::max_sets;
+        create_info.pNext = &inline_create_info;
+    }
+
+    VkHandle<VkDescriptorPool> pool;
+    vk_check(vkCreateDescriptorPool(vk_device(), &create_info, vk_allocation_callbacks(), pool.get_ptr_for_init()));
+    return pool;
+}
+
+static u64 inline_fallback_size(const DescriptorSetLayout& layout) {
+    const u64 alignment = SubBuffer<BufferUsage::UniformBit>::byte_alignment();
+
+    u64 size = 0;
+    for(const auto& block : layout.inline_blocks_fallbacks()) {
+        size += align_up_to(u64(block.byte_size), alignment);
+    }
+    return size;
+}
+
+TransientDescriptorPool::TransientDescriptorPool() :
+    _pool(create_transient_descriptor_pool()),
+    _inline_fallback_allocator(inline_fallback_buffer_size) {
+}
+
+TransientDescriptorPool::~TransientDescriptorPool() {
+    destroy_graphic_resource(std::move(_pool));
+}
+
+bool TransientDescriptorPool::has_room(const DescriptorSetLayout& layout) const {
+    if(_used_sets >= max_sets) {
+        return false;
+    }
+
+    const auto& counts = layout.desciptors_count();
+    for(usize i = 0; i != counts.size(); ++i) {
+        if(_used_descriptors[i] + counts[i] > transient_descriptor_capacity(i)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+VkDescriptorSet TransientDescriptorPool::alloc(const DescriptorSetLayout& layout, core::Span<Descriptor> descriptors) {
+    y_profile();
+
+    if(!has_room(layout)) {
+        return {};
+    }
+
+    u64 inline_fallback_offset = 0;
+    if(const u64 fallback_size = inline_fallback_size(layout)) {
+        const auto offset = _inline_fallback_allocator.alloc(fallback_size, SubBuffer<BufferUsage::UniformBit>::byte_alignment());
+        if(!offset) {
+            return {};
+        }
+
+        if(_inline_fallback_buffer.is_null()) {
+            _inline_fallback_buffer = Buffer<BufferUsage::UniformBit, MemoryType::CpuVisible>(inline_fallback_buffer_size);
+        }
+        inline_fallback_offset = offset.unwrap();
+    }
+
+    const VkDescriptorSetLayout vk_layout = layout.vk_descriptor_set_layout();
+
+    VkDescriptorSetAllocateInfo allocate_info = vk_struct();
+    {
+        allocate_info.descriptorPool = _pool;
+        allocate_info.descriptorSetCount = 1;
+        allocate_info.pSetLayouts = &vk_layout;
+    }
+
+    VkDescriptorSet set = {};
+    const VkResult result = vkAllocateDescriptorSets(vk_device(), &allocate_info, &set);
+    if(result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL) {
+        // Our accounting missed something, consider the pool full until the next reset
+        _used_sets = max_sets;
+        return {};
+    }
+    vk_check(result);
+
+    ++_used_sets;
+    for(usize i = 0; i != _used_descriptors.size(); ++i) {
+        _used_descriptors[i] += layout.desciptors_count()[i];
+    }
+
+    update_descriptor_set(set, descriptors, [&](usize aligned_block_size) {
+        const u64 buffer_start = inline_fallback_offset;
+        inline_fallback_offset += aligned_block_size;
+        return SubBuffer<BufferUsage::UniformBit, MemoryType::CpuVisible>(_inline_fallback_buffer, aligned_block_size, buffer_start);
+    });
+
+    return set;
+}
+
+void TransientDescriptorPool::reset() {
+    vk_check(vkResetDescriptorPool(vk_device(), _pool, 0));
+
+    _used_sets = 0;
+    _used_descriptors = {};
+    _inline_fallback_allocator.reset();
+}
+
+usize TransientDescriptorPool::used_sets() const {
+    return _used_sets;
+}
+
+
+
+TransientDescriptorPool* TransientDescriptorSetAllocator::claim_pool() {
+    return _pools.locked([&](Pools& pools) {
+        if(!pools.free.is_empty()) {
+            return pools.free.pop();
+        }
+        return pools.pools.emplace_back(std::make_unique<TransientDescriptorPool>()).get();
+    });
+}
+
+void TransientDescriptorSetAllocator::recycle(core::Span<TransientDescriptorPool*> pools) {
+    y_profile();
+
+    // Pools are not shared, so they can be reset without holding the lock
+    for(TransientDescriptorPool* pool : pools) {
+        pool->reset();
+    }
+
+    _pools.locked([&](Pools& p) {
+        for(TransientDescriptorPool* pool : pools) {
+            p.free << pool;
+        }
+    });
+}
+
+usize TransientDescriptorSetAllocator::pool_count() const {
+    return _pools.locked([&](const Pools& pools) {
+        return pools.pools.size();
+    });
+}
+
+usize TransientDescriptorSetAllocator::used_sets() const {
+    return _pools.locked([&](const Pools& pools) {
+        usize count = 0;
+        for(const auto& pool : pools.pools) {
+            count += pool->used_sets();
+        }
+        return count;
+    });
+}
+
 }
 
@@ -33,10 +33,12 @@ SOFTWARE.
 #include <y/core/HashMap.h>
 #include <y/concurrent/SpinLock.h>
 #include <y/concurrent/Mutexed.h>
+#include <y/concurrent/BumpAllocator.h>
 
 #include <memory>
 #include <algorithm>
 #include <memory>
+#include <atomic>
 
 template<>
 struct std::hash<VkDescriptorSetLayoutBinding> {
@@ -117,7 +119,6 @@ class DescriptorSetPool : NonMovable {
         VkHandle<VkDescriptorPool> _pool;
         NotOwner<VkDescriptorSetLayout> _layout;
 
-        usize _inline_blocks = 0;
         u64 _descriptor_buffer_size = 0;
         Buffer<BufferUsage::UniformBit, MemoryType::CpuVisible> _inline_buffer;
 };
@@ -174,6 +175,64 @@ class DescriptorSetAllocator {
         concurrent::Mutexed<LayoutMap> _layouts;
 };
 
+
+
+// Linear pool for descriptor sets of any layout, sets are never freed individually
+// Pools are owned by a single command buffer between resets and are not synchronized.
+class TransientDescriptorPool : NonMovable {
+    public:
+        static constexpr u32 max_sets = 256;
+        static constexpr u32 descriptors_per_type = 1024;
+        static constexpr u32 inline_uniform_bytes = 16 * 1024;
+        static constexpr u64 inline_fallback_buffer_size = 64 * 1024;
+
+        TransientDescriptorPool();
+        ~TransientDescriptorPool();
+
+        // Returns a null set if the pool is full
+        VkDescriptorSet alloc(const DescriptorSetLayout& layout, core::Span<Descriptor> descriptors);
+        void reset();
+
+        usize used_sets() const;
+
+    private:
+        bool has_room(const DescriptorSetLayout& layout) const;
+
+        VkHandle<VkDescriptorPool> _pool;
+
+        // Read by used_sets() from other threads
+        std::atomic<u32> _used_sets = 0;
+        std::array<u32, DescriptorSetLayout::descriptor_type_count> _used_descriptors = {};
+
+        concurrent::BumpAllocator _inline_fallback_allocator;
+        Buffer<BufferUsage::UniformBit, MemoryType::CpuVisible> _inline_fallback_buffer;
+};
+
+// Linear descriptor pools for sets that only live as long as the command buffer using them.
+// Command buffers claim whole pools, so allocating a set never takes a lock. Pools are reset and
+// recycled once the command buffer that claimed them has completed, whichever thread recorded it.
+class TransientDescriptorSetAllocator : NonMovable {
+    public:
+        TransientDescriptorSetAllocator() = default;
+
+        TransientDescriptorPool* claim_pool();
+
+        // The pools must not be used by any pending command buffer
+        void recycle(core::Span<TransientDescriptorPool*> pools);
+
+        // Slow: for debug only
+        usize pool_count() const;
+        usize used_sets() const;
+
+    private:
+        struct Pools {
+            core::Vector<std::unique_ptr<TransientDescriptorPool>> pools;
+            core::Vector<TransientDescriptorPool*> free;
+        };
+
+        concurrent::Mutexed<Pools> _pools;
+};
+
 }
 
 #endif // YAVE_GRAPHICS_DESCRIPTORS_DESCRIPTORSETALLOCATOR_H
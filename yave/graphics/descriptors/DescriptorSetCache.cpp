@@ -0,0 +1,325 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include "DescriptorSetCache.h"
+
+#include <y/core/Chrono.h>
+#include <y/utils/hash.h>
+
+#include <atomic>
+#include <bit>
+#include <cstring>
+
+namespace yave {
+
+// Caches with sets referencing each handle, and how many of their sets do.
+// Lock order is handle_users_lock then the cache's lock, caches only update this outside of their own lock.
+static std::mutex handle_users_lock;
+static core::FlatHashMap<u64, core::SmallVector<std::pair<DescriptorSetCache*, u32>, 2>> handle_users;
+
+static std::atomic<u64> total_hits = 0;
+static std::atomic<u64> total_misses = 0;
+static std::atomic<u64> total_invalidations = 0;
+static std::atomic<u64> total_update_time_ns = 0;
+
+template<typename T>
+static u64 handle_key(T handle) {
+    static_assert(sizeof(T) == sizeof(u64));
+    return std::bit_cast<u64>(handle);
+}
+
+static void add_handle(core::SmallVector<u64, 4>& handles, u64 handle) {
+    if(handle && std::find(handles.begin(), handles.end(), handle) == handles.end()) {
+        handles << handle;
+    }
+}
+
+static u64 build_key(core::Span<Descriptor> descriptors, core::Vector<u64>& key, core::SmallVector<u64, 4>& handles) {
+    for(const Descriptor& desc : descriptors) {
+        const Descriptor::DescriptorInfo& info = desc.descriptor_info();
+
+        key << u64(desc.vk_descriptor_type());
+        if(desc.is_buffer()) {
+            key << handle_key(info.buffer.buffer) << u64(info.buffer.offset) << u64(info.buffer.range);
+            add_handle(handles, handle_key(info.buffer.buffer));
+        } else if(desc.is_image()) {
+            key << handle_key(info.image.imageView) << handle_key(info.image.sampler) << u64(info.image.imageLayout);
+            add_handle(handles, handle_key(info.image.imageView));
+            add_handle(handles, handle_key(info.image.sampler));
+        } else if(desc.is_inline_block()) {
+            // Inline blocks are copied into the set, so their content is part of the key
+            const usize size = info.inline_block.size;
+            const usize start = key.size() + 1;
+            key << u64(size);
+            key.set_min_size(start + (size + sizeof(u64) - 1) / sizeof(u64), u64(0));
+            std::memcpy(key.data() + start, info.inline_block.data, size);
+        } else {
+            y_fatal("Unknown descriptor type");
+        }
+    }
+    return hash_range(key);
+}
+
+static void acquire_handles(DescriptorSetCache* cache, core::Span<u64> handles) {
+    const std::unique_lock lock(handle_users_lock);
+
+    for(const u64 handle : handles) {
+        auto& users = handle_users[handle];
+        if(const auto it = std::find_if(users.begin(), users.end(), [&](const auto& user) { return user.first == cache; }); it != users.end()) {
+            ++it->second;
+        } else {
+            users.emplace_back(cache, 1u);
+        }
+    }
+}
+
+// handle_users_lock must be held
+static void release_handles_locked(DescriptorSetCache* cache, core::Span<u64> handles) {
+    for(const u64 handle : handles) {
+        const auto users_it = handle_users.find(handle);
+        if(users_it == handle_users.end()) {
+            // Already invalidated
+            continue;
+        }
+
+        auto& users = users_it->second;
+        if(const auto it = std::find_if(users.begin(), users.end(), [&](const auto& user) { return user.first == cache; }); it != users.end()) {
+            if(!--it->second) {
+                users.erase_unordered(it);
+            }
+        }
+
+        if(users.is_empty()) {
+            handle_users.erase(users_it);
+        }
+    }
+}
+
+static void release_handles(DescriptorSetCache* cache, core::Span<u64> handles) {
+    if(!handles.is_empty()) {
+        const std::unique_lock lock(handle_users_lock);
+        release_handles_locked(cache, handles);
+    }
+}
+
+
+DescriptorSetCache::DescriptorSetCache() {
+}
+
+DescriptorSetCache::~DescriptorSetCache() {
+    clear();
+}
+
+DescriptorSetBase DescriptorSetCache::descriptor_set(core::Span<Descriptor> descriptors) {
+    y_profile();
+
+    core::Vector<u64> key;
+    core::SmallVector<u64, 4> handles;
+    const u64 hash = build_key(descriptors, key, handles);
+
+    {
+        const std::unique_lock lock(_lock);
+        if(const auto it = _indices.find(hash); it != _indices.end()) {
+            Entry& entry = _entries[it->second];
+            if(entry.key == key) {
+                entry.last_used = _frame;
+                ++_frame_stats.hits;
+                ++total_hits;
+                return entry.set;
+            }
+        }
+    }
+
+    // Handles are indexed before the set becomes visible, so that invalidations can't miss it
+    acquire_handles(this, handles);
+
+    // Sets are created outside of the lock: creating one might destroy resources, which would invalidate caches
+    const core::Chrono timer;
+    DescriptorSet set(descriptors);
+    const u64 update_time = timer.elapsed().to_nanos();
+
+    total_update_time_ns += update_time;
+    ++total_misses;
+
+    const std::unique_lock lock(_lock);
+
+    _frame_stats.update_time_ns += update_time;
+    ++_frame_stats.misses;
+
+    const DescriptorSetBase base = set;
+    const u32 index = u32(_entries.size());
+    for(const u64 handle : handles) {
+        _entries_by_handle[handle] << index;
+    }
+
+    if(_indices.find(hash) == _indices.end()) {
+        // On hash collision the first set stays cached and the other one lives for a single frame
+        _indices.insert({hash, index});
+        _entries.emplace_back(hash, _frame, std::move(key), std::move(handles), std::move(set));
+    } else {
+        _entries.emplace_back(u64(0), _frame, core::Vector<u64>(), std::move(handles), std::move(set));
+        _entries.last().last_used = _frame - max_unused_frames;
+    }
+
+    return base;
+}
+
+void DescriptorSetCache::next_frame() {
+    y_profile();
+
+    core::Vector<u64> released;
+
+    {
+        const std::unique_lock lock(_lock);
+
+        for(usize i = 0; i < _entries.size(); ++i) {
+            if(_entries[i].last_used + max_unused_frames <= _frame) {
+                evict(i, released);
+                --i;
+            }
+        }
+
+        ++_frame;
+
+        _last_frame_stats = _frame_stats;
+        _frame_stats = {};
+    }
+
+    release_handles(this, released);
+}
+
+void DescriptorSetCache::clear() {
+    core::Vector<u64> released;
+
+    {
+        const std::unique_lock lock(_lock);
+
+        for(const Entry& entry : _entries) {
+            std::copy(entry.handles.begin(), entry.handles.end(), std::back_inserter(released));
+        }
+
+        _entries.clear();
+        _indices.clear();
+        _entries_by_handle.clear();
+    }
+
+    release_handles(this, released);
+}
+
+usize DescriptorSetCache::size() const {
+    const std::unique_lock lock(_lock);
+    return _entries.size();
+}
+
+DescriptorSetCache::Stats DescriptorSetCache::last_frame_stats() const {
+    const std::unique_lock lock(_lock);
+    return _last_frame_stats;
+}
+
+DescriptorSetCache::Stats DescriptorSetCache::total_stats() {
+    Stats stats;
+    stats.hits = total_hits;
+    stats.misses = total_misses;
+    stats.invalidations = total_invalidations;
+    stats.update_time_ns = total_update_time_ns;
+    return stats;
+}
+
+void DescriptorSetCache::invalidate(VkBuffer buffer) {
+    invalidate_all(handle_key(buffer));
+}
+
+void DescriptorSetCache::invalidate(VkImageView image_view) {
+    invalidate_all(handle_key(image_view));
+}
+
+void DescriptorSetCache::invalidate(VkSampler sampler) {
+    invalidate_all(handle_key(sampler));
+}
+
+void DescriptorSetCache::invalidate_all(u64 handle) {
+    const std::unique_lock lock(handle_users_lock);
+
+    const auto it = handle_users.find(handle);
+    if(it == handle_users.end()) {
+        return;
+    }
+
+    const auto users = std::move(it->second);
+    handle_users.erase(it);
+
+    core::Vector<u64> released;
+    for(const auto& [cache, count] : users) {
+        released.make_empty();
+        cache->invalidate_handle(handle, released);
+        release_handles_locked(cache, released);
+    }
+}
+
+void DescriptorSetCache::invalidate_handle(u64 handle, core::Vector<u64>& released) {
+    const std::unique_lock lock(_lock);
+
+    // Evicting removes the entry from the handle's list, and the list itself once empty
+    for(auto it = _entries_by_handle.find(handle); it != _entries_by_handle.end(); it = _entries_by_handle.find(handle)) {
+        evict(it->second.last(), released);
+
+        ++_frame_stats.invalidations;
+        ++total_invalidations;
+    }
+}
+
+void DescriptorSetCache::evict(usize index, core::Vector<u64>& released) {
+    y_debug_assert(index < _entries.size());
+
+    if(const auto it = _indices.find(_entries[index].hash); it != _indices.end() && it->second == index) {
+        _indices.erase(it);
+    }
+
+    for(const u64 handle : _entries[index].handles) {
+        const auto it = _entries_by_handle.find(handle);
+        y_debug_assert(it != _entries_by_handle.end());
+
+        auto& indices = it->second;
+        indices.erase_unordered(std::find(indices.begin(), indices.end(), u32(index)));
+        if(indices.is_empty()) {
+            _entries_by_handle.erase(it);
+        }
+
+        released << handle;
+    }
+
+    const usize last = _entries.size() - 1;
+    if(index != last) {
+        if(const auto it = _indices.find(_entries[last].hash); it != _indices.end() && it->second == last) {
+            it->second = u32(index);
+        }
+
+        for(const u64 handle : _entries[last].handles) {
+            auto& indices = _entries_by_handle.find(handle)->second;
+            *std::find(indices.begin(), indices.end(), u32(last)) = u32(index);
+        }
+    }
+
+    _entries.erase_unordered(_entries.begin() + index);
+}
+
+}
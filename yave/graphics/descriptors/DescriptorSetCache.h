@@ -0,0 +1,100 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#ifndef YAVE_GRAPHICS_DESCRIPTORS_DESCRIPTORSETCACHE_H
+#define YAVE_GRAPHICS_DESCRIPTORS_DESCRIPTORSETCACHE_H
+
+#include "DescriptorSet.h"
+
+#include <y/core/Vector.h>
+#include <y/core/HashMap.h>
+
+#include <mutex>
+
+namespace yave {
+
+// Reuses descriptor sets across frames when they are created with the exact same descriptors.
+// Sets are keyed on the raw buffer, image view and sampler handles they reference, so caches
+// are flushed of a handle before it gets destroyed (see invalidate), which prevents stale hits from handle reuse.
+// Handles are indexed globally and per cache, so destroying one only visits the sets that reference it.
+class DescriptorSetCache : NonMovable {
+    public:
+        static constexpr u64 max_unused_frames = 8;
+
+        struct Stats {
+            u64 hits = 0;
+            u64 misses = 0;
+            u64 invalidations = 0;
+
+            // CPU time spent creating and updating descriptor sets
+            u64 update_time_ns = 0;
+        };
+
+        DescriptorSetCache();
+        ~DescriptorSetCache();
+
+        // The returned set is owned by the cache, it remains usable by any command buffer created before it gets evicted
+        DescriptorSetBase descriptor_set(core::Span<Descriptor> descriptors);
+
+        // Ages all sets and evicts the ones that haven't been used for max_unused_frames
+        void next_frame();
+
+        void clear();
+
+        usize size() const;
+
+        Stats last_frame_stats() const;
+        static Stats total_stats();
+
+        static void invalidate(VkBuffer buffer);
+        static void invalidate(VkImageView image_view);
+        static void invalidate(VkSampler sampler);
+
+    private:
+        struct Entry {
+            u64 hash = 0;
+            u64 last_used = 0;
+            core::Vector<u64> key;
+            core::SmallVector<u64, 4> handles;
+            DescriptorSet set;
+        };
+
+        static void invalidate_all(u64 handle);
+
+        // Both append the handles no longer referenced by the evicted sets to released
+        void invalidate_handle(u64 handle, core::Vector<u64>& released);
+        void evict(usize index, core::Vector<u64>& released);
+
+        mutable std::mutex _lock;
+
+        core::Vector<Entry> _entries;
+        core::FlatHashMap<u64, u32> _indices;
+        core::FlatHashMap<u64, core::SmallVector<u32, 4>> _entries_by_handle;
+
+        u64 _frame = 0;
+
+        Stats _frame_stats;
+        Stats _last_frame_stats;
+};
+
+}
+
+#endif // YAVE_GRAPHICS_DESCRIPTORS_DESCRIPTORSETCACHE_H
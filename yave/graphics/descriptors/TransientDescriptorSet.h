@@ -0,0 +1,48 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#ifndef YAVE_GRAPHICS_DESCRIPTORS_TRANSIENTDESCRIPTORSET_H
+#define YAVE_GRAPHICS_DESCRIPTORS_TRANSIENTDESCRIPTORSET_H
+
+#include "DescriptorSetBase.h"
+
+namespace yave {
+
+// Allocated from linear pools owned by the recorder's command buffer and never freed:
+// only valid for that command buffer, the pools are recycled once it has completed.
+class TransientDescriptorSet : public DescriptorSetBase {
+
+    public:
+        TransientDescriptorSet() = default;
+        TransientDescriptorSet(CmdBufferRecorderBase& recorder, core::Span<Descriptor> bindings);
+        TransientDescriptorSet(RenderPassRecorder& recorder, core::Span<Descriptor> bindings);
+
+        template<typename R, typename T, typename... Args> requires(sizeof...(Args) > 0 || !std::is_convertible_v<T, core::Span<Descriptor>>)
+        explicit TransientDescriptorSet(R& recorder, T&& t, Args&&... args) : TransientDescriptorSet(recorder, std::array<Descriptor, 1 + sizeof...(Args)>{Descriptor(y_fwd(t)), Descriptor(y_fwd(args))...}) {
+        }
+
+    private:
+        TransientDescriptorSet(CmdBufferData* data, core::Span<Descriptor> bindings);
+};
+
+}
+
+#endif // YAVE_GRAPHICS_DESCRIPTORS_TRANSIENTDESCRIPTORSET_H
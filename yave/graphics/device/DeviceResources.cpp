@@ -111,6 +111,7 @@ static constexpr std::array<std::string_view, usize(ComputePrograms::MaxComputeP
     "depth_bounds",
     "prev_camera",
     "update_transforms",
+    "gpu_culling",
 };
 
 
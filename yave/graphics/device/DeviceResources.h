@@ -57,6 +57,7 @@ class DeviceResources final : NonMovable {
             DepthBoundProgram,
             PrevCameraProgram,
             UpdateTransformsProgram,
+            GpuCullingProgram,
 
             MaxComputePrograms
         };
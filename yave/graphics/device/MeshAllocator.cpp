@@ -29,53 +29,65 @@ SOFTWARE.
 
 #include <y/core/FixedArray.h>
 #include <y/utils/memory.h>
+#include <y/utils/format.h>
 
 namespace yave {
 
-MeshAllocator::MeshAllocator() :
-        _attrib_buffer(default_vertex_count * MeshVertexStreams::total_vertex_size),
-        _triangle_buffer(default_triangle_count) {
+static const char* pool_name(MeshVertexFormat format) {
+    return format == MeshVertexFormat::Compact ? "compact" : "full";
+}
 
+MeshAllocator::MeshAllocator() {
+    init_pool(MeshVertexFormat::Full, default_vertex_count, default_triangle_count);
+    init_pool(MeshVertexFormat::Compact, default_compact_vertex_count, default_compact_triangle_count);
+}
 
-    _free_blocks << FreeBlock {
-        0, default_vertex_count,
-        0, default_triangle_count
-    };
+MeshAllocator::~MeshAllocator() {
+    const auto lock = std::unique_lock(_lock);
 
-    const u64 vertex_capacity = _attrib_buffer.byte_size() / u64(MeshVertexStreams::total_vertex_size);
+    for(const Pool& pool : _pools) {
+        y_always_assert(!pool.vertex_allocator.allocation_count() && !pool.triangle_allocator.allocation_count(), "Not all mesh memory has been released");
+    }
+}
 
-    _mesh_buffers = std::make_unique<MeshDrawBuffers>();
+void MeshAllocator::init_pool(MeshVertexFormat format, u64 vertex_count, u64 triangle_count) {
+    Pool& pool = _pools[usize(format)];
 
-    _mesh_buffers->_parent = this;
-    _mesh_buffers->_triangle_buffer = _triangle_buffer;
-    _mesh_buffers->_vertex_count = usize(vertex_capacity);
+    pool.attrib_buffer = AttribBuffer<>(vertex_count * compute_total_vertex_streams_size(format));
+    pool.index_buffer = IndexBuffer(triangle_count * 3 * index_size(format));
+    pool.vertex_capacity = vertex_count;
+    pool.triangle_capacity = triangle_count;
+
+    pool.vertex_allocator = core::TLSFAllocator(vertex_count);
+    pool.triangle_allocator = core::TLSFAllocator(triangle_count);
+
+    pool.mesh_buffers = std::make_unique<MeshDrawBuffers>();
+
+    pool.mesh_buffers->_parent = this;
+    pool.mesh_buffers->_index_buffer = pool.index_buffer;
+    pool.mesh_buffers->_vertex_count = usize(vertex_count);
+    pool.mesh_buffers->_vertex_format = format;
 
     {
         u64 attrib_offset = 0;
         for(usize i = 0; i != MeshDrawBuffers::vertex_stream_count; ++i) {
-            const u64 byte_len = vertex_capacity * vertex_stream_element_size(VertexStreamType(i));
-            _mesh_buffers->_attrib_buffers[i] = MutableAttribSubBuffer(_attrib_buffer, byte_len, attrib_offset);
+            const u64 byte_len = vertex_count * vertex_stream_element_size(VertexStreamType(i), format);
+            pool.mesh_buffers->_attrib_buffers[i] = MutableAttribSubBuffer(pool.attrib_buffer, byte_len, attrib_offset);
             attrib_offset += byte_len;
         }
     }
 
 #ifdef Y_DEBUG
     if(const auto* debug = debug_utils()) {
-        debug->set_resource_name(_triangle_buffer.vk_buffer(), "Mesh allocator triangle buffer");
-        debug->set_resource_name(_attrib_buffer.vk_buffer(), "Mesh allocator attrib buffer");
+        debug->set_resource_name(pool.index_buffer.vk_buffer(), fmt_c_str("Mesh allocator {} index buffer", pool_name(format)));
+        debug->set_resource_name(pool.attrib_buffer.vk_buffer(), fmt_c_str("Mesh allocator {} attrib buffer", pool_name(format)));
     }
+#else
+    unused(pool_name);
 #endif
 }
 
-MeshAllocator::~MeshAllocator() {
-    const auto lock = std::unique_lock(_lock);
-
-    sort_and_compact_blocks();
-
-    y_always_assert(_free_blocks.size() == 1, "Not all mesh memory has been released: mesh heap fragmented");
-}
-
-MeshDrawData MeshAllocator::alloc_mesh(const MeshVertexStreams& streams, core::Span<IndexedTriangle> triangles) {
+MeshDrawData MeshAllocator::alloc_mesh(const MeshVertexStreams& streams, core::Span<IndexedTriangle> triangles, MeshVertexFormat format) {
     y_profile();
 
     const u64 triangle_count = triangles.size();
@@ -84,18 +96,40 @@ MeshDrawData MeshAllocator::alloc_mesh(const MeshVertexStreams& streams, core::S
     y_debug_assert(triangle_count);
     y_debug_assert(vertex_count);
 
+    y_always_assert(format != MeshVertexFormat::Compact || vertex_count <= max_compact_vertex_count, "Too many vertices for compact vertex format");
+
+    Pool& pool = _pools[usize(format)];
+
     MeshDrawData mesh_data;
-    mesh_data._mesh_buffers = _mesh_buffers.get();
+    mesh_data._mesh_buffers = pool.mesh_buffers.get();
     mesh_data._vertex_count = u32(vertex_count);
     mesh_data._command.index_count = u32(triangles.size() * 3);
 
-    auto& global_triangle_buffer = _triangle_buffer;
-    auto& global_attrib_buffer = _attrib_buffer;
+    const auto [vertex_begin, triangle_begin] = alloc_block(pool, vertex_count, triangle_count);
+
+    y_always_assert(triangle_begin + triangle_count <= pool.triangle_capacity, "Triangle buffer pool is full");
+    y_always_assert(vertex_begin + vertex_count <= pool.vertex_capacity, "Vertex buffer pool is full");
+
+    // Compact meshes are encoded here so that assets keep full precision
+    CompactVertexStreams compact_streams;
+    core::Vector<u16> compact_indices;
+    if(format == MeshVertexFormat::Compact) {
+        y_profile_zone("encode");
 
-    const auto [vertex_begin, triangle_begin] = alloc_block(vertex_count, triangle_count);
+        compact_streams = CompactVertexStreams(streams);
 
-    y_always_assert(triangle_begin + triangle_count <= global_triangle_buffer.size(), "Triangle buffer pool is full");
-    y_always_assert(vertex_begin + vertex_count <= global_attrib_buffer.byte_size() / sizeof(PackedVertex), "Vertex buffer pool is full");
+        compact_indices.set_min_capacity(triangle_count * 3);
+        for(const IndexedTriangle& tri : triangles) {
+            for(const u32 index : tri) {
+                compact_indices << u16(index);
+            }
+        }
+
+        const math::QuantizationRange& range = compact_streams.position_range();
+        mesh_data._decode_info.position_offset = range.min;
+        mesh_data._decode_info.position_scale = range.extent;
+        mesh_data._decode_info.vertex_format = u32(format);
+    }
 
     {
         TransferCmdBufferRecorder recorder = create_disposable_transfer_cmd_buffer();
@@ -109,30 +143,28 @@ MeshDrawData MeshAllocator::alloc_mesh(const MeshVertexStreams& streams, core::S
         };
 
         {
-            MutableTriangleSubBuffer triangle_buffer(global_triangle_buffer, triangle_count * sizeof(IndexedTriangle), triangle_begin * sizeof(IndexedTriangle));
-            stage_copy(triangle_buffer, triangles.data());
+            const u64 triangle_size = 3 * index_size(format);
+            MutableIndexSubBuffer index_buffer(pool.index_buffer, triangle_count * triangle_size, triangle_begin * triangle_size);
+            stage_copy(index_buffer, format == MeshVertexFormat::Compact ? static_cast<const void*>(compact_indices.data()) : triangles.data());
             mesh_data._command.first_index = u32(triangle_begin * 3);
         }
 
         {
             const auto region = recorder.region("Mesh upload");
 
-            const auto attribs_sub_buffers = _mesh_buffers->_attrib_buffers;
-            const u64 buffer_elem_count = u64(_mesh_buffers->_vertex_count);
-            {
-                y_debug_assert(buffer_elem_count);
-                for(usize i = 0; i != attribs_sub_buffers.size(); ++i) {
-                    const AttribSubBuffer& sub_buffer = attribs_sub_buffers[i];
-                    const u64 elem_size = sub_buffer.byte_size() / buffer_elem_count;
-                    const u64 byte_len = vertex_count * elem_size;
-                    y_debug_assert(sub_buffer.byte_offset() % elem_size == 0);
-                    const u64 byte_offset = sub_buffer.byte_offset() + vertex_begin * elem_size;
-
-                    stage_copy(
-                        SubBuffer<BufferUsage::TransferDstBit>(global_attrib_buffer, byte_len, byte_offset),
-                        streams.data(VertexStreamType(i))
-                    );
-                }
+            const auto attribs_sub_buffers = pool.mesh_buffers->_attrib_buffers;
+            for(usize i = 0; i != attribs_sub_buffers.size(); ++i) {
+                const VertexStreamType type = VertexStreamType(i);
+                const AttribSubBuffer& sub_buffer = attribs_sub_buffers[i];
+                const u64 elem_size = vertex_stream_element_size(type, format);
+                const u64 byte_len = vertex_count * elem_size;
+                y_debug_assert(sub_buffer.byte_offset() % elem_size == 0);
+                const u64 byte_offset = sub_buffer.byte_offset() + vertex_begin * elem_size;
+
+                stage_copy(
+                    SubBuffer<BufferUsage::TransferDstBit>(pool.attrib_buffer, byte_len, byte_offset),
+                    format == MeshVertexFormat::Compact ? compact_streams.data(type) : streams.data(type)
+                );
             }
 
             mesh_data._command.vertex_offset = i32(vertex_begin);
@@ -145,104 +177,68 @@ MeshDrawData MeshAllocator::alloc_mesh(const MeshVertexStreams& streams, core::S
 }
 
 void MeshAllocator::recycle(MeshDrawData* data) {
-    y_debug_assert(data->_mesh_buffers == _mesh_buffers.get());
+    y_debug_assert(data->_mesh_buffers && data->_mesh_buffers->parent() == this);
 
     const auto lock = std::unique_lock(_lock);
 
-    _free_blocks << FreeBlock {
-        u64(data->_command.vertex_offset),
-        data->_vertex_count,
-        u64(data->_command.first_index) / 3,
-        u64(data->_command.index_count) / 3,
-    };
+    Pool& pool = _pools[usize(data->_mesh_buffers->vertex_format())];
+    pool.vertex_allocator.free(u64(data->_command.vertex_offset));
+    pool.triangle_allocator.free(u64(data->_command.first_index) / 3);
 
     data->_command = {};
+    data->_decode_info = {};
     data->_mesh_buffers = nullptr;
-
-    _should_compact = true;
 }
 
 
-std::pair<u64, u64> MeshAllocator::alloc_block(u64 vertex_count, u64 triangle_count) {
+std::pair<u64, u64> MeshAllocator::alloc_block(Pool& pool, u64 vertex_count, u64 triangle_count) {
     const auto lock = std::unique_lock(_lock);
 
-    sort_and_compact_blocks();
-
-    for(auto& block : _free_blocks) {
-        if(block.vertex_count < vertex_count || block.triangle_count < triangle_count) {
-            continue;
-        }
-
-        const u64 vertex_offset = block.vertex_offset;
-        const u64 triangle_offset = block.triangle_offset;
-
-        block.vertex_offset += vertex_count;
-        block.vertex_count -= vertex_count;
-        block.triangle_offset += triangle_count;
-        block.triangle_count -= triangle_count;
+    const auto vertex_offset = pool.vertex_allocator.alloc(vertex_count);
+    const auto triangle_offset = pool.triangle_allocator.alloc(triangle_count);
 
-        return {vertex_offset, triangle_offset};
+    if(!vertex_offset || !triangle_offset) {
+        y_fatal("Unable to alloc mesh data");
     }
 
-    y_fatal("Unable to alloc mesh data");
+    return {vertex_offset.unwrap(), triangle_offset.unwrap()};
 }
 
-void MeshAllocator::sort_and_compact_blocks() {
-    y_profile();
-
-    y_debug_assert(!_lock.try_lock());
-
-    const usize block_count = _free_blocks.size();
-    if(!_should_compact || block_count < 2) {
-        return;
-    }
 
-    _should_compact = false;
-
-    std::sort(_free_blocks.begin(), _free_blocks.end(), [](const auto& a, const auto& b) {
-        return a.vertex_offset < b.vertex_offset;
-    });
-
-    usize dst = 0;
-    for(usize i = 1; i != block_count; ++i) {
-        const u64 dst_end = _free_blocks[dst].vertex_offset + _free_blocks[dst].vertex_count;
-        if(_free_blocks[i].vertex_offset == dst_end) {
-            y_debug_assert(_free_blocks[dst].triangle_offset + _free_blocks[dst].triangle_count == _free_blocks[i].triangle_offset);
-            _free_blocks[dst].vertex_count += _free_blocks[i].vertex_count;
-            _free_blocks[dst].triangle_count += _free_blocks[i].triangle_count;
-        } else {
-            ++dst;
-            _free_blocks[dst] = _free_blocks[i];
-        }
-    }
+std::pair<u64, u64> MeshAllocator::available(MeshVertexFormat format) const {
+    const auto lock = std::unique_lock(_lock);
+    const Pool& pool = _pools[usize(format)];
+    return {pool.vertex_allocator.free_size(), pool.triangle_allocator.free_size()};
+}
 
-    _free_blocks.shrink_to(dst + 1);
+std::pair<u64, u64> MeshAllocator::allocated(MeshVertexFormat format) const {
+    const auto [vert, tris] = available(format);
+    const auto [vert_capacity, tris_capacity] = capacity(format);
+    return {vert_capacity - vert, tris_capacity - tris};
 }
 
+std::pair<u64, u64> MeshAllocator::capacity(MeshVertexFormat format) const {
+    const Pool& pool = _pools[usize(format)];
+    return {pool.vertex_capacity, pool.triangle_capacity};
+}
 
-std::pair<u64, u64> MeshAllocator::available() const {
+usize MeshAllocator::free_blocks() const {
     const auto lock = std::unique_lock(_lock);
-    u64 vert = 0;
-    u64 tris = 0;
-    for(const auto& b : _free_blocks) {
-        vert += b.vertex_count;
-        tris += b.triangle_count;
+    usize blocks = 0;
+    for(const Pool& pool : _pools) {
+        blocks += pool.vertex_allocator.stats().free_blocks + pool.triangle_allocator.stats().free_blocks;
     }
-    return {vert, tris};
+    return blocks;
 }
 
-std::pair<u64, u64> MeshAllocator::allocated() const {
-    const auto [vert, tris] = available();
-    return {default_vertex_count - vert, default_triangle_count - tris};
-}
-
-usize MeshAllocator::free_blocks() const {
+std::pair<core::TLSFAllocator::Stats, core::TLSFAllocator::Stats> MeshAllocator::stats(MeshVertexFormat format) const {
     const auto lock = std::unique_lock(_lock);
-    return _free_blocks.size();
+    const Pool& pool = _pools[usize(format)];
+    return {pool.vertex_allocator.stats(), pool.triangle_allocator.stats()};
 }
 
-const MeshDrawBuffers& MeshAllocator::mesh_buffers() const {
-    return *_mesh_buffers;
+const MeshDrawBuffers& MeshAllocator::mesh_buffers(MeshVertexFormat format) const {
+    return *_pools[usize(format)].mesh_buffers;
 }
 
 }
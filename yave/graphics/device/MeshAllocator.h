@@ -26,7 +26,7 @@ SOFTWARE.
 #include <yave/meshes/MeshDrawData.h>
 
 #include <y/core/Span.h>
-#include <y/core/Vector.h>
+#include <y/core/TLSFAllocator.h>
 
 #include <atomic>
 #include <mutex>
@@ -34,48 +34,57 @@ SOFTWARE.
 namespace yave {
 
 class MeshAllocator : NonMovable {
-    using MutableTriangleSubBuffer = SubBuffer<BufferUsage::IndexBit | BufferUsage::TransferDstBit>;
+    using MutableIndexSubBuffer = SubBuffer<BufferUsage::IndexBit | BufferUsage::TransferDstBit>;
     using MutableAttribSubBuffer = SubBuffer<BufferUsage::AttributeBit | BufferUsage::TransferDstBit>;
+    using IndexBuffer = Buffer<BufferUsage::IndexBit | BufferUsage::TransferDstBit>;
 
-    struct FreeBlock {
-        u64 vertex_offset;
-        u64 vertex_count;
+    // One per MeshVertexFormat, each with its own vertex and index buffers
+    struct Pool {
+        AttribBuffer<> attrib_buffer;
+        IndexBuffer index_buffer;
 
-        u64 triangle_offset;
-        u64 triangle_count;
+        u64 vertex_capacity = 0;
+        u64 triangle_capacity = 0;
+
+        core::TLSFAllocator vertex_allocator;
+        core::TLSFAllocator triangle_allocator;
+
+        std::unique_ptr<MeshDrawBuffers> mesh_buffers;
     };
 
     public:
         static const u64 default_vertex_count = 8 * 1024 * 1024;
         static const u64 default_triangle_count = 8 * 1024 * 1024;
 
+        static const u64 default_compact_vertex_count = 4 * 1024 * 1024;
+        static const u64 default_compact_triangle_count = 4 * 1024 * 1024;
+
         MeshAllocator();
         ~MeshAllocator();
 
-        MeshDrawData alloc_mesh(const MeshVertexStreams& streams, core::Span<IndexedTriangle> triangles);
+        MeshDrawData alloc_mesh(const MeshVertexStreams& streams, core::Span<IndexedTriangle> triangles, MeshVertexFormat format = MeshVertexFormat::Full);
+
+        std::pair<u64, u64> available(MeshVertexFormat format = MeshVertexFormat::Full) const;
+        std::pair<u64, u64> allocated(MeshVertexFormat format = MeshVertexFormat::Full) const;
+        std::pair<u64, u64> capacity(MeshVertexFormat format = MeshVertexFormat::Full) const;
+        usize free_blocks() const; // slow!
 
-        std::pair<u64, u64> available() const; // slow!
-        std::pair<u64, u64> allocated() const; // slow!
-        usize free_blocks() const;
+        // Vertex and triangle allocator stats
+        std::pair<core::TLSFAllocator::Stats, core::TLSFAllocator::Stats> stats(MeshVertexFormat format = MeshVertexFormat::Full) const; // slow!
 
-        const MeshDrawBuffers& mesh_buffers() const;
+        const MeshDrawBuffers& mesh_buffers(MeshVertexFormat format = MeshVertexFormat::Full) const;
 
     private:
         friend class MeshDrawData;
 
-        std::pair<u64, u64> alloc_block(u64 vertex_count, u64 triangle_count);
-        void sort_and_compact_blocks();
+        void init_pool(MeshVertexFormat format, u64 vertex_count, u64 triangle_count);
 
-        void recycle(MeshDrawData* data);
+        std::pair<u64, u64> alloc_block(Pool& pool, u64 vertex_count, u64 triangle_count);
 
-        AttribBuffer<> _attrib_buffer;
-        TriangleBuffer<> _triangle_buffer;
+        void recycle(MeshDrawData* data);
 
-        core::Vector<FreeBlock> _free_blocks;
-        bool _should_compact = false;
+        std::array<Pool, usize(MeshVertexFormat::Max)> _pools;
         mutable std::mutex _lock;
-
-        std::unique_ptr<MeshDrawBuffers> _mesh_buffers;
 };
 
 }
@@ -82,6 +82,8 @@ DeviceProperties PhysicalDevice::device_properties() const {
 
     properties.timestamp_period = limits.timestampPeriod;
 
+    properties.draw_indirect_count = _supported_features_1_2.drawIndirectCount;
+
     return properties;
 }
 
@@ -0,0 +1,167 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include "PipelineCache.h"
+
+#include <yave/graphics/device/PhysicalDevice.h>
+#include <yave/utils/FileSystemModel.h>
+
+#include <y/io2/File.h>
+#include <y/utils/log.h>
+#include <y/utils/format.h>
+
+#include <cstring>
+
+namespace yave {
+
+static core::String cache_file_name(const VkPhysicalDeviceProperties& properties) {
+    core::String name;
+    fmt_into(name, "pipelines_{:04x}_{:04x}_{:08x}_", properties.vendorID, properties.deviceID, properties.driverVersion);
+    for(const u8 b : properties.pipelineCacheUUID) {
+        fmt_into(name, "{:02x}", b);
+    }
+    name += ".cache";
+    return name;
+}
+
+static bool is_cache_data_compatible(core::Span<u8> data, const VkPhysicalDeviceProperties& properties) {
+    VkPipelineCacheHeaderVersionOne header = {};
+    if(data.size() < sizeof(header)) {
+        return false;
+    }
+
+    std::memcpy(&header, data.data(), sizeof(header));
+    return header.headerSize >= sizeof(header) &&
+           header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+           header.vendorID == properties.vendorID &&
+           header.deviceID == properties.deviceID &&
+           std::equal(std::begin(header.pipelineCacheUUID), std::end(header.pipelineCacheUUID), std::begin(properties.pipelineCacheUUID));
+}
+
+static core::Vector<u8> load_cache_data(const core::String& file_name, const VkPhysicalDeviceProperties& properties) {
+    y_profile();
+
+    core::Vector<u8> data;
+    if(auto file = io2::File::open(file_name); file.is_error() || file.unwrap().read_all(data).is_error()) {
+        return {};
+    }
+
+    if(!is_cache_data_compatible(data, properties)) {
+        log_msg(fmt("Pipeline cache \"{}\" is not compatible with this device, discarding", file_name), Log::Warning);
+        return {};
+    }
+
+    return data;
+}
+
+
+
+PipelineCache::PipelineCache() :
+        _file_name(cache_file_name(physical_device().vk_properties())),
+        _thread_pool(compile_thread_count) {
+
+    const core::Vector<u8> data = load_cache_data(_file_name, physical_device().vk_properties());
+
+    VkPipelineCacheCreateInfo create_info = vk_struct();
+    {
+        create_info.initialDataSize = data.size();
+        create_info.pInitialData = data.data();
+    }
+
+    if(vkCreatePipelineCache(vk_device(), &create_info, vk_allocation_callbacks(), _cache.get_ptr_for_init()) != VK_SUCCESS) {
+        log_msg("Unable to load pipeline cache, starting from an empty cache", Log::Warning);
+        create_info.initialDataSize = 0;
+        create_info.pInitialData = nullptr;
+        vk_check(vkCreatePipelineCache(vk_device(), &create_info, vk_allocation_callbacks(), _cache.get_ptr_for_init()));
+    }
+
+    if(!data.is_empty()) {
+        log_msg(fmt("Loaded {}KB of pipeline cache from \"{}\"", data.size() / 1024, _file_name));
+    }
+}
+
+PipelineCache::~PipelineCache() {
+    _thread_pool.process_until_empty();
+
+    if(!save()) {
+        log_msg(fmt("Unable to save pipeline cache to \"{}\"", _file_name), Log::Error);
+    }
+
+    destroy_graphic_resource(std::move(_cache));
+}
+
+VkPipelineCache PipelineCache::vk_pipeline_cache() const {
+    return _cache;
+}
+
+const core::String& PipelineCache::file_name() const {
+    return _file_name;
+}
+
+usize PipelineCache::data_size() const {
+    usize size = 0;
+    vk_check(vkGetPipelineCacheData(vk_device(), _cache, &size, nullptr));
+    return size;
+}
+
+bool PipelineCache::save() const {
+    y_profile();
+
+    core::Vector<u8> data;
+    {
+        usize size = 0;
+        vk_check(vkGetPipelineCacheData(vk_device(), _cache, &size, nullptr));
+        data = core::Vector<u8>(size, u8(0));
+
+        // The cache can grow between the two calls, in which case VK_INCOMPLETE is returned with a truncated but valid blob
+        const VkResult result = vkGetPipelineCacheData(vk_device(), _cache, &size, data.data());
+        if(result != VK_SUCCESS && result != VK_INCOMPLETE) {
+            return false;
+        }
+        data.shrink_to(size);
+    }
+
+    if(data.is_empty()) {
+        return true;
+    }
+
+    // Write to a temporary file and rename so a crash never leaves a truncated cache behind
+    const core::String tmp_file = _file_name + "_";
+    if(auto file = io2::File::create(tmp_file); file.is_error() || file.unwrap().write_array(data.data(), data.size()).is_error()) {
+        return false;
+    }
+    return bool(FileSystemModel::local_filesystem()->rename(tmp_file, _file_name));
+}
+
+void PipelineCache::schedule(std::function<void()> func, concurrent::DependencyGroup* signal) {
+    _thread_pool.schedule(std::move(func), signal);
+}
+
+void PipelineCache::wait(concurrent::DependencyGroup& group) {
+    _thread_pool.process_until_complete(group);
+}
+
+usize PipelineCache::pending_compilations() const {
+    return _thread_pool.pending_tasks();
+}
+
+}
@@ -0,0 +1,66 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#ifndef YAVE_GRAPHICS_DEVICE_PIPELINECACHE_H
+#define YAVE_GRAPHICS_DEVICE_PIPELINECACHE_H
+
+#include <yave/graphics/graphics.h>
+
+#include <y/concurrent/StaticThreadPool.h>
+#include <y/core/String.h>
+
+namespace yave {
+
+// Wraps a VkPipelineCache that is persisted to disk between runs and owns the worker threads used for background pipeline compilation.
+// The cache file name is derived from the physical device (vendor, device, driver version and pipelineCacheUUID),
+// so switching GPU or updating the driver never feeds a stale blob to the driver.
+class PipelineCache : NonMovable {
+    public:
+        static constexpr usize compile_thread_count = 2;
+
+        PipelineCache();
+        ~PipelineCache();
+
+        VkPipelineCache vk_pipeline_cache() const;
+
+        const core::String& file_name() const;
+        usize data_size() const;
+
+        bool save() const;
+
+        // Schedules a pipeline compilation on the compile threads, signal is set once func has run
+        void schedule(std::function<void()> func, concurrent::DependencyGroup* signal = nullptr);
+
+        // Blocks until the group is ready, processing pending compilations on the calling thread
+        void wait(concurrent::DependencyGroup& group);
+
+        usize pending_compilations() const;
+
+    private:
+        VkHandle<VkPipelineCache> _cache;
+        core::String _file_name;
+
+        concurrent::StaticThreadPool _thread_pool;
+};
+
+}
+
+#endif // YAVE_GRAPHICS_DEVICE_PIPELINECACHE_H
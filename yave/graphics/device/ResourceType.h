@@ -35,6 +35,7 @@ namespace yave {
     X(VkHandle<VkFramebuffer>)              \
     X(VkHandle<VkPipeline>)                 \
     X(VkHandle<VkPipelineLayout>)           \
+    X(VkHandle<VkPipelineCache>)            \
     X(VkHandle<VkShaderModule>)             \
     X(VkHandle<VkSampler>)                  \
     X(VkHandle<VkSwapchainKHR>)             \
@@ -62,6 +62,12 @@ void vk_destroy(VkPipelineLayout pipeline_layout) {
     }
 }
 
+void vk_destroy(VkPipelineCache cache) {
+    /*if()*/ {
+        vkDestroyPipelineCache(vk_device(), cache, vk_allocation_callbacks());
+    }
+}
+
 void vk_destroy(VkShaderModule module) {
     /*if()*/ {
         vkDestroyShaderModule(vk_device(), module, vk_allocation_callbacks());
@@ -168,6 +168,15 @@ u32 queue_family_index(core::Span<VkQueueFamilyProperties> families, VkQueueFlag
     return u32(best_family_index);
 }
 
+u32 dedicated_queue_family_index(core::Span<VkQueueFamilyProperties> families, VkQueueFlags flags, VkQueueFlags excluded) {
+    for(usize i = 0; i != families.size(); ++i) {
+        if(families[i].queueCount && (families[i].queueFlags & flags) == flags && !(families[i].queueFlags & excluded)) {
+            return u32(i);
+        }
+    }
+    return u32(-1);
+}
+
 VkQueue create_queue(VkDevice device, u32 family_index, u32 index) {
     VkQueue q = {};
     vkGetDeviceQueue(device, family_index, index, &q);
@@ -196,6 +205,7 @@ void print_properties(const DeviceProperties& properties) {
     log_msg(fmt("max_memory_allocations = {}", properties.max_memory_allocations));
     log_msg(fmt("max_inline_uniform_size = {}", properties.max_inline_uniform_size));
     log_msg(fmt("max_uniform_buffer_size = {}", properties.max_uniform_buffer_size));
+    log_msg(fmt("draw_indirect_count = {}", properties.draw_indirect_count));
 }
 
 
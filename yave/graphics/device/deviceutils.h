@@ -43,6 +43,7 @@ VkHandle<VkSampler> create_sampler(SamplerType type);
 
 core::Vector<VkQueueFamilyProperties> enumerate_family_properties(VkPhysicalDevice device);
 u32 queue_family_index(core::Span<VkQueueFamilyProperties> families, VkQueueFlags flags);
+u32 dedicated_queue_family_index(core::Span<VkQueueFamilyProperties> families, VkQueueFlags flags, VkQueueFlags excluded); // u32(-1) if none
 VkQueue create_queue(VkDevice device, u32 family_index, u32 index);
 
 void print_physical_properties(const VkPhysicalDeviceProperties& properties);
@@ -166,6 +166,15 @@ bool RenderPass::Layout::is_depth_only() const {
     return !_colors[0].is_valid();
 }
 
+ImageFormat RenderPass::Layout::depth_format() const {
+    return _depth;
+}
+
+core::Span<ImageFormat> RenderPass::Layout::color_formats() const {
+    const auto end = std::find_if(_colors.begin(), _colors.end(), [](const ImageFormat& f) { return !f.is_valid(); });
+    return core::Span<ImageFormat>(_colors.data(), usize(end - _colors.begin()));
+}
+
 bool RenderPass::Layout::operator==(const Layout& other) const {
     return _depth == other._depth && _colors == other._colors;
 }
@@ -181,6 +190,21 @@ RenderPass::RenderPass(core::Span<AttachmentData> colors) :
         RenderPass(AttachmentData(), colors) {
 }
 
+RenderPass::RenderPass(const Layout& layout) {
+    // Render pass compatibility only depends on attachment formats and sample counts, so usages and load ops are arbitrary here
+    const AttachmentData depth = layout.depth_format().is_valid()
+        ? AttachmentData(layout.depth_format(), ImageUsage::DepthBit, LoadOp::Clear)
+        : AttachmentData();
+
+    const core::Span<ImageFormat> color_formats = layout.color_formats();
+    auto colors = core::ScratchPad<AttachmentData>(color_formats.size());
+    std::transform(color_formats.begin(), color_formats.end(), colors.begin(), [](ImageFormat f) { return AttachmentData(f, ImageUsage::ColorBit, LoadOp::Clear); });
+
+    _attachment_count = colors.size();
+    _render_pass = create_renderpass(depth, colors);
+    _layout = Layout(depth, colors);
+}
+
 RenderPass::~RenderPass() {
     destroy_graphic_resource(std::move(_render_pass));
 }
@@ -66,6 +66,9 @@ class RenderPass {
                 u64 hash() const;
                 bool is_depth_only() const;
 
+                ImageFormat depth_format() const;
+                core::Span<ImageFormat> color_formats() const;
+
                 bool operator==(const Layout& other) const;
 
             private:
@@ -80,6 +83,9 @@ class RenderPass {
         RenderPass(AttachmentData depth, core::Span<AttachmentData> colors);
         RenderPass(core::Span<AttachmentData> colors);
 
+        // Creates a render pass compatible with any render pass sharing the same layout, for compiling pipelines ahead of time
+        explicit RenderPass(const Layout& layout);
+
         ~RenderPass();
 
         bool is_depth_only() const;
@@ -31,14 +31,19 @@ SOFTWARE.
 #include <yave/graphics/images/Sampler.h>
 #include <yave/graphics/commands/CmdQueue.h>
 #include <yave/graphics/descriptors/DescriptorSetAllocator.h>
+#include <yave/graphics/descriptors/DescriptorSetCache.h>
 #include <yave/graphics/memory/DeviceMemoryAllocator.h>
 #include <yave/graphics/device/LifetimeManager.h>
 #include <yave/graphics/device/MeshAllocator.h>
 #include <yave/graphics/device/MaterialAllocator.h>
+#include <yave/graphics/device/PipelineCache.h>
 #include <yave/graphics/images/TextureLibrary.h>
 
 #include <y/concurrent/Mutexed.h>
+#include <y/concurrent/StaticThreadPool.h>
 #include <y/core/ScratchPad.h>
+#include <y/utils/log.h>
+#include <y/utils/format.h>
 
 
 namespace yave {
@@ -53,7 +58,9 @@ std::array<Uninitialized<Sampler>, 5> samplers;
 
 Uninitialized<DeviceMemoryAllocator> allocator;
 Uninitialized<LifetimeManager> lifetime_manager;
+Uninitialized<PipelineCache> pipeline_cache;
 Uninitialized<DescriptorSetAllocator> descriptor_set_allocator;
+Uninitialized<TransientDescriptorSetAllocator> transient_descriptor_set_allocator;
 Uninitialized<MeshAllocator> mesh_allocator;
 Uninitialized<MaterialAllocator> material_allocator;
 Uninitialized<TextureLibrary> texture_library;
@@ -62,6 +69,9 @@ Uninitialized<DeviceResources> resources;
 VkDevice vk_device;
 
 Uninitialized<CmdQueue> queue;
+std::unique_ptr<CmdQueue> async_compute_queue;
+
+Uninitialized<concurrent::StaticThreadPool> recording_thread_pool;
 
 #ifdef Y_DEBUG
 std::atomic<bool> destroying = false;
@@ -79,6 +89,7 @@ static void init_vk_device() {
 
     const VkQueueFlags graphic_queue_flags = VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT;
     const u32 main_queue_index = queue_family_index(queue_families, graphic_queue_flags);
+    const u32 async_compute_queue_index = dedicated_queue_family_index(queue_families, VK_QUEUE_COMPUTE_BIT, VK_QUEUE_GRAPHICS_BIT);
 
     // const VkQueueFamilyProperties main_queue_family_properties = queue_families[main_queue_index];
     const usize queue_count = 1;
@@ -98,6 +109,11 @@ static void init_vk_device() {
         required_features_1_3.inlineUniformBlock = true;
     }
 
+    // Optional, used by GPU culling
+    if(physical_device().device_properties().draw_indirect_count) {
+        required_features_1_2.drawIndirectCount = true;
+    }
+
     y_always_assert(has_required_features(physical_device()), "Device doesn't support required features");
     y_always_assert(has_required_properties(physical_device()), "Device doesn't support required properties");
 
@@ -109,13 +125,26 @@ static void init_vk_device() {
     std::fill_n(queue_priorities.data(), queue_priorities.size(), 0.0f);
     queue_priorities[0] = 1.0f;
 
-    VkDeviceQueueCreateInfo queue_create_info = vk_struct();
+    const float async_compute_priority = 1.0f;
+
+    std::array<VkDeviceQueueCreateInfo, 2> queue_create_infos = {};
     {
+        VkDeviceQueueCreateInfo& queue_create_info = queue_create_infos[0];
+        queue_create_info = vk_struct();
         queue_create_info.queueFamilyIndex = main_queue_index;
         queue_create_info.pQueuePriorities = queue_priorities.data();
         queue_create_info.queueCount = u32(queue_priorities.size());
     }
 
+    const bool has_async_compute = async_compute_queue_index != u32(-1);
+    if(has_async_compute) {
+        VkDeviceQueueCreateInfo& queue_create_info = queue_create_infos[1];
+        queue_create_info = vk_struct();
+        queue_create_info.queueFamilyIndex = async_compute_queue_index;
+        queue_create_info.pQueuePriorities = &async_compute_priority;
+        queue_create_info.queueCount = 1;
+    }
+
     VkPhysicalDeviceFeatures2 features = vk_struct();
     {
         features.features = required_features;
@@ -131,8 +160,8 @@ static void init_vk_device() {
         create_info.ppEnabledExtensionNames = extensions.data();
         create_info.enabledLayerCount = u32(debug.device_layers().size());
         create_info.ppEnabledLayerNames = debug.device_layers().data();
-        create_info.queueCreateInfoCount = 1;
-        create_info.pQueueCreateInfos = &queue_create_info;
+        create_info.queueCreateInfoCount = has_async_compute ? 2 : 1;
+        create_info.pQueueCreateInfos = queue_create_infos.data();
     }
 
     {
@@ -144,6 +173,11 @@ static void init_vk_device() {
     print_properties(device::device_properties);
 
     device::queue.init(main_queue_index, create_queue(device::vk_device, main_queue_index, 0));
+
+    if(has_async_compute) {
+        device::async_compute_queue = std::make_unique<CmdQueue>(async_compute_queue_index, create_queue(device::vk_device, async_compute_queue_index, 0), "Async compute queue");
+        log_msg(fmt("Using queue family {} for async compute", async_compute_queue_index));
+    }
 }
 
 
@@ -162,12 +196,17 @@ void init_device(Instance& instance, PhysicalDevice device) {
     init_vk_device();
 
     device::lifetime_manager.init();
+    device::pipeline_cache.init();
     device::allocator.init(device_properties());
     device::descriptor_set_allocator.init();
+    device::transient_descriptor_set_allocator.init();
     device::mesh_allocator.init();
     device::material_allocator.init();
     device::texture_library.init();
 
+    // Leave some room for the loading and compilation threads
+    device::recording_thread_pool.init(std::max(2u, std::thread::hardware_concurrency() / 2));
+
     for(usize i = 0; i != device::samplers.size(); ++i) {
         device::samplers[i].init(create_sampler(SamplerType(i)));
     }
@@ -180,7 +219,10 @@ void destroy_device() {
     lifetime_manager().shutdown_collector_thread();
     wait_all_queues();
 
+    device::recording_thread_pool.destroy();
+
     device::resources.destroy();
+    device::pipeline_cache.destroy();
 
     lifetime_manager().wait_cmd_buffers();
 
@@ -190,6 +232,9 @@ void destroy_device() {
 #endif
 
     device::queue->clear_all_cmd_pools();
+    if(device::async_compute_queue) {
+        device::async_compute_queue->clear_all_cmd_pools();
+    }
 
     for(auto& sampler : device::samplers) {
         sampler.destroy();
@@ -198,10 +243,12 @@ void destroy_device() {
     device::texture_library.destroy();
     device::material_allocator.destroy();
     device::mesh_allocator.destroy();
+    device::transient_descriptor_set_allocator.destroy();
     device::descriptor_set_allocator.destroy();
     device::lifetime_manager.destroy();
     device::allocator.destroy();
 
+    device::async_compute_queue = nullptr;
     device::queue.destroy();
 
     {
@@ -263,6 +310,10 @@ DescriptorSetAllocator& descriptor_set_allocator() {
     return *device::descriptor_set_allocator;
 }
 
+TransientDescriptorSetAllocator& transient_descriptor_set_allocator() {
+    return *device::transient_descriptor_set_allocator;
+}
+
 MeshAllocator& mesh_allocator() {
     return *device::mesh_allocator;
 }
@@ -271,6 +322,10 @@ MaterialAllocator& material_allocator() {
     return *device::material_allocator;
 }
 
+PipelineCache& pipeline_cache() {
+    return *device::pipeline_cache;
+}
+
 TextureLibrary& texture_library() {
     return *device::texture_library;
 }
@@ -283,6 +338,10 @@ CmdQueue& loading_command_queue() {
     return *device::queue;
 }
 
+CmdQueue* async_compute_queue() {
+    return device::async_compute_queue.get();
+}
+
 const DeviceResources& device_resources() {
     return *device::resources;
 }
@@ -295,6 +354,10 @@ LifetimeManager& lifetime_manager() {
     return *device::lifetime_manager;
 }
 
+concurrent::StaticThreadPool& recording_thread_pool() {
+    return *device::recording_thread_pool;
+}
+
 const VkAllocationCallbacks* vk_allocation_callbacks() {
 #if 0
     static VkAllocationCallbacks callbacks = {
@@ -322,6 +385,10 @@ const VkAllocationCallbacks* vk_allocation_callbacks() {
 #endif
 }
 
+VkPipelineCache vk_pipeline_cache() {
+    return device::pipeline_cache->vk_pipeline_cache();
+}
+
 VkSampler vk_sampler(SamplerType type) {
     y_debug_assert(usize(type) < device::samplers.size());
     return device::samplers[usize(type)]->vk_sampler();
@@ -333,15 +400,35 @@ const DebugUtils* debug_utils() {
 
 void wait_all_queues() {
     device::queue->wait();
+    if(device::async_compute_queue) {
+        device::async_compute_queue->wait();
+    }
 }
 
 
 
 
 
+template<typename T>
+static void invalidate_cached_descriptor_sets(const T&) {
+}
+
+static void invalidate_cached_descriptor_sets(const VkHandle<VkBuffer>& buffer) {
+    DescriptorSetCache::invalidate(buffer.get());
+}
+
+static void invalidate_cached_descriptor_sets(const VkHandle<VkImageView>& image_view) {
+    DescriptorSetCache::invalidate(image_view.get());
+}
+
+static void invalidate_cached_descriptor_sets(const VkHandle<VkSampler>& sampler) {
+    DescriptorSetCache::invalidate(sampler.get());
+}
+
 #define YAVE_GENERATE_DESTROY_IMPL(T)                                                   \
     void destroy_graphic_resource(T&& t) {                                              \
         if(!t.is_null()) {                                                              \
+            invalidate_cached_descriptor_sets(t);                                       \
             lifetime_manager().destroy_later(std::move(t));                             \
             y_debug_assert(t.is_null());                                                \
         }                                                                               \
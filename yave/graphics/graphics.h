@@ -52,16 +52,21 @@ TransferCmdBufferRecorder create_disposable_transfer_cmd_buffer();
 const PhysicalDevice& physical_device();
 DeviceMemoryAllocator& device_allocator();
 DescriptorSetAllocator& descriptor_set_allocator();
+TransientDescriptorSetAllocator& transient_descriptor_set_allocator();
 MeshAllocator& mesh_allocator();
 MaterialAllocator& material_allocator();
+PipelineCache& pipeline_cache();
 TextureLibrary& texture_library();
 CmdQueue& command_queue();
 CmdQueue& loading_command_queue();
+CmdQueue* async_compute_queue(); // nullptr if the device doesn't have a dedicated compute queue
 const DeviceResources& device_resources();
 const DeviceProperties& device_properties();
 LifetimeManager& lifetime_manager();
+concurrent::StaticThreadPool& recording_thread_pool();
 
 const VkAllocationCallbacks* vk_allocation_callbacks();
+VkPipelineCache vk_pipeline_cache();
 VkSampler vk_sampler(SamplerType type);
 
 const DebugUtils* debug_utils();
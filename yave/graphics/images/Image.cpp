@@ -33,7 +33,7 @@ SOFTWARE.
 
 namespace yave {
 
-static VkHandle<VkImage> create_image(const math::Vec3ui& size, usize layers, usize mips, ImageFormat format, ImageUsage usage, ImageType type) {
+static VkImageCreateInfo image_create_info(const math::Vec3ui& size, usize layers, usize mips, ImageFormat format, ImageUsage usage, ImageType type) {
     y_debug_assert(usage != ImageUsage::TransferDstBit);
 
     VkImageCreateInfo create_info = vk_struct();
@@ -50,6 +50,11 @@ static VkHandle<VkImage> create_image(const math::Vec3ui& size, usize layers, us
         create_info.usage = VkImageUsageFlags(usage);
         create_info.samples = VK_SAMPLE_COUNT_1_BIT;
     }
+    return create_info;
+}
+
+static VkHandle<VkImage> create_image(const math::Vec3ui& size, usize layers, usize mips, ImageFormat format, ImageUsage usage, ImageType type) {
+    const VkImageCreateInfo create_info = image_create_info(size, layers, mips, format, usage, type);
 
     VkHandle<VkImage> image;
     vk_check(vkCreateImage(vk_device(), &create_info, vk_allocation_callbacks(), image.get_ptr_for_init()));
@@ -184,6 +189,18 @@ ImageBase::ImageBase(ImageUsage usage, ImageType type, const ImageData& data) :
     upload_data(*this, data);
 }
 
+ImageBase::ImageBase(ImageFormat format, ImageUsage usage, const math::Vec3ui& size, ImageType type, VkDeviceMemory memory, u64 memory_offset) :
+        _size(size),
+        _format(format),
+        _usage(usage) {
+
+    check_layer_count(type, _size, _layers);
+
+    _image = create_image(_size, _layers, _mips, _format, _usage, type);
+    vk_check(vkBindImageMemory(vk_device(), _image, memory, memory_offset));
+    _view = create_view(_image, _format, _layers, _mips, type);
+}
+
 ImageBase::~ImageBase() {
     destroy_graphic_resource(std::move(_view));
     destroy_graphic_resource(std::move(_image));
@@ -214,6 +231,17 @@ ImageUsage ImageBase::usage() const {
     return _usage;
 }
 
+VkMemoryRequirements ImageBase::memory_requirements(ImageFormat format, ImageUsage usage, const math::Vec3ui& size, ImageType type, usize layers, usize mips) {
+    const VkImageCreateInfo create_info = image_create_info(size, layers, mips, format, usage, type);
+
+    VkDeviceImageMemoryRequirements infos = vk_struct();
+    infos.pCreateInfo = &create_info;
+
+    VkMemoryRequirements2 reqs = vk_struct();
+    vkGetDeviceImageMemoryRequirements(vk_device(), &infos, &reqs);
+    return reqs.memoryRequirements;
+}
+
 VkImageView ImageBase::vk_view() const {
     y_debug_assert(!is_null());
     return _view;
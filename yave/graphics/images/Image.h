@@ -52,6 +52,8 @@ class ImageBase : NonCopyable {
         ImageFormat format() const;
         ImageUsage usage() const;
 
+        static VkMemoryRequirements memory_requirements(ImageFormat format, ImageUsage usage, const math::Vec3ui& size, ImageType type = ImageType::TwoD, usize layers = 1, usize mips = 1);
+
     protected:
         ImageBase() = default;
         ImageBase(ImageBase&&) = default;
@@ -60,6 +62,9 @@ class ImageBase : NonCopyable {
         ImageBase(ImageFormat format, ImageUsage usage, const math::Vec3ui& size, ImageType type = ImageType::TwoD, usize layers = 1, usize mips = 1, MemoryAllocFlags alloc_flags = MemoryAllocFlags::None);
         ImageBase(ImageUsage usage, ImageType type, const ImageData& data);
 
+        // Binds to memory owned by someone else, the image is left in VK_IMAGE_LAYOUT_UNDEFINED
+        ImageBase(ImageFormat format, ImageUsage usage, const math::Vec3ui& size, ImageType type, VkDeviceMemory memory, u64 memory_offset);
+
 
         math::Vec3ui _size;
         u32 _layers = 1;
@@ -0,0 +1,1270 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include "block_compression.h"
+
+#include <y/math/simd.h>
+
+#include <algorithm>
+#include <bit>
+
+namespace yave {
+
+static constexpr usize block_texels = 16;
+
+static constexpr u8 bc7_weights_3[] = {0, 9, 18, 27, 37, 46, 55, 64};
+static constexpr u8 bc7_weights_4[] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+// One bit per texel, set for texels of the second subset
+static constexpr u16 bc7_partitions_2[64] = {
+    0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+    0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+    0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+    0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+    0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+    0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+    0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+    0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22,
+};
+
+// Texel index of the second subset's anchor, the first subset's is always 0
+static constexpr u8 bc7_anchors_2[64] = {
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15,  2,  8,  2,  2,  8,  8, 15,
+     2,  8,  2,  2,  8,  8,  2,  2,
+    15, 15,  6,  8,  2,  8, 15, 15,
+     2,  8,  2,  2,  2, 15, 15,  6,
+     6,  2,  6,  8, 15, 15,  2,  2,
+    15, 15, 15, 15, 15,  2,  2, 15,
+};
+
+
+class BitWriter {
+    public:
+        void write(u64 value, usize bits) {
+            y_debug_assert(_offset + bits <= 128);
+            y_debug_assert(value < (u64(1) << bits));
+
+            const usize word = _offset / 64;
+            const usize shift = _offset % 64;
+            _data[word] |= value << shift;
+            if(shift + bits > 64) {
+                _data[word + 1] |= value >> (64 - shift);
+            }
+            _offset += bits;
+        }
+
+        Block128 data() const {
+            y_debug_assert(_offset == 128);
+            return _data;
+        }
+
+    private:
+        Block128 _data = {};
+        usize _offset = 0;
+};
+
+class BitReader {
+    public:
+        BitReader(const Block128& data) : _data(data) {
+        }
+
+        u32 read(usize bits) {
+            y_debug_assert(_offset + bits <= 128);
+
+            const usize word = _offset / 64;
+            const usize shift = _offset % 64;
+            u64 value = _data[word] >> shift;
+            if(shift + bits > 64) {
+                value |= _data[word + 1] << (64 - shift);
+            }
+            _offset += bits;
+            return u32(value & ((u64(1) << bits) - 1));
+        }
+
+    private:
+        Block128 _data;
+        usize _offset = 0;
+};
+
+
+struct Texels {
+    i32 values[block_texels][4];
+
+    Texels(const u8* texels) {
+        for(usize i = 0; i != block_texels; ++i) {
+            for(usize c = 0; c != 4; ++c) {
+                values[i][c] = texels[i * 4 + c];
+            }
+        }
+    }
+};
+
+static inline i32 round_to_int(float x) {
+    return i32(std::floor(x + 0.5f));
+}
+
+static inline i32 interpolate_bc7(i32 e0, i32 e1, i32 weight) {
+    return ((64 - weight) * e0 + weight * e1 + 32) >> 6;
+}
+
+// Expands 0-0xFFFF masks into one bit every two bits, for 2 bit indices
+static inline u32 spread_bits(u32 x) {
+    x = (x | (x << 8)) & 0x00FF00FF;
+    x = (x | (x << 4)) & 0x0F0F0F0F;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+    return x;
+}
+
+// Principal axis of the texels in mask using power iteration. Returns false if all texels are identical.
+template<usize N>
+static bool principal_axis(const Texels& texels, u16 mask, float (&mean)[N], float (&axis)[N], usize iterations = 8) {
+    y_debug_assert(mask);
+
+    for(usize c = 0; c != N; ++c) {
+        mean[c] = 0.0f;
+    }
+
+    const float inv_count = 1.0f / float(std::popcount(mask));
+    for(usize i = 0; i != block_texels; ++i) {
+        if(mask & (1 << i)) {
+            for(usize c = 0; c != N; ++c) {
+                mean[c] += float(texels.values[i][c]);
+            }
+        }
+    }
+    for(usize c = 0; c != N; ++c) {
+        mean[c] *= inv_count;
+    }
+
+    float cov[N][N] = {};
+    for(usize i = 0; i != block_texels; ++i) {
+        if(mask & (1 << i)) {
+            float d[N] = {};
+            for(usize c = 0; c != N; ++c) {
+                d[c] = float(texels.values[i][c]) - mean[c];
+            }
+            for(usize a = 0; a != N; ++a) {
+                for(usize b = a; b != N; ++b) {
+                    cov[a][b] += d[a] * d[b];
+                }
+            }
+        }
+    }
+
+    // Start from the channel with the largest variance
+    usize start = 0;
+    for(usize a = 0; a != N; ++a) {
+        for(usize b = 0; b != a; ++b) {
+            cov[a][b] = cov[b][a];
+        }
+        if(cov[a][a] > cov[start][start]) {
+            start = a;
+        }
+    }
+
+    if(cov[start][start] <= 0.0f) {
+        for(usize c = 0; c != N; ++c) {
+            axis[c] = 0.0f;
+        }
+        return false;
+    }
+
+    for(usize c = 0; c != N; ++c) {
+        axis[c] = cov[start][c];
+    }
+
+    for(usize k = 0; k != iterations; ++k) {
+        float next[N] = {};
+        float max_abs = 0.0f;
+        for(usize a = 0; a != N; ++a) {
+            for(usize b = 0; b != N; ++b) {
+                next[a] += cov[a][b] * axis[b];
+            }
+            max_abs = std::max(max_abs, std::abs(next[a]));
+        }
+        if(max_abs <= 0.0f) {
+            break;
+        }
+        for(usize c = 0; c != N; ++c) {
+            axis[c] = next[c] / max_abs;
+        }
+    }
+
+    float len2 = 0.0f;
+    for(usize c = 0; c != N; ++c) {
+        len2 += axis[c] * axis[c];
+    }
+    const float inv_len = 1.0f / std::sqrt(len2);
+    for(usize c = 0; c != N; ++c) {
+        axis[c] *= inv_len;
+    }
+    return true;
+}
+
+// Endpoints spanning the projection of the texels on their principal axis
+template<usize N>
+static void principal_endpoints(const Texels& texels, u16 mask, float (&endpoints)[2][4]) {
+    float mean[N] = {};
+    float axis[N] = {};
+    principal_axis(texels, mask, mean, axis);
+
+    float min_t = 0.0f;
+    float max_t = 0.0f;
+    for(usize i = 0; i != block_texels; ++i) {
+        if(mask & (1 << i)) {
+            float t = 0.0f;
+            for(usize c = 0; c != N; ++c) {
+                t += (float(texels.values[i][c]) - mean[c]) * axis[c];
+            }
+            min_t = std::min(min_t, t);
+            max_t = std::max(max_t, t);
+        }
+    }
+
+    for(usize c = 0; c != N; ++c) {
+        endpoints[0][c] = std::clamp(mean[c] + axis[c] * min_t, 0.0f, 255.0f);
+        endpoints[1][c] = std::clamp(mean[c] + axis[c] * max_t, 0.0f, 255.0f);
+    }
+}
+
+// Solves for the endpoints minimizing the squared error given the texel weights (in [0, 1], toward the second endpoint)
+template<usize N>
+static bool least_squares_endpoints(const Texels& texels, u16 mask, const float* weights, float (&endpoints)[2][4]) {
+    float aa = 0.0f;
+    float ab = 0.0f;
+    float bb = 0.0f;
+    float ax[N] = {};
+    float bx[N] = {};
+
+    for(usize i = 0; i != block_texels; ++i) {
+        if(mask & (1 << i)) {
+            const float b = weights[i];
+            const float a = 1.0f - b;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for(usize c = 0; c != N; ++c) {
+                ax[c] += a * float(texels.values[i][c]);
+                bx[c] += b * float(texels.values[i][c]);
+            }
+        }
+    }
+
+    const float det = aa * bb - ab * ab;
+    if(std::abs(det) < 1e-4f) {
+        return false;
+    }
+
+    const float inv_det = 1.0f / det;
+    for(usize c = 0; c != N; ++c) {
+        endpoints[0][c] = std::clamp((ax[c] * bb - bx[c] * ab) * inv_det, 0.0f, 255.0f);
+        endpoints[1][c] = std::clamp((bx[c] * aa - ax[c] * ab) * inv_det, 0.0f, 255.0f);
+    }
+    return true;
+}
+
+
+
+
+// ----------------------------- BC1 -----------------------------
+
+static inline u16 pack_565(i32 r, i32 g, i32 b) {
+    const u32 r5 = (u32(r) * 31 + 127) / 255;
+    const u32 g6 = (u32(g) * 63 + 127) / 255;
+    const u32 b5 = (u32(b) * 31 + 127) / 255;
+    return u16((r5 << 11) | (g6 << 5) | b5);
+}
+
+static inline void unpack_565(u16 color, i32* rgb) {
+    const i32 r = (color >> 11) & 0x1F;
+    const i32 g = (color >> 5) & 0x3F;
+    const i32 b = color & 0x1F;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+static void bc1_palette(u16 c0, u16 c1, i32 (&palette)[4][3]) {
+    unpack_565(c0, palette[0]);
+    unpack_565(c1, palette[1]);
+    for(usize c = 0; c != 3; ++c) {
+        if(c0 > c1) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        } else {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+}
+
+static inline Block64 bc1_block(u16 c0, u16 c1, u32 indices) {
+    return Block64(c0) | (Block64(c1) << 16) | (Block64(indices) << 32);
+}
+
+struct BC1Fit {
+    u16 c0 = 0;
+    u16 c1 = 0;
+    u32 indices = 0;
+    u32 error = u32(-1);
+};
+
+// Always uses the 4 colors mode unless both endpoints are equal
+static BC1Fit bc1_fit_indices(const Texels& texels, u16 a, u16 b) {
+    BC1Fit fit;
+    fit.c0 = std::max(a, b);
+    fit.c1 = std::min(a, b);
+    fit.error = 0;
+
+    i32 palette[4][3] = {};
+    bc1_palette(fit.c0, fit.c1, palette);
+
+    for(usize i = 0; i != block_texels; ++i) {
+        u32 best_index = 0;
+        u32 best_error = u32(-1);
+        for(u32 p = 0; p != 4; ++p) {
+            u32 error = 0;
+            for(usize c = 0; c != 3; ++c) {
+                const i32 d = texels.values[i][c] - palette[p][c];
+                error += u32(d * d);
+            }
+            if(error < best_error) {
+                best_error = error;
+                best_index = p;
+            }
+        }
+        fit.indices |= best_index << (i * 2);
+        fit.error += best_error;
+    }
+
+    return fit;
+}
+
+static bool bc1_least_squares(const Texels& texels, u32 indices, float (&endpoints)[2][4]) {
+    // Weight toward c1 of each index in 4 colors mode
+    static constexpr float index_weights[] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+
+    float weights[block_texels] = {};
+    for(usize i = 0; i != block_texels; ++i) {
+        weights[i] = index_weights[(indices >> (i * 2)) & 0x03];
+    }
+    return least_squares_endpoints<3>(texels, 0xFFFF, weights, endpoints);
+}
+
+static inline BC1Fit bc1_fit_endpoints(const Texels& texels, const float (&endpoints)[2][4]) {
+    const u16 a = pack_565(round_to_int(endpoints[0][0]), round_to_int(endpoints[0][1]), round_to_int(endpoints[0][2]));
+    const u16 b = pack_565(round_to_int(endpoints[1][0]), round_to_int(endpoints[1][1]), round_to_int(endpoints[1][2]));
+    return bc1_fit_indices(texels, a, b);
+}
+
+// Indices from the projection of each texel on the c1 -> c0 segment, in 4 colors mode (c0 > c1)
+static u32 bc1_project_indices(const u8* texels, u16 c0, u16 c1) {
+    y_debug_assert(c0 > c1);
+
+    i32 e0[3] = {};
+    i32 e1[3] = {};
+    unpack_565(c0, e0);
+    unpack_565(c1, e1);
+
+    const i32 dir[3] = {e0[0] - e1[0], e0[1] - e1[1], e0[2] - e1[2]};
+    const i32 dir_len2 = dir[0] * dir[0] + dir[1] * dir[1] + dir[2] * dir[2];
+
+    // Index from t = dot / dir_len2: [0, 1/6[ -> 1, [1/6, 1/2[ -> 3, [1/2, 5/6[ -> 2, [5/6, 1] -> 0
+    // which gives bit 0 = t < 1/2 and bit 1 = t in [1/6, 5/6[
+    u32 low_bits = 0;
+    u32 high_bits = 0;
+
+#ifdef Y_MATH_SSE
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i base = _mm_setr_epi16(i16(e1[0]), i16(e1[1]), i16(e1[2]), 0, i16(e1[0]), i16(e1[1]), i16(e1[2]), 0);
+    const __m128i direction = _mm_setr_epi16(i16(dir[0]), i16(dir[1]), i16(dir[2]), 0, i16(dir[0]), i16(dir[1]), i16(dir[2]), 0);
+    const __m128i threshold_1 = _mm_set1_epi32(dir_len2 - 1);
+    const __m128i threshold_3 = _mm_set1_epi32(3 * dir_len2 - 1);
+    const __m128i threshold_5 = _mm_set1_epi32(5 * dir_len2 - 1);
+
+    for(usize row = 0; row != 4; ++row) {
+        const __m128i rgba = _mm_loadu_si128(reinterpret_cast<const __m128i*>(texels + row * 16));
+        const __m128i lo = _mm_madd_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(rgba, zero), base), direction);
+        const __m128i hi = _mm_madd_epi16(_mm_sub_epi16(_mm_unpackhi_epi8(rgba, zero), base), direction);
+
+        // Sum the (rg, ba) pairs of each texel
+        const __m128 lo_f = _mm_castsi128_ps(lo);
+        const __m128 hi_f = _mm_castsi128_ps(hi);
+        const __m128i even = _mm_castps_si128(_mm_shuffle_ps(lo_f, hi_f, _MM_SHUFFLE(2, 0, 2, 0)));
+        const __m128i odd = _mm_castps_si128(_mm_shuffle_ps(lo_f, hi_f, _MM_SHUFFLE(3, 1, 3, 1)));
+        const __m128i dot = _mm_add_epi32(even, odd);
+        const __m128i dot_6 = _mm_add_epi32(_mm_slli_epi32(dot, 2), _mm_slli_epi32(dot, 1));
+
+        const u32 ge_1 = u32(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(dot_6, threshold_1))));
+        const u32 ge_3 = u32(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(dot_6, threshold_3))));
+        const u32 ge_5 = u32(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(dot_6, threshold_5))));
+
+        low_bits |= (~ge_3 & 0x0F) << (row * 4);
+        high_bits |= (ge_1 & ~ge_5 & 0x0F) << (row * 4);
+    }
+#else
+    for(usize i = 0; i != block_texels; ++i) {
+        i32 dot = 0;
+        for(usize c = 0; c != 3; ++c) {
+            dot += (i32(texels[i * 4 + c]) - e1[c]) * dir[c];
+        }
+        const i32 dot_6 = dot * 6;
+        low_bits |= u32(dot_6 < 3 * dir_len2) << i;
+        high_bits |= u32(dot_6 >= dir_len2 && dot_6 < 5 * dir_len2) << i;
+    }
+#endif
+
+    return spread_bits(low_bits) | (spread_bits(high_bits) << 1);
+}
+
+static Block64 encode_bc1_block_fast(const u8* texels) {
+    u8 min[4] = {};
+    u8 max[4] = {};
+
+#ifdef Y_MATH_SSE
+    {
+        const __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(texels));
+        const __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(texels + 16));
+        const __m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(texels + 32));
+        const __m128i r3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(texels + 48));
+
+        __m128i min_v = _mm_min_epu8(_mm_min_epu8(r0, r1), _mm_min_epu8(r2, r3));
+        __m128i max_v = _mm_max_epu8(_mm_max_epu8(r0, r1), _mm_max_epu8(r2, r3));
+        min_v = _mm_min_epu8(min_v, _mm_srli_si128(min_v, 8));
+        max_v = _mm_max_epu8(max_v, _mm_srli_si128(max_v, 8));
+        min_v = _mm_min_epu8(min_v, _mm_srli_si128(min_v, 4));
+        max_v = _mm_max_epu8(max_v, _mm_srli_si128(max_v, 4));
+
+        const u32 min_rgba = u32(_mm_cvtsi128_si32(min_v));
+        const u32 max_rgba = u32(_mm_cvtsi128_si32(max_v));
+        std::memcpy(min, &min_rgba, sizeof(min));
+        std::memcpy(max, &max_rgba, sizeof(max));
+    }
+#else
+    for(usize c = 0; c != 4; ++c) {
+        min[c] = max[c] = texels[c];
+    }
+    for(usize i = 1; i != block_texels; ++i) {
+        for(usize c = 0; c != 4; ++c) {
+            min[c] = std::min(min[c], texels[i * 4 + c]);
+            max[c] = std::max(max[c], texels[i * 4 + c]);
+        }
+    }
+#endif
+
+    // Inset the bounding box to reduce the error on the extremes
+    for(usize c = 0; c != 3; ++c) {
+        const u8 inset = u8((max[c] - min[c]) >> 4);
+        min[c] += inset;
+        max[c] -= inset;
+    }
+
+    // Use the bounding box diagonal that follows the channels correlation with the widest channel
+    {
+        usize major = 0;
+        for(usize c = 1; c != 3; ++c) {
+            if(max[c] - min[c] > max[major] - min[major]) {
+                major = c;
+            }
+        }
+
+        i32 center[3] = {};
+        for(usize c = 0; c != 3; ++c) {
+            center[c] = (i32(min[c]) + i32(max[c])) / 2;
+        }
+
+        i32 covariance[3] = {};
+        for(usize i = 0; i != block_texels; ++i) {
+            const i32 d = i32(texels[i * 4 + major]) - center[major];
+            for(usize c = 0; c != 3; ++c) {
+                covariance[c] += d * (i32(texels[i * 4 + c]) - center[c]);
+            }
+        }
+
+        for(usize c = 0; c != 3; ++c) {
+            if(covariance[c] < 0) {
+                std::swap(min[c], max[c]);
+            }
+        }
+    }
+
+    u16 c0 = pack_565(max[0], max[1], max[2]);
+    u16 c1 = pack_565(min[0], min[1], min[2]);
+    if(c0 == c1) {
+        return bc1_block(c0, c1, 0);
+    }
+
+    if(c0 < c1) {
+        std::swap(c0, c1);
+    }
+    return bc1_block(c0, c1, bc1_project_indices(texels, c0, c1));
+}
+
+static Block64 encode_bc1_block_refined(const u8* texels, bool high_quality) {
+    const Texels values(texels);
+
+    float endpoints[2][4] = {};
+    principal_endpoints<3>(values, 0xFFFF, endpoints);
+    BC1Fit best = bc1_fit_endpoints(values, endpoints);
+
+    const usize refine_iterations = high_quality ? 4 : 1;
+    for(usize i = 0; i != refine_iterations && best.error; ++i) {
+        if(best.c0 == best.c1 || !bc1_least_squares(values, best.indices, endpoints)) {
+            break;
+        }
+        const BC1Fit fit = bc1_fit_endpoints(values, endpoints);
+        if(fit.error >= best.error) {
+            break;
+        }
+        best = fit;
+    }
+
+    if(high_quality) {
+        // Greedy search of the neighbouring 565 endpoints
+        static constexpr u16 channel_masks[] = {0xF800, 0x07E0, 0x001F};
+        static constexpr u16 channel_ones[] = {0x0800, 0x0020, 0x0001};
+
+        for(bool improved = true; improved && best.error;) {
+            improved = false;
+            for(usize e = 0; e != 2; ++e) {
+                for(usize c = 0; c != 3; ++c) {
+                    for(const bool increment : {false, true}) {
+                        u16 endpoint_pair[] = {best.c0, best.c1};
+                        const u16 channel = endpoint_pair[e] & channel_masks[c];
+                        if(increment ? channel == channel_masks[c] : channel == 0) {
+                            continue;
+                        }
+                        endpoint_pair[e] = increment ? endpoint_pair[e] + channel_ones[c] : endpoint_pair[e] - channel_ones[c];
+                        const BC1Fit fit = bc1_fit_indices(values, endpoint_pair[0], endpoint_pair[1]);
+                        if(fit.error < best.error) {
+                            best = fit;
+                            improved = true;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return bc1_block(best.c0, best.c1, best.indices);
+}
+
+Block64 encode_bc1_block(const u8* texels, BlockCompressionQuality quality) {
+    switch(quality) {
+        case BlockCompressionQuality::Fast:
+            return encode_bc1_block_fast(texels);
+
+        case BlockCompressionQuality::Normal:
+            return encode_bc1_block_refined(texels, false);
+
+        case BlockCompressionQuality::High:
+            return encode_bc1_block_refined(texels, true);
+    }
+
+    y_fatal("Unknown compression quality");
+}
+
+void decode_bc1_block(Block64 block, u8* texels) {
+    i32 palette[4][3] = {};
+    bc1_palette(u16(block), u16(block >> 16), palette);
+
+    for(usize i = 0; i != block_texels; ++i) {
+        const usize index = (block >> (32 + i * 2)) & 0x03;
+        for(usize c = 0; c != 3; ++c) {
+            texels[i * 4 + c] = u8(palette[index][c]);
+        }
+        texels[i * 4 + 3] = 0xFF;
+    }
+}
+
+
+
+
+// ----------------------------- BC4 -----------------------------
+
+static void bc4_palette(u8 r0, u8 r1, u8 (&palette)[8]) {
+    palette[0] = r0;
+    palette[1] = r1;
+    if(r0 > r1) {
+        for(u32 i = 1; i != 7; ++i) {
+            palette[i + 1] = u8(((7 - i) * r0 + i * r1 + 3) / 7);
+        }
+    } else {
+        for(u32 i = 1; i != 5; ++i) {
+            palette[i + 1] = u8(((5 - i) * r0 + i * r1 + 2) / 5);
+        }
+        palette[6] = 0x00;
+        palette[7] = 0xFF;
+    }
+}
+
+static inline Block64 bc4_block(u8 r0, u8 r1, const u8* indices) {
+    Block64 block = Block64(r0) | (Block64(r1) << 8);
+    for(usize i = 0; i != block_texels; ++i) {
+        y_debug_assert(indices[i] < 8);
+        block |= Block64(indices[i]) << (16 + i * 3);
+    }
+    return block;
+}
+
+static u32 bc4_fit_indices(const u8* values, u8 r0, u8 r1, u8* indices) {
+    u8 palette[8] = {};
+    bc4_palette(r0, r1, palette);
+
+    u32 total_error = 0;
+    for(usize i = 0; i != block_texels; ++i) {
+        u32 best_error = u32(-1);
+        for(u8 p = 0; p != 8; ++p) {
+            const i32 d = i32(values[i]) - i32(palette[p]);
+            const u32 error = u32(d * d);
+            if(error < best_error) {
+                best_error = error;
+                indices[i] = p;
+            }
+        }
+        total_error += best_error;
+    }
+    return total_error;
+}
+
+static void extract_channel(const u8* texels, usize channel, u8* values) {
+#ifdef Y_MATH_SSE
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    const __m128i shift = _mm_cvtsi32_si128(int(channel * 8));
+    __m128i rows[4];
+    for(usize row = 0; row != 4; ++row) {
+        const __m128i rgba = _mm_loadu_si128(reinterpret_cast<const __m128i*>(texels + row * 16));
+        rows[row] = _mm_and_si128(_mm_srl_epi32(rgba, shift), mask);
+    }
+    const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(rows[0], rows[1]), _mm_packs_epi32(rows[2], rows[3]));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(values), packed);
+#else
+    for(usize i = 0; i != block_texels; ++i) {
+        values[i] = texels[i * 4 + channel];
+    }
+#endif
+}
+
+// Bounding range endpoints in 8 values mode, each value gets the closest of the evenly spaced levels
+static Block64 encode_bc4_block_fast(const u8* values) {
+    u8 indices[block_texels] = {};
+
+#ifdef Y_MATH_SSE
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values));
+    __m128i min_v = _mm_min_epu8(v, _mm_srli_si128(v, 8));
+    __m128i max_v = _mm_max_epu8(v, _mm_srli_si128(v, 8));
+    min_v = _mm_min_epu8(min_v, _mm_srli_si128(min_v, 4));
+    max_v = _mm_max_epu8(max_v, _mm_srli_si128(max_v, 4));
+    min_v = _mm_min_epu8(min_v, _mm_srli_si128(min_v, 2));
+    max_v = _mm_max_epu8(max_v, _mm_srli_si128(max_v, 2));
+    min_v = _mm_min_epu8(min_v, _mm_srli_si128(min_v, 1));
+    max_v = _mm_max_epu8(max_v, _mm_srli_si128(max_v, 1));
+
+    const u8 min = u8(_mm_cvtsi128_si32(min_v));
+    const u8 max = u8(_mm_cvtsi128_si32(max_v));
+    if(min == max) {
+        return bc4_block(max, min, indices);
+    }
+
+    // Level t of each value is the number of thresholds (2k - 1) * (max - min) that 14 * (value - min) reaches
+    const i32 diff = max - min;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i min_16 = _mm_set1_epi16(i16(min));
+    const __m128i fourteen = _mm_set1_epi16(14);
+    const __m128i lo = _mm_mullo_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(v, zero), min_16), fourteen);
+    const __m128i hi = _mm_mullo_epi16(_mm_sub_epi16(_mm_unpackhi_epi8(v, zero), min_16), fourteen);
+
+    __m128i level_lo = zero;
+    __m128i level_hi = zero;
+    for(i32 k = 1; k != 8; ++k) {
+        const __m128i threshold = _mm_set1_epi16(i16((2 * k - 1) * diff - 1));
+        level_lo = _mm_sub_epi16(level_lo, _mm_cmpgt_epi16(lo, threshold));
+        level_hi = _mm_sub_epi16(level_hi, _mm_cmpgt_epi16(hi, threshold));
+    }
+
+    // Levels 0 and 7 are the endpoints (indices 1 and 0), level t is index 8 - t otherwise
+    const __m128i eight = _mm_set1_epi16(8);
+    const __m128i seven = _mm_set1_epi16(7);
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i two = _mm_set1_epi16(2);
+    __m128i index_lo = _mm_and_si128(_mm_sub_epi16(eight, level_lo), seven);
+    __m128i index_hi = _mm_and_si128(_mm_sub_epi16(eight, level_hi), seven);
+    index_lo = _mm_xor_si128(index_lo, _mm_and_si128(_mm_cmpgt_epi16(two, index_lo), one));
+    index_hi = _mm_xor_si128(index_hi, _mm_and_si128(_mm_cmpgt_epi16(two, index_hi), one));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(indices), _mm_packus_epi16(index_lo, index_hi));
+#else
+    u8 min = values[0];
+    u8 max = values[0];
+    for(usize i = 1; i != block_texels; ++i) {
+        min = std::min(min, values[i]);
+        max = std::max(max, values[i]);
+    }
+    if(min == max) {
+        return bc4_block(max, min, indices);
+    }
+
+    const i32 diff = max - min;
+    for(usize i = 0; i != block_texels; ++i) {
+        const i32 scaled = (values[i] - min) * 14;
+        i32 level = 0;
+        for(i32 k = 1; k != 8; ++k) {
+            level += scaled >= (2 * k - 1) * diff;
+        }
+        const u8 index = u8((8 - level) & 0x07);
+        indices[i] = index < 2 ? index ^ 1 : index;
+    }
+#endif
+
+    return bc4_block(max, min, indices);
+}
+
+static Block64 encode_bc4_block_refined(const u8* values, bool high_quality) {
+    u8 min = values[0];
+    u8 max = values[0];
+    u8 inner_min = 0xFF;
+    u8 inner_max = 0x00;
+    for(usize i = 0; i != block_texels; ++i) {
+        min = std::min(min, values[i]);
+        max = std::max(max, values[i]);
+        if(values[i] != 0x00 && values[i] != 0xFF) {
+            inner_min = std::min(inner_min, values[i]);
+            inner_max = std::max(inner_max, values[i]);
+        }
+    }
+
+    u8 best_indices[block_texels] = {};
+    if(min == max) {
+        return bc4_block(max, min, best_indices);
+    }
+
+    u8 best_r0 = max;
+    u8 best_r1 = min;
+    u32 best_error = bc4_fit_indices(values, max, min, best_indices);
+
+    const auto try_endpoints = [&](u8 r0, u8 r1) {
+        u8 indices[block_texels] = {};
+        const u32 error = bc4_fit_indices(values, r0, r1, indices);
+        if(error < best_error) {
+            best_error = error;
+            best_r0 = r0;
+            best_r1 = r1;
+            std::copy_n(indices, block_texels, best_indices);
+        }
+    };
+
+    // The 6 values mode has exact 0 and 255 on top of its range
+    if((min == 0x00 || max == 0xFF) && inner_min <= inner_max) {
+        try_endpoints(inner_min, inner_max);
+    }
+
+    {
+        const i32 radius = std::min(high_quality ? 4 : 1, (max - min) / 4);
+        for(i32 d0 = 0; d0 <= radius; ++d0) {
+            for(i32 d1 = 0; d1 <= radius; ++d1) {
+                if(d0 || d1) {
+                    try_endpoints(u8(max - d0), u8(min + d1));
+                }
+            }
+        }
+    }
+
+    return bc4_block(best_r0, best_r1, best_indices);
+}
+
+Block64 encode_bc4_block(const u8* texels, usize channel, BlockCompressionQuality quality) {
+    y_debug_assert(channel < 4);
+
+    u8 values[block_texels] = {};
+    extract_channel(texels, channel, values);
+
+    switch(quality) {
+        case BlockCompressionQuality::Fast:
+            return encode_bc4_block_fast(values);
+
+        case BlockCompressionQuality::Normal:
+            return encode_bc4_block_refined(values, false);
+
+        case BlockCompressionQuality::High:
+            return encode_bc4_block_refined(values, true);
+    }
+
+    y_fatal("Unknown compression quality");
+}
+
+void decode_bc4_block(Block64 block, u8* texels, usize channel) {
+    u8 palette[8] = {};
+    bc4_palette(u8(block), u8(block >> 8), palette);
+
+    for(usize i = 0; i != block_texels; ++i) {
+        texels[i * 4 + channel] = palette[(block >> (16 + i * 3)) & 0x07];
+    }
+}
+
+
+
+
+// ----------------------------- BC5 -----------------------------
+
+Block128 encode_bc5_block(const u8* texels, BlockCompressionQuality quality) {
+    return {encode_bc4_block(texels, 0, quality), encode_bc4_block(texels, 1, quality)};
+}
+
+void decode_bc5_block(const Block128& block, u8* texels) {
+    decode_bc4_block(block[0], texels, 0);
+    decode_bc4_block(block[1], texels, 1);
+}
+
+
+
+
+// ----------------------------- BC7 -----------------------------
+
+// Endpoints are stored as they will be decoded, which means that the stored bits can be recovered from them
+struct BC7SubsetFit {
+    i32 endpoints[2][4] = {};
+    u8 indices[block_texels] = {};
+    u32 error = u32(-1);
+};
+
+// Picks the closest palette entry for each texel, or the closest weight to the texel's projection on the endpoints segment if not exhaustive
+template<usize N>
+static BC7SubsetFit bc7_fit_indices(const Texels& texels, u16 mask, const i32 (&endpoints)[2][4], core::Span<u8> weights, bool exhaustive) {
+    BC7SubsetFit fit;
+    std::copy_n(&endpoints[0][0], 8, &fit.endpoints[0][0]);
+    fit.error = 0;
+
+    i32 palette[16][N] = {};
+    for(usize w = 0; w != weights.size(); ++w) {
+        for(usize c = 0; c != N; ++c) {
+            palette[w][c] = interpolate_bc7(endpoints[0][c], endpoints[1][c], weights[w]);
+        }
+    }
+
+    if(!exhaustive) {
+        i32 dir[N] = {};
+        i32 dir_len2 = 0;
+        for(usize c = 0; c != N; ++c) {
+            dir[c] = endpoints[1][c] - endpoints[0][c];
+            dir_len2 += dir[c] * dir[c];
+        }
+
+        const i32 max_index = i32(weights.size() - 1);
+        const float scale = dir_len2 ? 64.0f / float(dir_len2) : 0.0f;
+        for(usize i = 0; i != block_texels; ++i) {
+            if(mask & (1 << i)) {
+                i32 dot = 0;
+                for(usize c = 0; c != N; ++c) {
+                    dot += (texels.values[i][c] - endpoints[0][c]) * dir[c];
+                }
+
+                const i32 t = std::clamp(round_to_int(float(dot) * scale), 0, 64);
+                i32 index = (t * max_index + 32) / 64;
+                if(index < max_index && std::abs(weights[index + 1] - t) < std::abs(weights[index] - t)) {
+                    ++index;
+                } else if(index > 0 && std::abs(weights[index - 1] - t) < std::abs(weights[index] - t)) {
+                    --index;
+                }
+
+                u32 error = 0;
+                for(usize c = 0; c != N; ++c) {
+                    const i32 d = texels.values[i][c] - palette[index][c];
+                    error += u32(d * d);
+                }
+                fit.indices[i] = u8(index);
+                fit.error += error;
+            }
+        }
+        return fit;
+    }
+
+    for(usize i = 0; i != block_texels; ++i) {
+        if(mask & (1 << i)) {
+            u32 best_error = u32(-1);
+            for(usize w = 0; w != weights.size(); ++w) {
+                u32 error = 0;
+                for(usize c = 0; c != N; ++c) {
+                    const i32 d = texels.values[i][c] - palette[w][c];
+                    error += u32(d * d);
+                }
+                if(error < best_error) {
+                    best_error = error;
+                    fit.indices[i] = u8(w);
+                }
+            }
+            fit.error += best_error;
+        }
+    }
+
+    return fit;
+}
+
+// Fits a subset along its principal axis, then refines the endpoints from the selected indices.
+// quantize(float endpoints, emit) calls emit with every quantized endpoint pair worth trying.
+template<usize N, typename Q>
+static BC7SubsetFit bc7_fit_subset(const Texels& texels, u16 mask, core::Span<u8> weights, usize refine_iterations, bool exhaustive, Q&& quantize) {
+    float endpoints[2][4] = {};
+    principal_endpoints<N>(texels, mask, endpoints);
+
+    BC7SubsetFit best;
+    const auto try_endpoints = [&](const i32 (&quantized)[2][4]) {
+        const BC7SubsetFit fit = bc7_fit_indices<N>(texels, mask, quantized, weights, exhaustive);
+        if(fit.error < best.error) {
+            best = fit;
+        }
+    };
+
+    quantize(endpoints, try_endpoints);
+
+    for(usize i = 0; i != refine_iterations && best.error; ++i) {
+        float index_weights[block_texels] = {};
+        for(usize t = 0; t != block_texels; ++t) {
+            index_weights[t] = float(weights[best.indices[t]]) / 64.0f;
+        }
+
+        if(!least_squares_endpoints<N>(texels, mask, index_weights, endpoints)) {
+            break;
+        }
+
+        const u32 previous_error = best.error;
+        quantize(endpoints, try_endpoints);
+        if(best.error >= previous_error) {
+            break;
+        }
+    }
+
+    return best;
+}
+
+
+// Mode 6: 1 subset, RGBA 7.7.7.7 endpoints with a unique P-bit each, 4 bits indices
+static BC7SubsetFit bc7_fit_mode_6(const Texels& texels, bool all_pbits, usize refine_iterations, bool exhaustive) {
+    const auto quantize_endpoint = [](const float (&endpoint)[4], i32 pbit, i32 (&quantized)[4]) {
+        i32 error = 0;
+        for(usize c = 0; c != 4; ++c) {
+            const i32 q = std::clamp(round_to_int((endpoint[c] - float(pbit)) * 0.5f), 0, 127);
+            quantized[c] = (q << 1) | pbit;
+            const i32 d = round_to_int(endpoint[c]) - quantized[c];
+            error += d * d;
+        }
+        return error;
+    };
+
+    const auto quantize = [&](const float (&endpoints)[2][4], auto&& emit) {
+        i32 candidates[2][2][4] = {};
+        i32 errors[2][2] = {};
+        for(usize e = 0; e != 2; ++e) {
+            for(i32 p = 0; p != 2; ++p) {
+                errors[e][p] = quantize_endpoint(endpoints[e], p, candidates[e][p]);
+            }
+        }
+
+        if(all_pbits) {
+            for(usize p0 = 0; p0 != 2; ++p0) {
+                for(usize p1 = 0; p1 != 2; ++p1) {
+                    i32 quantized[2][4] = {};
+                    std::copy_n(candidates[0][p0], 4, quantized[0]);
+                    std::copy_n(candidates[1][p1], 4, quantized[1]);
+                    emit(quantized);
+                }
+            }
+        } else {
+            i32 quantized[2][4] = {};
+            std::copy_n(candidates[0][errors[0][1] < errors[0][0]], 4, quantized[0]);
+            std::copy_n(candidates[1][errors[1][1] < errors[1][0]], 4, quantized[1]);
+            emit(quantized);
+        }
+    };
+
+    return bc7_fit_subset<4>(texels, 0xFFFF, bc7_weights_4, refine_iterations, exhaustive, quantize);
+}
+
+static Block128 bc7_encode_mode_6(BC7SubsetFit fit) {
+    // The anchor index's most significant bit is implicitly 0
+    if(fit.indices[0] & 0x08) {
+        std::swap(fit.endpoints[0], fit.endpoints[1]);
+        for(u8& index : fit.indices) {
+            index = 15 - index;
+        }
+    }
+
+    BitWriter writer;
+    writer.write(1 << 6, 7);
+    for(usize c = 0; c != 4; ++c) {
+        writer.write(u64(fit.endpoints[0][c] >> 1), 7);
+        writer.write(u64(fit.endpoints[1][c] >> 1), 7);
+    }
+    writer.write(u64(fit.endpoints[0][0] & 1), 1);
+    writer.write(u64(fit.endpoints[1][0] & 1), 1);
+    for(usize i = 0; i != block_texels; ++i) {
+        writer.write(fit.indices[i], i ? 4 : 3);
+    }
+    return writer.data();
+}
+
+
+// Mode 1: 2 subsets, RGB 6.6.6 endpoints with a P-bit shared by both endpoints of a subset, 3 bits indices
+static inline i32 expand_mode_1(i32 q, i32 pbit) {
+    const i32 v = (q << 1) | pbit;
+    return (v << 1) | (v >> 6);
+}
+
+static BC7SubsetFit bc7_fit_mode_1_subset(const Texels& texels, u16 mask, usize refine_iterations) {
+    const auto quantize = [](const float (&endpoints)[2][4], auto&& emit) {
+        for(i32 p = 0; p != 2; ++p) {
+            i32 quantized[2][4] = {};
+            for(usize e = 0; e != 2; ++e) {
+                for(usize c = 0; c != 3; ++c) {
+                    const float target = endpoints[e][c];
+                    const i32 q = std::clamp(round_to_int((target * (127.0f / 255.0f) - float(p)) * 0.5f), 0, 63);
+
+                    // Expansion isn't linear, check the neighbours
+                    i32 best = expand_mode_1(q, p);
+                    for(const i32 n : {q - 1, q + 1}) {
+                        if(n >= 0 && n <= 63) {
+                            const i32 expanded = expand_mode_1(n, p);
+                            if(std::abs(float(expanded) - target) < std::abs(float(best) - target)) {
+                                best = expanded;
+                            }
+                        }
+                    }
+                    quantized[e][c] = best;
+                }
+                quantized[e][3] = 0xFF;
+            }
+            emit(quantized);
+        }
+    };
+
+    return bc7_fit_subset<3>(texels, mask, bc7_weights_3, refine_iterations, true, quantize);
+}
+
+// Estimates the error of each 2 subsets partition from the variance left off each subset's principal axis
+static float bc7_estimate_partition_error(const Texels& texels, u16 partition) {
+    float error = 0.0f;
+    for(const u16 mask : {u16(~partition), partition}) {
+        float mean[3] = {};
+        float axis[3] = {};
+        if(!principal_axis(texels, mask, mean, axis, 3)) {
+            continue;
+        }
+
+        for(usize i = 0; i != block_texels; ++i) {
+            if(mask & (1 << i)) {
+                float d[3] = {};
+                float t = 0.0f;
+                for(usize c = 0; c != 3; ++c) {
+                    d[c] = float(texels.values[i][c]) - mean[c];
+                    t += d[c] * axis[c];
+                }
+                for(usize c = 0; c != 3; ++c) {
+                    const float r = d[c] - t * axis[c];
+                    error += r * r;
+                }
+            }
+        }
+    }
+    return error;
+}
+
+struct BC7Mode1Fit {
+    usize partition = 0;
+    BC7SubsetFit subsets[2];
+    u32 error = u32(-1);
+};
+
+static BC7Mode1Fit bc7_fit_mode_1(const Texels& texels, usize candidate_count, usize refine_iterations) {
+    y_debug_assert(candidate_count <= 64);
+
+    std::array<std::pair<float, u8>, 64> estimates;
+    for(usize p = 0; p != 64; ++p) {
+        estimates[p] = {bc7_estimate_partition_error(texels, bc7_partitions_2[p]), u8(p)};
+    }
+    std::partial_sort(estimates.begin(), estimates.begin() + candidate_count, estimates.end());
+
+    BC7Mode1Fit best;
+    for(usize k = 0; k != candidate_count; ++k) {
+        const usize partition = estimates[k].second;
+        const u16 mask = bc7_partitions_2[partition];
+
+        BC7Mode1Fit fit;
+        fit.partition = partition;
+        fit.subsets[0] = bc7_fit_mode_1_subset(texels, u16(~mask), refine_iterations);
+        fit.subsets[1] = bc7_fit_mode_1_subset(texels, mask, refine_iterations);
+        fit.error = fit.subsets[0].error + fit.subsets[1].error;
+
+        if(fit.error < best.error) {
+            best = fit;
+        }
+    }
+
+    return best;
+}
+
+static Block128 bc7_encode_mode_1(const BC7Mode1Fit& fit) {
+    const u16 mask = bc7_partitions_2[fit.partition];
+    const usize anchors[] = {0, bc7_anchors_2[fit.partition]};
+
+    i32 endpoints[2][2][4] = {};
+    u8 indices[block_texels] = {};
+    for(usize s = 0; s != 2; ++s) {
+        const BC7SubsetFit& subset = fit.subsets[s];
+        const bool flip = subset.indices[anchors[s]] & 0x04;
+        std::copy_n(&subset.endpoints[flip ? 1 : 0][0], 4, endpoints[s][0]);
+        std::copy_n(&subset.endpoints[flip ? 0 : 1][0], 4, endpoints[s][1]);
+
+        for(usize i = 0; i != block_texels; ++i) {
+            if(bool(mask & (1 << i)) == bool(s)) {
+                indices[i] = flip ? 7 - subset.indices[i] : subset.indices[i];
+            }
+        }
+    }
+
+    BitWriter writer;
+    writer.write(1 << 1, 2);
+    writer.write(fit.partition, 6);
+    for(usize c = 0; c != 3; ++c) {
+        for(usize s = 0; s != 2; ++s) {
+            writer.write(u64(endpoints[s][0][c] >> 2), 6);
+            writer.write(u64(endpoints[s][1][c] >> 2), 6);
+        }
+    }
+    for(usize s = 0; s != 2; ++s) {
+        writer.write(u64((endpoints[s][0][0] >> 1) & 1), 1);
+    }
+    for(usize i = 0; i != block_texels; ++i) {
+        writer.write(indices[i], (i == anchors[0] || i == anchors[1]) ? 2 : 3);
+    }
+    return writer.data();
+}
+
+
+Block128 encode_bc7_block(const u8* texels, BlockCompressionQuality quality) {
+    const Texels values(texels);
+
+    bool opaque = true;
+    for(usize i = 0; i != block_texels; ++i) {
+        opaque &= values.values[i][3] == 0xFF;
+    }
+
+    switch(quality) {
+        case BlockCompressionQuality::Fast:
+            return bc7_encode_mode_6(bc7_fit_mode_6(values, false, 0, false));
+
+        case BlockCompressionQuality::Normal: {
+            const BC7SubsetFit mode_6 = bc7_fit_mode_6(values, false, 1, true);
+
+            // Only look for partitions if a single subset is noticeably off (more than 4 per channel on average)
+            if(opaque && mode_6.error > block_texels * 3 * 16) {
+                const BC7Mode1Fit mode_1 = bc7_fit_mode_1(values, 2, 1);
+                if(mode_1.error < mode_6.error) {
+                    return bc7_encode_mode_1(mode_1);
+                }
+            }
+            return bc7_encode_mode_6(mode_6);
+        }
+
+        case BlockCompressionQuality::High: {
+            const BC7SubsetFit mode_6 = bc7_fit_mode_6(values, true, 2, true);
+            if(opaque && mode_6.error) {
+                const BC7Mode1Fit mode_1 = bc7_fit_mode_1(values, 4, 2);
+                if(mode_1.error < mode_6.error) {
+                    return bc7_encode_mode_1(mode_1);
+                }
+            }
+            return bc7_encode_mode_6(mode_6);
+        }
+    }
+
+    y_fatal("Unknown compression quality");
+}
+
+void decode_bc7_block(const Block128& block, u8* texels) {
+    BitReader reader(block);
+
+    if(block[0] & 0x40 && !(block[0] & 0x3F)) {
+        reader.read(7);
+
+        i32 endpoints[2][4] = {};
+        for(usize c = 0; c != 4; ++c) {
+            endpoints[0][c] = i32(reader.read(7)) << 1;
+            endpoints[1][c] = i32(reader.read(7)) << 1;
+        }
+        for(usize e = 0; e != 2; ++e) {
+            const i32 pbit = i32(reader.read(1));
+            for(usize c = 0; c != 4; ++c) {
+                endpoints[e][c] |= pbit;
+            }
+        }
+
+        for(usize i = 0; i != block_texels; ++i) {
+            const u8 weight = bc7_weights_4[reader.read(i ? 4 : 3)];
+            for(usize c = 0; c != 4; ++c) {
+                texels[i * 4 + c] = u8(interpolate_bc7(endpoints[0][c], endpoints[1][c], weight));
+            }
+        }
+        return;
+    }
+
+    if((block[0] & 0x03) == 0x02) {
+        reader.read(2);
+        const usize partition = reader.read(6);
+        const u16 mask = bc7_partitions_2[partition];
+        const usize anchor = bc7_anchors_2[partition];
+
+        i32 quantized[2][2][3] = {};
+        for(usize c = 0; c != 3; ++c) {
+            for(usize s = 0; s != 2; ++s) {
+                quantized[s][0][c] = i32(reader.read(6));
+                quantized[s][1][c] = i32(reader.read(6));
+            }
+        }
+
+        i32 endpoints[2][2][3] = {};
+        for(usize s = 0; s != 2; ++s) {
+            const i32 pbit = i32(reader.read(1));
+            for(usize e = 0; e != 2; ++e) {
+                for(usize c = 0; c != 3; ++c) {
+                    endpoints[s][e][c] = expand_mode_1(quantized[s][e][c], pbit);
+                }
+            }
+        }
+
+        for(usize i = 0; i != block_texels; ++i) {
+            const usize subset = (mask >> i) & 1;
+            const u8 weight = bc7_weights_3[reader.read((i == 0 || i == anchor) ? 2 : 3)];
+            for(usize c = 0; c != 3; ++c) {
+                texels[i * 4 + c] = u8(interpolate_bc7(endpoints[subset][0][c], endpoints[subset][1][c], weight));
+            }
+            texels[i * 4 + 3] = 0xFF;
+        }
+        return;
+    }
+
+    y_debug_assert(false && "Unsupported BC7 mode");
+    std::fill_n(texels, block_texels * 4, u8(0));
+}
+
+}
@@ -0,0 +1,57 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#ifndef YAVE_GRAPHICS_IMAGES_BLOCK_COMPRESSION_H
+#define YAVE_GRAPHICS_IMAGES_BLOCK_COMPRESSION_H
+
+#include <yave/yave.h>
+
+#include <array>
+
+namespace yave {
+
+enum class BlockCompressionQuality {
+    Fast,       // Bounding box endpoints, single mode
+    Normal,     // Principal axis endpoints with least squares refinement
+    High,       // Searches more endpoints and partitions, up to an order of magnitude slower
+};
+
+using Block64 = u64;
+using Block128 = std::array<u64, 2>;
+
+// Encoders take a 4x4 block of RGBA8 texels (64 bytes, row major).
+// BC1 ignores alpha, BC4 encodes a single channel and BC5 encodes red and green.
+Block64 encode_bc1_block(const u8* texels, BlockCompressionQuality quality = BlockCompressionQuality::Normal);
+Block64 encode_bc4_block(const u8* texels, usize channel = 0, BlockCompressionQuality quality = BlockCompressionQuality::Normal);
+Block128 encode_bc5_block(const u8* texels, BlockCompressionQuality quality = BlockCompressionQuality::Normal);
+Block128 encode_bc7_block(const u8* texels, BlockCompressionQuality quality = BlockCompressionQuality::Normal);
+
+// Decoders write a 4x4 block of RGBA8 texels, only touching the channels the format stores.
+void decode_bc1_block(Block64 block, u8* texels);
+void decode_bc4_block(Block64 block, u8* texels, usize channel = 0);
+void decode_bc5_block(const Block128& block, u8* texels);
+
+// Only modes 1 and 6 are supported: they are the only ones produced by encode_bc7_block.
+void decode_bc7_block(const Block128& block, u8* texels);
+
+}
+
+#endif // YAVE_GRAPHICS_IMAGES_BLOCK_COMPRESSION_H
@@ -36,9 +36,8 @@ DeviceMemoryHeap::DeviceMemoryHeap(u32 type_bits, MemoryType type, u64 heap_size
         DeviceMemoryHeapBase(type),
         _memory(alloc_memory(heap_size, type_bits, type)),
         _heap_size(heap_size),
-        _mapping(nullptr) {
-
-    _free_blocks << FreeBlock { 0, heap_size };
+        _mapping(nullptr),
+        _allocator(heap_size, alignment) {
 
     if(is_cpu_visible(type)) {
         const VkMemoryMapFlags flags = {};
@@ -51,10 +50,8 @@ DeviceMemoryHeap::DeviceMemoryHeap(u32 type_bits, MemoryType type, u64 heap_size
 DeviceMemoryHeap::~DeviceMemoryHeap() {
     const auto lock = std::unique_lock(_lock);
 
-    sort_and_compact_blocks();
-
-    y_always_assert(_free_blocks.size() == 1, "Not all memory has been released: heap fragmented");
-    y_always_assert(_free_blocks[0].offset == 0 && _free_blocks[0].size == _heap_size, "Not all memory has been freed");
+    y_always_assert(_allocator.allocation_count() == 0, "Not all memory has been released");
+    y_always_assert(_allocator.free_size() == _heap_size, "Not all memory has been freed");
 
     if(_mapping) {
         vkUnmapMemory(vk_device(), _memory);
@@ -72,50 +69,20 @@ core::Result<DeviceMemory> DeviceMemoryHeap::alloc(VkMemoryRequirements reqs) {
 
     y_debug_assert(reqs.alignment % DeviceMemoryHeap::alignment == 0 || DeviceMemoryHeap::alignment % reqs.alignment == 0);
 
+    const u64 alloc_size = align_size(reqs.size, alignment);
+
     const auto lock = std::unique_lock(_lock);
 
-    sort_and_compact_blocks();
-
-    for(usize i = 0; i != _free_blocks.size(); ++i) {
-        auto& block = _free_blocks[i];
-        const u64 block_end = block.offset + block.size;
-
-        const u64 alloc_start = align_size(block.offset, reqs.alignment);
-        const u64 alloc_size = align_size(reqs.size, alignment);
-        const u64 alloc_end = alloc_start + alloc_size;
-
-        if(alloc_end > block_end) {
-            continue;
-        }
-
-        y_debug_assert(alloc_start % alignment == 0);
-        y_debug_assert(alloc_size % alignment == 0);
-
-        {
-            if(block.offset != alloc_start) {
-                block.size = alloc_start - block.offset;
-                if(block_end != alloc_end) {
-                    _free_blocks << FreeBlock { alloc_end, block_end - alloc_end };
-                    _should_compact = true;
-                }
-            } else {
-                if(block_end != alloc_end) {
-                    block.offset = alloc_end;
-                    block.size = block_end - alloc_end;
-                } else {
-                    _free_blocks.erase_unordered(_free_blocks.begin() + i);
-                    _should_compact = true;
-                }
-            }
-
-            y_debug_assert(alloc_start % reqs.alignment == 0);
-            y_debug_assert(alloc_size >= reqs.size);
-
-            return core::Ok(create(alloc_start, alloc_size));
-        }
+    const auto alloc_start = _allocator.alloc(alloc_size, reqs.alignment);
+    if(!alloc_start) {
+        return core::Err();
     }
 
-    return core::Err();
+    y_debug_assert(alloc_start.unwrap() % alignment == 0);
+    y_debug_assert(alloc_start.unwrap() % reqs.alignment == 0);
+    y_debug_assert(_allocator.allocated_size(alloc_start.unwrap()) == alloc_size);
+
+    return core::Ok(create(alloc_start.unwrap(), alloc_size));
 }
 
 void DeviceMemoryHeap::free(const DeviceMemory& memory) {
@@ -123,44 +90,8 @@ void DeviceMemoryHeap::free(const DeviceMemory& memory) {
 
     const auto lock = std::unique_lock(_lock);
 
-    _free_blocks << FreeBlock {
-        memory.vk_offset(),
-        memory.vk_size()
-    };
-
-    _should_compact = true;
-}
-
-
-void DeviceMemoryHeap::sort_and_compact_blocks() {
-    y_profile();
-
-    y_debug_assert(!_lock.try_lock());
-
-    const usize block_count = _free_blocks.size();
-    if(!_should_compact || block_count < 2) {
-        return;
-    }
-
-    _should_compact = false;
-
-    std::sort(_free_blocks.begin(), _free_blocks.end(), [](const auto& a, const auto& b) {
-        return a.offset < b.offset;
-    });
-
-    usize dst = 0;
-    for(usize i = 1; i != block_count; ++i) {
-        const u64 dst_end = _free_blocks[dst].offset + _free_blocks[dst].size;
-        if(_free_blocks[i].offset == dst_end) {
-            _free_blocks[dst].size += _free_blocks[i].size;
-        } else {
-            y_debug_assert(_free_blocks[i].offset > dst_end);
-            ++dst;
-            _free_blocks[dst] = _free_blocks[i];
-        }
-    }
-
-    _free_blocks.shrink_to(dst + 1);
+    y_debug_assert(_allocator.allocated_size(memory.vk_offset()) == memory.vk_size());
+    _allocator.free(memory.vk_offset());
 }
 
 void* DeviceMemoryHeap::map(const VkMappedMemoryRange& range, MappingAccess access) {
@@ -178,16 +109,16 @@ u64 DeviceMemoryHeap::size() const {
 
 u64 DeviceMemoryHeap::available() const {
     const auto lock = std::unique_lock(_lock);
-    u64 tot = 0;
-    for(const auto& b : _free_blocks) {
-        tot += b.size;
-    }
-    return tot;
+    return _allocator.free_size();
 }
 
 usize DeviceMemoryHeap::free_blocks() const {
+    return stats().free_blocks;
+}
+
+core::TLSFAllocator::Stats DeviceMemoryHeap::stats() const {
     const auto lock = std::unique_lock(_lock);
-    return _free_blocks.size();
+    return _allocator.stats();
 }
 
 }
@@ -24,7 +24,7 @@ SOFTWARE.
 
 #include "DeviceMemoryHeapBase.h"
 
-#include <y/core/Vector.h>
+#include <y/core/TLSFAllocator.h>
 
 #include <mutex>
 
@@ -32,12 +32,6 @@ namespace yave {
 
 // For DeviceAllocator, should not be used directly
 class DeviceMemoryHeap : public DeviceMemoryHeapBase {
-
-    struct FreeBlock {
-        u64 offset;
-        u64 size;
-    };
-
     public:
         static constexpr u64 alignment = 256;
 
@@ -52,21 +46,21 @@ class DeviceMemoryHeap : public DeviceMemoryHeapBase {
         void unmap(const VkMappedMemoryRange& range, MappingAccess access) override;
 
         u64 size() const;
-        u64 available() const; // slow!
-        usize free_blocks() const;
+        u64 available() const;
+        usize free_blocks() const; // slow!
+
+        core::TLSFAllocator::Stats stats() const; // slow!
 
     private:
         void swap(DeviceMemoryHeap& other);
 
         DeviceMemory create(u64 offset, u64 size);
-        void sort_and_compact_blocks();
 
         VkDeviceMemory _memory = {};
         u64 _heap_size = 0;
         void* _mapping = nullptr;
 
-        core::Vector<FreeBlock> _free_blocks;
-        bool _should_compact = false;
+        core::TLSFAllocator _allocator;
         mutable std::mutex _lock;
 };
 
@@ -66,7 +66,7 @@ ComputeProgram::ComputeProgram(const ComputeShader& comp) : _local_size(comp.loc
         create_info.stage = stage;
     }
 
-    vk_check(vkCreateComputePipelines(vk_device(), {}, 1, &create_info, vk_allocation_callbacks(), _pipeline.get_ptr_for_init()));
+    vk_check(vkCreateComputePipelines(vk_device(), vk_pipeline_cache(), 1, &create_info, vk_allocation_callbacks(), _pipeline.get_ptr_for_init()));
 }
 
 ComputeProgram::~ComputeProgram() {
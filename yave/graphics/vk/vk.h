@@ -276,6 +276,8 @@ VK_STRUCT_TYPE(VkBufferDeviceAddressInfo,                           VK_STRUCTURE
 VK_STRUCT_TYPE(VkBufferOpaqueCaptureAddressCreateInfo,              VK_STRUCTURE_TYPE_BUFFER_OPAQUE_CAPTURE_ADDRESS_CREATE_INFO)
 VK_STRUCT_TYPE(VkMemoryOpaqueCaptureAddressAllocateInfo,            VK_STRUCTURE_TYPE_MEMORY_OPAQUE_CAPTURE_ADDRESS_ALLOCATE_INFO)
 VK_STRUCT_TYPE(VkDeviceMemoryOpaqueCaptureAddressInfo,              VK_STRUCTURE_TYPE_DEVICE_MEMORY_OPAQUE_CAPTURE_ADDRESS_INFO)
+VK_STRUCT_TYPE(VkDeviceBufferMemoryRequirements,                    VK_STRUCTURE_TYPE_DEVICE_BUFFER_MEMORY_REQUIREMENTS)
+VK_STRUCT_TYPE(VkDeviceImageMemoryRequirements,                     VK_STRUCTURE_TYPE_DEVICE_IMAGE_MEMORY_REQUIREMENTS)
 
 #undef VK_STRUCT_TYPE
 
@@ -88,6 +88,39 @@ static VkCompareOp depth_mode(DepthTestMode mode) {
     }
 }
 
+// Compact streams are read through normalized/half formats so shaders see the same input types
+static VkFormat compact_attrib_format(VertexStreamType type) {
+    switch(type) {
+        case VertexStreamType::Position:
+            return VK_FORMAT_R16G16B16A16_UNORM;
+
+        case VertexStreamType::NormalTangent:
+            return VK_FORMAT_R32_UINT;
+
+        default: // Uv
+            return VK_FORMAT_R16G16_SFLOAT;
+    }
+}
+
+static void patch_vertex_format(core::MutableSpan<VkVertexInputAttributeDescription> attribs, core::MutableSpan<VkVertexInputBindingDescription> bindings, MeshVertexFormat format) {
+    if(format == MeshVertexFormat::Full) {
+        return;
+    }
+
+    for(VkVertexInputAttributeDescription& attrib : attribs) {
+        if(attrib.binding < MeshVertexStreams::stream_count) {
+            y_debug_assert(attrib.offset == 0);
+            attrib.format = compact_attrib_format(VertexStreamType(attrib.binding));
+        }
+    }
+
+    for(VkVertexInputBindingDescription& binding : bindings) {
+        if(binding.binding < MeshVertexStreams::stream_count) {
+            binding.stride = u32(vertex_stream_element_size(VertexStreamType(binding.binding), format));
+        }
+    }
+}
+
 static GeometryShader create_geometry_shader(const SpirVData& geom) {
     if(geom.is_empty()) {
         return GeometryShader();
@@ -97,7 +130,7 @@ static GeometryShader create_geometry_shader(const SpirVData& geom) {
 
 
 
-GraphicPipeline MaterialCompiler::compile(const MaterialTemplate* material, const RenderPass& render_pass) {
+GraphicPipeline MaterialCompiler::compile(const MaterialTemplate* material, const RenderPass& render_pass, MeshVertexFormat vertex_format) {
     y_profile();
 
     core::DebugTimer _("MaterialCompiler::compile", core::Duration::milliseconds(2));
@@ -115,8 +148,9 @@ GraphicPipeline MaterialCompiler::compile(const MaterialTemplate* material, cons
         keep_depth_only_stages(pipeline_shader_stages);
     }
 
-    const auto attribute_bindings = program.vk_attribute_bindings();
-    const auto attribute_descriptions = program.vk_attributes_descriptions();
+    core::ScratchVector<VkVertexInputBindingDescription> attribute_bindings(program.vk_attribute_bindings());
+    core::ScratchVector<VkVertexInputAttributeDescription> attribute_descriptions(program.vk_attributes_descriptions());
+    patch_vertex_format(attribute_descriptions, attribute_bindings, vertex_format);
 
     VkPipelineVertexInputStateCreateInfo vertex_input = vk_struct();
     {
@@ -237,7 +271,7 @@ GraphicPipeline MaterialCompiler::compile(const MaterialTemplate* material, cons
     }
 
     VkHandle<VkPipeline> pipeline;
-    vk_check(vkCreateGraphicsPipelines(vk_device(), {}, 1, &create_info, vk_allocation_callbacks(), pipeline.get_ptr_for_init()));
+    vk_check(vkCreateGraphicsPipelines(vk_device(), vk_pipeline_cache(), 1, &create_info, vk_allocation_callbacks(), pipeline.get_ptr_for_init()));
     return GraphicPipeline(std::move(pipeline), std::move(pipeline_layout));
 }
 
@@ -24,11 +24,13 @@ SOFTWARE.
 
 #include "GraphicPipeline.h"
 
+#include <yave/meshes/MeshVertexStreams.h>
+
 namespace yave {
 
 class MaterialCompiler {
     public:
-        static GraphicPipeline compile(const MaterialTemplate* material, const RenderPass& render_pass);
+        static GraphicPipeline compile(const MaterialTemplate* material, const RenderPass& render_pass, MeshVertexFormat vertex_format = MeshVertexFormat::Full);
 };
 
 
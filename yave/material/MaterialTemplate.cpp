@@ -24,6 +24,7 @@ SOFTWARE.
 
 #include <yave/graphics/graphics.h>
 #include <yave/graphics/framebuffer/RenderPass.h>
+#include <yave/graphics/device/PipelineCache.h>
 #include <yave/graphics/device/extensions/DebugUtils.h>
 
 #include <y/utils/log.h>
@@ -36,32 +37,109 @@ namespace yave {
 MaterialTemplate::MaterialTemplate(MaterialTemplateData&& data) : _data(std::move(data)) {
 }
 
-const GraphicPipeline& MaterialTemplate::compile(const RenderPass& render_pass) const {
-    Y_TODO(make material compilation thread safe?)
+MaterialTemplate::MaterialTemplate(MaterialTemplate&& other) {
+    *this = std::move(other);
+}
+
+MaterialTemplate& MaterialTemplate::operator=(MaterialTemplate&& other) {
+    // Pending compilations reference the template they were scheduled from
+    wait_for_compilations();
+    other.wait_for_compilations();
+
+    const std::scoped_lock lock(_lock, other._lock);
+    _compiled = std::move(other._compiled);
+    _data = std::move(other._data);
+#ifdef Y_DEBUG
+    _name = std::move(other._name);
+#endif
+    return *this;
+}
+
+MaterialTemplate::~MaterialTemplate() {
+    wait_for_compilations();
+}
+
+const GraphicPipeline& MaterialTemplate::compile(const RenderPass& render_pass, MeshVertexFormat vertex_format) const {
     if(!render_pass.vk_render_pass()) {
         y_fatal("Unable to compile material: null renderpass");
     }
 
-    const auto& key = render_pass.layout();
-    const auto it = _compiled.find(key);
-    if(it == _compiled.end()) {
-        if(_compiled.size() == max_compiled_pipelines) {
-            log_msg("Discarding graphic pipeline", Log::Warning);
-            std::move(_compiled.begin() + 1, _compiled.end(), _compiled.begin());
-            _compiled.pop();
-        }
+    CompiledPipeline* compiled = find_or_create(Key(render_pass.layout(), vertex_format));
+    compile_pipeline(compiled, render_pass, vertex_format);
+    return compiled->pipeline;
+}
+
+const GraphicPipeline* MaterialTemplate::compile_async(const RenderPass& render_pass, MeshVertexFormat vertex_format) const {
+    const Key key(render_pass.layout(), vertex_format);
+    CompiledPipeline* compiled = find_or_create(key);
+    if(compiled->ready) {
+        return &compiled->pipeline;
+    }
+
+    schedule_compilation(compiled, key);
+    return nullptr;
+}
+
+void MaterialTemplate::prewarm(const RenderPass::Layout& layout, MeshVertexFormat vertex_format) const {
+    const Key key(layout, vertex_format);
+    CompiledPipeline* compiled = find_or_create(key);
+    if(!compiled->ready) {
+        schedule_compilation(compiled, key);
+    }
+}
+
+MaterialTemplate::CompiledPipeline* MaterialTemplate::find_or_create(const Key& key) const {
+    const std::unique_lock lock(_lock);
+    if(const auto it = _compiled.find(key); it != _compiled.end()) {
+        return it->second.get();
+    }
 
-        _compiled.insert(key, MaterialCompiler::compile(this, render_pass));
+    _compiled.insert(key, std::make_unique<CompiledPipeline>());
+    return _compiled.last().second.get();
+}
+
+void MaterialTemplate::compile_pipeline(CompiledPipeline* compiled, const RenderPass& render_pass, MeshVertexFormat vertex_format) const {
+    // Whoever gets here first compiles, everyone else waits for it
+    std::call_once(compiled->once, [&] {
+        y_profile_zone("compile material");
+
+        compiled->pipeline = MaterialCompiler::compile(this, render_pass, vertex_format);
 
 #ifdef Y_DEBUG
         if(const auto* debug = debug_utils(); debug && !_name.is_empty()) {
-            debug->set_resource_name(_compiled.last().second.vk_pipeline(), _name.data());
+            debug->set_resource_name(compiled->pipeline.vk_pipeline(), _name.data());
         }
 #endif
 
-        return _compiled.last().second;
+        compiled->ready = true;
+    });
+}
+
+void MaterialTemplate::schedule_compilation(CompiledPipeline* compiled, const Key& key) const {
+    {
+        const std::unique_lock lock(_lock);
+        if(compiled->scheduled) {
+            return;
+        }
+        compiled->scheduled = true;
+    }
+
+    pipeline_cache().schedule([this, compiled, key] {
+        if(!compiled->ready) {
+            // The pipeline only needs a compatible render pass, which doesn't outlive the compilation
+            const RenderPass render_pass(key.first);
+            compile_pipeline(compiled, render_pass, key.second);
+        }
+    }, &compiled->compiled);
+}
+
+void MaterialTemplate::wait_for_compilations() const {
+    const std::unique_lock lock(_lock);
+    for(auto& [key, compiled] : _compiled) {
+        if(compiled->scheduled) {
+            pipeline_cache().wait(compiled->compiled);
+        }
     }
-    return it->second;
 }
 
 
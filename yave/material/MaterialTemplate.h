@@ -26,9 +26,15 @@ SOFTWARE.
 
 #include <yave/graphics/framebuffer/RenderPass.h>
 #include <yave/graphics/descriptors/DescriptorSet.h>
+#include <yave/meshes/MeshVertexStreams.h>
 
 #include <y/core/AssocVector.h>
 #include <y/core/String.h>
+#include <y/concurrent/StaticThreadPool.h>
+
+#include <memory>
+#include <mutex>
+#include <atomic>
 
 #include "GraphicPipeline.h"
 #include "MaterialTemplateData.h"
@@ -38,21 +44,47 @@ namespace yave {
 class MaterialTemplate final {
 
     public:
-        static constexpr usize max_compiled_pipelines = 8;
-
         MaterialTemplate() = default;
         MaterialTemplate(MaterialTemplateData&& data);
 
-        const GraphicPipeline& compile(const RenderPass& render_pass) const;
+        MaterialTemplate(MaterialTemplate&& other);
+        MaterialTemplate& operator=(MaterialTemplate&& other);
+
+        ~MaterialTemplate();
+
+        // Blocks until the pipeline is available, compiling it on the calling thread if nobody else is
+        const GraphicPipeline& compile(const RenderPass& render_pass, MeshVertexFormat vertex_format = MeshVertexFormat::Full) const;
+
+        // Never blocks: returns nullptr and schedules a background compilation if the pipeline isn't ready yet
+        const GraphicPipeline* compile_async(const RenderPass& render_pass, MeshVertexFormat vertex_format = MeshVertexFormat::Full) const;
+
+        // Schedules a background compilation for a render pass layout, so the pipeline is ready before it is first drawn
+        void prewarm(const RenderPass::Layout& layout, MeshVertexFormat vertex_format = MeshVertexFormat::Full) const;
 
         const MaterialTemplateData& data() const;
 
         void set_name(const char* name);
 
     private:
-        //void swap(Material& other);
+        using Key = std::pair<RenderPass::Layout, MeshVertexFormat>;
+
+        struct CompiledPipeline : NonMovable {
+            GraphicPipeline pipeline;
+
+            std::once_flag once;
+            std::atomic<bool> ready = false;
+
+            bool scheduled = false;
+            concurrent::DependencyGroup compiled;
+        };
+
+        CompiledPipeline* find_or_create(const Key& key) const;
+        void compile_pipeline(CompiledPipeline* compiled, const RenderPass& render_pass, MeshVertexFormat vertex_format) const;
+        void schedule_compilation(CompiledPipeline* compiled, const Key& key) const;
+        void wait_for_compilations() const;
 
-        mutable core::AssocVector<RenderPass::Layout, GraphicPipeline> _compiled;
+        mutable std::mutex _lock;
+        mutable core::AssocVector<Key, std::unique_ptr<CompiledPipeline>> _compiled;
 
         MaterialTemplateData _data;
 
@@ -103,6 +103,28 @@ void MeshData::add_sub_mesh(core::Span<PackedVertex> vertices, core::Span<Indexe
     add_sub_mesh(MeshVertexStreams(vertices), triangles);
 }
 
+void MeshData::build_meshlets() {
+    y_profile();
+
+    _meshlets = MeshletData();
+
+    const core::Span<math::Vec3> positions = _vertex_streams.stream<VertexStreamType::Position>();
+    for(usize i = 0; i != _sub_meshes.size(); ++i) {
+        const SubMesh& sub_mesh = _sub_meshes[i];
+        const core::Span<IndexedTriangle> triangles(_triangles.data() + sub_mesh.first_triangle, sub_mesh.triangle_count);
+        yave::build_meshlets(_meshlets, triangles, positions, u32(i));
+    }
+}
+
+void MeshData::set_vertex_format(MeshVertexFormat format) {
+    y_always_assert(format != MeshVertexFormat::Compact || _vertex_streams.vertex_count() <= max_compact_vertex_count, "Too many vertices for compact vertex format");
+    _vertex_format = format;
+}
+
+MeshVertexFormat MeshData::vertex_format() const {
+    return _vertex_format;
+}
+
 float MeshData::radius() const {
     return _aabb.origin_radius();
 }
@@ -123,6 +145,10 @@ core::Span<MeshData::SubMesh> MeshData::sub_meshes() const {
     return _sub_meshes;
 }
 
+const MeshletData& MeshData::meshlets() const {
+    return _meshlets;
+}
+
 core::Span<Bone> MeshData::bones() const {
     if(!_skeleton) {
         return {};
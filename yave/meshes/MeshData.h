@@ -25,6 +25,7 @@ SOFTWARE.
 #include "Skeleton.h"
 #include "MeshVertexStreams.h"
 #include "AABB.h"
+#include "mesh_optimization.h"
 
 #include <y/reflect/reflect.h>
 
@@ -52,6 +53,13 @@ class MeshData {
         u32 add_vertices_from_streams(const MeshVertexStreams& streams);
         void add_sub_mesh(core::Span<IndexedTriangle> triangles, u32 vertex_offset);
 
+        // Splits every sub-mesh in meshlets, following the current triangle order
+        void build_meshlets();
+
+        // Format used on the GPU. Compact requires at most max_compact_vertex_count vertices.
+        void set_vertex_format(MeshVertexFormat format);
+        MeshVertexFormat vertex_format() const;
+
         float radius() const;
         const AABB& aabb() const;
 
@@ -59,6 +67,8 @@ class MeshData {
         core::Span<IndexedTriangle> triangles() const;
         core::Span<SubMesh> sub_meshes() const;
 
+        const MeshletData& meshlets() const;
+
         core::Span<Bone> bones() const;
         core::Span<SkinWeights> skin() const;
 
@@ -66,7 +76,7 @@ class MeshData {
 
         bool is_empty() const;
 
-        y_reflect(MeshData, _aabb, _vertex_streams, _triangles, _sub_meshes, _skeleton)
+        y_reflect(MeshData, _aabb, _vertex_streams, _triangles, _sub_meshes, _skeleton, _meshlets, _vertex_format)
 
     private:
         struct SkeletonData {
@@ -83,6 +93,10 @@ class MeshData {
         core::Vector<SubMesh> _sub_meshes;
 
         std::unique_ptr<SkeletonData> _skeleton;
+
+        MeshletData _meshlets;
+
+        MeshVertexFormat _vertex_format = MeshVertexFormat::Full;
 };
 
 }
@@ -34,8 +34,16 @@ usize MeshDrawBuffers::vertex_count() const {
     return _vertex_count;
 }
 
-TriangleSubBuffer MeshDrawBuffers::triangle_buffer() const {
-    return _triangle_buffer;
+IndexSubBuffer MeshDrawBuffers::index_buffer() const {
+    return _index_buffer;
+}
+
+VkIndexType MeshDrawBuffers::index_type() const {
+    return _vertex_format == MeshVertexFormat::Compact ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+}
+
+MeshVertexFormat MeshDrawBuffers::vertex_format() const {
+    return _vertex_format;
 }
 
 MeshAllocator* MeshDrawBuffers::parent() const {
@@ -66,9 +74,9 @@ bool MeshDrawData::is_null() const {
     return !_mesh_buffers;
 }
 
-TriangleSubBuffer MeshDrawData::triangle_buffer() const {
+IndexSubBuffer MeshDrawData::index_buffer() const {
     y_debug_assert(_mesh_buffers);
-    return _mesh_buffers->triangle_buffer();
+    return _mesh_buffers->index_buffer();
 }
 
 const MeshDrawBuffers& MeshDrawData::mesh_buffers() const {
@@ -80,8 +88,13 @@ const MeshDrawCommand& MeshDrawData::draw_command() const {
     return _command;
 }
 
+const MeshDecodeInfo& MeshDrawData::decode_info() const {
+    return _decode_info;
+}
+
 void MeshDrawData::swap(MeshDrawData& other) {
     std::swap(_command, other._command);
+    std::swap(_decode_info, other._decode_info);
     std::swap(_vertex_count, other._vertex_count);
     std::swap(_mesh_buffers, other._mesh_buffers);
 }
@@ -46,6 +46,16 @@ struct MeshDrawCommand {
     }
 };
 
+// Per draw data needed by vertex shaders to decode vertices, matches MeshDecodeInfo in shaders
+struct MeshDecodeInfo {
+    math::Vec3 position_offset;
+    u32 vertex_format = u32(MeshVertexFormat::Full);
+    math::Vec3 position_scale = math::Vec3(1.0f);
+    u32 padding = 0;
+};
+
+static_assert(sizeof(MeshDecodeInfo) == 32);
+
 class MeshDrawBuffers : NonMovable {
     public:
         static constexpr usize vertex_stream_count = MeshVertexStreams::stream_count;
@@ -53,7 +63,10 @@ class MeshDrawBuffers : NonMovable {
         MeshDrawBuffers() = default;
 
         core::Span<AttribSubBuffer> attrib_buffers() const;
-        TriangleSubBuffer triangle_buffer() const;
+        IndexSubBuffer index_buffer() const;
+        VkIndexType index_type() const;
+
+        MeshVertexFormat vertex_format() const;
 
         usize vertex_count() const;
 
@@ -64,7 +77,9 @@ class MeshDrawBuffers : NonMovable {
 
         usize _vertex_count = 0;
         std::array<AttribSubBuffer, vertex_stream_count> _attrib_buffers;
-        TriangleSubBuffer _triangle_buffer;
+        IndexSubBuffer _index_buffer;
+
+        MeshVertexFormat _vertex_format = MeshVertexFormat::Full;
 
         MeshAllocator* _parent = nullptr;
 };
@@ -80,9 +95,10 @@ class MeshDrawData : NonCopyable {
         bool is_null() const;
 
         const MeshDrawBuffers& mesh_buffers() const;
-        TriangleSubBuffer triangle_buffer() const;
+        IndexSubBuffer index_buffer() const;
 
         const MeshDrawCommand& draw_command() const;
+        const MeshDecodeInfo& decode_info() const;
 
     private:
         friend class LifetimeManager;
@@ -94,6 +110,7 @@ class MeshDrawData : NonCopyable {
         void swap(MeshDrawData& other);
 
         MeshDrawCommand _command = {};
+        MeshDecodeInfo _decode_info = {};
         u32 _vertex_count = 0;
 
         MeshDrawBuffers* _mesh_buffers = nullptr;
@@ -22,6 +22,8 @@ SOFTWARE.
 
 #include "MeshVertexStreams.h"
 
+#include <y/core/Vector.h>
+
 
 namespace yave {
 
@@ -57,6 +59,24 @@ MeshVertexStreams MeshVertexStreams::merged(const MeshVertexStreams& other) cons
     return str;
 }
 
+MeshVertexStreams MeshVertexStreams::reordered(core::Span<u32> vertices) const {
+    MeshVertexStreams str(vertices.size());
+
+    for(usize i = 0; i != stream_count; ++i) {
+        const VertexStreamType type = VertexStreamType(i);
+        const usize stream_elem_size = vertex_stream_element_size(type);
+
+        u8* dst = str.data(type);
+        for(const u32 index : vertices) {
+            y_debug_assert(index < _vertex_count);
+            std::memcpy(dst, vertex_stream_data(type, index), stream_elem_size);
+            dst += stream_elem_size;
+        }
+    }
+
+    return str;
+}
+
 PackedVertex MeshVertexStreams::operator[](usize index) const {
     y_debug_assert(index < _vertex_count);
 
@@ -110,5 +130,82 @@ const u8* MeshVertexStreams::data(VertexStreamType type) const {
     return _storage.data() + offset;
 }
 
+
+
+
+CompactVertexStreams::CompactVertexStreams(const MeshVertexStreams& streams) : _vertex_count(streams.vertex_count()) {
+    usize offset = 0;
+    for(usize i = 0; i != stream_count; ++i) {
+        _stream_offsets[i] = offset;
+        offset += _vertex_count * vertex_stream_element_size(VertexStreamType(i), MeshVertexFormat::Compact);
+    }
+    _storage = core::FixedArray<u8>(offset);
+
+    {
+        const core::Span<math::Vec3> positions = streams.stream<VertexStreamType::Position>();
+
+        math::Vec3 max(-std::numeric_limits<float>::max());
+        math::Vec3 min(std::numeric_limits<float>::max());
+        for(const math::Vec3& p : positions) {
+            max = max.max(p);
+            min = min.min(p);
+        }
+        _position_range = _vertex_count ? math::QuantizationRange::from_bounds(min, max) : math::QuantizationRange{};
+
+        auto* dst = reinterpret_cast<std::array<u16, 4>*>(_storage.data() + _stream_offsets[usize(VertexStreamType::Position)]);
+        for(const math::Vec3& p : positions) {
+            const math::Vec<3, u16> q = _position_range.quantize(p);
+            *dst++ = {q.x(), q.y(), q.z(), 0};
+        }
+    }
+
+    {
+        auto* dst = reinterpret_cast<u32*>(_storage.data() + _stream_offsets[usize(VertexStreamType::NormalTangent)]);
+        for(const math::Vec2ui& packed : streams.stream<VertexStreamType::NormalTangent>()) {
+            const math::Vec4 normal = unpack_2_10_10_10(packed.x());
+            *dst++ = pack_compact_normal_tangent(normal.to<3>(), unpack_2_10_10_10(packed.y()));
+        }
+    }
+
+    {
+        auto* dst = reinterpret_cast<std::array<u16, 2>*>(_storage.data() + _stream_offsets[usize(VertexStreamType::Uv)]);
+        for(const math::Vec2& uv : streams.stream<VertexStreamType::Uv>()) {
+            *dst++ = {math::float_to_half(uv.x()), math::float_to_half(uv.y())};
+        }
+    }
+}
+
+MeshVertexStreams CompactVertexStreams::decoded() const {
+    core::Vector<PackedVertex> vertices;
+    vertices.set_min_capacity(_vertex_count);
+
+    const auto* positions = reinterpret_cast<const std::array<u16, 4>*>(data(VertexStreamType::Position));
+    const auto* normal_tangents = reinterpret_cast<const u32*>(data(VertexStreamType::NormalTangent));
+    const auto* uvs = reinterpret_cast<const std::array<u16, 2>*>(data(VertexStreamType::Uv));
+
+    for(usize i = 0; i != _vertex_count; ++i) {
+        const auto [normal, tangent_sign] = unpack_compact_normal_tangent(normal_tangents[i]);
+        vertices << pack_vertex(FullVertex {
+            _position_range.dequantize(math::Vec<3, u16>(positions[i][0], positions[i][1], positions[i][2])),
+            normal,
+            tangent_sign,
+            math::Vec2(math::half_to_float(uvs[i][0]), math::half_to_float(uvs[i][1])),
+        });
+    }
+
+    return MeshVertexStreams(vertices);
+}
+
+usize CompactVertexStreams::vertex_count() const {
+    return _vertex_count;
+}
+
+const u8* CompactVertexStreams::data(VertexStreamType type) const {
+    return _storage.data() + _stream_offsets[usize(type)];
 }
 
+const math::QuantizationRange& CompactVertexStreams::position_range() const {
+    return _position_range;
+}
+
+}
@@ -52,6 +52,17 @@ struct VertexStreamInfo {};
 #undef DECLARE_STREAM_INFOS
 
 
+enum class MeshVertexFormat : u32 {
+    Full = 0,   // Float positions and UVs, 2_10_10_10 normals and tangents, 32 bits indices
+    Compact,    // 16 bits positions relative to the mesh bounds, octahedral normals and tangents, half UVs, 16 bits indices
+
+    Max
+};
+
+// Compact meshes use 16 bits indices
+static constexpr usize max_compact_vertex_count = usize(1) << 16;
+
+
 inline constexpr usize vertex_stream_element_size(VertexStreamType type) {
 #define STREAM_CASE(Type) case VertexStreamType::Type: return sizeof(VertexStreamInfo<VertexStreamType::Type>::type)
     switch(type) {
@@ -64,10 +75,28 @@ inline constexpr usize vertex_stream_element_size(VertexStreamType type) {
 #undef STREAM_CASE
 }
 
-inline constexpr usize compute_total_vertex_streams_size() {
+inline constexpr usize vertex_stream_element_size(VertexStreamType type, MeshVertexFormat format) {
+    if(format == MeshVertexFormat::Full) {
+        return vertex_stream_element_size(type);
+    }
+
+    switch(type) {
+        case VertexStreamType::Position:        return 4 * sizeof(u16);
+        case VertexStreamType::NormalTangent:   return sizeof(u32);
+        case VertexStreamType::Uv:              return 2 * sizeof(u16);
+        default:
+            y_fatal("Unknown stream type");
+    }
+}
+
+inline constexpr usize index_size(MeshVertexFormat format) {
+    return format == MeshVertexFormat::Full ? sizeof(u32) : sizeof(u16);
+}
+
+inline constexpr usize compute_total_vertex_streams_size(MeshVertexFormat format = MeshVertexFormat::Full) {
     usize total_size = 0;
     for(usize i = 0; i != usize(VertexStreamType::Max); ++i) {
-        total_size += vertex_stream_element_size(VertexStreamType(i));
+        total_size += vertex_stream_element_size(VertexStreamType(i), format);
     }
     return total_size;
 }
@@ -84,6 +113,9 @@ class MeshVertexStreams {
 
         MeshVertexStreams merged(const MeshVertexStreams& other) const;
 
+        // Creates streams containing the given vertices, in order
+        MeshVertexStreams reordered(core::Span<u32> vertices) const;
+
         usize vertex_count() const;
 
         bool has_stream(VertexStreamType type) const;
@@ -126,6 +158,32 @@ class MeshVertexStreams {
 
 };
 
+// MeshVertexFormat::Compact encoding of vertex streams, as uploaded to the GPU
+class CompactVertexStreams {
+    public:
+        static constexpr usize stream_count = MeshVertexStreams::stream_count;
+        static constexpr usize total_vertex_size = compute_total_vertex_streams_size(MeshVertexFormat::Compact);
+
+        CompactVertexStreams() = default;
+        CompactVertexStreams(const MeshVertexStreams& streams);
+
+        MeshVertexStreams decoded() const;
+
+        usize vertex_count() const;
+
+        const u8* data(VertexStreamType type) const;
+
+        // Positions are stored relative to this range
+        const math::QuantizationRange& position_range() const;
+
+    private:
+        usize _vertex_count = 0;
+        std::array<usize, stream_count> _stream_offsets = {};
+        core::FixedArray<u8> _storage;
+
+        math::QuantizationRange _position_range;
+};
+
 }
 
 #endif // YAVE_MESHES_MESH_VERTEX_STREAMS_H
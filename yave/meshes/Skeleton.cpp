@@ -51,7 +51,7 @@ Skeleton::Skeleton(core::Span<Bone> bones) : _bones(bones) {
     }
 
     for(auto& transform : _inverses) {
-        transform = transform.inverse();
+        transform = transform.affine_inverse();
     }
 
     /*for(usize i = 0; i != _bones.size(); ++i) {
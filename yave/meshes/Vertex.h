@@ -24,6 +24,8 @@ SOFTWARE.
 
 #include <yave/yave.h>
 
+#include <y/math/quantization.h>
+
 #include <array>
 
 namespace yave {
@@ -64,6 +66,30 @@ inline math::Vec4 unpack_2_10_10_10(u32 packed) {
     );
 }
 
+// Octahedral normal on 2x8 bits, octahedral tangent on 2x7 bits and the bitangent sign in the high bit
+inline u32 pack_compact_normal_tangent(const math::Vec3& normal, const math::Vec4& tangent_sign) {
+    const math::Vec2 n = math::encode_octahedral(normal);
+    const math::Vec2 t = math::encode_octahedral(tangent_sign.to<3>());
+    return
+        (math::quantize_snorm<8>(n.x()) <<  0) |
+        (math::quantize_snorm<8>(n.y()) <<  8) |
+        (math::quantize_snorm<7>(t.x()) << 16) |
+        (math::quantize_snorm<7>(t.y()) << 23) |
+        (tangent_sign.w() < 0.0f ? (1u << 31) : 0);
+}
+
+inline std::pair<math::Vec3, math::Vec4> unpack_compact_normal_tangent(u32 packed) {
+    const math::Vec3 normal = math::decode_octahedral(math::Vec2(
+        math::dequantize_snorm<8>(packed >>  0),
+        math::dequantize_snorm<8>(packed >>  8)
+    ));
+    const math::Vec3 tangent = math::decode_octahedral(math::Vec2(
+        math::dequantize_snorm<7>(packed >> 16),
+        math::dequantize_snorm<7>(packed >> 23)
+    ));
+    return {normal, math::Vec4(tangent, (packed >> 31) ? -1.0f : 1.0f)};
+}
+
 inline PackedVertex pack_vertex(const FullVertex& v) {
     return PackedVertex {
         v.position,
@@ -0,0 +1,575 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include "mesh_optimization.h"
+
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <cmath>
+
+namespace yave {
+
+static constexpr u32 invalid_index = u32(-1);
+
+
+VertexCacheStats analyze_vertex_cache(core::Span<IndexedTriangle> triangles, usize vertex_count, usize cache_size) {
+    y_profile();
+
+    if(triangles.is_empty()) {
+        return {};
+    }
+
+    // A vertex is in the cache if fewer than cache_size misses happened since it was last loaded
+    core::Vector<u64> load_time(vertex_count, 0);
+    u64 time = cache_size;
+
+    usize misses = 0;
+    usize unique_vertices = 0;
+    for(const IndexedTriangle& tri : triangles) {
+        for(const u32 index : tri) {
+            y_debug_assert(index < vertex_count);
+            if(!load_time[index]) {
+                ++unique_vertices;
+            }
+            if(time - load_time[index] >= cache_size) {
+                load_time[index] = ++time;
+                ++misses;
+            }
+        }
+    }
+
+    return VertexCacheStats {
+        float(misses) / float(triangles.size()),
+        float(misses) / float(unique_vertices),
+    };
+}
+
+VertexFetchStats analyze_vertex_fetch(core::Span<IndexedTriangle> triangles, usize vertex_count, usize vertex_size) {
+    y_profile();
+
+    static constexpr usize line_size = 64;
+    static constexpr usize cache_lines = 64;
+    static constexpr usize transform_cache_size = 16;
+
+    if(triangles.is_empty()) {
+        return {};
+    }
+
+    core::Vector<u64> load_time((vertex_count * vertex_size + line_size - 1) / line_size, 0);
+    core::Vector<u64> transform_time(vertex_count, 0);
+    u64 time = cache_lines;
+    u64 transforms = transform_cache_size;
+
+    usize lines_fetched = 0;
+    usize unique_vertices = 0;
+    for(const IndexedTriangle& tri : triangles) {
+        for(const u32 index : tri) {
+            y_debug_assert(index < vertex_count);
+            unique_vertices += !transform_time[index];
+
+            // Vertices still in the post-transform cache aren't fetched
+            if(transforms - transform_time[index] < transform_cache_size) {
+                continue;
+            }
+            transform_time[index] = ++transforms;
+
+            const usize first_line = (index * vertex_size) / line_size;
+            const usize last_line = ((index + 1) * vertex_size - 1) / line_size;
+            for(usize line = first_line; line <= last_line; ++line) {
+                if(time - load_time[line] >= cache_lines) {
+                    load_time[line] = ++time;
+                    ++lines_fetched;
+                }
+            }
+        }
+    }
+
+    const u64 bytes_fetched = u64(lines_fetched) * line_size;
+    return VertexFetchStats {
+        bytes_fetched,
+        float(bytes_fetched) / float(unique_vertices * vertex_size),
+    };
+}
+
+
+
+namespace forsyth {
+static constexpr usize cache_size = 32;
+static constexpr usize max_valence = 32;
+
+static constexpr float cache_decay_power = 1.5f;
+static constexpr float last_triangle_score = 0.75f;
+static constexpr float valence_boost_scale = 2.0f;
+static constexpr float valence_boost_power = 0.5f;
+
+struct ScoreTables {
+    std::array<float, cache_size + 1> cache;
+    std::array<float, max_valence + 1> valence;
+
+    ScoreTables() {
+        for(usize i = 0; i != cache_size; ++i) {
+            cache[i] = i < 3
+                ? last_triangle_score
+                : std::pow(1.0f - float(i - 3) / float(cache_size - 3), cache_decay_power);
+        }
+        cache[cache_size] = 0.0f; // Not in cache
+
+        valence[0] = 0.0f;
+        for(usize i = 1; i != valence.size(); ++i) {
+            valence[i] = valence_boost_scale * std::pow(float(i), -valence_boost_power);
+        }
+    }
+
+    float score(u32 cache_position, u32 live_triangles) const {
+        if(!live_triangles) {
+            return -1.0f;
+        }
+        return cache[cache_position] + valence[std::min(usize(live_triangles), max_valence)];
+    }
+};
+}
+
+void optimize_vertex_cache(core::MutableSpan<IndexedTriangle> triangles, usize vertex_count) {
+    y_profile();
+
+    static const forsyth::ScoreTables tables;
+    static constexpr u32 not_in_cache = u32(forsyth::cache_size);
+
+    const usize triangle_count = triangles.size();
+    if(triangle_count < 2) {
+        return;
+    }
+
+    // Per vertex list of the triangles that haven't been emitted yet
+    core::Vector<u32> live_triangles(vertex_count, 0);
+    for(const IndexedTriangle& tri : triangles) {
+        for(const u32 index : tri) {
+            y_debug_assert(index < vertex_count);
+            ++live_triangles[index];
+        }
+    }
+
+    core::Vector<u32> adjacency_offsets(vertex_count + 1, 0);
+    for(usize i = 0; i != vertex_count; ++i) {
+        adjacency_offsets[i + 1] = adjacency_offsets[i] + live_triangles[i];
+    }
+
+    core::Vector<u32> adjacency(triangle_count * 3, 0);
+    {
+        core::Vector<u32> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+        for(usize t = 0; t != triangle_count; ++t) {
+            for(const u32 index : triangles[t]) {
+                adjacency[fill[index]++] = u32(t);
+            }
+        }
+    }
+
+    core::Vector<u32> cache_position(vertex_count, not_in_cache);
+    core::Vector<float> vertex_score(vertex_count, 0.0f);
+    for(usize i = 0; i != vertex_count; ++i) {
+        vertex_score[i] = tables.score(not_in_cache, live_triangles[i]);
+    }
+
+    core::Vector<float> triangle_score(triangle_count, 0.0f);
+    core::Vector<u8> emitted(triangle_count, 0);
+    u32 best_triangle = 0;
+    for(usize t = 0; t != triangle_count; ++t) {
+        const IndexedTriangle& tri = triangles[t];
+        triangle_score[t] = vertex_score[tri[0]] + vertex_score[tri[1]] + vertex_score[tri[2]];
+        if(triangle_score[t] > triangle_score[best_triangle]) {
+            best_triangle = u32(t);
+        }
+    }
+
+    std::array<u32, forsyth::cache_size + 3> cache = {};
+    std::array<u32, forsyth::cache_size + 3> next_cache = {};
+    usize cache_count = 0;
+
+    core::Vector<IndexedTriangle> output;
+    output.set_min_capacity(triangle_count);
+
+    usize input_cursor = 0;
+    while(best_triangle != invalid_index) {
+        const IndexedTriangle tri = triangles[best_triangle];
+        emitted[best_triangle] = 1;
+        output << tri;
+
+        // Remove the triangle from its vertices' live lists
+        for(const u32 index : tri) {
+            u32* begin = adjacency.data() + adjacency_offsets[index];
+            u32* end = begin + live_triangles[index];
+            u32* it = std::find(begin, end, best_triangle);
+            y_debug_assert(it != end);
+            *it = *(end - 1);
+            --live_triangles[index];
+        }
+
+        // Push the triangle vertices at the front of the cache
+        usize next_count = 0;
+        for(const u32 index : tri) {
+            if(std::find(next_cache.begin(), next_cache.begin() + next_count, index) == next_cache.begin() + next_count) {
+                next_cache[next_count++] = index;
+            }
+        }
+        for(usize i = 0; i != cache_count; ++i) {
+            const u32 index = cache[i];
+            if(index != tri[0] && index != tri[1] && index != tri[2]) {
+                next_cache[next_count++] = index;
+            }
+        }
+
+        // Update scores of the vertices in (or evicted from) the cache, and of their triangles
+        for(usize i = 0; i != next_count; ++i) {
+            const u32 index = next_cache[i];
+            cache_position[index] = i < forsyth::cache_size ? u32(i) : not_in_cache;
+
+            const float score = tables.score(cache_position[index], live_triangles[index]);
+            const float delta = score - vertex_score[index];
+            vertex_score[index] = score;
+
+            const u32* adj = adjacency.data() + adjacency_offsets[index];
+            for(u32 k = 0; k != live_triangles[index]; ++k) {
+                triangle_score[adj[k]] += delta;
+            }
+        }
+
+        // Only triangles using a cached vertex are candidates
+        best_triangle = invalid_index;
+        float best_score = -1.0f;
+        for(usize i = 0; i != std::min(next_count, forsyth::cache_size); ++i) {
+            const u32 index = next_cache[i];
+            const u32* adj = adjacency.data() + adjacency_offsets[index];
+            for(u32 k = 0; k != live_triangles[index]; ++k) {
+                if(triangle_score[adj[k]] > best_score) {
+                    best_score = triangle_score[adj[k]];
+                    best_triangle = adj[k];
+                }
+            }
+        }
+
+        cache_count = std::min(next_count, forsyth::cache_size);
+        std::copy_n(next_cache.begin(), cache_count, cache.begin());
+
+        // Nothing connected to the cache: restart from the first triangle not yet emitted
+        if(best_triangle == invalid_index) {
+            while(input_cursor != triangle_count && emitted[input_cursor]) {
+                ++input_cursor;
+            }
+            if(input_cursor != triangle_count) {
+                best_triangle = u32(input_cursor);
+            }
+        }
+    }
+
+    y_debug_assert(output.size() == triangle_count);
+    std::copy(output.begin(), output.end(), triangles.begin());
+}
+
+
+
+void optimize_overdraw(core::MutableSpan<IndexedTriangle> triangles, core::Span<math::Vec3> positions, float threshold) {
+    y_profile();
+
+    static constexpr usize cache_size = 16;
+
+    const usize triangle_count = triangles.size();
+    if(triangle_count < 2) {
+        return;
+    }
+
+    const usize vertex_count = positions.size();
+
+    // Vertex cache misses, restarting from a cold cache at every cluster start
+    core::Vector<u64> load_time(vertex_count, 0);
+    u64 time = cache_size;
+    const auto simulate = [&](const IndexedTriangle& tri) {
+        u32 misses = 0;
+        for(const u32 index : tri) {
+            if(time - load_time[index] >= cache_size) {
+                load_time[index] = ++time;
+                ++misses;
+            }
+        }
+        return misses;
+    };
+    const auto flush_cache = [&] {
+        time += cache_size;
+    };
+
+    // Hard boundaries: triangles that share nothing with the cache
+    core::Vector<u32> hard_clusters = {0};
+    simulate(triangles[0]);
+    for(usize t = 1; t != triangle_count; ++t) {
+        if(simulate(triangles[t]) == 3) {
+            hard_clusters << u32(t);
+        }
+    }
+    hard_clusters << u32(triangle_count);
+
+    // Soft boundaries: restart as soon as the cluster cache efficiency is within threshold of the hard cluster
+    core::Vector<u32> clusters;
+    for(usize c = 0; c + 1 < hard_clusters.size(); ++c) {
+        const usize begin = hard_clusters[c];
+        const usize end = hard_clusters[c + 1];
+
+        flush_cache();
+        usize hard_misses = 0;
+        for(usize t = begin; t != end; ++t) {
+            hard_misses += simulate(triangles[t]);
+        }
+        const float max_acmr = threshold * float(hard_misses) / float(end - begin);
+
+        flush_cache();
+        clusters << u32(begin);
+        usize cluster_start = begin;
+        usize cluster_misses = 0;
+        for(usize t = begin; t != end; ++t) {
+            cluster_misses += simulate(triangles[t]);
+            if(t + 1 != end && float(cluster_misses) <= max_acmr * float(t + 1 - cluster_start)) {
+                flush_cache();
+                clusters << u32(t + 1);
+                cluster_start = t + 1;
+                cluster_misses = 0;
+            }
+        }
+    }
+    clusters << u32(triangle_count);
+
+    // Area weighted centroid and normal of every cluster
+    struct ClusterInfo {
+        math::Vec3 centroid;
+        math::Vec3 normal;
+        float area = 0.0f;
+        float sort_key = 0.0f;
+    };
+
+    const usize cluster_count = clusters.size() - 1;
+    core::Vector<ClusterInfo> infos(cluster_count, ClusterInfo{});
+
+    math::Vec3 mesh_centroid;
+    float mesh_area = 0.0f;
+    for(usize c = 0; c != cluster_count; ++c) {
+        ClusterInfo& info = infos[c];
+        for(usize t = clusters[c]; t != clusters[c + 1]; ++t) {
+            const IndexedTriangle& tri = triangles[t];
+            const math::Vec3 p0 = positions[tri[0]];
+            const math::Vec3 p1 = positions[tri[1]];
+            const math::Vec3 p2 = positions[tri[2]];
+
+            const math::Vec3 normal = (p1 - p0).cross(p2 - p0);
+            const float area = normal.length();
+
+            info.centroid += (p0 + p1 + p2) * (area / 3.0f);
+            info.normal += normal;
+            info.area += area;
+        }
+
+        mesh_centroid += info.centroid;
+        mesh_area += info.area;
+
+        if(info.area > 0.0f) {
+            info.centroid /= info.area;
+        }
+    }
+
+    if(mesh_area > 0.0f) {
+        mesh_centroid /= mesh_area;
+    }
+
+    for(ClusterInfo& info : infos) {
+        const float normal_length = info.normal.length();
+        info.sort_key = normal_length > 0.0f ? (info.centroid - mesh_centroid).dot(info.normal / normal_length) : 0.0f;
+    }
+
+    // Outward facing clusters first, they are more likely to occlude the others
+    core::Vector<u32> order(cluster_count, 0);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](u32 a, u32 b) { return infos[a].sort_key > infos[b].sort_key; });
+
+    core::Vector<IndexedTriangle> output;
+    output.set_min_capacity(triangle_count);
+    for(const u32 c : order) {
+        for(usize t = clusters[c]; t != clusters[c + 1]; ++t) {
+            output << triangles[t];
+        }
+    }
+
+    std::copy(output.begin(), output.end(), triangles.begin());
+}
+
+
+
+core::Vector<u32> optimize_vertex_fetch(core::MutableSpan<IndexedTriangle> triangles, usize vertex_count) {
+    y_profile();
+
+    core::Vector<u32> remap(vertex_count, invalid_index);
+    core::Vector<u32> vertices;
+    vertices.set_min_capacity(vertex_count);
+
+    for(IndexedTriangle& tri : triangles) {
+        for(u32& index : tri) {
+            y_debug_assert(index < vertex_count);
+            if(remap[index] == invalid_index) {
+                remap[index] = u32(vertices.size());
+                vertices << index;
+            }
+            index = remap[index];
+        }
+    }
+
+    return vertices;
+}
+
+void optimize_mesh(MeshVertexStreams& streams, core::MutableSpan<IndexedTriangle> triangles) {
+    y_profile();
+
+    optimize_vertex_cache(triangles, streams.vertex_count());
+    optimize_overdraw(triangles, streams.stream<VertexStreamType::Position>());
+
+    const core::Vector<u32> vertices = optimize_vertex_fetch(triangles, streams.vertex_count());
+    if(vertices.size() != streams.vertex_count() || !std::is_sorted(vertices.begin(), vertices.end())) {
+        streams = streams.reordered(vertices);
+    }
+}
+
+
+
+static void compute_meshlet_bounds(Meshlet& meshlet, const MeshletData& meshlets, core::Span<math::Vec3> positions) {
+    const u32* vertices = meshlets.vertices.data() + meshlet.first_vertex;
+    const u8* triangles = meshlets.triangles.data() + meshlet.first_triangle * 3;
+
+    // Bounding sphere, centered on the bounding box
+    {
+        math::Vec3 min(std::numeric_limits<float>::max());
+        math::Vec3 max(-std::numeric_limits<float>::max());
+        for(u32 i = 0; i != meshlet.vertex_count; ++i) {
+            min = min.min(positions[vertices[i]]);
+            max = max.max(positions[vertices[i]]);
+        }
+
+        meshlet.center = (min + max) * 0.5f;
+
+        float radius_sq = 0.0f;
+        for(u32 i = 0; i != meshlet.vertex_count; ++i) {
+            radius_sq = std::max(radius_sq, (positions[vertices[i]] - meshlet.center).length2());
+        }
+        meshlet.radius = std::sqrt(radius_sq);
+    }
+
+    // Normal cone
+    {
+        math::Vec3 normals[max_meshlet_triangles];
+        usize normal_count = 0;
+        math::Vec3 axis;
+        for(u32 t = 0; t != meshlet.triangle_count; ++t) {
+            const math::Vec3 a = positions[vertices[triangles[t * 3 + 0]]];
+            const math::Vec3 b = positions[vertices[triangles[t * 3 + 1]]];
+            const math::Vec3 c = positions[vertices[triangles[t * 3 + 2]]];
+
+            const math::Vec3 normal = (b - a).cross(c - a);
+            const float length = normal.length();
+            if(length > 0.0f) {
+                normals[normal_count] = normal / length;
+                axis += normals[normal_count];
+                ++normal_count;
+            }
+        }
+
+        meshlet.cone_axis = math::Vec3(0.0f, 0.0f, 1.0f);
+        meshlet.cone_cutoff = 1.0f;
+
+        const float axis_length = axis.length();
+        if(!normal_count || axis_length <= 0.0f) {
+            return;
+        }
+
+        axis /= axis_length;
+
+        float min_dot = 1.0f;
+        for(usize i = 0; i != normal_count; ++i) {
+            min_dot = std::min(min_dot, normals[i].dot(axis));
+        }
+
+        // Cones wider than ~85 degrees are not worth testing
+        if(min_dot > 0.1f) {
+            meshlet.cone_axis = axis;
+            meshlet.cone_cutoff = std::sqrt(1.0f - min_dot * min_dot);
+        }
+    }
+}
+
+void build_meshlets(MeshletData& meshlets, core::Span<IndexedTriangle> triangles, core::Span<math::Vec3> positions, u32 sub_mesh) {
+    y_profile();
+
+    static_assert(max_meshlet_vertices <= 256, "Meshlet triangles use 8 bits indices");
+
+    core::Vector<u32> local_index(positions.size(), invalid_index);
+
+    Meshlet meshlet;
+    meshlet.sub_mesh = sub_mesh;
+    meshlet.first_vertex = u32(meshlets.vertices.size());
+    meshlet.first_triangle = u32(meshlets.triangles.size() / 3);
+
+    const auto flush = [&] {
+        if(!meshlet.triangle_count) {
+            return;
+        }
+
+        for(u32 i = 0; i != meshlet.vertex_count; ++i) {
+            local_index[meshlets.vertices[meshlet.first_vertex + i]] = invalid_index;
+        }
+
+        compute_meshlet_bounds(meshlet, meshlets, positions);
+        meshlets.meshlets << meshlet;
+
+        meshlet.first_vertex += meshlet.vertex_count;
+        meshlet.first_triangle += meshlet.triangle_count;
+        meshlet.vertex_count = 0;
+        meshlet.triangle_count = 0;
+    };
+
+    for(const IndexedTriangle& tri : triangles) {
+        const u32 new_vertices =
+            (local_index[tri[0]] == invalid_index) +
+            (local_index[tri[1]] == invalid_index && tri[1] != tri[0]) +
+            (local_index[tri[2]] == invalid_index && tri[2] != tri[0] && tri[2] != tri[1]);
+
+        if(meshlet.vertex_count + new_vertices > max_meshlet_vertices || meshlet.triangle_count == max_meshlet_triangles) {
+            flush();
+        }
+
+        for(const u32 index : tri) {
+            y_debug_assert(index < positions.size());
+            if(local_index[index] == invalid_index) {
+                local_index[index] = meshlet.vertex_count++;
+                meshlets.vertices << index;
+            }
+            meshlets.triangles << u8(local_index[index]);
+        }
+        ++meshlet.triangle_count;
+    }
+
+    flush();
+}
+
+}
@@ -0,0 +1,98 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#ifndef YAVE_MESHES_MESH_OPTIMIZATION_H
+#define YAVE_MESHES_MESH_OPTIMIZATION_H
+
+#include "MeshVertexStreams.h"
+
+#include <y/core/Vector.h>
+
+namespace yave {
+
+static constexpr usize max_meshlet_vertices = 64;
+static constexpr usize max_meshlet_triangles = 124;
+
+struct Meshlet {
+    u32 sub_mesh = 0;
+
+    u32 first_vertex = 0;
+    u32 vertex_count = 0;
+    u32 first_triangle = 0;
+    u32 triangle_count = 0;
+
+    math::Vec3 center;
+    float radius = 0.0f;
+
+    // The meshlet is entirely back facing from eye if
+    // dot(center - eye, cone_axis) >= cone_cutoff * length(center - eye) + radius
+    math::Vec3 cone_axis;
+    float cone_cutoff = 1.0f;
+};
+
+struct MeshletData {
+    core::Vector<Meshlet> meshlets;
+    core::Vector<u32> vertices;     // Indices into the mesh vertex streams
+    core::Vector<u8> triangles;     // Three indices into the meshlet vertices per triangle
+
+    y_reflect(MeshletData, meshlets, vertices, triangles)
+};
+
+struct VertexCacheStats {
+    float acmr = 0.0f;  // Vertex shader invocations per triangle, 0.5 at best for a regular grid
+    float atvr = 0.0f;  // Vertex shader invocations per vertex, 1.0 at best
+};
+
+struct VertexFetchStats {
+    u64 bytes_fetched = 0;
+    float overfetch = 0.0f; // Bytes fetched over the size of the referenced vertices, 1.0 at best
+};
+
+// Simulates a FIFO post-transform cache
+VertexCacheStats analyze_vertex_cache(core::Span<IndexedTriangle> triangles, usize vertex_count, usize cache_size = 16);
+
+// Simulates a small cache of 64 bytes lines over a vertex buffer with vertex_size bytes per vertex,
+// fetched on post-transform cache misses
+VertexFetchStats analyze_vertex_fetch(core::Span<IndexedTriangle> triangles, usize vertex_count, usize vertex_size);
+
+
+// Reorders triangles to maximize post-transform cache hits (Forsyth, "Linear-Speed Vertex Cache Optimisation")
+void optimize_vertex_cache(core::MutableSpan<IndexedTriangle> triangles, usize vertex_count);
+
+// Splits triangles in clusters that don't degrade the vertex cache efficiency by more than threshold,
+// and sorts them so that outward facing clusters are drawn first (Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw")
+void optimize_overdraw(core::MutableSpan<IndexedTriangle> triangles, core::Span<math::Vec3> positions, float threshold = 1.05f);
+
+// Reorders vertices in order of first use and rewrites indices. Returns the original index of every new vertex.
+// Unreferenced vertices are removed.
+core::Vector<u32> optimize_vertex_fetch(core::MutableSpan<IndexedTriangle> triangles, usize vertex_count);
+
+// Runs all of the above, in order, remapping every vertex stream.
+void optimize_mesh(MeshVertexStreams& streams, core::MutableSpan<IndexedTriangle> triangles);
+
+
+// Splits triangles in meshlets of at most max_meshlet_vertices vertices and max_meshlet_triangles triangles,
+// following the triangle order (which should already be optimized for vertex cache).
+void build_meshlets(MeshletData& meshlets, core::Span<IndexedTriangle> triangles, core::Span<math::Vec3> positions, u32 sub_mesh = 0);
+
+}
+
+#endif // YAVE_MESHES_MESH_OPTIMIZATION_H
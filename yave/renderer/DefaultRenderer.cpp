@@ -34,7 +34,7 @@ DefaultRenderer DefaultRenderer::create(FrameGraph& framegraph, const SceneView&
 
     DefaultRenderer renderer;
 
-    renderer.visibility     = SceneVisibilitySubPass::create(scene_view);
+    renderer.visibility     = SceneVisibilitySubPass::create(scene_view, !scene_view.scene()->gpu_culling());
     renderer.camera         = CameraBufferPass::create(framegraph, scene_view, size, settings.taa);
     renderer.gbuffer        = GBufferPass::create(framegraph, renderer.camera, renderer.visibility, size);
     renderer.ssao           = SSAOPass::create(framegraph, renderer.gbuffer, settings.ssao);
@@ -53,5 +53,12 @@ DefaultRenderer DefaultRenderer::create(FrameGraph& framegraph, const SceneView&
     return renderer;
 }
 
+void DefaultRenderer::prewarm_pipelines(const Scene& scene) {
+    y_profile();
+
+    scene.prewarm_pipelines(PassType::GBuffer, GBufferPass::render_pass_layout());
+    scene.prewarm_pipelines(PassType::Depth, ShadowMapPass::render_pass_layout());
+}
+
 }
 
@@ -60,6 +60,8 @@ struct DefaultRenderer {
                                   const SceneView& scene_view,
                                   const math::Vec2ui& size,
                                   const RendererSettings& settings = RendererSettings());
+
+    static void prewarm_pipelines(const Scene& scene);
 };
 
 }
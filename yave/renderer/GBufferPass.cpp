@@ -21,6 +21,7 @@ SOFTWARE.
 **********************************/
 
 #include "GBufferPass.h"
+#include "GpuCullingPass.h"
 
 #include <yave/framegraph/FrameGraph.h>
 #include <yave/framegraph/FrameGraphPass.h>
@@ -29,12 +30,15 @@ SOFTWARE.
 
 namespace yave {
 
+static constexpr ImageFormat depth_format = VK_FORMAT_D32_SFLOAT;
+static constexpr ImageFormat motion_format = VK_FORMAT_R16G16_SFLOAT;
+static constexpr ImageFormat color_format = VK_FORMAT_R8G8B8A8_SRGB;
+static constexpr ImageFormat normal_format = VK_FORMAT_A2R10G10B10_UNORM_PACK32;
+static constexpr ImageFormat emissive_format = VK_FORMAT_B10G11R11_UFLOAT_PACK32;
+
 GBufferPass GBufferPass::create(FrameGraph& framegraph, const CameraBufferPass& camera, const SceneVisibilitySubPass& visibility, const math::Vec2ui& size) {
-    static constexpr ImageFormat depth_format = VK_FORMAT_D32_SFLOAT;
-    static constexpr ImageFormat motion_format = VK_FORMAT_R16G16_SFLOAT;
-    static constexpr ImageFormat color_format = VK_FORMAT_R8G8B8A8_SRGB;
-    static constexpr ImageFormat normal_format = VK_FORMAT_A2R10G10B10_UNORM_PACK32;
-    static constexpr ImageFormat emissive_format = VK_FORMAT_B10G11R11_UFLOAT_PACK32;
+    const bool gpu_culling = visibility.scene_view.scene()->gpu_culling();
+    const GpuCullingPass culling = gpu_culling ? GpuCullingPass::create(framegraph, visibility.scene_view) : GpuCullingPass();
 
     FrameGraphPassBuilder builder = framegraph.add_pass("G-buffer pass");
 
@@ -50,7 +54,9 @@ GBufferPass GBufferPass::create(FrameGraph& framegraph, const CameraBufferPass&
     pass.color = color;
     pass.normal = normal;
     pass.emissive = emissive;
-    pass.scene_pass = SceneRenderSubPass::create(builder, camera, visibility, PassType::GBuffer);
+    pass.scene_pass = gpu_culling
+        ? SceneRenderSubPass::create(builder, camera, visibility, culling.draws, PassType::GBuffer)
+        : SceneRenderSubPass::create(builder, camera, visibility, PassType::GBuffer);
 
     builder.add_depth_output(depth);
     builder.add_color_output(motion);
@@ -65,5 +71,15 @@ GBufferPass GBufferPass::create(FrameGraph& framegraph, const CameraBufferPass&
     return pass;
 }
 
+RenderPass::Layout GBufferPass::render_pass_layout() {
+    const std::array colors = {
+        RenderPass::AttachmentData(motion_format, ImageUsage::ColorBit, RenderPass::LoadOp::Clear),
+        RenderPass::AttachmentData(color_format, ImageUsage::ColorBit, RenderPass::LoadOp::Clear),
+        RenderPass::AttachmentData(normal_format, ImageUsage::ColorBit, RenderPass::LoadOp::Clear),
+        RenderPass::AttachmentData(emissive_format, ImageUsage::ColorBit, RenderPass::LoadOp::Clear),
+    };
+    return RenderPass::Layout(RenderPass::AttachmentData(depth_format, ImageUsage::DepthBit, RenderPass::LoadOp::Clear), colors);
+}
+
 }
 
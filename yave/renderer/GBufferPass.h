@@ -24,6 +24,8 @@ SOFTWARE.
 
 #include "SceneRenderSubPass.h"
 
+#include <yave/graphics/framebuffer/RenderPass.h>
+
 namespace yave {
 
 struct GBufferPass {
@@ -36,6 +38,8 @@ struct GBufferPass {
     FrameGraphImageId emissive;
 
     static GBufferPass create(FrameGraph& framegraph, const CameraBufferPass& camera, const SceneVisibilitySubPass& visibility, const math::Vec2ui& size);
+
+    static RenderPass::Layout render_pass_layout();
 };
 
 }
@@ -0,0 +1,98 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include "GpuCullingPass.h"
+
+#include <yave/graphics/shaders/ComputeProgram.h>
+#include <yave/framegraph/FrameGraph.h>
+#include <yave/framegraph/FrameGraphPass.h>
+#include <yave/framegraph/FrameGraphFrameResources.h>
+#include <yave/graphics/device/DeviceResources.h>
+#include <yave/graphics/commands/CmdBufferRecorder.h>
+
+namespace yave {
+
+GpuCullingPass GpuCullingPass::create(FrameGraph& framegraph, const SceneView& scene_view) {
+    const Scene* scene = scene_view.scene();
+    const StaticMeshDrawList& draw_list = scene->static_mesh_draw_list();
+
+    GpuCullingPass pass;
+    pass.draws.runs = draw_list.runs();
+
+    const usize candidate_count = draw_list.candidate_count();
+    if(!candidate_count) {
+        return pass;
+    }
+
+    struct CullingParams {
+        std::array<math::Vec4, 5> frustum_planes;
+        u32 candidate_count;
+        u32 visibility_mask;
+    } params = {};
+
+    {
+        const Frustum frustum = scene_view.camera().frustum();
+        for(usize i = 0; i != params.frustum_planes.size(); ++i) {
+            const Frustum::Plane& plane = frustum.planes()[i];
+            // Planes are relative to the frustum position
+            params.frustum_planes[i] = math::Vec4(plane.normal, plane.offset + plane.normal.dot(frustum.position()));
+        }
+        params.candidate_count = u32(candidate_count);
+        params.visibility_mask = scene_view.visibility_mask();
+    }
+
+    FrameGraphComputePassBuilder builder = framegraph.add_compute_pass("GPU culling pass");
+
+    const auto commands = builder.declare_typed_buffer<VkDrawIndexedIndirectCommand>(candidate_count);
+    const auto counts = builder.declare_typed_buffer<u32>(pass.draws.runs->size());
+    const auto indices = builder.declare_typed_buffer<math::Vec2ui>(candidate_count);
+    const auto decode_infos = builder.declare_typed_buffer<shader::MeshDecodeInfo>(candidate_count);
+
+    // Counts need to start at zero
+    builder.map_buffer(counts);
+
+    builder.add_external_input(Descriptor(scene->transform_manager().transform_buffer()));
+    builder.add_external_input(Descriptor(draw_list.candidate_buffer()));
+    builder.add_storage_output(commands);
+    builder.add_storage_output(counts);
+    builder.add_storage_output(indices);
+    builder.add_storage_output(decode_infos);
+    builder.add_inline_input(InlineDescriptor(params));
+    builder.set_render_func([=](CmdBufferRecorder& recorder, const FrameGraphPass* self) {
+        {
+            auto mapping = self->resources().map_buffer(counts);
+            std::fill(mapping.begin(), mapping.end(), 0u);
+        }
+
+        const auto& program = device_resources()[DeviceResources::GpuCullingProgram];
+        recorder.dispatch_size(program, math::Vec2ui(u32(candidate_count), 1), self->descriptor_sets());
+    });
+
+    pass.draws.commands = commands;
+    pass.draws.counts = counts;
+    pass.draws.indices = indices;
+    pass.draws.decode_infos = decode_infos;
+
+    return pass;
+}
+
+}
@@ -32,10 +32,10 @@ SOFTWARE.
 
 namespace yave {
 
-IdBufferPass IdBufferPass::create(FrameGraph& framegraph, const CameraBufferPass& camera, const SceneVisibilitySubPass& visibility, const math::Vec2ui& size) {
-    static constexpr ImageFormat depth_format = VK_FORMAT_D32_SFLOAT;
-    static constexpr ImageFormat id_format = VK_FORMAT_R32_UINT;
+static constexpr ImageFormat depth_format = VK_FORMAT_D32_SFLOAT;
+static constexpr ImageFormat id_format = VK_FORMAT_R32_UINT;
 
+IdBufferPass IdBufferPass::create(FrameGraph& framegraph, const CameraBufferPass& camera, const SceneVisibilitySubPass& visibility, const math::Vec2ui& size) {
     FrameGraphPassBuilder builder = framegraph.add_pass("Id-buffer pass");
 
     const auto depth = builder.declare_image(depth_format, size);
@@ -56,5 +56,12 @@ IdBufferPass IdBufferPass::create(FrameGraph& framegraph, const CameraBufferPass
     return pass;
 }
 
+RenderPass::Layout IdBufferPass::render_pass_layout() {
+    const std::array colors = {
+        RenderPass::AttachmentData(id_format, ImageUsage::ColorBit, RenderPass::LoadOp::Clear),
+    };
+    return RenderPass::Layout(RenderPass::AttachmentData(depth_format, ImageUsage::DepthBit, RenderPass::LoadOp::Clear), colors);
+}
+
 }
 
@@ -33,6 +33,8 @@ struct IdBufferPass {
     FrameGraphImageId id;
 
     static IdBufferPass create(FrameGraph& framegraph, const CameraBufferPass& camera, const SceneVisibilitySubPass& visibility, const math::Vec2ui& size);
+
+    static RenderPass::Layout render_pass_layout();
 };
 
 }
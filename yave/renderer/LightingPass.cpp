@@ -27,6 +27,7 @@ SOFTWARE.
 #include <yave/framegraph/FrameGraphFrameResources.h>
 #include <yave/graphics/device/DeviceResources.h>
 #include <yave/graphics/commands/CmdBufferRecorder.h>
+#include <yave/graphics/descriptors/TransientDescriptorSet.h>
 
 #include <yave/scene/Scene.h>
 #include <yave/meshes/StaticMesh.h>
@@ -289,7 +290,7 @@ static void local_lights_pass_compute(FrameGraph& framegraph,
             const auto& program = device_resources()[debug_tiles ? DeviceResources::DeferredLocalsDebugProgram : DeviceResources::DeferredLocalsProgram];
 
             const math::Vec2ui light_count(point_count, spot_count);
-            const auto light_count_set = DescriptorSet(InlineDescriptor(light_count));
+            const auto light_count_set = TransientDescriptorSet(recorder, InlineDescriptor(light_count));
             const std::array<DescriptorSetBase, 2> descriptor_sets = {self->descriptor_sets()[0], light_count_set};
             recorder.dispatch_size(program, size, descriptor_sets);
         }
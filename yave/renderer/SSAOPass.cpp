@@ -123,6 +123,7 @@ static FrameGraphImageId compute_linear_depth(FrameGraph& framegraph, const GBuf
     builder.add_uniform_input(gbuffer.depth);
     builder.add_uniform_input(gbuffer.scene_pass.camera);
     builder.add_storage_output(linear_depth);
+    builder.allow_async_compute();
     builder.set_render_func([=](CmdBufferRecorder& recorder, const FrameGraphPass* self) {
         const auto& program = device_resources()[DeviceResources::LinearizeDepthProgram];
         recorder.dispatch_size(program, size, self->descriptor_sets());
@@ -181,6 +182,7 @@ static FrameGraphImageId compute_mini_ao(FrameGraph& framegraph, FrameGraphImage
     builder.add_uniform_input(linear_depth);
     builder.add_storage_output(ao);
     builder.add_inline_input(InlineDescriptor(compute_ao_params(tan_half_fov, size.x())));
+    builder.allow_async_compute();
     builder.set_render_func([=](CmdBufferRecorder& recorder, const FrameGraphPass* self) {
         const auto& program = device_resources()[DeviceResources::SSAOProgram];
         recorder.dispatch_size(program, size, self->descriptor_sets());
@@ -35,13 +35,16 @@ SOFTWARE.
 
 namespace yave {
 
-static void fill_scene_render_pass(SceneRenderSubPass& pass, FrameGraphPassBuilder& builder, PassType pass_type) {
-    pass.render_func = pass.scene_view.scene()->prepare_render(builder, *pass.visibility.visible, pass_type);
-
+static void add_camera_input(SceneRenderSubPass& pass, FrameGraphPassBuilder& builder) {
     pass.main_descriptor_set_index = builder.next_descriptor_set_index();
     builder.add_uniform_input(pass.camera, PipelineStage::None, pass.main_descriptor_set_index);
 }
 
+static void fill_scene_render_pass(SceneRenderSubPass& pass, FrameGraphPassBuilder& builder, PassType pass_type) {
+    pass.render_func = pass.scene_view.scene()->prepare_render(builder, *pass.visibility.visible, pass_type);
+    add_camera_input(pass, builder);
+}
+
 
 SceneRenderSubPass SceneRenderSubPass::create(FrameGraphPassBuilder& builder, const SceneView& scene_view, const SceneVisibilitySubPass& visibility, PassType pass_type) {
     const auto camera = builder.declare_typed_buffer<shader::Camera>();
@@ -68,6 +71,18 @@ SceneRenderSubPass SceneRenderSubPass::create(FrameGraphPassBuilder& builder, co
     return pass;
 }
 
+SceneRenderSubPass SceneRenderSubPass::create(FrameGraphPassBuilder& builder, const CameraBufferPass& camera, const SceneVisibilitySubPass& visibility, const CulledStaticMeshDraws& draws, PassType pass_type) {
+    SceneRenderSubPass pass;
+    pass.scene_view = camera.view;
+    pass.camera = camera.camera;
+    pass.visibility = visibility;
+
+    pass.render_func = pass.scene_view.scene()->prepare_render(builder, draws, pass_type);
+    add_camera_input(pass, builder);
+
+    return pass;
+}
+
 void SceneRenderSubPass::render(RenderPassRecorder& render_pass, const FrameGraphPass* pass) const {
     render_pass.set_main_descriptor_set(pass->descriptor_sets()[main_descriptor_set_index]);
 
@@ -24,6 +24,7 @@ SOFTWARE.
 
 #include <yave/scene/Scene.h>
 #include <yave/scene/SceneView.h>
+#include <yave/scene/StaticMeshDrawList.h>
 #include <yave/framegraph/FrameGraphResourceId.h>
 
 #include "SceneVisibilitySubPass.h"
@@ -43,6 +44,9 @@ struct SceneRenderSubPass {
     static SceneRenderSubPass create(FrameGraphPassBuilder& builder, const SceneView& scene_view, const SceneVisibilitySubPass& visibility, PassType pass_type);
     static SceneRenderSubPass create(FrameGraphPassBuilder& builder, const CameraBufferPass& camera, const SceneVisibilitySubPass& visibility, PassType pass_type);
 
+    // Static meshes are drawn from the output of a GPU culling pass, visibility is only kept for the other users of the pass
+    static SceneRenderSubPass create(FrameGraphPassBuilder& builder, const CameraBufferPass& camera, const SceneVisibilitySubPass& visibility, const CulledStaticMeshDraws& draws, PassType pass_type);
+
     void render(RenderPassRecorder& render_pass, const FrameGraphPass* pass) const;
 };
 
@@ -24,14 +24,17 @@ SOFTWARE.
 
 namespace yave {
 
-SceneVisibilitySubPass SceneVisibilitySubPass::create(const SceneView& scene_view) {
+SceneVisibilitySubPass SceneVisibilitySubPass::create(const SceneView& scene_view, bool gather_meshes) {
     const Scene* scene = scene_view.scene();
 
     SceneVisibilitySubPass pass;
     pass.scene_view = scene_view;
     pass.visible = std::make_shared<SceneVisibility>();
+    pass.visible->has_meshes = gather_meshes;
 
-    scene->gather_visible(pass.visible->meshes, scene->meshes(), scene_view.camera(), scene_view.visibility_mask());
+    if(gather_meshes) {
+        scene->gather_visible(pass.visible->meshes, scene->meshes(), scene_view.camera(), scene_view.visibility_mask());
+    }
     scene->gather_visible(pass.visible->point_lights, scene->point_lights(), scene_view.camera(), scene_view.visibility_mask());
     scene->gather_visible(pass.visible->spot_lights, scene->spot_lights(), scene_view.camera(), scene_view.visibility_mask());
 
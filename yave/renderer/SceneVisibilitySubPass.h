@@ -31,7 +31,8 @@ struct SceneVisibilitySubPass {
     SceneView scene_view;
     std::shared_ptr<SceneVisibility> visible;
 
-    static SceneVisibilitySubPass create(const SceneView& scene_view);
+    // Meshes can be skipped if they are drawn through the GPU culling path, so the cost doesn't scale with the mesh count
+    static SceneVisibilitySubPass create(const SceneView& scene_view, bool gather_meshes = true);
 };
 
 }
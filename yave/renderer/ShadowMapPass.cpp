@@ -113,6 +113,8 @@ static SubPass create_sub_pass(FrameGraphPassBuilder& builder,
     };
 }
 
+static constexpr ImageFormat shadow_format = VK_FORMAT_D32_SFLOAT;
+
 static math::Matrix4<> flip_for_backfaces(math::Matrix4<> proj) {
     proj[0] = -proj[0];
     return proj;
@@ -223,8 +225,6 @@ ShadowMapPass ShadowMapPass::create(FrameGraph& framegraph, const SceneView& sce
 
     const auto region = framegraph.region("Shadows");
 
-    static constexpr ImageFormat shadow_format = VK_FORMAT_D32_SFLOAT;
-
     FrameGraphPassBuilder builder = framegraph.add_pass("Shadow pass");
 
     const u32 shadow_map_log_size = log2ui(settings.shadow_map_size);
@@ -299,17 +299,24 @@ ShadowMapPass ShadowMapPass::create(FrameGraph& framegraph, const SceneView& sce
         auto shadow_infos = self->resources().map_buffer(shadow_buffer);
 
         for(usize i = 0; i != passes.size(); ++i) {
-            const auto& pass = passes[i];
-            shadow_infos[i] = pass.info;
-
-            render_pass.set_viewport(Viewport(math::Vec2(float(pass.viewport_size)), pass.viewport_offset));
-            pass.scene_pass.render(render_pass, self);
+            shadow_infos[i] = passes[i].info;
         }
+
+        // Each shadow map gets its own command buffer
+        render_pass.record_parallel(passes.size(), [&](RenderPassRecorder& recorder, usize i) {
+            const auto& pass = passes[i];
+            recorder.set_viewport(Viewport(math::Vec2(float(pass.viewport_size)), pass.viewport_offset));
+            pass.scene_pass.render(recorder, self);
+        });
     });
 
 
     return pass;
 }
 
+RenderPass::Layout ShadowMapPass::render_pass_layout() {
+    return RenderPass::Layout(RenderPass::AttachmentData(shadow_format, ImageUsage::DepthBit, RenderPass::LoadOp::Clear), {});
+}
+
 }
 
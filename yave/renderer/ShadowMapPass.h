@@ -46,6 +46,8 @@ struct ShadowMapPass {
     std::shared_ptr<core::FlatHashMap<const void*, math::Vec4ui>> shadow_indices;
 
     static ShadowMapPass create(FrameGraph& framegraph, const SceneView& scene, const ShadowMapSettings& settings = ShadowMapSettings());
+
+    static RenderPass::Layout render_pass_layout();
 };
 
 
@@ -21,6 +21,7 @@ SOFTWARE.
 **********************************/
 
 #include "EcsScene.h"
+#include "StaticMeshDrawList.h"
 
 #include <yave/components/TransformableComponent.h>
 #include <yave/components/StaticMeshComponent.h>
@@ -76,7 +77,7 @@ typename S::value_type EcsScene::unregister_object(const ecs::EntityId id, u32 O
 }
 
 template<typename T, typename S>
-void EcsScene::process_component_visibility(u32 ObjectIndices::* index_ptr, S& storage) {
+bool EcsScene::process_component_visibility(u32 ObjectIndices::* index_ptr, S& storage) {
     y_profile();
 
     auto update_visibility = [&](ecs::EntityId id, u32 mask) {
@@ -96,12 +97,16 @@ void EcsScene::process_component_visibility(u32 ObjectIndices::* index_ptr, S& s
     for(const ecs::EntityId id : group_base->removed_ids()) {
         update_visibility(id, u32(-1));
     }
+
+    return !group_base->added_ids().is_empty() || !group_base->removed_ids().is_empty();
 }
 
 template<typename T, typename S>
-void EcsScene::process_transformable_components(u32 ObjectIndices::* index_ptr, S& storage) {
+bool EcsScene::process_transformable_components(u32 ObjectIndices::* index_ptr, S& storage) {
     y_profile();
 
+    bool changed = false;
+
     auto update_transform = [this](auto& obj, const TransformableComponent& tr, const auto& comp) {
         if(!obj.has_transform()) {
             obj.transform_index = _transform_manager.alloc_transform();
@@ -119,6 +124,7 @@ void EcsScene::process_transformable_components(u32 ObjectIndices::* index_ptr,
         y_profile_zone("Add new objects");
         for(const ecs::EntityId id : group_base->added_ids()) {
             register_object(id, index_ptr, storage);
+            changed = true;
         }
     }
 
@@ -131,6 +137,7 @@ void EcsScene::process_transformable_components(u32 ObjectIndices::* index_ptr,
             obj.component = comp;
             // We need to update in case the AABB has changed
             update_transform(obj, tr, comp);
+            changed = true;
         }
     }
 
@@ -149,10 +156,12 @@ void EcsScene::process_transformable_components(u32 ObjectIndices::* index_ptr,
             if(const u32 transform_index = unregister_object(id, index_ptr, storage).transform_index; transform_index == u32(-1)) {
                 _transform_manager.free_transform(transform_index);
             }
+            changed = true;
         }
     }
 
-    process_component_visibility<T>(index_ptr, storage);
+    const bool visibility_changed = process_component_visibility<T>(index_ptr, storage);
+    return changed || visibility_changed;
 }
 
 
@@ -249,7 +258,9 @@ void EcsScene::update_from_world() {
 
     y_debug_assert(_world);
 
-    process_transformable_components<StaticMeshComponent>(&ObjectIndices::mesh, _meshes);
+    if(process_transformable_components<StaticMeshComponent>(&ObjectIndices::mesh, _meshes)) {
+        _static_mesh_draws->set_dirty();
+    }
     process_transformable_components<PointLightComponent>(&ObjectIndices::point_light, _point_lights);
     process_transformable_components<SpotLightComponent>(&ObjectIndices::spot_light, _spot_lights);
     process_components<DirectionalLightComponent>(&ObjectIndices::directional_light, _directionals);
@@ -258,9 +269,13 @@ void EcsScene::update_from_world() {
     process_atmosphere();
 
 
-    if(_transform_manager.need_update()) {
+    const bool update_draw_list = _gpu_culling && _static_mesh_draws->is_dirty();
+    if(_transform_manager.need_update() || update_draw_list) {
         ComputeCmdBufferRecorder recorder = create_disposable_compute_cmd_buffer();
         _transform_manager.update_buffer(recorder);
+        if(update_draw_list) {
+            _static_mesh_draws->rebuild(_meshes, recorder);
+        }
         recorder.submit_async();
     }
 
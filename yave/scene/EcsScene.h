@@ -57,11 +57,12 @@ class EcsScene : public Scene {
         template<typename S>
         typename S::value_type unregister_object(const ecs::EntityId id, u32 ObjectIndices::* index_ptr, S& storage);
 
+        // Returns true if objects have been added, removed, or had their component or visibility changed
         template<typename T, typename S>
-        void process_component_visibility(u32 ObjectIndices::* index_ptr, S& storage);
+        bool process_component_visibility(u32 ObjectIndices::* index_ptr, S& storage);
 
         template<typename T, typename S>
-        void process_transformable_components(u32 ObjectIndices::* index_ptr, S& storage);
+        bool process_transformable_components(u32 ObjectIndices::* index_ptr, S& storage);
 
         template<typename T, typename S>
         void process_components(u32 ObjectIndices::* index_ptr, S& storage);
@@ -21,12 +21,15 @@ SOFTWARE.
 **********************************/
 
 #include "Scene.h"
+#include "StaticMeshDrawList.h"
 
 #include <yave/camera/Camera.h>
+#include <yave/graphics/device/DeviceProperties.h>
+#include <yave/graphics/graphics.h>
 
 namespace yave {
 
-Scene::Scene() {
+Scene::Scene() : _static_mesh_draws(std::make_unique<StaticMeshDrawList>()) {
 }
 
 Scene::~Scene() {
@@ -40,6 +43,30 @@ const math::Transform<>& Scene::transform(const TransformableSceneObjectData& ob
     return _transform_manager.transform(obj.transform_index);
 }
 
+void Scene::set_async_pipelines(bool enabled) {
+    _async_pipelines = enabled;
+}
+
+bool Scene::async_pipelines() const {
+    return _async_pipelines;
+}
+
+void Scene::set_gpu_culling(bool enabled) {
+    enabled = enabled && device_properties().draw_indirect_count;
+    if(enabled && !_gpu_culling) {
+        _static_mesh_draws->set_dirty();
+    }
+    _gpu_culling = enabled;
+}
+
+bool Scene::gpu_culling() const {
+    return _gpu_culling;
+}
+
+const StaticMeshDrawList& Scene::static_mesh_draw_list() const {
+    return *_static_mesh_draws;
+}
+
 
 }
 
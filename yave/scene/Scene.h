@@ -32,11 +32,15 @@ SOFTWARE.
 #include <yave/components/AtmosphereComponent.h>
 
 #include <yave/camera/Camera.h>
+#include <yave/graphics/framebuffer/RenderPass.h>
 
 #include <functional>
 
 namespace yave {
 
+class StaticMeshDrawList;
+struct CulledStaticMeshDraws;
+
 enum class PassType {
     Depth,
     GBuffer,
@@ -93,6 +97,22 @@ class Scene : NonMovable {
 
         RenderFunc prepare_render(FrameGraphPassBuilder& builder, const SceneVisibility& visibility, PassType pass_type) const;
 
+        // Draws the output of a GPU culling pass, Id passes are not supported
+        RenderFunc prepare_render(FrameGraphPassBuilder& builder, const CulledStaticMeshDraws& draws, PassType pass_type) const;
+
+        // Schedules background compilation of every pipeline needed to draw the scene's meshes in a pass
+        void prewarm_pipelines(PassType pass_type, const RenderPass::Layout& layout) const;
+
+        // When enabled, meshes whose pipeline is still being compiled are skipped instead of stalling the frame
+        void set_async_pipelines(bool enabled);
+        bool async_pipelines() const;
+
+        // When enabled, static meshes are culled on the GPU. Ignored if the device does not support indirect draw counts
+        void set_gpu_culling(bool enabled);
+        bool gpu_culling() const;
+
+        const StaticMeshDrawList& static_mesh_draw_list() const;
+
 
 
         core::Span<StaticMeshObject>        meshes() const          { return _meshes; }
@@ -132,6 +152,10 @@ class Scene : NonMovable {
         std::unique_ptr<AtmosphereObject> _atmosphere;
 
         TransformManager _transform_manager;
+        std::unique_ptr<StaticMeshDrawList> _static_mesh_draws;
+
+        bool _async_pipelines = false;
+        bool _gpu_culling = false;
 };
 
 }
@@ -30,6 +30,9 @@ struct SceneVisibility {
     core::Vector<const StaticMeshObject*> meshes;
     core::Vector<const PointLightObject*> point_lights;
     core::Vector<const SpotLightObject*> spot_lights;
+
+    // False when static meshes are culled on the GPU instead, in which case meshes is empty
+    bool has_meshes = true;
 };
 
 
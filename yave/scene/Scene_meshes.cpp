@@ -22,9 +22,11 @@ SOFTWARE.
 
 #include "Scene.h"
 #include "SceneVisibility.h"
+#include "StaticMeshDrawList.h"
 
 #include <yave/meshes/StaticMesh.h>
 #include <yave/material/Material.h>
+#include <yave/material/MaterialTemplate.h>
 
 #include <yave/graphics/device/DeviceResources.h>
 #include <yave/graphics/device/MeshAllocator.h>
@@ -36,14 +38,29 @@ SOFTWARE.
 #include <yave/framegraph/FrameGraphFrameResources.h>
 #include <yave/framegraph/FrameGraphPass.h>
 
+#include <y/core/ScratchPad.h>
+
 namespace yave {
 
+// Draw runs are split into at most this many secondary command buffers
+static constexpr usize max_recording_chunks = 8;
+static constexpr usize min_runs_per_chunk = 32;
+
 struct StaticMeshBatch {
     const MaterialTemplate* material_template = nullptr;
     VkDrawIndexedIndirectCommand cmd = {};
     math::Vec2ui indices;
+    const MeshDrawData* draw_data = nullptr;
+
+    MeshVertexFormat vertex_format() const {
+        return draw_data->mesh_buffers().vertex_format();
+    }
 };
 
+static bool is_same_run(const StaticMeshBatch& a, const StaticMeshBatch& b) {
+    return a.material_template == b.material_template && a.vertex_format() == b.vertex_format();
+}
+
 
 static void collect_batches(core::Span<const StaticMeshObject*> meshes, core::Vector<StaticMeshBatch>& batches) {
     y_profile();
@@ -63,7 +80,8 @@ static void collect_batches(core::Span<const StaticMeshObject*> meshes, core::Ve
                 batches.emplace_back(
                     mat->material_template(),
                     static_mesh->draw_command().vk_indirect_data(),
-                    math::Vec2ui(transform_index, mat->draw_data().index())
+                    math::Vec2ui(transform_index, mat->draw_data().index()),
+                    &static_mesh->draw_data()
                 );
             }
         } else {
@@ -72,7 +90,8 @@ static void collect_batches(core::Span<const StaticMeshObject*> meshes, core::Ve
                     batches.emplace_back(
                         mat->material_template(),
                         static_mesh->sub_meshes()[i].vk_indirect_data(),
-                        math::Vec2ui(transform_index, mat->draw_data().index())
+                        math::Vec2ui(transform_index, mat->draw_data().index()),
+                        &static_mesh->draw_data()
                     );
                 }
             }
@@ -81,14 +100,15 @@ static void collect_batches(core::Span<const StaticMeshObject*> meshes, core::Ve
 
     {
         y_profile_zone("sort batches");
-        std::sort(batches.begin(), batches.end(), [](const StaticMeshBatch& a, const StaticMeshBatch& b) { return a.material_template < b.material_template; });
+        std::sort(batches.begin(), batches.end(), [](const StaticMeshBatch& a, const StaticMeshBatch& b) {
+            return std::tuple(a.vertex_format(), a.material_template) < std::tuple(b.vertex_format(), b.material_template);
+        });
     }
 }
 
 static void collect_batches_for_id(core::Span<const StaticMeshObject*> meshes, core::Vector<StaticMeshBatch>& batches) {
     y_profile();
 
-    u32 index = 0;
     for(const StaticMeshObject* mesh : meshes) {
         const u32 transform_index = mesh->transform_index;
 
@@ -99,11 +119,15 @@ static void collect_batches_for_id(core::Span<const StaticMeshObject*> meshes, c
 
         batches.emplace_back(
             nullptr,
-            static_mesh->draw_command().vk_indirect_data(index),
-            math::Vec2ui(transform_index, mesh->entity_index)
+            static_mesh->draw_command().vk_indirect_data(),
+            math::Vec2ui(transform_index, mesh->entity_index),
+            &static_mesh->draw_data()
         );
+    }
 
-        ++index;
+    {
+        y_profile_zone("sort batches");
+        std::sort(batches.begin(), batches.end(), [](const StaticMeshBatch& a, const StaticMeshBatch& b) { return a.vertex_format() < b.vertex_format(); });
     }
 }
 
@@ -146,75 +170,180 @@ Scene::RenderFunc Scene::prepare_render(FrameGraphPassBuilder& builder, const Sc
     const auto indirect_buffer = builder.declare_typed_buffer<VkDrawIndexedIndirectCommand>(batch_count);
     builder.map_buffer(indirect_buffer);
 
+    const auto decode_infos_buffer = builder.declare_typed_buffer<MeshDecodeInfo>(batch_count);
+    builder.map_buffer(decode_infos_buffer);
+
     builder.add_external_input(Descriptor(_transform_manager.transform_buffer()), stage, descriptor_set_index);
     builder.add_external_input(Descriptor(material_allocator().material_buffer()), stage, descriptor_set_index);
     builder.add_storage_input(indices_buffer, stage, descriptor_set_index);
+    builder.add_storage_input(decode_infos_buffer, stage, descriptor_set_index);
     builder.add_indrect_input(indirect_buffer);
 
 
 
 
-    return [=](RenderPassRecorder& render_pass, const FrameGraphPass* pass) {
+    return [=, async_pipelines = _async_pipelines](RenderPassRecorder& render_pass, const FrameGraphPass* pass) {
         y_debug_assert(!static_mesh_batches->is_empty());
 
         const core::Span<StaticMeshBatch> batches = *static_mesh_batches;
 
-        const DescriptorSet& pass_set = pass->descriptor_sets()[descriptor_set_index];
+        const DescriptorSetBase& pass_set = pass->descriptor_sets()[descriptor_set_index];
         const IndirectSubBuffer buffer = pass->resources().buffer<BufferUsage::IndirectBit>(indirect_buffer);
 
         auto indirect_mapping = pass->resources().map_buffer(indirect_buffer);
         auto indices_mapping = pass->resources().map_buffer(indices_buffer);
+        auto decode_infos_mapping = pass->resources().map_buffer(decode_infos_buffer);
 
-        render_pass.bind_mesh_buffers(mesh_allocator().mesh_buffers());
+        for(usize i = 0; i != batches.size(); ++i) {
+            const StaticMeshBatch& batch = batches[i];
 
-        switch(pass_type) {
-            case PassType::Depth:
-            case PassType::GBuffer: {
-                const std::array<DescriptorSetBase, 2> desc_sets = {pass_set, texture_library().descriptor_set()};
-
-                usize start_of_batch = 0;
-                const MaterialTemplate* prev_template = batches[0].material_template;
-                auto push_batch = [&](const MaterialTemplate* material_template, usize index) {
-                    if(prev_template == material_template) {
-                        return;
-                    }
+            indirect_mapping[i] = batch.cmd;
+            indirect_mapping[i].firstInstance = u32(i);
+            indices_mapping[i] = batch.indices;
+            decode_infos_mapping[i] = batch.draw_data->decode_info();
+        }
 
-                    if(const usize batch_size = index - start_of_batch) {
-                        if(prev_template) {
-                            render_pass.bind_material_template(prev_template, desc_sets, true);
-                            render_pass.draw_indirect(IndirectSubBuffer(buffer, batch_size, start_of_batch));
-                        }
+        const std::array<DescriptorSetBase, 2> desc_sets = {pass_set, texture_library().descriptor_set()};
+        const MaterialTemplate* id_template = device_resources()[DeviceResources::IdMaterialTemplate];
 
-                        start_of_batch = index;
-                    }
+        const auto bind_material_template = [&](RenderPassRecorder& recorder, const MaterialTemplate* material_template, core::Span<DescriptorSetBase> sets, MeshVertexFormat vertex_format) {
+            if(async_pipelines) {
+                return recorder.try_bind_material_template(material_template, sets, true, vertex_format);
+            }
+            recorder.bind_material_template(material_template, sets, true, vertex_format);
+            return true;
+        };
+
+        // Batches are sorted by vertex format first, so each format is bound only once
+        core::ScratchVector<std::pair<usize, usize>> runs(batches.size());
+        {
+            usize start_of_batch = 0;
+            for(usize i = 1; i <= batches.size(); ++i) {
+                const StaticMeshBatch& first = batches[start_of_batch];
+                const bool end_of_run = (i == batches.size()) || (pass_type == PassType::Id
+                    ? first.vertex_format() != batches[i].vertex_format()
+                    : !is_same_run(first, batches[i]));
+
+                if(end_of_run) {
+                    runs.emplace_back(start_of_batch, i);
+                    start_of_batch = i;
+                }
+            }
+        }
+
+        // Small scenes are not worth the extra secondary command buffers
+        const usize chunk_count = std::clamp(runs.size() / min_runs_per_chunk, usize(1), max_recording_chunks);
+        const usize runs_per_chunk = (runs.size() + chunk_count - 1) / chunk_count;
 
-                    prev_template = material_template;
-                };
+        render_pass.record_parallel(chunk_count, [&](RenderPassRecorder& recorder, usize chunk) {
+            const usize chunk_end = std::min(runs.size(), (chunk + 1) * runs_per_chunk);
+            for(usize r = chunk * runs_per_chunk; r < chunk_end; ++r) {
+                const auto [start_of_batch, end_of_batch] = runs[r];
+                const StaticMeshBatch& first = batches[start_of_batch];
 
-                for(usize i = 0; i != batches.size(); ++i) {
-                    StaticMeshBatch batch = batches[i];
-                    batch.cmd.firstInstance = u32(i);
+                const MeshVertexFormat vertex_format = first.vertex_format();
+                recorder.bind_mesh_buffers(mesh_allocator().mesh_buffers(vertex_format));
 
-                    indirect_mapping[i] = batch.cmd;
-                    indices_mapping[i] = batch.indices;
+                const bool bound = pass_type == PassType::Id
+                    ? bind_material_template(recorder, id_template, pass_set, vertex_format)
+                    : bind_material_template(recorder, first.material_template, desc_sets, vertex_format);
 
-                    push_batch(batch.material_template, i);
+                // Pipeline is still compiling, the run will show up in a later frame
+                if(bound) {
+                    recorder.draw_indirect(IndirectSubBuffer(buffer, end_of_batch - start_of_batch, start_of_batch));
                 }
-                push_batch(nullptr, batches.size());
-            } break;
-
-            case PassType::Id: {
-                for(usize i = 0; i != batches.size(); ++i) {
-                    const StaticMeshBatch& batch = batches[i];
-                    indirect_mapping[i] = batch.cmd;
-                    indices_mapping[i] = batch.indices;
+            }
+        });
+    };
+}
+
+Scene::RenderFunc Scene::prepare_render(FrameGraphPassBuilder& builder, const CulledStaticMeshDraws& draws, PassType pass_type) const {
+    y_profile();
+
+    y_debug_assert(pass_type != PassType::Id);
+
+    if(!draws.runs || draws.runs->is_empty()) {
+        return {};
+    }
+
+    static const PipelineStage stage = PipelineStage::VertexBit | PipelineStage::FragmentBit;
+    const i32 descriptor_set_index = builder.next_descriptor_set_index();
+
+    builder.add_external_input(Descriptor(_transform_manager.transform_buffer()), stage, descriptor_set_index);
+    builder.add_external_input(Descriptor(material_allocator().material_buffer()), stage, descriptor_set_index);
+    builder.add_storage_input(draws.indices, stage, descriptor_set_index);
+    builder.add_storage_input(draws.decode_infos, stage, descriptor_set_index);
+    builder.add_indrect_input(draws.commands);
+    builder.add_indrect_input(draws.counts);
+
+    const auto commands_buffer = draws.commands;
+    const auto counts_buffer = draws.counts;
+    const auto runs = draws.runs;
+
+    return [=, async_pipelines = _async_pipelines](RenderPassRecorder& render_pass, const FrameGraphPass* pass) {
+        const DescriptorSetBase& pass_set = pass->descriptor_sets()[descriptor_set_index];
+        const IndirectSubBuffer commands = pass->resources().buffer<BufferUsage::IndirectBit>(commands_buffer);
+        const TypedSubBuffer<u32, BufferUsage::IndirectBit> counts = pass->resources().buffer<BufferUsage::IndirectBit>(counts_buffer);
+
+        const std::array<DescriptorSetBase, 2> desc_sets = {pass_set, texture_library().descriptor_set()};
+
+        // Unlike the CPU path, every run is recorded since we don't know which ones are empty
+        const usize chunk_count = std::clamp(runs->size() / min_runs_per_chunk, usize(1), max_recording_chunks);
+        const usize runs_per_chunk = (runs->size() + chunk_count - 1) / chunk_count;
+
+        render_pass.record_parallel(chunk_count, [&](RenderPassRecorder& recorder, usize chunk) {
+            const usize chunk_end = std::min(runs->size(), (chunk + 1) * runs_per_chunk);
+            for(usize r = chunk * runs_per_chunk; r < chunk_end; ++r) {
+                const StaticMeshDrawList::Run& run = (*runs)[r];
+
+                recorder.bind_mesh_buffers(mesh_allocator().mesh_buffers(run.vertex_format));
+
+                if(async_pipelines) {
+                    if(!recorder.try_bind_material_template(run.material_template, desc_sets, true, run.vertex_format)) {
+                        continue;
+                    }
+                } else {
+                    recorder.bind_material_template(run.material_template, desc_sets, true, run.vertex_format);
                 }
-                render_pass.bind_material_template(device_resources()[DeviceResources::IdMaterialTemplate], pass_set, true);
-                render_pass.draw_indirect(buffer);
-            } break;
-        }
+
+                recorder.draw_indirect_count(IndirectSubBuffer(commands, run.size, run.offset), TypedSubBuffer<u32, BufferUsage::IndirectBit>(counts, 1, r));
+            }
+        });
     };
 }
 
+void Scene::prewarm_pipelines(PassType pass_type, const RenderPass::Layout& layout) const {
+    y_profile();
+
+    const MaterialTemplate* id_template = device_resources()[DeviceResources::IdMaterialTemplate];
+
+    core::Vector<std::pair<const MaterialTemplate*, MeshVertexFormat>> pipelines;
+    for(const StaticMeshObject& mesh : _meshes) {
+        const StaticMesh* static_mesh = mesh.component.mesh().get();
+        if(!static_mesh) {
+            continue;
+        }
+
+        const MeshVertexFormat vertex_format = static_mesh->draw_data().mesh_buffers().vertex_format();
+        if(pass_type == PassType::Id) {
+            pipelines.emplace_back(id_template, vertex_format);
+            continue;
+        }
+
+        for(const auto& material : mesh.component.materials()) {
+            if(const Material* mat = material.get()) {
+                pipelines.emplace_back(mat->material_template(), vertex_format);
+            }
+        }
+    }
+
+    std::sort(pipelines.begin(), pipelines.end());
+    const auto end = std::unique(pipelines.begin(), pipelines.end());
+
+    for(auto it = pipelines.begin(); it != end; ++it) {
+        it->first->prewarm(layout, it->second);
+    }
+}
+
 }
 
@@ -0,0 +1,165 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include "StaticMeshDrawList.h"
+
+#include <yave/meshes/StaticMesh.h>
+#include <yave/material/Material.h>
+#include <yave/material/MaterialTemplate.h>
+
+#include <yave/graphics/buffers/BufferMapping.h>
+#include <yave/graphics/barriers/Barrier.h>
+#include <yave/graphics/commands/CmdBufferRecorder.h>
+
+#include <y/utils/sort.h>
+
+namespace yave {
+
+struct DrawCandidate {
+    const MaterialTemplate* material_template = nullptr;
+    MeshVertexFormat vertex_format = MeshVertexFormat::Full;
+    shader::MeshDrawCandidate data;
+};
+
+static shader::MeshDrawCandidate create_candidate(const StaticMeshObject& mesh, const MeshDrawCommand& command, const Material* material) {
+    const VkDrawIndexedIndirectCommand cmd = command.vk_indirect_data();
+    const MeshDecodeInfo& decode_info = mesh.component.mesh()->draw_data().decode_info();
+    const AABB aabb = mesh.component.aabb();
+
+    shader::MeshDrawCandidate candidate = {};
+    candidate.aabb_center = aabb.center();
+    candidate.aabb_half_extent = aabb.half_extent();
+    candidate.transform_index = mesh.transform_index;
+    candidate.material_index = material->draw_data().index();
+    candidate.index_count = cmd.indexCount;
+    candidate.first_index = cmd.firstIndex;
+    candidate.vertex_offset = cmd.vertexOffset;
+    candidate.visibility_mask = mesh.visibility_mask;
+
+    static_assert(sizeof(candidate.decode_info) == sizeof(decode_info));
+    std::memcpy(&candidate.decode_info, &decode_info, sizeof(decode_info));
+
+    return candidate;
+}
+
+void StaticMeshDrawList::set_dirty() {
+    _dirty = true;
+}
+
+bool StaticMeshDrawList::is_dirty() const {
+    return _dirty;
+}
+
+void StaticMeshDrawList::rebuild(core::Span<StaticMeshObject> meshes, ComputeCapableCmdBufferRecorder& recorder) {
+    y_profile();
+
+    bool complete = true;
+
+    core::Vector<DrawCandidate> candidates;
+    candidates.set_min_capacity(meshes.size());
+    for(const StaticMeshObject& mesh : meshes) {
+        const AssetPtr<StaticMesh>& static_mesh = mesh.component.mesh();
+        if(static_mesh.is_loading()) {
+            complete = false;
+        }
+
+        if(!static_mesh || !mesh.has_transform()) {
+            continue;
+        }
+
+        const core::Span materials = mesh.component.materials();
+        for(usize i = 0; i != materials.size(); ++i) {
+            if(materials[i].is_loading()) {
+                complete = false;
+            }
+
+            if(const Material* mat = materials[i].get()) {
+                const MeshDrawCommand& command = materials.size() == 1 ? static_mesh->draw_command() : static_mesh->sub_meshes()[i];
+                candidates.emplace_back(
+                    mat->material_template(),
+                    static_mesh->draw_data().mesh_buffers().vertex_format(),
+                    create_candidate(mesh, command, mat)
+                );
+            }
+        }
+    }
+
+    {
+        y_profile_zone("sort candidates");
+        std::sort(candidates.begin(), candidates.end(), [](const DrawCandidate& a, const DrawCandidate& b) {
+            return std::tuple(a.vertex_format, a.material_template) < std::tuple(b.vertex_format, b.material_template);
+        });
+    }
+
+    auto same_run = [](const DrawCandidate& a, const DrawCandidate& b) {
+        return a.material_template == b.material_template && a.vertex_format == b.vertex_format;
+    };
+
+    auto runs = std::make_shared<core::Vector<Run>>();
+    for_each_run(candidates.begin(), candidates.end(), same_run, [&](usize offset, usize size) {
+        for(usize i = 0; i != size; ++i) {
+            candidates[offset + i].data.run_index = u32(runs->size());
+            candidates[offset + i].data.run_offset = u32(offset);
+        }
+        runs->emplace_back(candidates[offset].material_template, candidates[offset].vertex_format, u32(offset), u32(size));
+    });
+
+    _runs = std::move(runs);
+    _candidate_count = candidates.size();
+    _dirty = !complete;
+
+    if(candidates.is_empty()) {
+        return;
+    }
+
+    if(_candidates.size() < candidates.size()) {
+        _candidates = CandidateBuffer(2_uu << log2ui(candidates.size()));
+    }
+
+    TypedStagingBuffer<shader::MeshDrawCandidate> staging(candidates.size());
+    {
+        auto mapping = staging.map(MappingAccess::WriteOnly);
+        for(usize i = 0; i != candidates.size(); ++i) {
+            mapping[i] = candidates[i].data;
+        }
+    }
+
+    {
+        const auto region = recorder.region("Static mesh draw list update");
+        recorder.unbarriered_copy(staging, SubBuffer<BufferUsage::TransferDstBit>(_candidates, staging.byte_size(), 0));
+        recorder.barriers(BufferBarrier(_candidates, PipelineStage::TransferBit, PipelineStage::ComputeBit));
+    }
+}
+
+usize StaticMeshDrawList::candidate_count() const {
+    return _candidate_count;
+}
+
+TypedSubBuffer<shader::MeshDrawCandidate, BufferUsage::StorageBit> StaticMeshDrawList::candidate_buffer() const {
+    return _candidates;
+}
+
+const std::shared_ptr<const core::Vector<StaticMeshDrawList::Run>>& StaticMeshDrawList::runs() const {
+    return _runs;
+}
+
+}
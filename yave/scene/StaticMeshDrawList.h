@@ -0,0 +1,80 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#ifndef YAVE_SCENE_STATICMESHDRAWLIST_H
+#define YAVE_SCENE_STATICMESHDRAWLIST_H
+
+#include "Scene.h"
+
+#include <yave/meshes/MeshVertexStreams.h>
+#include <yave/graphics/buffers/Buffer.h>
+#include <yave/graphics/shader_structs.h>
+#include <yave/framegraph/FrameGraphResourceId.h>
+
+#include <memory>
+
+namespace yave {
+
+// Every static mesh draw of a scene, kept on the GPU so that culling can be done in a compute shader.
+// Draws are grouped in runs sharing a material template and a vertex format, each run gets its own draw count.
+class StaticMeshDrawList : NonMovable {
+    public:
+        struct Run {
+            const MaterialTemplate* material_template = nullptr;
+            MeshVertexFormat vertex_format = MeshVertexFormat::Full;
+            u32 offset = 0;
+            u32 size = 0;
+        };
+
+        using CandidateBuffer = TypedBuffer<shader::MeshDrawCandidate, BufferUsage::StorageBit | BufferUsage::TransferDstBit>;
+
+        void set_dirty();
+        bool is_dirty() const;
+
+        // Meshes or materials that are still loading are skipped, and the list stays dirty until they are loaded
+        void rebuild(core::Span<StaticMeshObject> meshes, ComputeCapableCmdBufferRecorder& recorder);
+
+        usize candidate_count() const;
+        TypedSubBuffer<shader::MeshDrawCandidate, BufferUsage::StorageBit> candidate_buffer() const;
+
+        const std::shared_ptr<const core::Vector<Run>>& runs() const;
+
+    private:
+        CandidateBuffer _candidates;
+        std::shared_ptr<const core::Vector<Run>> _runs = std::make_shared<core::Vector<Run>>();
+        usize _candidate_count = 0;
+
+        bool _dirty = true;
+};
+
+// Output of the culling pass, laid out like the draw list: run i uses commands [offset, offset + size) and counts[i]
+struct CulledStaticMeshDraws {
+    FrameGraphTypedBufferId<VkDrawIndexedIndirectCommand> commands;
+    FrameGraphTypedBufferId<u32> counts;
+    FrameGraphTypedBufferId<math::Vec2ui> indices;
+    FrameGraphTypedBufferId<shader::MeshDecodeInfo> decode_infos;
+
+    std::shared_ptr<const core::Vector<StaticMeshDrawList::Run>> runs;
+};
+
+}
+
+#endif // YAVE_SCENE_STATICMESHDRAWLIST_H
@@ -0,0 +1,115 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#include "AnimationSystem.h"
+
+#include <yave/animations/SkeletonInstance.h>
+#include <yave/graphics/buffers/BufferMapping.h>
+#include <yave/graphics/commands/CmdQueue.h>
+
+#include <yave/ecs/EntityWorld.h>
+
+#include <y/utils/log.h>
+#include <y/utils/format.h>
+
+namespace yave {
+
+static constexpr usize default_bone_capacity = 16 * 1024;
+
+AnimationSystem::AnimationSystem() : ecs::System("AnimationSystem") {
+    for(FrameBuffer& frame : _frames) {
+        frame.buffer = BoneBuffer(default_bone_capacity);
+    }
+}
+
+void AnimationSystem::setup(ecs::SystemScheduler& sched) {
+    sched.schedule(ecs::SystemSchedule::Update, "Evaluate poses", [this](ecs::EntityGroup<ecs::Mutate<SkeletonInstance>>&& group, concurrent::StaticThreadPool& thread_pool) {
+        const float dt = float(_timer.reset().to_secs());
+
+        // Instances are packed in the buffer in group order
+        usize bone_count = 0;
+        for(auto&& [instance] : group) {
+            if(instance.advance(dt)) {
+                instance._bone_offset = u32(bone_count);
+                bone_count += instance.bone_count();
+            } else {
+                instance._bone_offset = SkeletonInstance::no_bone_offset;
+            }
+        }
+
+        _bone_count = bone_count;
+        if(!bone_count) {
+            return;
+        }
+
+        next_frame();
+        reserve_bones(bone_count);
+
+        // Workers write straight into the mapped buffer, each instance owns a disjoint range
+        auto mapping = _frames[_frame_index].buffer.map(MappingAccess::WriteOnly);
+        const core::MutableSpan<math::Transform<>> bones(mapping.data(), mapping.size());
+
+        _jobs.make_empty();
+        for(auto&& [instance] : group) {
+            if(instance.bone_offset() != SkeletonInstance::no_bone_offset) {
+                _jobs << instance.pose_job(core::MutableSpan<math::Transform<>>(bones.data() + instance.bone_offset(), instance.bone_count()));
+            }
+        }
+
+        y_profile_msg(fmt_c_str("{} skeletons, {} bones", _jobs.size(), bone_count));
+        evaluate_poses(_jobs, &thread_pool);
+    });
+}
+
+TypedSubBuffer<math::Transform<>, BufferUsage::StorageBit> AnimationSystem::bone_buffer() const {
+    return _frames[_frame_index].buffer;
+}
+
+usize AnimationSystem::bone_count() const {
+    return _bone_count;
+}
+
+void AnimationSystem::next_frame() {
+    y_profile();
+
+    // Everything submitted so far might read the current buffer
+    _frames[_frame_index].fence = command_queue().timeline().current_timeline();
+
+    _frame_index = (_frame_index + 1) % frames_in_flight;
+
+    FrameBuffer& frame = _frames[_frame_index];
+    if(frame.fence.is_valid()) {
+        frame.fence.wait();
+    }
+}
+
+void AnimationSystem::reserve_bones(usize bone_count) {
+    BoneBuffer& buffer = _frames[_frame_index].buffer;
+    if(buffer.size() >= bone_count) {
+        return;
+    }
+
+    const usize capacity = std::max(usize(buffer.size()) * 2, bone_count);
+    log_msg(fmt("Growing bone buffer to {} bones", capacity), Log::Perf);
+    buffer = BoneBuffer(capacity);
+}
+
+}
@@ -0,0 +1,74 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+#ifndef YAVE_SYSTEMS_ANIMATIONSYSTEM_H
+#define YAVE_SYSTEMS_ANIMATIONSYSTEM_H
+
+#include <yave/ecs/System.h>
+#include <yave/animations/pose.h>
+
+#include <yave/graphics/buffers/buffers.h>
+#include <yave/graphics/commands/Timeline.h>
+
+#include <y/core/Chrono.h>
+#include <y/core/Vector.h>
+
+#include <array>
+
+namespace yave {
+
+// Evaluates every SkeletonInstance of the world in parallel and writes all skinning palettes into one bone buffer.
+// Each instance gets its bone_offset into that buffer, which is only valid until the next update.
+// Bone buffers are cycled over several frames so that palettes still read by the GPU are never overwritten.
+class AnimationSystem : public ecs::System {
+    public:
+        using BoneBuffer = TypedBuffer<math::Transform<>, BufferUsage::StorageBit, MemoryType::CpuVisible>;
+
+        static constexpr usize frames_in_flight = 3;
+
+        AnimationSystem();
+
+        void setup(ecs::SystemScheduler& sched) override;
+
+        TypedSubBuffer<math::Transform<>, BufferUsage::StorageBit> bone_buffer() const;
+        usize bone_count() const;
+
+    private:
+        struct FrameBuffer {
+            BoneBuffer buffer;
+            TimelineFence fence;
+        };
+
+        void next_frame();
+        void reserve_bones(usize bone_count);
+
+        std::array<FrameBuffer, frames_in_flight> _frames;
+        usize _frame_index = 0;
+        usize _bone_count = 0;
+
+        core::Vector<PoseJob> _jobs;
+
+        core::Chrono _timer;
+};
+
+}
+
+#endif // YAVE_SYSTEMS_ANIMATIONSYSTEM_H
@@ -22,7 +22,7 @@ SOFTWARE.
 
 #include "DirectDraw.h"
 
-#include <yave/graphics/descriptors/DescriptorSet.h>
+#include <yave/graphics/descriptors/TransientDescriptorSet.h>
 #include <yave/graphics/buffers/Buffer.h>
 #include <yave/graphics/commands/CmdBufferRecorder.h>
 #include <yave/graphics/device/DeviceResources.h>
@@ -163,7 +163,7 @@ void DirectDraw::render(RenderPassRecorder& recorder, const math::Matrix4<>& vie
     }
 
     const auto* material = device_resources()[DeviceResources::WireFrameMaterialTemplate];
-    recorder.bind_material_template(material, DescriptorSet(InlineDescriptor(view_proj)));
+    recorder.bind_material_template(material, TransientDescriptorSet(recorder, InlineDescriptor(view_proj)));
     recorder.bind_attrib_buffers({vertices});
     recorder.draw_array(vertex_count);
 }
@@ -29,6 +29,8 @@ namespace yave {
 class AABB;
 class Animation;
 class AnimationChannel;
+class AnimationClip;
+class AnimationSystem;
 class AssetDependencies;
 class AssetLoader;
 class AssetLoaderSystem;
@@ -116,7 +118,9 @@ class MeshData;
 class MeshDrawBuffers;
 class MeshDrawData;
 class MeshVertexStreams;
+class ParallelRenderPass;
 class PhysicalDevice;
+class PipelineCache;
 class PointLightComponent;
 class RenderPass;
 class RenderPassRecorder;
@@ -148,6 +152,9 @@ class TransferCmdBufferRecorder;
 class TransformManager;
 class TransformableComponent;
 class TransientBuffer;
+class TransientDescriptorPool;
+class TransientDescriptorSet;
+class TransientDescriptorSetAllocator;
 class Window;
 struct Allocator;
 struct AssetData;
@@ -218,6 +225,7 @@ struct ObjectIndices;
 struct PackedVertex;
 struct Plane;
 struct Pool;
+struct PoseJob;
 struct Region;
 struct RendererSettings;
 struct ResourceCreateInfo;
@@ -0,0 +1,505 @@
+/*******************************
+Copyright (c) 2016-2024 Grégoire Angerand
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+**********************************/
+
+#include "profile.h"
+
+#include <y/core/HashMap.h>
+#include <y/core/Chrono.h>
+#include <y/io2/io.h>
+
+#include <y/utils/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace yave {
+namespace profiler {
+
+namespace {
+
+struct Event {
+    const char* name = nullptr;
+    u64 start = 0;
+    u64 end = 0;
+};
+
+// Slots can be overwritten while being read, so every field is atomic. Torn reads are detected and discarded by drain_buffer
+struct EventSlot {
+    std::atomic<const char*> name = nullptr;
+    std::atomic<u64> start = 0;
+    std::atomic<u64> end = 0;
+};
+
+// Single producer (the owning thread), single consumer (whoever calls end_frame)
+// Buffers are recycled once their thread has exited and they have been fully drained
+struct ThreadBuffer : NonMovable {
+    static constexpr usize capacity = 16 * 1024;
+    static constexpr u64 mask = capacity - 1;
+
+    static_assert(is_pow_of_2(capacity));
+
+    std::unique_ptr<EventSlot[]> events = std::make_unique<EventSlot[]>(capacity);
+    std::atomic<u64> write_index = 0;
+
+    u64 read_index = 0;
+    u32 thread_id = 0;
+    core::String thread_name;
+
+    // Protected by the state lock
+    bool in_use = true;
+};
+
+struct CapturedEvent {
+    Event event;
+    u32 thread_id = 0;
+};
+
+struct ZoneHistory {
+    const char* name = nullptr;
+    core::Vector<float> frame_ms;
+    core::Vector<u32> frame_calls;
+};
+
+struct ProfilerState {
+    std::mutex lock;
+
+    core::Vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+    // interned strings are never freed
+    core::FlatHashMap<std::string_view, const char*> interned;
+    core::Vector<std::unique_ptr<char[]>> interned_storage;
+
+    usize history_size = 128;
+    usize frame_index = 0;
+    usize frame_count = 0;
+    core::Vector<float> frame_ms;
+    core::FlatHashMap<std::string_view, usize> zone_indices;
+    core::Vector<ZoneHistory> zones;
+
+    usize capture_frames = 0;
+    bool capture_done = false;
+    core::Vector<CapturedEvent> capture;
+    core::Vector<Event> captured_frames;
+
+    core::Vector<Event> scratch;
+
+    u64 frame_start = 0;
+    u64 dropped_events = 0;
+
+    // Tick calibration
+    u64 origin_ticks = 0;
+    core::Chrono origin_chrono;
+    double ns_per_tick = 1.0;
+};
+
+ProfilerState& state() {
+    static ProfilerState* st = [] {
+        auto* s = new ProfilerState();
+        s->origin_ticks = detail::cpu_ticks();
+        s->origin_chrono.start();
+        s->frame_start = s->origin_ticks;
+        s->frame_ms = core::Vector<float>(s->history_size, 0.0f);
+        return s;
+    }();
+    return *st;
+}
+
+ThreadBuffer* register_thread() {
+    ProfilerState& st = state();
+    const std::unique_lock lock(st.lock);
+
+    ThreadBuffer* buffer = nullptr;
+    for(const auto& buf : st.buffers) {
+        // Buffers that still hold events of their previous thread can not be reused yet
+        if(!buf->in_use && buf->read_index == buf->write_index.load(std::memory_order_relaxed)) {
+            buffer = buf.get();
+            break;
+        }
+    }
+
+    if(!buffer) {
+        buffer = st.buffers.emplace_back(std::make_unique<ThreadBuffer>()).get();
+    }
+
+    buffer->in_use = true;
+    buffer->thread_id = concurrent::thread_id();
+    buffer->thread_name = concurrent::thread_name();
+
+    return buffer;
+}
+
+void release_thread(ThreadBuffer* buffer) {
+    ProfilerState& st = state();
+    const std::unique_lock lock(st.lock);
+    buffer->in_use = false;
+}
+
+struct ThreadBufferHandle : NonMovable {
+    ThreadBuffer* buffer = nullptr;
+
+    ~ThreadBufferHandle() {
+        if(buffer) {
+            release_thread(buffer);
+        }
+    }
+};
+
+thread_local ThreadBufferHandle this_thread_buffer;
+
+void calibrate(ProfilerState& st, u64 now) {
+    const u64 ticks = now - st.origin_ticks;
+    const u64 nanos = st.origin_chrono.elapsed().to_nanos();
+    if(ticks && nanos >= 1000000) {
+        st.ns_per_tick = double(nanos) / double(ticks);
+    }
+}
+
+double ticks_to_ms(const ProfilerState& st, u64 ticks) {
+    return double(ticks) * st.ns_per_tick * 0.000001;
+}
+
+double ticks_to_us(const ProfilerState& st, u64 ticks) {
+    return double(ticks) * st.ns_per_tick * 0.001;
+}
+
+void drain_buffer(ProfilerState& st, ThreadBuffer& buffer, core::Vector<Event>& out) {
+    const u64 write_index = buffer.write_index.load(std::memory_order_acquire);
+    if(write_index - buffer.read_index > ThreadBuffer::capacity) {
+        st.dropped_events += write_index - buffer.read_index - ThreadBuffer::capacity;
+        buffer.read_index = write_index - ThreadBuffer::capacity;
+    }
+
+    const usize first = out.size();
+    for(u64 i = buffer.read_index; i != write_index; ++i) {
+        const EventSlot& slot = buffer.events[i & ThreadBuffer::mask];
+        out << Event{slot.name.load(std::memory_order_relaxed), slot.start.load(std::memory_order_relaxed), slot.end.load(std::memory_order_relaxed)};
+    }
+
+    // The producer might have wrapped around while we were copying, discard anything that might have been overwritten.
+    // With a write index of n, the producer can be writing the slot of event n - capacity
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const u64 new_write_index = buffer.write_index.load(std::memory_order_relaxed);
+    if(new_write_index - buffer.read_index >= ThreadBuffer::capacity) {
+        const u64 overwritten = std::min(new_write_index - buffer.read_index - ThreadBuffer::capacity + 1, write_index - buffer.read_index);
+        std::move(out.begin() + first + overwritten, out.end(), out.begin() + first);
+        out.shrink_to(out.size() - usize(overwritten));
+        st.dropped_events += overwritten;
+    }
+
+    buffer.read_index = write_index;
+}
+
+void escape_json(core::String& out, std::string_view str) {
+    for(const char c : str) {
+        if(c == '"' || c == '\\') {
+            out.push_back('\\');
+        }
+        out.push_back(c);
+    }
+}
+
+ZoneHistory& zone_history(ProfilerState& st, const char* name) {
+    const std::string_view key = name;
+    if(const auto it = st.zone_indices.find(key); it != st.zone_indices.end()) {
+        return st.zones[it->second];
+    }
+
+    st.zone_indices.insert({key, st.zones.size()});
+
+    ZoneHistory& zone = st.zones.emplace_back();
+    zone.name = name;
+    zone.frame_ms = core::Vector<float>(st.history_size, 0.0f);
+    zone.frame_calls = core::Vector<u32>(st.history_size, 0u);
+    return zone;
+}
+
+}
+
+
+namespace detail {
+u64 cpu_ticks_fallback() {
+    return core::Chrono::program().to_nanos();
+}
+
+void record_zone(const char* name, u64 start, u64 end) {
+    ThreadBuffer* buffer = this_thread_buffer.buffer;
+    if(!buffer) [[unlikely]] {
+        buffer = this_thread_buffer.buffer = register_thread();
+    }
+
+    const u64 index = buffer->write_index.load(std::memory_order_relaxed);
+
+    // Pairs with the fence in drain_buffer: a consumer that sees any of these stores will also see the write index
+    std::atomic_thread_fence(std::memory_order_release);
+
+    EventSlot& slot = buffer->events[index & ThreadBuffer::mask];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.end.store(end, std::memory_order_relaxed);
+    buffer->write_index.store(index + 1, std::memory_order_release);
+}
+}
+
+
+bool is_enabled() {
+#ifdef YAVE_CPU_PROFILING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void set_history_size(usize frames) {
+    y_always_assert(frames, "History size can not be 0");
+
+    ProfilerState& st = state();
+    const std::unique_lock lock(st.lock);
+
+    st.history_size = frames;
+    st.frame_index = 0;
+    st.frame_count = 0;
+    st.frame_ms = core::Vector<float>(frames, 0.0f);
+    for(ZoneHistory& zone : st.zones) {
+        zone.frame_ms = core::Vector<float>(frames, 0.0f);
+        zone.frame_calls = core::Vector<u32>(frames, 0u);
+    }
+}
+
+usize history_size() {
+    ProfilerState& st = state();
+    const std::unique_lock lock(st.lock);
+    return st.history_size;
+}
+
+FrameStats frame_stats() {
+    ProfilerState& st = state();
+    const std::unique_lock lock(st.lock);
+
+    FrameStats stats;
+    stats.frame_count = std::min(st.frame_count, st.history_size);
+    stats.dropped_events = st.dropped_events;
+
+    if(!stats.frame_count) {
+        return stats;
+    }
+
+    stats.min_ms = std::numeric_limits<double>::max();
+    for(usize i = 0; i != stats.frame_count; ++i) {
+        const double ms = st.frame_ms[i];
+        stats.min_ms = std::min(stats.min_ms, ms);
+        stats.max_ms = std::max(stats.max_ms, ms);
+        stats.avg_ms += ms;
+    }
+    stats.avg_ms /= stats.frame_count;
+    stats.last_ms = st.frame_ms[(st.frame_index + st.history_size - 1) % st.history_size];
+
+    return stats;
+}
+
+core::Vector<ZoneStats> zone_stats() {
+    ProfilerState& st = state();
+    const std::unique_lock lock(st.lock);
+
+    const usize frame_count = std::min(st.frame_count, st.history_size);
+
+    core::Vector<ZoneStats> stats;
+    for(const ZoneHistory& zone : st.zones) {
+        ZoneStats zone_stats;
+        zone_stats.name = zone.name;
+        zone_stats.min_ms = std::numeric_limits<double>::max();
+
+        u64 total_calls = 0;
+        for(usize i = 0; i != frame_count; ++i) {
+            if(const u32 calls = zone.frame_calls[i]) {
+                const double ms = zone.frame_ms[i];
+                zone_stats.min_ms = std::min(zone_stats.min_ms, ms);
+                zone_stats.max_ms = std::max(zone_stats.max_ms, ms);
+                zone_stats.avg_ms += ms;
+                total_calls += calls;
+                ++zone_stats.active_frames;
+            }
+        }
+
+        if(!zone_stats.active_frames) {
+            continue;
+        }
+
+        zone_stats.avg_ms /= zone_stats.active_frames;
+        zone_stats.avg_calls = double(total_calls) / zone_stats.active_frames;
+        stats << zone_stats;
+    }
+
+    return stats;
+}
+
+void capture_frames(usize frame_count) {
+    ProfilerState& st = state();
+    const std::unique_lock lock(st.lock);
+
+    st.capture.make_empty();
+    st.captured_frames.make_empty();
+    st.capture_frames = frame_count;
+    st.capture_done = false;
+}
+
+bool is_capturing() {
+    ProfilerState& st = state();
+    const std::unique_lock lock(st.lock);
+    return st.capture_frames;
+}
+
+bool has_capture() {
+    ProfilerState& st = state();
+    const std::unique_lock lock(st.lock);
+    return st.capture_done;
+}
+
+bool export_chrome_trace(io2::Writer& writer) {
+    ProfilerState& st = state();
+    const std::unique_lock lock(st.lock);
+
+    if(!st.capture_done || st.captured_frames.is_empty()) {
+        return false;
+    }
+
+    const u64 origin = st.captured_frames[0].start;
+
+    core::String json = "{\"traceEvents\":[\n";
+
+    // The frame track uses thread id 0
+    json += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"Frames\"}}";
+    for(const auto& buffer : st.buffers) {
+        const std::string_view name = buffer->thread_name.is_empty() ? std::string_view("Unnamed thread") : buffer->thread_name.view();
+        fmt_into(json, ",\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":{},\"args\":{{\"name\":\"", buffer->thread_id + 1);
+        escape_json(json, name);
+        json += "\"}}";
+    }
+
+    auto push_event = [&](const Event& event, u32 tid) {
+        const u64 start = event.start > origin ? event.start - origin : 0;
+        const u64 end = event.end > origin ? event.end - origin : 0;
+        json += ",\n{\"name\":\"";
+        escape_json(json, event.name);
+        fmt_into(json, "\",\"ph\":\"X\",\"pid\":0,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}", tid, ticks_to_us(st, start), ticks_to_us(st, end - start));
+    };
+
+    for(const Event& frame : st.captured_frames) {
+        push_event(frame, 0);
+    }
+
+    for(const CapturedEvent& captured : st.capture) {
+        push_event(captured.event, captured.thread_id + 1);
+    }
+
+    json += "\n]}\n";
+
+    return writer.write(json.data(), json.size()).is_ok();
+}
+
+void begin_frame() {
+    // Frames are delimited by end_frame only
+}
+
+void end_frame() {
+    const u64 now = detail::cpu_ticks();
+
+    ProfilerState& st = state();
+    const std::unique_lock lock(st.lock);
+
+    calibrate(st, now);
+
+    const usize frame = st.frame_index;
+    st.frame_ms[frame] = float(ticks_to_ms(st, now - st.frame_start));
+    for(ZoneHistory& zone : st.zones) {
+        zone.frame_ms[frame] = 0.0f;
+        zone.frame_calls[frame] = 0;
+    }
+
+    const bool capturing = st.capture_frames;
+    if(capturing) {
+        st.captured_frames << Event{"Frame", st.frame_start, now};
+    }
+
+    for(const auto& buffer : st.buffers) {
+        st.scratch.make_empty();
+        drain_buffer(st, *buffer, st.scratch);
+
+        for(const Event& event : st.scratch) {
+            ZoneHistory& zone = zone_history(st, event.name);
+            zone.frame_ms[frame] += float(ticks_to_ms(st, event.end - event.start));
+            ++zone.frame_calls[frame];
+
+            if(capturing) {
+                st.capture << CapturedEvent{event, buffer->thread_id};
+            }
+        }
+    }
+
+    if(capturing && --st.capture_frames == 0) {
+        st.capture_done = true;
+    }
+
+    st.frame_index = (frame + 1) % st.history_size;
+    ++st.frame_count;
+    st.frame_start = now;
+}
+
+const char* intern_name(const char* name) {
+    thread_local core::FlatHashMap<std::string_view, const char*> cache;
+
+    const std::string_view view = name;
+    if(const auto it = cache.find(view); it != cache.end()) {
+        return it->second;
+    }
+
+    ProfilerState& st = state();
+    const std::unique_lock lock(st.lock);
+
+    const char* interned = nullptr;
+    if(const auto it = st.interned.find(view); it != st.interned.end()) {
+        interned = it->second;
+    } else {
+        auto storage = std::make_unique<char[]>(view.size() + 1);
+        std::copy_n(view.data(), view.size(), storage.get());
+        interned = storage.get();
+        st.interned.insert({std::string_view(interned, view.size()), interned});
+        st.interned_storage << std::move(storage);
+    }
+
+    cache.insert({std::string_view(interned, view.size()), interned});
+    return interned;
+}
+
+const char* location_name(const char* func, const char* file, int line) {
+    std::string_view file_name = file;
+    if(const usize sep = file_name.find_last_of("/\\"); sep != std::string_view::npos) {
+        file_name = file_name.substr(sep + 1);
+    }
+
+    const core::String name = fmt_to_owned("{} ({}:{})", func, file_name, line);
+    return intern_name(name.data());
+}
+
+}
+}
@@ -23,6 +23,8 @@ SOFTWARE.
 #define YAVE_UTILS_PROFILE_H
 
 #include <y/concurrent/concurrent.h>
+#include <y/core/Vector.h>
+
 #include <cstring>
 
 #if defined(TRACY_ENABLE) && !defined(YAVE_PROFILING_DISABLED)
@@ -34,20 +36,134 @@ SOFTWARE.
 #error TRACY_ENABLE should be set if YAVE_PROFILING is set
 #endif
 
+#if defined(YAVE_BUILTIN_PROFILING) && !defined(YAVE_PROFILING_DISABLED)
+#define YAVE_CPU_PROFILING
+#endif
+
+
+namespace y::io2 {
+class Writer;
+}
+
+namespace yave {
+
+using namespace y;
+
+namespace profiler {
+
+// Built-in zone recorder: zones are pushed into per-thread lock-free buffers
+// and aggregated on the frame boundary (when y_profile_frame_end() is called)
+
+struct ZoneStats {
+    const char* name = nullptr;
+
+    // Per frame values (all calls summed), computed over the frames where the zone was active
+    double min_ms = 0.0;
+    double avg_ms = 0.0;
+    double max_ms = 0.0;
+
+    double avg_calls = 0.0;
+    usize active_frames = 0;
+};
+
+struct FrameStats {
+    double min_ms = 0.0;
+    double avg_ms = 0.0;
+    double max_ms = 0.0;
+    double last_ms = 0.0;
+
+    usize frame_count = 0;
+    u64 dropped_events = 0;
+};
+
+bool is_enabled();
+
+void set_history_size(usize frames);
+usize history_size();
+
+FrameStats frame_stats();
+core::Vector<ZoneStats> zone_stats();
+
+// Records every event of the next frame_count frames, retrievable with export_chrome_trace
+void capture_frames(usize frame_count);
+bool is_capturing();
+bool has_capture();
+bool export_chrome_trace(io2::Writer& writer);
+
+void begin_frame();
+void end_frame();
+
+const char* intern_name(const char* name);
+
+// Returns a unique name for a source location, so that functions sharing a name get separate zones
+const char* location_name(const char* func, const char* file, int line);
+
+namespace detail {
+u64 cpu_ticks_fallback();
+void record_zone(const char* name, u64 start, u64 end);
+
+inline u64 cpu_ticks() {
+#if defined(Y_GNU) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_ia32_rdtsc();
+#else
+    return cpu_ticks_fallback();
+#endif
+}
+}
+
+class ScopedZone : NonMovable {
+    public:
+        inline ScopedZone(const char* name) : _name(name), _start(detail::cpu_ticks()) {
+        }
+
+        inline ~ScopedZone() {
+            detail::record_zone(_name, _start, detail::cpu_ticks());
+        }
+
+    private:
+        const char* _name = nullptr;
+        u64 _start = 0;
+};
+
+}
+}
+
+
+#ifdef YAVE_CPU_PROFILING
+
+#define y_cpu_profile_frame_begin()             yave::profiler::begin_frame()
+#define y_cpu_profile_frame_end()               yave::profiler::end_frame()
+
+#define y_cpu_profile_zone(name)                const yave::profiler::ScopedZone y_create_name_with_prefix(cpu_zone)(name)
+#define y_cpu_profile_dyn_zone(name)            const yave::profiler::ScopedZone y_create_name_with_prefix(cpu_zone)(yave::profiler::intern_name(name))
+#define y_cpu_profile_func()                    static const char* const y_create_name_with_prefix(cpu_zone_name) = yave::profiler::location_name(__func__, __FILE__, __LINE__); \
+                                                y_cpu_profile_zone(y_create_name_with_prefix(cpu_zone_name))
+
+#else
+
+#define y_cpu_profile_frame_begin()             do {} while(false)
+#define y_cpu_profile_frame_end()               do {} while(false)
+
+#define y_cpu_profile_zone(name)                do {} while(false)
+#define y_cpu_profile_dyn_zone(name)            do {} while(false)
+#define y_cpu_profile_func()                    do {} while(false)
+
+#endif // YAVE_CPU_PROFILING
+
 
 #ifdef YAVE_PROFILING
 
 #include <external/tracy/public/tracy/Tracy.hpp>
 
 
-#define y_profile_frame_begin()                 do {} while(false)
-#define y_profile_frame_end()                   do { FrameMark; } while(false)
+#define y_profile_frame_begin()                 do { y_cpu_profile_frame_begin(); } while(false)
+#define y_profile_frame_end()                   do { FrameMark; y_cpu_profile_frame_end(); } while(false)
 
 #define y_profile_msg(msg)                      do { const char* y_msg = (msg); TracyMessage(y_msg, std::strlen(y_msg)); } while(false)
 
-#define y_profile()                             ZoneNamed(y_create_name_with_prefix(tracy), true)
-#define y_profile_zone(name)                    ZoneNamedN(y_create_name_with_prefix(tracy), name, true)
-#define y_profile_dyn_zone(name)                ZoneNamed(y_create_name_with_prefix(tracy), true); ZoneNameV(y_create_name_with_prefix(tracy), name, std::strlen(name))
+#define y_profile()                             ZoneNamed(y_create_name_with_prefix(tracy), true); y_cpu_profile_func()
+#define y_profile_zone(name)                    ZoneNamedN(y_create_name_with_prefix(tracy), name, true); y_cpu_profile_zone(name)
+#define y_profile_dyn_zone(name)                ZoneNamed(y_create_name_with_prefix(tracy), true); ZoneNameV(y_create_name_with_prefix(tracy), name, std::strlen(name)); y_cpu_profile_dyn_zone(name)
 
 
 #define y_profile_alloc(ptr, size)              TracyAlloc(ptr, size)
@@ -59,14 +175,14 @@ SOFTWARE.
 
 #else
 
-#define y_profile_frame_begin()                 do {} while(false)
-#define y_profile_frame_end()                   do {} while(false)
+#define y_profile_frame_begin()                 y_cpu_profile_frame_begin()
+#define y_profile_frame_end()                   y_cpu_profile_frame_end()
 
 #define y_profile_msg(msg)                      do {} while(false)
 
-#define y_profile()                             do {} while(false)
-#define y_profile_zone(name)                    do {} while(false)
-#define y_profile_dyn_zone(name)                do {} while(false)
+#define y_profile()                             y_cpu_profile_func()
+#define y_profile_zone(name)                    y_cpu_profile_zone(name)
+#define y_profile_dyn_zone(name)                y_cpu_profile_dyn_zone(name)
 
 #define y_profile_alloc(ptr, size)              do {} while(false)
 #define y_profile_free(ptr)                     do {} while(false)
@@ -31,6 +31,10 @@ namespace y::core {
 class String;
 }
 
+namespace y::concurrent {
+class StaticThreadPool;
+}
+
 namespace yave {
 
 using namespace y;